@@ -0,0 +1,384 @@
+//*****************************************************************************
+//
+// autotune.c - Relay feedback autotuning of the cascaded controllers.
+//
+// The relay runs from MotorControl() through AutotuneOuter() and
+// AutotuneInner().  The foreground only starts or aborts an experiment and
+// reads the results once g_ui32AutotuneState shows it has ended, so nothing
+// here needs interrupt masking.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "utils/uartstdio.h"
+#include "motor_config.h"
+#include "control_math.h"
+#include "motor.h"
+#include "autotune.h"
+#include "params.h"
+
+//*****************************************************************************
+//
+// Tuning rules, from the ultimate gain and period of each loop.  The
+// velocity loop gets a Tyreus-Luyben PI, less aggressive than
+// Ziegler-Nichols and nearly free of overshoot; the position loop a
+// proportional gain with the gain margin of AUTOTUNE_KP_RATIO, the outer
+// loop of a cascade being kept well inside the inner one.
+//
+//*****************************************************************************
+#define AUTOTUNE_KV_RATIO       (1.0f / 3.2f)   // Kv / Ku
+#define AUTOTUNE_TI_RATIO       2.2f            // Ti / Tu
+#define AUTOTUNE_KP_RATIO       (1.0f / 4.0f)   // Kp / Ku
+
+#define AUTOTUNE_PI             3.14159265f
+
+//*****************************************************************************
+//
+// Relay with hysteresis and the measurement of the oscillation it causes
+//
+//*****************************************************************************
+typedef struct
+{
+    int32_t Amplitude;          // Relay output
+    int32_t Hysteresis;         // Input band the relay holds in
+    int32_t Output;             // +Amplitude or -Amplitude
+    uint32_t Switches;          // Upward switches so far
+    uint32_t CycleStart;        // Tick of the last upward switch
+    int32_t Max;                // Input extremes since then
+    int32_t Min;
+    uint32_t PeriodSum;         // Over the measured cycles [ticks]
+    int64_t SwingSum;           // Peak to peak, over the measured cycles
+    uint32_t Cycles;            // Cycles measured
+}
+tAutotuneRelay;
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+volatile uint32_t g_ui32AutotuneAxis = AUTOTUNE_NO_AXIS;   // Axis tuned
+volatile uint32_t g_ui32AutotuneState = AUTOTUNE_IDLE;
+tAutotuneResult g_sAutotuneVelocity;
+tAutotuneResult g_sAutotunePosition;
+
+static tAutotuneRelay g_sAutotuneRelay;
+static uint32_t g_ui32AutotuneTick;         // Ticks into the experiment
+static uint32_t g_ui32AutotuneLastAxis;     // Axis of the next report
+static volatile bool g_bAutotuneAbort;      // Set by AutotuneAbort()
+
+//
+// Gains of the axis before the experiment, restored if it fails
+//
+static control_gain_t g_sAutotuneSavedKp;
+static control_gain_t g_sAutotuneSavedKv;
+static control_gain_t g_sAutotuneSavedKi;
+
+
+//*****************************************************************************
+//
+// Start a relay experiment
+//
+//*****************************************************************************
+static void AutotuneRelayInit(int32_t i32Amplitude, int32_t i32Hysteresis)
+{
+    g_sAutotuneRelay.Amplitude = i32Amplitude;
+    g_sAutotuneRelay.Hysteresis = i32Hysteresis;
+    g_sAutotuneRelay.Output = -i32Amplitude;
+    g_sAutotuneRelay.Switches = 0;
+    g_sAutotuneRelay.CycleStart = 0;
+    g_sAutotuneRelay.Max = INT32_MIN;
+    g_sAutotuneRelay.Min = INT32_MAX;
+    g_sAutotuneRelay.PeriodSum = 0;
+    g_sAutotuneRelay.SwingSum = 0;
+    g_sAutotuneRelay.Cycles = 0;
+    g_ui32AutotuneTick = 0;
+}
+
+
+//*****************************************************************************
+//
+// Switch the relay on its input (reference - measurement) and measure each
+// cycle from one upward switch to the next.  Returns true once
+// AUTOTUNE_CYCLES cycles are measured.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(AutotuneRelayStep, ".ramfunc")
+#endif
+static bool AutotuneRelayStep(int32_t i32Input)
+{
+    tAutotuneRelay *psRelay = &g_sAutotuneRelay;
+
+    if (i32Input > psRelay->Max)
+        psRelay->Max = i32Input;
+    if (i32Input < psRelay->Min)
+        psRelay->Min = i32Input;
+
+    if ((psRelay->Output < 0) && (i32Input > psRelay->Hysteresis))
+    {
+        psRelay->Output = psRelay->Amplitude;
+
+        if (psRelay->Switches > AUTOTUNE_SKIP_CYCLES)
+        {
+            psRelay->PeriodSum += g_ui32AutotuneTick - psRelay->CycleStart;
+            psRelay->SwingSum += psRelay->Max - psRelay->Min;
+            psRelay->Cycles++;
+        }
+        psRelay->Switches++;
+        psRelay->CycleStart = g_ui32AutotuneTick;
+        psRelay->Max = i32Input;
+        psRelay->Min = i32Input;
+    }
+    else if ((psRelay->Output > 0) && (i32Input < -psRelay->Hysteresis))
+    {
+        psRelay->Output = -psRelay->Amplitude;
+    }
+
+    return psRelay->Cycles >= AUTOTUNE_CYCLES;
+}
+
+
+//*****************************************************************************
+//
+// Ultimate gain and period from the measured cycles.  Returns false when
+// the oscillation stayed inside the hysteresis.
+//
+//*****************************************************************************
+static bool AutotuneRelayResult(tAutotuneResult *psResult)
+{
+    const tAutotuneRelay *psRelay = &g_sAutotuneRelay;
+    float fSwing, fHyst, fA2;
+
+    fSwing = (float)psRelay->SwingSum / (float)(2 * psRelay->Cycles);
+    fHyst = (float)psRelay->Hysteresis;
+    fA2 = fSwing * fSwing - fHyst * fHyst;
+    if (fA2 <= 0.0f)
+        return false;
+
+    psResult->Ku = 4.0f * (float)psRelay->Amplitude /
+                   (AUTOTUNE_PI * sqrtf(fA2));
+    psResult->Tu = (float)psRelay->PeriodSum /
+                   ((float)psRelay->Cycles * (float)CONTROL_TICK_HZ);
+    psResult->Cycles = psRelay->Cycles;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// End the experiment, restoring the previous gains unless it succeeded
+//
+//*****************************************************************************
+static void AutotuneEnd(uint32_t ui32Axis, uint32_t ui32State)
+{
+    if (ui32State != AUTOTUNE_DONE)
+    {
+        g_sParams.Kp[ui32Axis] = g_sAutotuneSavedKp;
+        g_sParams.Kv[ui32Axis] = g_sAutotuneSavedKv;
+        g_sParams.Ki[ui32Axis] = g_sAutotuneSavedKi;
+    }
+    g_sMotor.Integral[ui32Axis] = 0;
+
+    g_ui32AutotuneAxis = AUTOTUNE_NO_AXIS;
+    g_ui32AutotuneState = ui32State;
+}
+
+
+//*****************************************************************************
+//
+// Start tuning an axis.  The axis should be at rest under closed loop
+// control.  Returns false while another experiment runs.
+//
+//*****************************************************************************
+bool AutotuneStart(uint32_t ui32Axis)
+{
+    if (g_ui32AutotuneAxis != AUTOTUNE_NO_AXIS)
+        return false;
+
+    g_sAutotuneSavedKp = g_sParams.Kp[ui32Axis];
+    g_sAutotuneSavedKv = g_sParams.Kv[ui32Axis];
+    g_sAutotuneSavedKi = g_sParams.Ki[ui32Axis];
+    g_sAutotuneVelocity.Cycles = 0;
+    g_sAutotunePosition.Cycles = 0;
+    g_ui32AutotuneLastAxis = ui32Axis;
+    g_bAutotuneAbort = false;
+
+    AutotuneRelayInit(AUTOTUNE_VELOCITY_RELAY, AUTOTUNE_VELOCITY_HYST);
+    g_ui32AutotuneState = AUTOTUNE_VELOCITY;
+
+    //
+    // The control interrupt picks the experiment up from here
+    //
+    g_ui32AutotuneAxis = ui32Axis;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Outer loop hook, called by MotorControl() for the axis being tuned on the
+// ticks the position loop runs.  The position experiment replaces the
+// velocity command with the relay.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(AutotuneOuter, ".ramfunc")
+#endif
+void AutotuneOuter(uint32_t ui32Axis)
+{
+    float fKp;
+
+    if (g_ui32AutotuneState != AUTOTUNE_POSITION)
+        return;
+
+    if (AutotuneRelayStep(g_sMotor.Error[ui32Axis]))
+    {
+        if (!AutotuneRelayResult(&g_sAutotunePosition))
+        {
+            AutotuneEnd(ui32Axis, AUTOTUNE_FAILED);
+            return;
+        }
+
+        fKp = AUTOTUNE_KP_RATIO * g_sAutotunePosition.Ku;
+        g_sParams.Kp[ui32Axis] = ControlGainFromMicro((int32_t)(fKp * 1.0e6f));
+        AutotuneEnd(ui32Axis, AUTOTUNE_DONE);
+        return;
+    }
+
+    g_sMotor.VelocityCmd[ui32Axis] = g_sAutotuneRelay.Output;
+}
+
+
+//*****************************************************************************
+//
+// Inner loop hook, called by MotorControl() every tick for the axis being
+// tuned with the output of its velocity loop [%].  The velocity experiment
+// replaces it with the relay.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(AutotuneInner, ".ramfunc")
+#endif
+control_t AutotuneInner(uint32_t ui32Axis, control_t u)
+{
+    float fKv, fKi;
+
+    if (g_bAutotuneAbort)
+    {
+        AutotuneEnd(ui32Axis, AUTOTUNE_ABORTED);
+        return u;
+    }
+
+    if (++g_ui32AutotuneTick > AUTOTUNE_TIMEOUT)
+    {
+        AutotuneEnd(ui32Axis, AUTOTUNE_FAILED);
+        return u;
+    }
+
+    if (g_ui32AutotuneState != AUTOTUNE_VELOCITY)
+        return u;
+
+    if (AutotuneRelayStep(-g_sMotor.Velocity[ui32Axis]))
+    {
+        if (!AutotuneRelayResult(&g_sAutotuneVelocity))
+        {
+            AutotuneEnd(ui32Axis, AUTOTUNE_FAILED);
+            return u;
+        }
+
+        //
+        // PI gains for the velocity loop, then on to the position loop
+        //
+        fKv = AUTOTUNE_KV_RATIO * g_sAutotuneVelocity.Ku;
+        fKi = fKv / (AUTOTUNE_TI_RATIO * g_sAutotuneVelocity.Tu);
+        g_sParams.Kv[ui32Axis] = ControlGainFromMicro((int32_t)(fKv * 1.0e6f));
+        g_sParams.Ki[ui32Axis] =
+            ControlGainFromMicroRate((int32_t)(fKi * 1.0e6f), CONTROL_TICK_HZ);
+        g_sMotor.Integral[ui32Axis] = 0;
+
+        AutotuneRelayInit(AUTOTUNE_POSITION_RELAY, AUTOTUNE_POSITION_HYST);
+        g_ui32AutotuneState = AUTOTUNE_POSITION;
+        return u;
+    }
+
+    g_sMotor.Integral[ui32Axis] = 0;
+
+    return CONTROL_FROM_INT(g_sAutotuneRelay.Output);
+}
+
+
+//*****************************************************************************
+//
+// Stop the running experiment.  The control interrupt ends it on its next
+// tick and restores the previous gains.  Returns false if none runs.
+//
+//*****************************************************************************
+bool AutotuneAbort(void)
+{
+    if (g_ui32AutotuneAxis == AUTOTUNE_NO_AXIS)
+        return false;
+
+    g_bAutotuneAbort = true;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Called by the main loop.  Once an experiment has ended, print its report
+// and go back to idle.  The interrupt leaves the state alone from the end
+// of an experiment until the next AutotuneStart().
+//
+//*****************************************************************************
+void AutotunePoll(void)
+{
+    if ((g_ui32AutotuneState != AUTOTUNE_DONE) &&
+        (g_ui32AutotuneState != AUTOTUNE_FAILED) &&
+        (g_ui32AutotuneState != AUTOTUNE_ABORTED))
+        return;
+
+    AutotuneReport(g_ui32AutotuneLastAxis);
+    g_ui32AutotuneState = AUTOTUNE_IDLE;
+}
+
+
+//*****************************************************************************
+//
+// Print the outcome of the last experiment and the gains of the axis in the
+// units of the gain commands
+//
+//*****************************************************************************
+void AutotuneReport(uint32_t ui32Axis)
+{
+    static const char *const ppcState[] =
+    {
+        "idle", "velocity loop", "position loop", "done", "failed", "aborted"
+    };
+    const tAutotuneResult *psResult;
+    uint32_t i;
+
+    UARTprintf("Autotune motor %u: %s\n", ui32Axis + 1,
+               ppcState[g_ui32AutotuneState]);
+
+    for (i = 0; i < 2; i++)
+    {
+        psResult = i ? &g_sAutotunePosition : &g_sAutotuneVelocity;
+        if (psResult->Cycles)
+            UARTprintf("  %s loop: Ku %d [1e-6], Tu %d us over %u cycles\n",
+                       i ? "position" : "velocity",
+                       (int32_t)(psResult->Ku * 1.0e6f),
+                       (int32_t)(psResult->Tu * 1.0e6f), psResult->Cycles);
+    }
+
+    UARTprintf("  kp %d | kv %d | ki %d [1e-6]\n",
+               ControlGainToMicro(g_sParams.Kp[ui32Axis]),
+               ControlGainToMicro(g_sParams.Kv[ui32Axis]),
+               ControlGainToMicroRate(g_sParams.Ki[ui32Axis],
+                                      CONTROL_TICK_HZ));
+}
@@ -0,0 +1,102 @@
+//*****************************************************************************
+//
+// autotune.h - Relay feedback autotuning of the cascaded controllers.
+//
+// AutotuneStart() runs two relay experiments (Astrom-Hagglund) on one axis
+// from the control interrupt while the other axes keep running:
+//
+// 1. Velocity loop.  The PI output of the axis is replaced by a relay of
+//    +-AUTOTUNE_VELOCITY_RELAY % switching on the sign of the velocity, so
+//    the axis shakes about standstill.
+// 2. Position loop.  With the velocity gains from the first experiment in
+//    place, the velocity command of the outer loop is replaced by a relay
+//    of +-AUTOTUNE_POSITION_RELAY counts/s switching on the sign of the
+//    position error, so the axis oscillates about its setpoint.
+//
+// Each relay has a hysteresis of +-e on its input.  After
+// AUTOTUNE_SKIP_CYCLES cycles the period Tu and the amplitude a of the
+// input are averaged over AUTOTUNE_CYCLES cycles, and the describing
+// function of the relay gives the ultimate gain of the loop:
+//
+//   Ku = 4 d / (pi * sqrt(a^2 - e^2))
+//
+// for a relay amplitude d.  The velocity loop gets the PI gains and the
+// position loop the proportional gain of the rules in autotune.c, applied
+// as soon as each experiment ends.  The feedforward gains are left alone.
+// An experiment that does not finish within AUTOTUNE_TIMEOUT ticks, or is
+// stopped by AutotuneAbort(), restores the previous gains.
+//
+// AutotuneStart() returns at once.  The main loop calls AutotunePoll(),
+// which prints the report once the experiments have ended.
+//
+// Only the relay switching runs in the interrupt, a few compares per tick.
+// The gains are worked out once at the end of each experiment.
+//
+//*****************************************************************************
+
+#ifndef __AUTOTUNE_H__
+#define __AUTOTUNE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor_config.h"
+#include "control_math.h"
+
+//*****************************************************************************
+//
+// Experiment parameters
+//
+//*****************************************************************************
+#define AUTOTUNE_VELOCITY_RELAY     10      // Relay amplitude [%]
+#define AUTOTUNE_VELOCITY_HYST      200     // Hysteresis [counts/s]
+#define AUTOTUNE_POSITION_RELAY     2000    // Relay amplitude [counts/s]
+#define AUTOTUNE_POSITION_HYST      2       // Hysteresis [counts]
+#define AUTOTUNE_SKIP_CYCLES        2       // Settling cycles
+#define AUTOTUNE_CYCLES             4       // Measured cycles
+#define AUTOTUNE_TIMEOUT            (2 * CONTROL_TICK_HZ)   // Per experiment
+
+//*****************************************************************************
+//
+// State of the autotuner
+//
+//*****************************************************************************
+#define AUTOTUNE_IDLE           0
+#define AUTOTUNE_VELOCITY       1       // Velocity loop experiment
+#define AUTOTUNE_POSITION       2       // Position loop experiment
+#define AUTOTUNE_DONE           3
+#define AUTOTUNE_FAILED         4
+#define AUTOTUNE_ABORTED        5
+
+#define AUTOTUNE_NO_AXIS        0xFFFFFFFF
+
+//*****************************************************************************
+//
+// Result of one experiment
+//
+//*****************************************************************************
+typedef struct
+{
+    float Ku;                   // Ultimate gain
+    float Tu;                   // Ultimate period [s]
+    uint32_t Cycles;            // Cycles measured
+}
+tAutotuneResult;
+
+extern volatile uint32_t g_ui32AutotuneAxis;
+extern volatile uint32_t g_ui32AutotuneState;
+extern tAutotuneResult g_sAutotuneVelocity;
+extern tAutotuneResult g_sAutotunePosition;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern bool AutotuneStart(uint32_t ui32Axis);
+extern void AutotuneOuter(uint32_t ui32Axis);
+extern control_t AutotuneInner(uint32_t ui32Axis, control_t u);
+extern bool AutotuneAbort(void);
+extern void AutotunePoll(void);
+extern void AutotuneReport(uint32_t ui32Axis);
+
+#endif // __AUTOTUNE_H__
@@ -0,0 +1,127 @@
+//*****************************************************************************
+//
+// clock_config.h - System clock and the periods derived from it.
+//
+// SYSTEM_CLOCK_MHZ selects the system clock, one of the PLL settings below
+// (16 MHz crystal, 400 MHz PLL divided by 2 and by the system divider).
+// Every count of system clocks in the firmware is derived from
+// SYSTEM_CLOCK_HZ here: the PWM period, the period of the control tick
+// timer, the QEI velocity capture window and the clocks per microsecond.
+// Changing the clock keeps the PWM at CLOCK_PWM_HZ and the control tick at
+// CONTROL_TICK_HZ; the checks at the end stop the build if a rate cannot be
+// met exactly at the selected clock.
+//
+// The derivations take the clock as an argument so that
+// tools/clock_check.cpp can check them for every supported clock.
+//
+//*****************************************************************************
+
+#ifndef __CLOCK_CONFIG_H__
+#define __CLOCK_CONFIG_H__
+
+#include "motor_config.h"
+
+//*****************************************************************************
+//
+// System clock [MHz].  Can also be set from the project's predefined
+// symbols (--define).
+//
+// 80 -> SYSCTL_SYSDIV_2_5, the highest clock of the TM4C123
+// 50 -> SYSCTL_SYSDIV_4
+// 40 -> SYSCTL_SYSDIV_5
+//
+//*****************************************************************************
+#ifndef SYSTEM_CLOCK_MHZ
+#define SYSTEM_CLOCK_MHZ        80
+#endif
+
+#if SYSTEM_CLOCK_MHZ == 80
+#define SYSTEM_CLOCK_SYSDIV     SYSCTL_SYSDIV_2_5
+#elif SYSTEM_CLOCK_MHZ == 50
+#define SYSTEM_CLOCK_SYSDIV     SYSCTL_SYSDIV_4
+#elif SYSTEM_CLOCK_MHZ == 40
+#define SYSTEM_CLOCK_SYSDIV     SYSCTL_SYSDIV_5
+#else
+#error "SYSTEM_CLOCK_MHZ must be 80, 50 or 40"
+#endif
+
+#define SYSTEM_CLOCK_HZ         (SYSTEM_CLOCK_MHZ * 1000000)
+
+//
+// The supported clocks [MHz], for the host checks.  Keep in step with the
+// list above.
+//
+#define CLOCK_SUPPORTED_MHZ     { 80, 50, 40 }
+
+//*****************************************************************************
+//
+// Rates that do not depend on the clock
+//
+// CLOCK_PWM_HZ           PWM frequency of the motor drives
+// CLOCK_QEI_VELOCITY_HZ  QEI velocity captures per second (800 us window)
+// CLOCK_QEI_VELOCITY_US  the same capture window [us]
+//
+//*****************************************************************************
+#define CLOCK_PWM_HZ            20000
+#define CLOCK_QEI_VELOCITY_HZ   1250
+#define CLOCK_QEI_VELOCITY_US   (1000000 / CLOCK_QEI_VELOCITY_HZ)
+
+//*****************************************************************************
+//
+// Periods [system clocks] at a clock of ui32ClockHz.  The PWM clock is the
+// system clock (SYSCTL_PWMDIV_1).
+//
+//*****************************************************************************
+#define CLOCK_PERIOD(ui32ClockHz, ui32Hz)   ((ui32ClockHz) / (ui32Hz))
+#define CLOCK_PWM_PERIOD(ui32ClockHz)                                         \
+    CLOCK_PERIOD(ui32ClockHz, CLOCK_PWM_HZ)
+#define CLOCK_TICK_PERIOD(ui32ClockHz)                                        \
+    CLOCK_PERIOD(ui32ClockHz, CONTROL_TICK_HZ)
+#define CLOCK_QEI_VELOCITY_PERIOD(ui32ClockHz)                                \
+    CLOCK_PERIOD(ui32ClockHz, CLOCK_QEI_VELOCITY_HZ)
+#define CLOCK_PER_US(ui32ClockHz)           ((ui32ClockHz) / 1000000)
+#define CLOCK_US_PERIOD(ui32ClockHz, ui32Us)                                  \
+    ((ui32Us) * CLOCK_PER_US(ui32ClockHz))
+
+//
+// True if a rate divides the clock exactly
+//
+#define CLOCK_EXACT(ui32ClockHz, ui32Hz)    (((ui32ClockHz) % (ui32Hz)) == 0)
+
+//
+// True if the PWM period suits the generators: even, as they count up and
+// down, within their 16-bit load register, and a whole number of clocks per
+// percent of duty cycle (MOTOR_PWM_PER_PERCENT)
+//
+#define CLOCK_PWM_PERIOD_VALID(ui32Period)                                    \
+    ((((ui32Period) % 2) == 0) && ((ui32Period) / 2 <= 0xFFFF) &&             \
+     (((ui32Period) % 100) == 0))
+
+//*****************************************************************************
+//
+// Checks of the selected clock
+//
+//*****************************************************************************
+#if !CLOCK_EXACT(SYSTEM_CLOCK_HZ, 1000000)
+#error "The system clock must be a whole number of MHz"
+#endif
+#if !CLOCK_EXACT(SYSTEM_CLOCK_HZ, CLOCK_PWM_HZ)
+#error "The system clock is not a multiple of CLOCK_PWM_HZ"
+#endif
+#if !CLOCK_PWM_PERIOD_VALID(CLOCK_PWM_PERIOD(SYSTEM_CLOCK_HZ))
+#error "The PWM period does not suit the PWM generators"
+#endif
+#if !CLOCK_EXACT(SYSTEM_CLOCK_HZ, CONTROL_TICK_HZ)
+#error "The system clock is not a multiple of CONTROL_TICK_HZ"
+#endif
+#if !CLOCK_EXACT(SYSTEM_CLOCK_HZ, CLOCK_QEI_VELOCITY_HZ)
+#error "The system clock is not a multiple of CLOCK_QEI_VELOCITY_HZ"
+#endif
+#if !CLOCK_EXACT(1000000, CLOCK_QEI_VELOCITY_HZ)
+#error "The QEI velocity capture window is not a whole number of us"
+#endif
+#if SYSTEM_CLOCK_HZ < 16 * CONSOLE_BAUD
+#error "CONSOLE_BAUD is above SysClk / 16"
+#endif
+
+#endif // __CLOCK_CONFIG_H__
@@ -0,0 +1,366 @@
+//*****************************************************************************
+//
+// command.c - Non-blocking console command parser.
+//
+// The parser keeps the line being received in a few static variables.
+// Numbers are accumulated digit by digit as they arrive, so no line buffer
+// and no sscanf() are needed.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "utils/uartstdio.h"
+#include "command.h"
+
+#ifndef UART_BUFFERED
+#error "The command parser needs the buffered uartstdio (UART_BUFFERED)"
+#endif
+
+//*****************************************************************************
+//
+// Parser states
+//
+//*****************************************************************************
+#define COMMAND_STATE_NAME      0       // Receiving the command name
+#define COMMAND_STATE_SPACE     1       // Between two words
+#define COMMAND_STATE_NUMBER    2       // Receiving an argument
+#define COMMAND_STATE_ERROR     3       // Line is bad, skip to its end
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+static uint32_t g_ui32CommandState = COMMAND_STATE_NAME;
+static int g_iCommandError = COMMAND_OK;    // Reason for COMMAND_STATE_ERROR
+
+static char g_pcCommandName[COMMAND_MAX_NAME + 1];
+static uint32_t g_ui32CommandNameLen = 0;
+
+static int32_t g_pi32CommandArgs[COMMAND_MAX_ARGS];
+static uint32_t g_ui32CommandArgc = 0;
+
+static uint32_t g_ui32NumberValue;          // Magnitude so far
+static uint32_t g_ui32NumberBase;           // 10 or 16
+static uint32_t g_ui32NumberDigits;         // Characters taken so far
+static bool g_bNumberNegative;
+
+
+//*****************************************************************************
+//
+// Start over with an empty line
+//
+//*****************************************************************************
+static void CommandReset(void)
+{
+    g_ui32CommandState = COMMAND_STATE_NAME;
+    g_iCommandError = COMMAND_OK;
+    g_ui32CommandNameLen = 0;
+    g_ui32CommandArgc = 0;
+}
+
+
+//*****************************************************************************
+//
+// Mark the line as bad, the rest of it is ignored
+//
+//*****************************************************************************
+static void CommandFail(int iError)
+{
+    g_ui32CommandState = COMMAND_STATE_ERROR;
+    g_iCommandError = iError;
+}
+
+
+//*****************************************************************************
+//
+// Begin a new argument
+//
+//*****************************************************************************
+static void CommandNumberStart(void)
+{
+    if (g_ui32CommandArgc >= COMMAND_MAX_ARGS)
+    {
+        CommandFail(COMMAND_TOO_MANY_ARGS);
+        return;
+    }
+
+    g_ui32NumberValue = 0;
+    g_ui32NumberBase = 10;
+    g_ui32NumberDigits = 0;
+    g_bNumberNegative = false;
+    g_ui32CommandState = COMMAND_STATE_NUMBER;
+}
+
+
+//*****************************************************************************
+//
+// Add one character to the argument being received
+//
+//*****************************************************************************
+static void CommandNumberChar(unsigned char ucChar)
+{
+    uint32_t ui32Digit;
+
+    //
+    // Sign and base prefix
+    //
+    if ((ucChar == '-') && (g_ui32NumberDigits == 0) && !g_bNumberNegative)
+    {
+        g_bNumberNegative = true;
+        return;
+    }
+
+    if (((ucChar == 'x') || (ucChar == 'X')) && (g_ui32NumberDigits == 1) &&
+        (g_ui32NumberValue == 0) && (g_ui32NumberBase == 10))
+    {
+        g_ui32NumberBase = 16;
+        g_ui32NumberDigits = 0;
+        return;
+    }
+
+    if ((ucChar >= '0') && (ucChar <= '9'))
+        ui32Digit = ucChar - '0';
+    else if ((g_ui32NumberBase == 16) && (ucChar >= 'a') && (ucChar <= 'f'))
+        ui32Digit = ucChar - 'a' + 10;
+    else if ((g_ui32NumberBase == 16) && (ucChar >= 'A') && (ucChar <= 'F'))
+        ui32Digit = ucChar - 'A' + 10;
+    else
+    {
+        CommandFail(COMMAND_INVALID_ARG);
+        return;
+    }
+
+    //
+    // Hex covers the full 32-bit pattern, decimal must fit an int32_t
+    //
+    if (g_ui32NumberBase == 16)
+    {
+        if (g_ui32NumberValue > 0x0FFFFFFF)
+        {
+            CommandFail(COMMAND_INVALID_ARG);
+            return;
+        }
+        g_ui32NumberValue = (g_ui32NumberValue << 4) | ui32Digit;
+    }
+    else
+    {
+        if (g_ui32NumberValue > (0x80000000 - ui32Digit) / 10)
+        {
+            CommandFail(COMMAND_INVALID_ARG);
+            return;
+        }
+        g_ui32NumberValue = g_ui32NumberValue * 10 + ui32Digit;
+    }
+
+    g_ui32NumberDigits++;
+}
+
+
+//*****************************************************************************
+//
+// Store the argument that just ended
+//
+//*****************************************************************************
+static void CommandNumberEnd(void)
+{
+    if (g_ui32NumberDigits == 0)
+    {
+        CommandFail(COMMAND_INVALID_ARG);
+        return;
+    }
+
+    if ((g_ui32NumberBase == 10) && !g_bNumberNegative &&
+        (g_ui32NumberValue > 0x7FFFFFFF))
+    {
+        CommandFail(COMMAND_INVALID_ARG);
+        return;
+    }
+
+    g_pi32CommandArgs[g_ui32CommandArgc++] =
+        (int32_t)(g_bNumberNegative ? (0 - g_ui32NumberValue) :
+                                      g_ui32NumberValue);
+    g_ui32CommandState = COMMAND_STATE_SPACE;
+}
+
+
+//*****************************************************************************
+//
+// Compare the received name with a table entry
+//
+//*****************************************************************************
+static bool CommandMatch(const char *pcCmd)
+{
+    uint32_t i;
+
+    for (i = 0; i < g_ui32CommandNameLen; i++)
+    {
+        if (pcCmd[i] != g_pcCommandName[i])
+            return false;
+    }
+
+    return pcCmd[i] == 0;
+}
+
+
+//*****************************************************************************
+//
+// Look up and run the command of a complete line
+//
+//*****************************************************************************
+static int CommandDispatch(void)
+{
+    const tCommandEntry *psEntry;
+
+    if (g_ui32CommandState == COMMAND_STATE_NUMBER)
+        CommandNumberEnd();
+
+    if (g_ui32CommandState == COMMAND_STATE_ERROR)
+        return g_iCommandError;
+
+    for (psEntry = g_psCommandTable; psEntry->pcCmd; psEntry++)
+    {
+        if (CommandMatch(psEntry->pcCmd))
+            return psEntry->pfnCmd(g_ui32CommandArgc, g_pi32CommandArgs);
+    }
+
+    return COMMAND_BAD_CMD;
+}
+
+
+//*****************************************************************************
+//
+// Feed one received character to the parser.  Returns the status of the
+// command when the character ends a non-empty line, COMMAND_OK otherwise.
+//
+//*****************************************************************************
+int CommandInput(unsigned char ucChar)
+{
+    int iStatus;
+
+    //
+    // End of line - run the command
+    //
+    if ((ucChar == '\r') || (ucChar == '\n'))
+    {
+        if ((g_ui32CommandState == COMMAND_STATE_NAME) &&
+            (g_ui32CommandNameLen == 0))
+            return COMMAND_OK;
+
+        iStatus = CommandDispatch();
+        CommandReset();
+        return iStatus;
+    }
+
+    //
+    // Separators end the current word
+    //
+    if ((ucChar == ' ') || (ucChar == '\t') || (ucChar == ','))
+    {
+        if (g_ui32CommandState == COMMAND_STATE_NUMBER)
+            CommandNumberEnd();
+        else if ((g_ui32CommandState == COMMAND_STATE_NAME) &&
+                 g_ui32CommandNameLen)
+            g_ui32CommandState = COMMAND_STATE_SPACE;
+        return COMMAND_OK;
+    }
+
+    switch (g_ui32CommandState)
+    {
+        case COMMAND_STATE_NAME:
+        {
+            //
+            // A line starting with a number has no name
+            //
+            if ((g_ui32CommandNameLen == 0) &&
+                (((ucChar >= '0') && (ucChar <= '9')) || (ucChar == '-')))
+            {
+                CommandNumberStart();
+                CommandNumberChar(ucChar);
+                break;
+            }
+
+            if (g_ui32CommandNameLen >= COMMAND_MAX_NAME)
+            {
+                CommandFail(COMMAND_BAD_CMD);
+                break;
+            }
+
+            if ((ucChar >= 'A') && (ucChar <= 'Z'))
+                ucChar += 'a' - 'A';
+            g_pcCommandName[g_ui32CommandNameLen++] = ucChar;
+            break;
+        }
+
+        case COMMAND_STATE_SPACE:
+        {
+            CommandNumberStart();
+            if (g_ui32CommandState == COMMAND_STATE_NUMBER)
+                CommandNumberChar(ucChar);
+            break;
+        }
+
+        case COMMAND_STATE_NUMBER:
+        {
+            CommandNumberChar(ucChar);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return COMMAND_OK;
+}
+
+
+//*****************************************************************************
+//
+// Process all received characters.  Never waits for input.
+//
+//*****************************************************************************
+void CommandPoll(void)
+{
+    int iStatus;
+
+    while (UARTRxBytesAvail())
+    {
+        iStatus = CommandInput(UARTgetc());
+
+        switch (iStatus)
+        {
+            case COMMAND_BAD_CMD:
+                UARTprintf("Unknown command, try \"help\"\n");
+                break;
+
+            case COMMAND_TOO_MANY_ARGS:
+                UARTprintf("Too many arguments\n");
+                break;
+
+            case COMMAND_INVALID_ARG:
+                UARTprintf("Invalid argument\n");
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+
+//*****************************************************************************
+//
+// Print the help lines of the command table
+//
+//*****************************************************************************
+void CommandHelp(void)
+{
+    const tCommandEntry *psEntry;
+
+    for (psEntry = g_psCommandTable; psEntry->pcCmd; psEntry++)
+    {
+        if (psEntry->pcHelp)
+            UARTprintf("%8s %s\n", psEntry->pcCmd, psEntry->pcHelp);
+    }
+}
@@ -0,0 +1,71 @@
+//*****************************************************************************
+//
+// command.h - Non-blocking console command parser.
+//
+// CommandPoll() is called from the main loop.  It takes whatever bytes
+// have arrived in the uartstdio receive buffer and runs them through a
+// small state machine, so the loop never waits for a complete line.  A line
+// is a command name followed by up to COMMAND_MAX_ARGS integer arguments,
+// separated by spaces or commas:
+//
+//   kp 1 2000
+//   trace 10 0x41
+//
+// Arguments are decimal, or hexadecimal with a "0x" prefix, and may be
+// negative.  A line that starts with a number is passed to the "" entry of
+// the table.  When the line ends the name is looked up in
+// g_psCommandTable[], which the application provides and terminates with a
+// zero entry, and the handler is called with the parsed arguments.
+//
+//*****************************************************************************
+
+#ifndef __COMMAND_H__
+#define __COMMAND_H__
+
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// Limits of one command line
+//
+//*****************************************************************************
+#define COMMAND_MAX_NAME        8
+#define COMMAND_MAX_ARGS        4
+
+//*****************************************************************************
+//
+// Status returned by the command handlers
+//
+//*****************************************************************************
+#define COMMAND_OK              0
+#define COMMAND_BAD_CMD         (-1)
+#define COMMAND_TOO_MANY_ARGS   (-2)
+#define COMMAND_INVALID_ARG     (-3)
+
+//*****************************************************************************
+//
+// One entry of the command table
+//
+//*****************************************************************************
+typedef int (*pfnCommand)(uint32_t ui32Argc, const int32_t *pi32Argv);
+
+typedef struct
+{
+    const char *pcCmd;          // Command name
+    pfnCommand pfnCmd;          // Handler
+    const char *pcHelp;         // One line of help, 0 to hide the entry
+}
+tCommandEntry;
+
+extern const tCommandEntry g_psCommandTable[];
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void CommandPoll(void);
+extern int CommandInput(unsigned char ucChar);
+extern void CommandHelp(void);
+
+#endif // __COMMAND_H__
@@ -0,0 +1,288 @@
+//*****************************************************************************
+//
+// control_math.h - Arithmetic used inside the control interrupt.
+//
+// The Cortex-M4F FPU only handles single precision, so double math in the
+// control loop ends up in run-time library calls.  This header provides one
+// set of names for the controller arithmetic with two implementations,
+// selected in motor_config.h:
+//
+// CONTROL_MATH_FIXED -> control_t is Q16.16, control_gain_t is Q8.24.  All
+//                       operations saturate instead of wrapping.
+// CONTROL_MATH_FLOAT -> control_t and control_gain_t are float.
+//
+// Gains use 24 fractional bits so that small gains such as Kp = 0.0020 keep
+// their precision (relative quantization error below 2e-5).
+//
+//*****************************************************************************
+
+#ifndef __CONTROL_MATH_H__
+#define __CONTROL_MATH_H__
+
+#include <stdint.h>
+#include "motor_config.h"
+
+#ifdef CONTROL_MATH_FIXED
+
+//*****************************************************************************
+//
+// Fixed-point implementation
+//
+//*****************************************************************************
+typedef int32_t control_t;              // Q16.16 signal
+typedef int32_t control_gain_t;         // Q8.24 gain
+
+#define CONTROL_FRAC_BITS       16
+#define CONTROL_GAIN_FRAC_BITS  24
+
+//
+// Conversion of compile-time constants, rounded to nearest
+//
+#define CONTROL_CONST(x)                                                      \
+    ((control_t)((x) * 65536.0 + (((x) >= 0) ? 0.5 : -0.5)))
+#define CONTROL_GAIN(x)                                                       \
+    ((control_gain_t)((x) * 16777216.0 + (((x) >= 0) ? 0.5 : -0.5)))
+
+//
+// Conversion of an integer to a signal value, saturating
+//
+#define CONTROL_FROM_INT(x)     ControlSat64((int64_t)(x) << CONTROL_FRAC_BITS)
+
+//
+// Conversion to an integer, truncating towards zero like a C cast does
+//
+#define CONTROL_TO_INT(x)                                                     \
+    ((int32_t)(((x) + (((x) >> 31) & ((1 << CONTROL_FRAC_BITS) - 1))) >>      \
+               CONTROL_FRAC_BITS))
+
+//
+// Raw Q16.16 value, used for telemetry
+//
+#define CONTROL_TO_Q16(x)       ((int32_t)(x))
+
+//*****************************************************************************
+//
+// Clamp a 64-bit intermediate result to the 32-bit signal range
+//
+//*****************************************************************************
+static inline control_t
+ControlSat64(int64_t x)
+{
+    if (x > INT32_MAX)
+        return INT32_MAX;
+    else if (x < INT32_MIN)
+        return INT32_MIN;
+
+    return (control_t)x;
+}
+
+//*****************************************************************************
+//
+// Saturating addition and subtraction
+//
+//*****************************************************************************
+static inline control_t
+ControlAdd(control_t a, control_t b)
+{
+    return ControlSat64((int64_t)a + b);
+}
+
+static inline control_t
+ControlSub(control_t a, control_t b)
+{
+    return ControlSat64((int64_t)a - b);
+}
+
+//*****************************************************************************
+//
+// Gain times an integer quantity (e.g. an error in counts) -> signal
+//
+//*****************************************************************************
+static inline control_t
+ControlGainMulInt(control_gain_t k, int32_t x)
+{
+    return ControlSat64(((int64_t)k * x) >>
+                        (CONTROL_GAIN_FRAC_BITS - CONTROL_FRAC_BITS));
+}
+
+//*****************************************************************************
+//
+// Gain times a signal -> signal
+//
+//*****************************************************************************
+static inline control_t
+ControlGainMul(control_gain_t k, control_t x)
+{
+    return ControlSat64(((int64_t)k * x) >> CONTROL_GAIN_FRAC_BITS);
+}
+
+//*****************************************************************************
+//
+// Run-time conversion of a gain given in units of 1e-6 (console input)
+//
+//*****************************************************************************
+static inline control_gain_t
+ControlGainFromMicro(int32_t i32Micro)
+{
+    return ControlSat64(((int64_t)i32Micro << CONTROL_GAIN_FRAC_BITS) /
+                        1000000);
+}
+
+//
+// and back, truncating (console output)
+//
+static inline int32_t
+ControlGainToMicro(control_gain_t k)
+{
+    return (int32_t)(((int64_t)k * 1000000) >> CONTROL_GAIN_FRAC_BITS);
+}
+
+//
+// The same in units of 1e-9, in one 64-bit step so that no gain saturates
+// in units of 1e-6 on the way
+//
+static inline control_gain_t
+ControlGainFromNano(int32_t i32Nano)
+{
+    return ControlSat64(((int64_t)i32Nano << CONTROL_GAIN_FRAC_BITS) /
+                        1000000000);
+}
+
+static inline int32_t
+ControlGainToNano(control_gain_t k)
+{
+    return ControlSat64(((int64_t)k * 1000000000) >> CONTROL_GAIN_FRAC_BITS);
+}
+
+//*****************************************************************************
+//
+// Run-time conversion of a gain given per second in units of 1e-6 to the
+// gain per step of a loop running at ui32RateHz (integral gains), in one
+// 64-bit division so that neither the range nor the small gains are lost
+// to an intermediate Q8.24 value
+//
+//*****************************************************************************
+static inline control_gain_t
+ControlGainFromMicroRate(int32_t i32Micro, uint32_t ui32RateHz)
+{
+    return ControlSat64(((int64_t)i32Micro << CONTROL_GAIN_FRAC_BITS) /
+                        (1000000LL * ui32RateHz));
+}
+
+//
+// and back, truncating (console output)
+//
+static inline int32_t
+ControlGainToMicroRate(control_gain_t k, uint32_t ui32RateHz)
+{
+    int64_t i64Scaled = (int64_t)k * ui32RateHz;
+
+    return ControlSat64((i64Scaled >> CONTROL_GAIN_FRAC_BITS) * 1000000 +
+                        (((i64Scaled & ((1 << CONTROL_GAIN_FRAC_BITS) - 1)) *
+                          1000000) >> CONTROL_GAIN_FRAC_BITS));
+}
+
+#else
+
+//*****************************************************************************
+//
+// Single precision implementation
+//
+//*****************************************************************************
+typedef float control_t;
+typedef float control_gain_t;
+
+#define CONTROL_CONST(x)        ((control_t)(x))
+#define CONTROL_GAIN(x)         ((control_gain_t)(x))
+#define CONTROL_FROM_INT(x)     ((control_t)(x))
+#define CONTROL_TO_INT(x)       ((int32_t)(x))
+#define CONTROL_TO_Q16(x)       ((int32_t)((x) * 65536.0f))
+
+static inline control_t
+ControlAdd(control_t a, control_t b)
+{
+    return a + b;
+}
+
+static inline control_t
+ControlSub(control_t a, control_t b)
+{
+    return a - b;
+}
+
+static inline control_t
+ControlGainMulInt(control_gain_t k, int32_t x)
+{
+    return k * (control_t)x;
+}
+
+static inline control_t
+ControlGainMul(control_gain_t k, control_t x)
+{
+    return k * x;
+}
+
+static inline control_gain_t
+ControlGainFromMicro(int32_t i32Micro)
+{
+    return (control_gain_t)i32Micro * 1.0e-6f;
+}
+
+static inline int32_t
+ControlGainToMicro(control_gain_t k)
+{
+    return (int32_t)(k * 1.0e6f);
+}
+
+static inline control_gain_t
+ControlGainFromNano(int32_t i32Nano)
+{
+    return (control_gain_t)i32Nano * 1.0e-9f;
+}
+
+static inline int32_t
+ControlGainToNano(control_gain_t k)
+{
+    return (int32_t)(k * 1.0e9f);
+}
+
+static inline control_gain_t
+ControlGainFromMicroRate(int32_t i32Micro, uint32_t ui32RateHz)
+{
+    return (control_gain_t)i32Micro * 1.0e-6f / (float)ui32RateHz;
+}
+
+static inline int32_t
+ControlGainToMicroRate(control_gain_t k, uint32_t ui32RateHz)
+{
+    return (int32_t)(k * 1.0e6f * (float)ui32RateHz);
+}
+
+#endif
+
+//*****************************************************************************
+//
+// Largest gain the console takes in units of 1e-6, the last one Q8.24
+// holds.  The float build takes the same range, so that both store the
+// same gains for the same input.
+//
+//*****************************************************************************
+#define CONTROL_GAIN_MICRO_MAX  127999999
+
+//*****************************************************************************
+//
+// Symmetric saturation to [-limit, limit]
+//
+//*****************************************************************************
+static inline control_t
+ControlClamp(control_t x, control_t limit)
+{
+    if (x > limit)
+        return limit;
+    else if (x < -limit)
+        return -limit;
+
+    return x;
+}
+
+#endif // __CONTROL_MATH_H__
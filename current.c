@@ -0,0 +1,166 @@
+//*****************************************************************************
+//
+// current.c - Motor current sensing through ADC0 and uDMA.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_adc.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/adc.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pwm.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+#include "motor_config.h"
+#include "motor.h"
+#include "current.h"
+
+//*****************************************************************************
+//
+// Double buffer of the samples, and the uDMA control structure of each half
+//
+//*****************************************************************************
+static uint16_t g_ppui16CurrentBuffer[2][MOTOR_NUM_AXES];
+
+static const uint32_t g_pui32CurrentSelect[2] =
+{
+    UDMA_PRI_SELECT, UDMA_ALT_SELECT
+};
+
+static uint32_t g_ui32CurrentHalf = 0;      // Half that completes next
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+volatile uint32_t g_ui32CurrentSamples = 0;     // Sample sets processed
+volatile uint32_t g_ui32CurrentOverruns = 0;    // Sets processed a period late
+
+
+//*****************************************************************************
+//
+// Set up the transfer of one conversion into one half of the buffer
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(CurrentArm, ".ramfunc")
+#endif
+static void CurrentArm(uint32_t ui32Half)
+{
+    uDMAChannelTransferSet(CURRENT_DMA_CHANNEL | g_pui32CurrentSelect[ui32Half],
+                           UDMA_MODE_PINGPONG,
+                           (void *)(ADC0_BASE + ADC_O_SSFIFO1),
+                           g_ppui16CurrentBuffer[ui32Half], MOTOR_NUM_AXES);
+}
+
+
+//*****************************************************************************
+//
+// Configure the current sensor pins, the ADC sequencer, its PWM trigger and
+// the uDMA channel, and start the conversions.  The PWM generators must be
+// running (MotorConfigure()) and the uDMA controller enabled.
+//
+//*****************************************************************************
+void CurrentConfigure(void)
+{
+    const tMotorAxis *psAxis;
+    uint32_t i, ui32Step;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        psAxis = &g_psMotorAxes[i];
+        SysCtlPeripheralEnable(psAxis->CurrentPinPeriph);
+        GPIOPinTypeADC(psAxis->CurrentPinPort, psAxis->CurrentPin);
+    }
+    SysCtlDelay(10);
+
+    //
+    // One step per axis, the last one ends the sequence.  ADC_TRIGGER_PWM1
+    // is generator 1 of PWM module 0, the generator of the first axis.
+    //
+    ADCSequenceDisable(ADC0_BASE, CURRENT_SEQUENCE);
+    ADCSequenceConfigure(ADC0_BASE, CURRENT_SEQUENCE,
+                         ADC_TRIGGER_PWM1 | ADC_TRIGGER_PWM_MOD0, 0);
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        ui32Step = g_psMotorAxes[i].CurrentChannel;
+        if (i == MOTOR_NUM_AXES - 1)
+            ui32Step |= ADC_CTL_IE | ADC_CTL_END;
+        ADCSequenceStepConfigure(ADC0_BASE, CURRENT_SEQUENCE, i, ui32Step);
+    }
+
+    PWMGenIntTrigEnable(g_psMotorAxes[0].PWMBase, g_psMotorAxes[0].PWMGen,
+                        PWM_TR_CNT_LOAD);
+
+    //
+    // Ping-pong transfers of 16-bit samples from the sequencer FIFO, both
+    // halves armed
+    //
+    uDMAChannelAttributeDisable(CURRENT_DMA_CHANNEL, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(CURRENT_DMA_CHANNEL | UDMA_PRI_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 |
+                          UDMA_ARB_1);
+    uDMAChannelControlSet(CURRENT_DMA_CHANNEL | UDMA_ALT_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 |
+                          UDMA_ARB_1);
+    g_ui32CurrentHalf = 0;
+    CurrentArm(0);
+    CurrentArm(1);
+    uDMAChannelEnable(CURRENT_DMA_CHANNEL);
+
+    //
+    // The current loop preempts the control tick
+    //
+    ADCSequenceDMAEnable(ADC0_BASE, CURRENT_SEQUENCE);
+    ADCIntEnable(ADC0_BASE, CURRENT_SEQUENCE);
+    IntPrioritySet(INT_ADC0SS1, 0x00);
+    IntEnable(INT_ADC0SS1);
+
+    ADCSequenceEnable(ADC0_BASE, CURRENT_SEQUENCE);
+}
+
+
+//*****************************************************************************
+//
+// Run the current loop on every half of the buffer whose transfer has
+// completed and arm it again.  Called from the ADC0 sequencer 1 interrupt.
+// Both halves are complete only when the handler was held off for a whole
+// PWM period; they are then taken oldest first and the channel, stopped
+// for lack of an armed half, is restarted.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(CurrentService, ".ramfunc")
+#endif
+void CurrentService(void)
+{
+    uint32_t i;
+
+    ADCIntClear(ADC0_BASE, CURRENT_SEQUENCE);
+
+    for (i = 0; i < 2; i++)
+    {
+        if (uDMAChannelModeGet(CURRENT_DMA_CHANNEL |
+                               g_pui32CurrentSelect[g_ui32CurrentHalf]) !=
+            UDMA_MODE_STOP)
+            break;
+
+        if (i)
+            g_ui32CurrentOverruns++;
+
+        MotorCurrentControl(g_ppui16CurrentBuffer[g_ui32CurrentHalf]);
+        CurrentArm(g_ui32CurrentHalf);
+        g_ui32CurrentHalf ^= 1;
+        g_ui32CurrentSamples++;
+    }
+
+    if (!uDMAChannelIsEnabled(CURRENT_DMA_CHANNEL))
+        uDMAChannelEnable(CURRENT_DMA_CHANNEL);
+}
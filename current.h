@@ -0,0 +1,48 @@
+//*****************************************************************************
+//
+// current.h - Motor current sensing through ADC0 and uDMA.
+//
+// ADC0 sample sequencer CURRENT_SEQUENCE converts the current sensor of
+// every axis, one step per axis in axis order, on each load event of the
+// PWM generator of the first axis.  The generators of all axes run in step
+// (MotorConfigure()), so that is the middle of the on time of every axis.
+// uDMA moves the MOTOR_NUM_AXES samples of each conversion in ping-pong
+// mode, alternately into the two halves of a double buffer, and the
+// sequencer interrupt of each completed half calls MotorCurrentControl()
+// with it while the other half fills.
+//
+// The pipeline is only started with MOTOR_CURRENT_LOOP (motor_config.h).
+//
+//*****************************************************************************
+
+#ifndef __CURRENT_H__
+#define __CURRENT_H__
+
+#include <stdint.h>
+#include "motor_config.h"
+
+//*****************************************************************************
+//
+// ADC0 sample sequencer and uDMA channel of the current samples.
+// Sequencer 1 has four steps, enough for four axes.
+//
+//*****************************************************************************
+#define CURRENT_SEQUENCE        1
+#define CURRENT_DMA_CHANNEL     UDMA_CHANNEL_ADC1
+
+#if MOTOR_NUM_AXES > 4
+#error "ADC0 sequencer 1 samples at most four current sensors"
+#endif
+
+extern volatile uint32_t g_ui32CurrentSamples;
+extern volatile uint32_t g_ui32CurrentOverruns;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void CurrentConfigure(void);
+extern void CurrentService(void);
+
+#endif // __CURRENT_H__
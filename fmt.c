@@ -0,0 +1,102 @@
+//*****************************************************************************
+//
+// fmt.c - Fixed layout text records without a format string.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "fmt.h"
+
+//*****************************************************************************
+//
+// The two digits of 0 to 99, and the powers of ten that need one more digit
+//
+//*****************************************************************************
+static const char g_pcFmtDigits[200] =
+{
+    '0','0', '0','1', '0','2', '0','3', '0','4',
+    '0','5', '0','6', '0','7', '0','8', '0','9',
+    '1','0', '1','1', '1','2', '1','3', '1','4',
+    '1','5', '1','6', '1','7', '1','8', '1','9',
+    '2','0', '2','1', '2','2', '2','3', '2','4',
+    '2','5', '2','6', '2','7', '2','8', '2','9',
+    '3','0', '3','1', '3','2', '3','3', '3','4',
+    '3','5', '3','6', '3','7', '3','8', '3','9',
+    '4','0', '4','1', '4','2', '4','3', '4','4',
+    '4','5', '4','6', '4','7', '4','8', '4','9',
+    '5','0', '5','1', '5','2', '5','3', '5','4',
+    '5','5', '5','6', '5','7', '5','8', '5','9',
+    '6','0', '6','1', '6','2', '6','3', '6','4',
+    '6','5', '6','6', '6','7', '6','8', '6','9',
+    '7','0', '7','1', '7','2', '7','3', '7','4',
+    '7','5', '7','6', '7','7', '7','8', '7','9',
+    '8','0', '8','1', '8','2', '8','3', '8','4',
+    '8','5', '8','6', '8','7', '8','8', '8','9',
+    '9','0', '9','1', '9','2', '9','3', '9','4',
+    '9','5', '9','6', '9','7', '9','8', '9','9'
+};
+
+static const uint32_t g_pui32FmtPowers[FMT_UINT_MAX - 1] =
+{
+    10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+
+//*****************************************************************************
+//
+// Write ui32Value in decimal to pcOut.  Returns the end of the digits.
+//
+//*****************************************************************************
+char *FmtUint(char *pcOut, uint32_t ui32Value)
+{
+    uint32_t ui32Len, ui32Quot, ui32Pair;
+    char *pcEnd;
+
+    for (ui32Len = 1; ui32Len < FMT_UINT_MAX; ui32Len++)
+        if (ui32Value < g_pui32FmtPowers[ui32Len - 1])
+            break;
+
+    //
+    // Fill in from the last digit, two at a time
+    //
+    pcEnd = pcOut + ui32Len;
+    pcOut = pcEnd;
+
+    while (ui32Value >= 100)
+    {
+        ui32Quot = FMT_DIV100(ui32Value);
+        ui32Pair = 2 * (ui32Value - 100 * ui32Quot);
+        *--pcOut = g_pcFmtDigits[ui32Pair + 1];
+        *--pcOut = g_pcFmtDigits[ui32Pair];
+        ui32Value = ui32Quot;
+    }
+
+    if (ui32Value >= 10)
+    {
+        *--pcOut = g_pcFmtDigits[2 * ui32Value + 1];
+        *--pcOut = g_pcFmtDigits[2 * ui32Value];
+    }
+    else
+    {
+        *--pcOut = (char)('0' + ui32Value);
+    }
+
+    return pcEnd;
+}
+
+
+//*****************************************************************************
+//
+// Write i32Value in decimal to pcOut.  Returns the end of the digits.
+//
+//*****************************************************************************
+char *FmtInt(char *pcOut, int32_t i32Value)
+{
+    if (i32Value < 0)
+    {
+        *pcOut++ = '-';
+        return FmtUint(pcOut, 0u - (uint32_t)i32Value);
+    }
+
+    return FmtUint(pcOut, (uint32_t)i32Value);
+}
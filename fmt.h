@@ -0,0 +1,108 @@
+//*****************************************************************************
+//
+// fmt.h - Fixed layout text records without a format string.
+//
+// UARTprintf() parses its format string on every call, finds the digits of
+// each number with a division per digit and hands the line to UARTwrite()
+// piece by piece.  For output that runs all the time, such as the status
+// lines of telemetry.c, the layout is known when the firmware is built, so
+// it is described once as a list of fields instead, a macro like this one
+// (line continuations left out):
+//
+//   #define STATUS_FORMAT(TEXT, INT, UINT, pcOut, psSample)
+//       TEXT(pcOut, "P1 = ")    INT(pcOut, (psSample)->Position1)
+//       TEXT(pcOut, " | n = ")  UINT(pcOut, (psSample)->Count)
+//       TEXT(pcOut, "\r\n")
+//
+// The list is expanded by the macros below into
+//
+//   FMT_RECORD_SIZE(STATUS_FORMAT)          the largest record in bytes, a
+//                                           constant for sizing the buffer
+//   FMT_RECORD(pcOut, STATUS_FORMAT, ps)    straight line code that copies
+//                                           the literals and converts the
+//                                           values, advancing pcOut
+//
+// TEXT only takes string literals, whose lengths are then constants.  The
+// record is not terminated and has no "\n" to "\r\n" translation, so it
+// can be passed as it is to UARTwriteRaw() in a single call.
+//
+// Numbers are converted without dividing: the digit count is found by
+// comparing with the powers of ten, and the digits are written two at a
+// time from a table, with the quotient by 100 taken as a multiplication by
+// 2^37 / 100 rounded up, which is exact for every 32-bit value.
+//
+//*****************************************************************************
+
+#ifndef __FMT_H__
+#define __FMT_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Longest conversions, "4294967295" and "-2147483648"
+//
+//*****************************************************************************
+#define FMT_UINT_MAX            10
+#define FMT_INT_MAX             11
+
+//*****************************************************************************
+//
+// Quotient of a 32-bit value by 100
+//
+//*****************************************************************************
+#define FMT_DIV100(ui32Value)                                                 \
+    ((uint32_t)(((uint64_t)(uint32_t)(ui32Value) * 0x51EB851Fu) >> 37))
+
+//*****************************************************************************
+//
+// Field expansions.  Each one takes the output pointer first.
+//
+//*****************************************************************************
+#define FMT_SIZE_TEXT(pcOut, pcText)    + (sizeof("" pcText) - 1)
+#define FMT_SIZE_INT(pcOut, i32Value)   + FMT_INT_MAX
+#define FMT_SIZE_UINT(pcOut, ui32Value) + FMT_UINT_MAX
+
+#define FMT_PUT_TEXT(pcOut, pcText)                                           \
+    memcpy((pcOut), "" pcText, sizeof("" pcText) - 1);                        \
+    (pcOut) += sizeof("" pcText) - 1;
+#define FMT_PUT_INT(pcOut, i32Value)                                          \
+    (pcOut) = FmtInt((pcOut), (i32Value));
+#define FMT_PUT_UINT(pcOut, ui32Value)                                        \
+    (pcOut) = FmtUint((pcOut), (ui32Value));
+
+//*****************************************************************************
+//
+// Size of the longest record of a format, and the code that writes one to
+// pcOut from the values in psArg
+//
+//*****************************************************************************
+#define FMT_RECORD_SIZE(FORMAT)                                               \
+    (0 FORMAT(FMT_SIZE_TEXT, FMT_SIZE_INT, FMT_SIZE_UINT, 0, 0))
+
+#define FMT_RECORD(pcOut, FORMAT, psArg)                                      \
+    do                                                                        \
+    {                                                                         \
+        FORMAT(FMT_PUT_TEXT, FMT_PUT_INT, FMT_PUT_UINT, pcOut, psArg)         \
+    }                                                                         \
+    while (0)
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern char *FmtUint(char *pcOut, uint32_t ui32Value);
+extern char *FmtInt(char *pcOut, int32_t i32Value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FMT_H__
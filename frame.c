@@ -0,0 +1,143 @@
+//*****************************************************************************
+//
+// frame.c - COBS framing with CRC-16 for the binary serial protocols.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "frame.h"
+
+//*****************************************************************************
+//
+// CRC-16/CCITT, four bits at a time
+//
+//*****************************************************************************
+static const uint16_t g_pui16CRCNibble[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t FrameCRC16(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    uint16_t ui16CRC = 0xFFFF;
+
+    while (ui32Len--)
+    {
+        ui16CRC ^= (uint16_t)(*pui8Data++) << 8;
+        ui16CRC = (ui16CRC << 4) ^ g_pui16CRCNibble[ui16CRC >> 12];
+        ui16CRC = (ui16CRC << 4) ^ g_pui16CRCNibble[ui16CRC >> 12];
+    }
+
+    return ui16CRC;
+}
+
+
+//*****************************************************************************
+//
+// COBS encoding of one byte stream, appended to pui8Out.  Returns the
+// number of bytes written.
+//
+//*****************************************************************************
+static uint32_t FrameCOBS(const uint8_t *pui8In, uint32_t ui32Len,
+                          uint8_t *pui8Out, uint32_t ui32Out,
+                          uint32_t *pui32Code)
+{
+    while (ui32Len--)
+    {
+        //
+        // Close the current block on a zero or when it is full
+        //
+        if (*pui8In == 0)
+        {
+            pui8Out[*pui32Code] = (uint8_t)(ui32Out - *pui32Code);
+            *pui32Code = ui32Out++;
+        }
+        else
+        {
+            pui8Out[ui32Out++] = *pui8In;
+            if ((ui32Out - *pui32Code) == 0xFF)
+            {
+                pui8Out[*pui32Code] = 0xFF;
+                *pui32Code = ui32Out++;
+            }
+        }
+        pui8In++;
+    }
+
+    return ui32Out;
+}
+
+
+//*****************************************************************************
+//
+// Encode a payload into a complete frame (COBS, CRC and delimiter).
+// pui8Out must hold FRAME_MAX_ENCODED(ui32Len) bytes.  Returns the number
+// of bytes to transmit.
+//
+//*****************************************************************************
+uint32_t FrameEncode(const uint8_t *pui8Payload, uint32_t ui32Len,
+                     uint8_t *pui8Out)
+{
+    uint8_t pui8CRC[2];
+    uint16_t ui16CRC;
+    uint32_t ui32Code = 0;
+    uint32_t ui32Out = 1;
+
+    ui16CRC = FrameCRC16(pui8Payload, ui32Len);
+    pui8CRC[0] = (uint8_t)ui16CRC;
+    pui8CRC[1] = (uint8_t)(ui16CRC >> 8);
+
+    ui32Out = FrameCOBS(pui8Payload, ui32Len, pui8Out, ui32Out, &ui32Code);
+    ui32Out = FrameCOBS(pui8CRC, 2, pui8Out, ui32Out, &ui32Code);
+
+    pui8Out[ui32Code] = (uint8_t)(ui32Out - ui32Code);
+    pui8Out[ui32Out++] = 0;
+
+    return ui32Out;
+}
+
+
+//*****************************************************************************
+//
+// Decode one received frame (without its 0x00 delimiter) and check its
+// CRC.  pui8Payload must hold ui32Len bytes.  Returns the payload length,
+// or -1 if the frame is malformed or the CRC does not match.
+//
+//*****************************************************************************
+int32_t FrameDecode(const uint8_t *pui8In, uint32_t ui32Len,
+                    uint8_t *pui8Payload)
+{
+    uint32_t ui32In = 0;
+    uint32_t ui32Out = 0;
+    uint32_t ui32Code, i;
+    uint16_t ui16CRC;
+
+    while (ui32In < ui32Len)
+    {
+        ui32Code = pui8In[ui32In++];
+        if ((ui32Code == 0) || ((ui32In + ui32Code - 1) > ui32Len))
+            return -1;
+
+        for (i = 1; i < ui32Code; i++)
+            pui8Payload[ui32Out++] = pui8In[ui32In++];
+
+        //
+        // A block shorter than 254 data bytes stands for a trailing zero,
+        // except at the very end of the frame
+        //
+        if ((ui32Code < 0xFF) && (ui32In < ui32Len))
+            pui8Payload[ui32Out++] = 0;
+    }
+
+    if (ui32Out < 2)
+        return -1;
+
+    ui32Out -= 2;
+    ui16CRC = FrameCRC16(pui8Payload, ui32Out);
+    if ((pui8Payload[ui32Out] != (uint8_t)ui16CRC) ||
+        (pui8Payload[ui32Out + 1] != (uint8_t)(ui16CRC >> 8)))
+        return -1;
+
+    return (int32_t)ui32Out;
+}
@@ -0,0 +1,50 @@
+//*****************************************************************************
+//
+// frame.h - COBS framing with CRC-16 for the binary serial protocols.
+//
+// A frame on the wire is
+//
+//   COBS(payload | CRC16(payload) LSB first) 0x00
+//
+// COBS removes every zero byte from the encoded data, so 0x00 only ever
+// appears as the frame delimiter and a receiver can resynchronize after
+// any corrupted or lost byte.  The CRC is CRC-16/CCITT-FALSE
+// (polynomial 0x1021, initial value 0xFFFF).
+//
+//*****************************************************************************
+
+#ifndef __FRAME_H__
+#define __FRAME_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Largest payload handled by the framing layer and the worst-case size of
+// the encoded frame: one COBS overhead byte per 254 bytes, CRC and delimiter
+//
+//*****************************************************************************
+#define FRAME_MAX_PAYLOAD       320
+#define FRAME_MAX_ENCODED(n)    ((n) + 2 + (((n) + 2) / 254) + 1 + 1)
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern uint16_t FrameCRC16(const uint8_t *pui8Data, uint32_t ui32Len);
+extern uint32_t FrameEncode(const uint8_t *pui8Payload, uint32_t ui32Len,
+                            uint8_t *pui8Out);
+extern int32_t FrameDecode(const uint8_t *pui8In, uint32_t ui32Len,
+                           uint8_t *pui8Payload);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FRAME_H__
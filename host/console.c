@@ -0,0 +1,231 @@
+//*****************************************************************************
+//
+// console.c - uartstdio.c of the host build.
+//
+// Output goes to stdout as it is written, the transmit buffer never fills.
+// Input is what HostConsoleInput() queued, by the runner from its script or
+// by a test.  When the main loop polls and nothing is queued the idle
+// function runs, and if it queued nothing either one control tick passes
+// (HostTick()), so the main loop runs once per tick while it waits.
+//
+// Received characters are echoed while echo is on, as the target echoes
+// them, so the output reads like a terminal session.  The last
+// HOST_CONSOLE_CAPTURE bytes of output are also kept for the tests.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "utils/uartstdio.h"
+#include "hal.h"
+
+//*****************************************************************************
+//
+// Input queue and output capture
+//
+//*****************************************************************************
+#define HOST_CONSOLE_INPUT      4096
+#define HOST_CONSOLE_CAPTURE    65536
+
+static char g_pcHostInput[HOST_CONSOLE_INPUT];
+static uint32_t g_ui32HostInputRead = 0;
+static uint32_t g_ui32HostInputWrite = 0;
+
+static char g_pcHostCapture[HOST_CONSOLE_CAPTURE + 1];
+static uint32_t g_ui32HostCaptureLen = 0;
+
+static void (*g_pfnHostIdle)(void) = 0;
+static bool g_bHostEcho = true;
+static bool g_bHostQuiet = false;
+
+
+//*****************************************************************************
+//
+// Write to stdout and the capture buffer, which drops its older half when
+// full
+//
+//*****************************************************************************
+static void HostConsoleWrite(const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Keep;
+
+    if (!g_bHostQuiet)
+    {
+        fwrite(pcBuf, 1, ui32Len, stdout);
+        fflush(stdout);
+    }
+
+    if (ui32Len > HOST_CONSOLE_CAPTURE / 2)
+    {
+        pcBuf += ui32Len - HOST_CONSOLE_CAPTURE / 2;
+        ui32Len = HOST_CONSOLE_CAPTURE / 2;
+    }
+    if (g_ui32HostCaptureLen + ui32Len > HOST_CONSOLE_CAPTURE)
+    {
+        ui32Keep = HOST_CONSOLE_CAPTURE / 2;
+        memmove(g_pcHostCapture,
+                g_pcHostCapture + g_ui32HostCaptureLen - ui32Keep, ui32Keep);
+        g_ui32HostCaptureLen = ui32Keep;
+    }
+    memcpy(g_pcHostCapture + g_ui32HostCaptureLen, pcBuf, ui32Len);
+    g_ui32HostCaptureLen += ui32Len;
+    g_pcHostCapture[g_ui32HostCaptureLen] = 0;
+}
+
+
+//*****************************************************************************
+//
+// Host side
+//
+//*****************************************************************************
+void HostConsoleInput(const char *pcText)
+{
+    while (*pcText &&
+           ((g_ui32HostInputWrite - g_ui32HostInputRead) < HOST_CONSOLE_INPUT))
+        g_pcHostInput[g_ui32HostInputWrite++ % HOST_CONSOLE_INPUT] = *pcText++;
+}
+
+void HostConsoleIdleSet(void (*pfnIdle)(void))
+{
+    g_pfnHostIdle = pfnIdle;
+}
+
+void HostConsoleQuiet(bool bQuiet)
+{
+    g_bHostQuiet = bQuiet;
+}
+
+const char *HostConsoleOutput(void)
+{
+    return g_pcHostCapture;
+}
+
+void HostConsoleClear(void)
+{
+    g_ui32HostCaptureLen = 0;
+    g_pcHostCapture[0] = 0;
+}
+
+
+//*****************************************************************************
+//
+// uartstdio API
+//
+//*****************************************************************************
+void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud,
+                     uint32_t ui32SrcClock)
+{
+}
+
+int UARTwrite(const char *pcBuf, uint32_t ui32Len)
+{
+    HostConsoleWrite(pcBuf, ui32Len);
+
+    return ui32Len;
+}
+
+int UARTwriteRaw(const unsigned char *pucBuf, uint32_t ui32Len)
+{
+    HostConsoleWrite((const char *)pucBuf, ui32Len);
+
+    return ui32Len;
+}
+
+void UARTvprintf(const char *pcString, va_list vaArgP)
+{
+    char pcLine[1024];
+    int iLen;
+
+    iLen = vsnprintf(pcLine, sizeof(pcLine), pcString, vaArgP);
+    if (iLen > (int)sizeof(pcLine) - 1)
+        iLen = sizeof(pcLine) - 1;
+    if (iLen > 0)
+        HostConsoleWrite(pcLine, iLen);
+}
+
+void UARTprintf(const char *pcString, ...)
+{
+    va_list vaArgP;
+
+    va_start(vaArgP, pcString);
+    UARTvprintf(pcString, vaArgP);
+    va_end(vaArgP);
+}
+
+int UARTRxBytesAvail(void)
+{
+    if (g_ui32HostInputRead == g_ui32HostInputWrite)
+    {
+        if (g_pfnHostIdle)
+            g_pfnHostIdle();
+        if (g_ui32HostInputRead == g_ui32HostInputWrite)
+            HostTick();
+    }
+
+    return g_ui32HostInputWrite - g_ui32HostInputRead;
+}
+
+unsigned char UARTgetc(void)
+{
+    char cChar;
+
+    while (!UARTRxBytesAvail())
+    {
+    }
+
+    cChar = g_pcHostInput[g_ui32HostInputRead++ % HOST_CONSOLE_INPUT];
+    if (g_bHostEcho)
+        HostConsoleWrite((cChar == '\r') ? "\n" : &cChar, 1);
+
+    return cChar;
+}
+
+int UARTgets(char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Count = 0;
+    char cChar;
+
+    while (ui32Count + 1 < ui32Len)
+    {
+        cChar = UARTgetc();
+        if ((cChar == '\r') || (cChar == '\n'))
+            break;
+        pcBuf[ui32Count++] = cChar;
+    }
+    pcBuf[ui32Count] = 0;
+
+    return ui32Count;
+}
+
+int UARTPeek(unsigned char ucChar)
+{
+    uint32_t i;
+
+    for (i = g_ui32HostInputRead; i != g_ui32HostInputWrite; i++)
+        if (g_pcHostInput[i % HOST_CONSOLE_INPUT] == (char)ucChar)
+            return i - g_ui32HostInputRead;
+
+    return -1;
+}
+
+void UARTFlushTx(bool bDiscard)
+{
+}
+
+void UARTFlushRx(void)
+{
+    g_ui32HostInputRead = g_ui32HostInputWrite;
+}
+
+int UARTTxBytesFree(void)
+{
+    return UART_TX_BUFFER_SIZE;
+}
+
+void UARTEchoSet(bool bEnable)
+{
+    g_bHostEcho = bEnable;
+}
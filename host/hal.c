@@ -0,0 +1,965 @@
+//*****************************************************************************
+//
+// hal.c - Host build of the firmware: driverlib and core peripherals.
+//
+// The register file holds every address the firmware touches, created on
+// first access as zero.  Two kinds of address are aliases of another
+// register: the bit-band alias of the peripheral region, one word per bit,
+// and the GPIO data register, masked by bits 9:2 of the address.  HWREG()
+// returns a pointer, so a write through an alias is only seen on the next
+// access to the register file; HostReg() first applies the last alias
+// handed out, and HostRegSync() does it for readers outside HWREG().
+//
+// The driverlib calls keep their state in the registers where the firmware
+// or the plant read it back (PWM generators, GPIO data, QEI position and
+// velocity, timer load), and in static variables otherwise.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_pwm.h"
+#include "inc/hw_qei.h"
+#include "inc/hw_timer.h"
+#include "driverlib/adc.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/fpu.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pwm.h"
+#include "driverlib/qei.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+#include "clock_config.h"
+#include "motor_config.h"
+#include "isr_timing.h"
+#include "plant.h"
+#include "hal.h"
+
+//*****************************************************************************
+//
+// Interrupt handlers of main_20191001_v1.c
+//
+//*****************************************************************************
+extern void Timer0IntHandler(void);
+extern void PWM0Gen1IntHandler(void);
+extern void ADC0SS1IntHandler(void);
+extern void PendSVIntHandler(void);
+
+static void (* const g_ppfnHostVectors[NUM_INTERRUPTS])(void) =
+{
+    [FAULT_PENDSV] = PendSVIntHandler,
+    [INT_PWM0_1] = PWM0Gen1IntHandler,
+    [INT_ADC0SS1] = ADC0SS1IntHandler,
+    [INT_TIMER0A] = Timer0IntHandler
+};
+
+//*****************************************************************************
+//
+// The .stack section of the CCS link, __stack and __STACK_END are defined
+// on it by the host build (CMakeLists.txt).  main() runs on the host stack
+// instead, so it is never filled.
+//
+//*****************************************************************************
+uint32_t g_pui32HostStack[HOST_STACK_SIZE / sizeof(uint32_t)];
+
+//*****************************************************************************
+//
+// Register file - open addressing on the address, never full in practice
+//
+//*****************************************************************************
+#define HOST_REG_SLOTS          4096
+
+typedef struct
+{
+    uint32_t Addr;
+    bool Used;
+    volatile uint32_t Value;
+}
+tHostReg;
+
+static tHostReg g_psHostRegs[HOST_REG_SLOTS];
+static tHostReg *g_psHostAlias = 0;         // Alias handed out last
+
+#define HOST_BITBAND_BASE       0x42000000
+#define HOST_BITBAND_END        0x44000000
+
+//
+// GPIO ports and their pin states
+//
+static const uint32_t g_pui32HostGPIOBase[] =
+{
+    GPIO_PORTA_BASE, GPIO_PORTB_BASE, GPIO_PORTC_BASE,
+    GPIO_PORTD_BASE, GPIO_PORTE_BASE, GPIO_PORTF_BASE
+};
+
+#define HOST_GPIO_PORTS         (sizeof(g_pui32HostGPIOBase) /                \
+                                 sizeof(g_pui32HostGPIOBase[0]))
+
+static uint32_t g_pui32HostGPIOData[HOST_GPIO_PORTS];
+
+//*****************************************************************************
+//
+// NVIC state.  The active priority is 0x100 in thread mode.
+//
+//*****************************************************************************
+static bool g_pbHostIntEnabled[NUM_INTERRUPTS];
+static bool g_pbHostIntPending[NUM_INTERRUPTS];
+static uint8_t g_pui8HostIntPriority[NUM_INTERRUPTS];
+static bool g_bHostPrimask = true;          // Disabled out of reset
+static uint32_t g_ui32HostBasepri = 0;
+static uint32_t g_ui32HostActive = 0x100;
+
+//*****************************************************************************
+//
+// uDMA channels, the primary and alternate control structure of each
+//
+//*****************************************************************************
+#define HOST_DMA_CHANNELS       32
+
+typedef struct
+{
+    uint32_t Mode[2];
+    uint16_t *Dst[2];
+    uint32_t Count[2];
+    uint32_t Select;                // Structure the next request uses
+    bool Enabled;
+}
+tHostDMAChannel;
+
+static tHostDMAChannel g_psHostDMA[HOST_DMA_CHANNELS];
+
+//*****************************************************************************
+//
+// ADC0 sample sequencers
+//
+//*****************************************************************************
+#define HOST_ADC_SEQUENCES      4
+
+static bool g_pbHostADCEnabled[HOST_ADC_SEQUENCES];
+static bool g_pbHostADCDMA[HOST_ADC_SEQUENCES];
+static bool g_pbHostADCInt[HOST_ADC_SEQUENCES];
+
+//*****************************************************************************
+//
+// Timer 0 and PWM interrupt enables, and the EEPROM (2 kB)
+//
+//*****************************************************************************
+static bool g_bHostTimerRunning = false;
+static bool g_bHostTimerInt = false;
+static uint32_t g_pui32HostPWMIntEnable[2];
+
+#define HOST_EEPROM_WORDS       512
+
+static uint32_t g_pui32HostEEPROM[HOST_EEPROM_WORDS];
+static bool g_bHostEEPROMErased = false;
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+volatile uint32_t g_ui32HostTicks = 0;      // Control ticks simulated
+uint32_t g_ui32HostRegAccesses = 0;         // HWREG() calls
+
+
+//*****************************************************************************
+//
+// Find or create the entry of an address
+//
+//*****************************************************************************
+static tHostReg *HostRegEntry(uint32_t ui32Addr)
+{
+    uint32_t ui32Slot = (ui32Addr * 2654435761u) >> 20;
+
+    while (g_psHostRegs[ui32Slot].Used &&
+           (g_psHostRegs[ui32Slot].Addr != ui32Addr))
+        ui32Slot = (ui32Slot + 1) & (HOST_REG_SLOTS - 1);
+
+    if (!g_psHostRegs[ui32Slot].Used)
+    {
+        g_psHostRegs[ui32Slot].Used = true;
+        g_psHostRegs[ui32Slot].Addr = ui32Addr;
+        g_psHostRegs[ui32Slot].Value = 0;
+    }
+
+    return &g_psHostRegs[ui32Slot];
+}
+
+
+//*****************************************************************************
+//
+// Port index of a GPIO data alias, -1 for any other address
+//
+//*****************************************************************************
+static int32_t HostGPIOPort(uint32_t ui32Addr)
+{
+    uint32_t i;
+
+    for (i = 0; i < HOST_GPIO_PORTS; i++)
+        if ((ui32Addr >= g_pui32HostGPIOBase[i]) &&
+            (ui32Addr < g_pui32HostGPIOBase[i] + 0x400))
+            return i;
+
+    return -1;
+}
+
+
+//*****************************************************************************
+//
+// Word and bit of a bit-band alias address
+//
+//*****************************************************************************
+static uint32_t HostBitBandWord(uint32_t ui32Addr, uint32_t *pui32Bit)
+{
+    uint32_t ui32Byte = (ui32Addr & 0x01FFFFFF) >> 5;
+
+    *pui32Bit = ((ui32Addr >> 2) & 7) + 8 * (ui32Byte & 3);
+
+    return 0x40000000 | (ui32Byte & ~3u);
+}
+
+
+//*****************************************************************************
+//
+// Apply the value of the alias handed out last to the register behind it
+//
+//*****************************************************************************
+void HostRegSync(void)
+{
+    tHostReg *psAlias = g_psHostAlias;
+    tHostReg *psWord;
+    uint32_t ui32Bit, ui32Mask;
+    int32_t i32Port;
+
+    if (!psAlias)
+        return;
+    g_psHostAlias = 0;
+
+    i32Port = HostGPIOPort(psAlias->Addr);
+    if (i32Port >= 0)
+    {
+        ui32Mask = (psAlias->Addr >> 2) & 0xFF;
+        g_pui32HostGPIOData[i32Port] =
+            (g_pui32HostGPIOData[i32Port] & ~ui32Mask) |
+            (psAlias->Value & ui32Mask);
+        return;
+    }
+
+    psWord = HostRegEntry(HostBitBandWord(psAlias->Addr, &ui32Bit));
+    if (psAlias->Value & 1)
+        psWord->Value |= 1u << ui32Bit;
+    else
+        psWord->Value &= ~(1u << ui32Bit);
+}
+
+
+//*****************************************************************************
+//
+// System clocks of host time, for DWT_CYCCNT
+//
+//*****************************************************************************
+static uint32_t HostCycles(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return (uint32_t)(((uint64_t)sNow.tv_sec * 1000000000u + sNow.tv_nsec) *
+                      SYSTEM_CLOCK_MHZ / 1000);
+}
+
+
+//*****************************************************************************
+//
+// HWREG() - the register at an address
+//
+//*****************************************************************************
+volatile uint32_t *HostReg(uint32_t ui32Addr)
+{
+    tHostReg *psReg;
+    uint32_t ui32Bit;
+    int32_t i32Port;
+
+    HostRegSync();
+
+    g_ui32HostRegAccesses++;
+    psReg = HostRegEntry(ui32Addr);
+
+    if (ui32Addr == DWT_CYCCNT)
+    {
+        psReg->Value = HostCycles();
+    }
+    else if ((i32Port = HostGPIOPort(ui32Addr)) >= 0)
+    {
+        psReg->Value = g_pui32HostGPIOData[i32Port] & ((ui32Addr >> 2) & 0xFF);
+        g_psHostAlias = psReg;
+    }
+    else if ((ui32Addr >= HOST_BITBAND_BASE) && (ui32Addr < HOST_BITBAND_END))
+    {
+        psReg->Value = (HostRegEntry(HostBitBandWord(ui32Addr, &ui32Bit))->Value >>
+                        ui32Bit) & 1;
+        g_psHostAlias = psReg;
+    }
+
+    return &psReg->Value;
+}
+
+
+//*****************************************************************************
+//
+// NVIC - run the pending interrupts that preempt what is running, highest
+// priority first.  Handlers nest through the recursion.
+//
+//*****************************************************************************
+void HostIntDispatch(void)
+{
+    volatile uint32_t *pui32IntCtrl;
+    uint32_t i, ui32Best, ui32Threshold, ui32Saved;
+
+    while (1)
+    {
+        pui32IntCtrl = HostReg(NVIC_INT_CTRL);
+        if (*pui32IntCtrl & NVIC_INT_CTRL_PEND_SV)
+        {
+            *pui32IntCtrl &= ~NVIC_INT_CTRL_PEND_SV;
+            g_pbHostIntPending[FAULT_PENDSV] = true;
+        }
+
+        if (g_bHostPrimask)
+            return;
+
+        ui32Threshold = g_ui32HostActive;
+        if (g_ui32HostBasepri && (g_ui32HostBasepri < ui32Threshold))
+            ui32Threshold = g_ui32HostBasepri;
+
+        ui32Best = NUM_INTERRUPTS;
+        for (i = 0; i < NUM_INTERRUPTS; i++)
+        {
+            if (g_pbHostIntPending[i] && g_ppfnHostVectors[i] &&
+                ((i < 16) || g_pbHostIntEnabled[i]) &&
+                ((g_pui8HostIntPriority[i] & 0xE0) < ui32Threshold))
+            {
+                ui32Threshold = g_pui8HostIntPriority[i] & 0xE0;
+                ui32Best = i;
+            }
+        }
+        if (ui32Best == NUM_INTERRUPTS)
+            return;
+
+        g_pbHostIntPending[ui32Best] = false;
+        ui32Saved = g_ui32HostActive;
+        g_ui32HostActive = g_pui8HostIntPriority[ui32Best] & 0xE0;
+        g_ppfnHostVectors[ui32Best]();
+        g_ui32HostActive = ui32Saved;
+    }
+}
+
+void HostIntRaise(uint32_t ui32Interrupt)
+{
+    g_pbHostIntPending[ui32Interrupt] = true;
+    HostIntDispatch();
+}
+
+bool IntMasterEnable(void)
+{
+    bool bWasDisabled = g_bHostPrimask;
+
+    g_bHostPrimask = false;
+    HostIntDispatch();
+
+    return bWasDisabled;
+}
+
+bool IntMasterDisable(void)
+{
+    bool bWasDisabled = g_bHostPrimask;
+
+    g_bHostPrimask = true;
+
+    return bWasDisabled;
+}
+
+void IntEnable(uint32_t ui32Interrupt)
+{
+    g_pbHostIntEnabled[ui32Interrupt] = true;
+    HostIntDispatch();
+}
+
+void IntDisable(uint32_t ui32Interrupt)
+{
+    g_pbHostIntEnabled[ui32Interrupt] = false;
+}
+
+void IntPendSet(uint32_t ui32Interrupt)
+{
+    HostIntRaise(ui32Interrupt);
+}
+
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    g_pui8HostIntPriority[ui32Interrupt] = ui8Priority;
+}
+
+int32_t IntPriorityGet(uint32_t ui32Interrupt)
+{
+    return g_pui8HostIntPriority[ui32Interrupt];
+}
+
+void IntPriorityMaskSet(uint32_t ui32PriorityMask)
+{
+    g_ui32HostBasepri = ui32PriorityMask & 0xE0;
+    HostIntDispatch();
+}
+
+uint32_t IntPriorityMaskGet(void)
+{
+    return g_ui32HostBasepri;
+}
+
+
+//*****************************************************************************
+//
+// System control - the clock is set by SYSTEM_CLOCK_MHZ, and peripherals
+// are ready at once
+//
+//*****************************************************************************
+void SysCtlClockSet(uint32_t ui32Config)
+{
+}
+
+void SysCtlDelay(uint32_t ui32Count)
+{
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    return true;
+}
+
+void SysCtlPWMClockSet(uint32_t ui32Config)
+{
+}
+
+void FPUEnable(void)
+{
+}
+
+void FPULazyStackingEnable(void)
+{
+}
+
+
+//*****************************************************************************
+//
+// GPIO - only the data register is modelled
+//
+//*****************************************************************************
+void GPIODirModeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32PinIO)
+{
+}
+
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins,
+                      uint32_t ui32Strength, uint32_t ui32PadType)
+{
+    //
+    // A pull-up reads high, like SW1 when it is not pressed
+    //
+    if (ui32PadType == GPIO_PIN_TYPE_STD_WPU)
+        HWREG(ui32Port + GPIO_O_DATA + (ui8Pins << 2)) = ui8Pins;
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+}
+
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    return HWREG(ui32Port + GPIO_O_DATA + (ui8Pins << 2));
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    HWREG(ui32Port + GPIO_O_DATA + (ui8Pins << 2)) = ui8Val;
+}
+
+void GPIOPinTypeADC(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypePWM(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeQEI(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+
+//*****************************************************************************
+//
+// PWM - generator registers as in driverlib, which the plant reads
+//
+//*****************************************************************************
+void PWMGenConfigure(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Config)
+{
+    HWREG(ui32Base + ui32Gen + PWM_O_X_CTL) =
+        (HWREG(ui32Base + ui32Gen + PWM_O_X_CTL) & PWM_X_CTL_ENABLE) |
+        (ui32Config & ~PWM_X_CTL_ENABLE);
+}
+
+void PWMGenPeriodSet(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Period)
+{
+    if (HWREG(ui32Base + ui32Gen + PWM_O_X_CTL) & PWM_X_CTL_MODE)
+        HWREG(ui32Base + ui32Gen + PWM_O_X_LOAD) = ui32Period / 2;
+    else
+        HWREG(ui32Base + ui32Gen + PWM_O_X_LOAD) = ui32Period - 1;
+}
+
+uint32_t PWMGenPeriodGet(uint32_t ui32Base, uint32_t ui32Gen)
+{
+    if (HWREG(ui32Base + ui32Gen + PWM_O_X_CTL) & PWM_X_CTL_MODE)
+        return HWREG(ui32Base + ui32Gen + PWM_O_X_LOAD) * 2;
+
+    return HWREG(ui32Base + ui32Gen + PWM_O_X_LOAD) + 1;
+}
+
+void PWMGenEnable(uint32_t ui32Base, uint32_t ui32Gen)
+{
+    HWREG(ui32Base + ui32Gen + PWM_O_X_CTL) |= PWM_X_CTL_ENABLE;
+}
+
+void PWMGenDisable(uint32_t ui32Base, uint32_t ui32Gen)
+{
+    HWREG(ui32Base + ui32Gen + PWM_O_X_CTL) &= ~PWM_X_CTL_ENABLE;
+}
+
+void PWMPulseWidthSet(uint32_t ui32Base, uint32_t ui32PWMOut,
+                      uint32_t ui32Width)
+{
+    uint32_t ui32Gen = ui32Base + (ui32PWMOut & 0xFC0);
+
+    if (HWREG(ui32Gen + PWM_O_X_CTL) & PWM_X_CTL_MODE)
+        ui32Width /= 2;
+
+    HWREG(ui32Gen + ((ui32PWMOut & 1) ? PWM_O_X_CMPB : PWM_O_X_CMPA)) =
+        HWREG(ui32Gen + PWM_O_X_LOAD) - ui32Width;
+}
+
+void PWMOutputState(uint32_t ui32Base, uint32_t ui32PWMOutBits, bool bEnable)
+{
+    if (bEnable)
+        HWREG(ui32Base + PWM_O_ENABLE) |= ui32PWMOutBits;
+    else
+        HWREG(ui32Base + PWM_O_ENABLE) &= ~ui32PWMOutBits;
+}
+
+void PWMOutputUpdateMode(uint32_t ui32Base, uint32_t ui32PWMOutBits,
+                         uint32_t ui32Mode)
+{
+}
+
+void PWMGenIntTrigEnable(uint32_t ui32Base, uint32_t ui32Gen,
+                         uint32_t ui32IntTrig)
+{
+    HWREG(ui32Base + ui32Gen + PWM_O_X_INTEN) |= ui32IntTrig;
+}
+
+void PWMGenIntClear(uint32_t ui32Base, uint32_t ui32Gen, uint32_t ui32Ints)
+{
+}
+
+void PWMIntEnable(uint32_t ui32Base, uint32_t ui32GenFault)
+{
+    g_pui32HostPWMIntEnable[(ui32Base == PWM1_BASE) ? 1 : 0] |= ui32GenFault;
+}
+
+
+//*****************************************************************************
+//
+// QEI - the plant counts in the position and velocity registers
+//
+//*****************************************************************************
+void QEIEnable(uint32_t ui32Base)
+{
+}
+
+void QEIDisable(uint32_t ui32Base)
+{
+}
+
+void QEIConfigure(uint32_t ui32Base, uint32_t ui32Config,
+                  uint32_t ui32MaxPosition)
+{
+    HWREG(ui32Base + QEI_O_MAXPOS) = ui32MaxPosition;
+}
+
+uint32_t QEIPositionGet(uint32_t ui32Base)
+{
+    return HWREG(ui32Base + QEI_O_POS);
+}
+
+void QEIPositionSet(uint32_t ui32Base, uint32_t ui32Position)
+{
+    HWREG(ui32Base + QEI_O_POS) = ui32Position;
+}
+
+int32_t QEIDirectionGet(uint32_t ui32Base)
+{
+    return (HWREG(ui32Base + QEI_O_STAT) & QEI_STAT_DIRECTION) ? -1 : 1;
+}
+
+void QEIVelocityEnable(uint32_t ui32Base)
+{
+}
+
+void QEIVelocityDisable(uint32_t ui32Base)
+{
+}
+
+void QEIVelocityConfigure(uint32_t ui32Base, uint32_t ui32PreDiv,
+                          uint32_t ui32Period)
+{
+    HWREG(ui32Base + QEI_O_CTL) = ui32PreDiv;
+    HWREG(ui32Base + QEI_O_LOAD) = ui32Period - 1;
+}
+
+uint32_t QEIVelocityGet(uint32_t ui32Base)
+{
+    return HWREG(ui32Base + QEI_O_SPEED);
+}
+
+void QEIIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+}
+
+
+//*****************************************************************************
+//
+// Timer - only Timer 0 A, the control tick
+//
+//*****************************************************************************
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    HWREG(ui32Base + TIMER_O_TAILR) = ui32Value;
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    if (ui32Base == TIMER0_BASE)
+        g_bHostTimerRunning = true;
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    if (ui32Base == TIMER0_BASE)
+        g_bHostTimerInt = true;
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+}
+
+
+//*****************************************************************************
+//
+// ADC - the sequencers are triggered by the plant through HostADCConvert()
+//
+//*****************************************************************************
+void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                          uint32_t ui32Trigger, uint32_t ui32Priority)
+{
+}
+
+void ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                              uint32_t ui32Step, uint32_t ui32Config)
+{
+}
+
+void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    g_pbHostADCEnabled[ui32SequenceNum] = true;
+}
+
+void ADCSequenceDisable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    g_pbHostADCEnabled[ui32SequenceNum] = false;
+}
+
+void ADCSequenceDMAEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    g_pbHostADCDMA[ui32SequenceNum] = true;
+}
+
+void ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    g_pbHostADCInt[ui32SequenceNum] = true;
+}
+
+void ADCIntClear(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+}
+
+bool HostADCRunning(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    return (ui32Base == ADC0_BASE) && g_pbHostADCEnabled[ui32SequenceNum];
+}
+
+
+//*****************************************************************************
+//
+// One conversion of a sequencer.  With uDMA the samples go to the control
+// structure in use, which then reads as stopped, and the channel moves to
+// the other one; once both are stopped the channel disables itself.  The
+// interrupt is raised when a transfer completes, and a conversion with no
+// transfer armed is lost.  Transfers are of 16-bit samples, the only size
+// the firmware uses.
+//
+//*****************************************************************************
+void HostADCConvert(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                    const uint16_t *pui16Samples, uint32_t ui32Count)
+{
+    tHostDMAChannel *psChannel;
+    uint32_t ui32Select, i;
+
+    if (!HostADCRunning(ui32Base, ui32SequenceNum) ||
+        !g_pbHostADCDMA[ui32SequenceNum])
+        return;
+
+    psChannel = &g_psHostDMA[UDMA_CHANNEL_ADC0 + ui32SequenceNum];
+    ui32Select = psChannel->Select;
+    if (!psChannel->Enabled || (psChannel->Mode[ui32Select] == UDMA_MODE_STOP))
+        return;
+
+    for (i = 0; (i < ui32Count) && (i < psChannel->Count[ui32Select]); i++)
+        psChannel->Dst[ui32Select][i] = pui16Samples[i];
+
+    psChannel->Mode[ui32Select] = UDMA_MODE_STOP;
+    psChannel->Select = ui32Select ^ 1;
+    if (psChannel->Mode[ui32Select ^ 1] == UDMA_MODE_STOP)
+        psChannel->Enabled = false;
+
+    if (g_pbHostADCInt[ui32SequenceNum])
+        HostIntRaise(INT_ADC0SS0 + ui32SequenceNum);
+}
+
+
+//*****************************************************************************
+//
+// uDMA
+//
+//*****************************************************************************
+void uDMAEnable(void)
+{
+}
+
+void uDMAControlBaseSet(void *pControlTable)
+{
+}
+
+void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    if (ui32Attr & UDMA_ATTR_ALTSELECT)
+        g_psHostDMA[ui32ChannelNum & 0x1F].Select = 0;
+}
+
+void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex,
+                           uint32_t ui32Control)
+{
+}
+
+void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex,
+                            uint32_t ui32Mode, void *pvSrcAddr,
+                            void *pvDstAddr, uint32_t ui32TransferSize)
+{
+    tHostDMAChannel *psChannel = &g_psHostDMA[ui32ChannelStructIndex & 0x1F];
+    uint32_t ui32Select = (ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0;
+
+    psChannel->Mode[ui32Select] = ui32Mode;
+    psChannel->Dst[ui32Select] = (uint16_t *)pvDstAddr;
+    psChannel->Count[ui32Select] = ui32TransferSize;
+}
+
+void uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    g_psHostDMA[ui32ChannelNum & 0x1F].Enabled = true;
+}
+
+void uDMAChannelDisable(uint32_t ui32ChannelNum)
+{
+    g_psHostDMA[ui32ChannelNum & 0x1F].Enabled = false;
+}
+
+bool uDMAChannelIsEnabled(uint32_t ui32ChannelNum)
+{
+    return g_psHostDMA[ui32ChannelNum & 0x1F].Enabled;
+}
+
+uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    return g_psHostDMA[ui32ChannelStructIndex & 0x1F].Mode[
+        (ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0];
+}
+
+
+//*****************************************************************************
+//
+// EEPROM - erased (all ones) unless loaded from a file
+//
+//*****************************************************************************
+static void HostEEPROMErase(void)
+{
+    if (!g_bHostEEPROMErased)
+    {
+        memset(g_pui32HostEEPROM, 0xFF, sizeof(g_pui32HostEEPROM));
+        g_bHostEEPROMErased = true;
+    }
+}
+
+uint32_t EEPROMInit(void)
+{
+    HostEEPROMErase();
+
+    return EEPROM_INIT_OK;
+}
+
+uint32_t EEPROMSizeGet(void)
+{
+    return sizeof(g_pui32HostEEPROM);
+}
+
+void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    HostEEPROMErase();
+    if (ui32Address + ui32Count <= sizeof(g_pui32HostEEPROM))
+        memcpy(pui32Data, (uint8_t *)g_pui32HostEEPROM + ui32Address,
+               ui32Count);
+}
+
+uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address,
+                       uint32_t ui32Count)
+{
+    HostEEPROMErase();
+    if (ui32Address + ui32Count > sizeof(g_pui32HostEEPROM))
+        return 1;
+    memcpy((uint8_t *)g_pui32HostEEPROM + ui32Address, pui32Data, ui32Count);
+
+    return 0;
+}
+
+bool HostEEPROMLoad(const char *pcFile)
+{
+    FILE *psFile = fopen(pcFile, "rb");
+    bool bOk;
+
+    if (!psFile)
+        return false;
+    HostEEPROMErase();
+    bOk = fread(g_pui32HostEEPROM, 1, sizeof(g_pui32HostEEPROM), psFile) ==
+          sizeof(g_pui32HostEEPROM);
+    fclose(psFile);
+
+    return bOk;
+}
+
+bool HostEEPROMSave(const char *pcFile)
+{
+    FILE *psFile = fopen(pcFile, "wb");
+    bool bOk;
+
+    if (!psFile)
+        return false;
+    HostEEPROMErase();
+    bOk = fwrite(g_pui32HostEEPROM, 1, sizeof(g_pui32HostEEPROM), psFile) ==
+          sizeof(g_pui32HostEEPROM);
+
+    return (fclose(psFile) == 0) && bOk;
+}
+
+
+//*****************************************************************************
+//
+// Clocks per control tick, 0 until the tick is configured
+//
+//*****************************************************************************
+uint32_t HostTickClocks(void)
+{
+#ifdef CONTROL_TICK_PWM
+    if (!HWREG(PWM0_BASE + PWM_GEN_1 + PWM_O_X_LOAD))
+        return 0;
+    return PWMGenPeriodGet(PWM0_BASE, PWM_GEN_1) * CONTROL_PWM_DIVIDER;
+#else
+    if (!g_bHostTimerRunning)
+        return 0;
+    return HWREG(TIMER0_BASE + TIMER_O_TAILR) + 1;
+#endif
+}
+
+
+//*****************************************************************************
+//
+// One control tick: the plant moves to the sample point of the next tick,
+// where the tick interrupt fires.  Its handler sees no entry latency.
+//
+//*****************************************************************************
+void HostTick(void)
+{
+#ifdef CONTROL_TICK_PWM
+    uint32_t i;
+#endif
+
+    PlantStep();
+    g_ui32HostTicks++;
+
+#ifdef CONTROL_TICK_PWM
+    HWREG(PWM0_BASE + PWM_GEN_1 + PWM_O_X_COUNT) =
+        HWREG(PWM0_BASE + PWM_GEN_1 + PWM_O_X_LOAD);
+    if ((HWREG(PWM0_BASE + PWM_GEN_1 + PWM_O_X_INTEN) & PWM_INT_CNT_LOAD) &&
+        (g_pui32HostPWMIntEnable[0] & PWM_INT_GEN_1))
+        for (i = 0; i < CONTROL_PWM_DIVIDER; i++)
+            HostIntRaise(INT_PWM0_1);
+#else
+    HWREG(TIMER0_BASE + TIMER_O_TAV) = HWREG(TIMER0_BASE + TIMER_O_TAILR);
+    if (g_bHostTimerRunning && g_bHostTimerInt)
+        HostIntRaise(INT_TIMER0A);
+#endif
+
+    HostIntDispatch();
+}
+
+
+//*****************************************************************************
+//
+// Run a number of ticks back to back, from the main loop or a test
+//
+//*****************************************************************************
+void HostRun(uint32_t ui32Ticks)
+{
+    while (ui32Ticks--)
+        HostTick();
+}
@@ -0,0 +1,104 @@
+//*****************************************************************************
+//
+// hal.h - Host build of the firmware: driverlib and core peripherals.
+//
+// The firmware sources are compiled unchanged for the host against the
+// stand-in TivaWare headers in host/include.  hal.c implements the
+// driverlib calls they make on top of a register file that HWREG() goes
+// through, so what the firmware writes to the PWM, GPIO, QEI and timer
+// registers, directly or through driverlib, reads back like on the target.
+// plant.c drives the other side of those registers from a motor model.
+//
+// Interrupts are dispatched by an NVIC model with the priorities, PRIMASK
+// and BASEPRI the firmware sets, to the handlers of main: a raised
+// interrupt runs at once if it preempts what is running, otherwise when
+// the mask or the running handler lets it.  A PendSV pended through
+// NVIC_INT_CTRL is taken at the next dispatch, which follows every
+// handler, so one pended from an interrupt is tail-chained as on the
+// target.
+//
+// Time is simulated: HostTick() advances the plant by one control tick
+// and raises the tick interrupt (CONTROL_PWM_DIVIDER times with
+// CONTROL_TICK_PWM).  The console (console.c) calls it whenever the main
+// loop polls for input and none is waiting, so the main loop runs once per
+// tick.  DWT_CYCCNT counts host time in system clocks, so the ISR_TIMING
+// reports are host timings.
+//
+//*****************************************************************************
+
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+//
+// Register file.  g_ui32HostRegAccesses counts the HWREG() accesses of the
+// firmware and of the driverlib calls, a read-modify-write as one.
+//
+//*****************************************************************************
+extern uint32_t g_ui32HostRegAccesses;
+
+extern volatile uint32_t *HostReg(uint32_t ui32Addr);
+extern void HostRegSync(void);
+
+//*****************************************************************************
+//
+// Interrupts
+//
+//*****************************************************************************
+extern void HostIntRaise(uint32_t ui32Interrupt);
+extern void HostIntDispatch(void);
+
+//*****************************************************************************
+//
+// Simulated time
+//
+//*****************************************************************************
+extern volatile uint32_t g_ui32HostTicks;
+
+extern uint32_t HostTickClocks(void);
+extern void HostTick(void);
+extern void HostRun(uint32_t ui32Ticks);
+
+//*****************************************************************************
+//
+// ADC conversions, from the plant: the samples of one trigger of a sample
+// sequencer, moved by uDMA when the sequencer uses it
+//
+//*****************************************************************************
+extern bool HostADCRunning(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void HostADCConvert(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                           const uint16_t *pui16Samples, uint32_t ui32Count);
+
+//*****************************************************************************
+//
+// EEPROM contents, optionally kept in a file between runs
+//
+//*****************************************************************************
+extern bool HostEEPROMLoad(const char *pcFile);
+extern bool HostEEPROMSave(const char *pcFile);
+
+//*****************************************************************************
+//
+// Console (console.c).  The idle function is called when the main loop
+// polls for input and none is waiting, before the tick.  The output is
+// also kept in a buffer for the tests.
+//
+//*****************************************************************************
+extern void HostConsoleInput(const char *pcText);
+extern void HostConsoleIdleSet(void (*pfnIdle)(void));
+extern void HostConsoleQuiet(bool bQuiet);
+extern const char *HostConsoleOutput(void);
+extern void HostConsoleClear(void);
+
+//*****************************************************************************
+//
+// The firmware entry point, main() of main_20191001_v1.c renamed by the
+// host build
+//
+//*****************************************************************************
+extern int FirmwareMain(void);
+
+#endif // __HAL_H__
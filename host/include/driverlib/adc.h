@@ -0,0 +1,42 @@
+//*****************************************************************************
+//
+// adc.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  The functions are
+// implemented in host/hal.c.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ADC_H__
+#define __DRIVERLIB_ADC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC_TRIGGER_PWM0        0x00000006
+#define ADC_TRIGGER_PWM1        0x00000007
+#define ADC_TRIGGER_PWM_MOD0    0x00000000
+#define ADC_TRIGGER_PWM_MOD1    0x10000000
+
+#define ADC_CTL_CH0             0x00000000
+#define ADC_CTL_CH1             0x00000001
+#define ADC_CTL_CH2             0x00000002
+#define ADC_CTL_CH3             0x00000003
+#define ADC_CTL_END             0x00000020
+#define ADC_CTL_IE              0x00000040
+
+#define ADC_INT_SS1             0x00000002
+#define ADC_INT_DMA_SS1         0x00000200
+
+extern void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                                 uint32_t ui32Trigger, uint32_t ui32Priority);
+extern void ADCSequenceStepConfigure(uint32_t ui32Base,
+                                     uint32_t ui32SequenceNum,
+                                     uint32_t ui32Step, uint32_t ui32Config);
+extern void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCSequenceDisable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCSequenceDMAEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCIntClear(uint32_t ui32Base, uint32_t ui32SequenceNum);
+
+#endif // __DRIVERLIB_ADC_H__
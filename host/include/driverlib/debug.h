@@ -0,0 +1,16 @@
+//*****************************************************************************
+//
+// debug.h - Host stand-in for the TivaWare header of the same name.
+//
+// ASSERT() is checked on the host, as in a driverlib DEBUG build.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_DEBUG_H__
+#define __DRIVERLIB_DEBUG_H__
+
+#include <assert.h>
+
+#define ASSERT(expr)            assert(expr)
+
+#endif // __DRIVERLIB_DEBUG_H__
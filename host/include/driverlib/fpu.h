@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// fpu.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  The functions are
+// implemented in host/hal.c.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_FPU_H__
+#define __DRIVERLIB_FPU_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern void FPUEnable(void);
+extern void FPULazyStackingEnable(void);
+
+#endif // __DRIVERLIB_FPU_H__
@@ -0,0 +1,25 @@
+//*****************************************************************************
+//
+// pin_map.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  The functions are
+// implemented in host/hal.c.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define __DRIVERLIB_PIN_MAP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_PA0_U0RX           0x00000001
+#define GPIO_PA1_U0TX           0x00000401
+#define GPIO_PB5_M0PWM3         0x00011404
+#define GPIO_PC5_PHA1           0x00021406
+#define GPIO_PC6_PHB1           0x00021806
+#define GPIO_PD6_PHA0           0x00031806
+#define GPIO_PD7_PHB0           0x00031C06
+#define GPIO_PE4_M1PWM2         0x00041005
+
+#endif // __DRIVERLIB_PIN_MAP_H__
@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// pwm.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  The functions are
+// implemented in host/hal.c.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_PWM_H__
+#define __DRIVERLIB_PWM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PWM_GEN_0               0x00000040
+#define PWM_GEN_1               0x00000080
+#define PWM_GEN_2               0x000000C0
+#define PWM_GEN_3               0x00000100
+#define PWM_GEN_0_BIT           0x00000001
+#define PWM_GEN_1_BIT           0x00000002
+
+#define PWM_OUT_0               0x00000040
+#define PWM_OUT_1               0x00000041
+#define PWM_OUT_2               0x00000082
+#define PWM_OUT_3               0x00000083
+#define PWM_OUT_0_BIT           0x00000001
+#define PWM_OUT_1_BIT           0x00000002
+#define PWM_OUT_2_BIT           0x00000004
+#define PWM_OUT_3_BIT           0x00000008
+
+#define PWM_GEN_MODE_DOWN       0x00000000
+#define PWM_GEN_MODE_UP_DOWN    0x00000002
+#define PWM_GEN_MODE_NO_SYNC    0x00000000
+#define PWM_GEN_MODE_SYNC       0x00000038
+#define PWM_GEN_MODE_DBG_RUN    0x00000004
+#define PWM_GEN_MODE_DBG_STOP   0x00000000
+
+#define PWM_INT_CNT_ZERO        0x00000001
+#define PWM_INT_CNT_LOAD        0x00000002
+#define PWM_TR_CNT_ZERO         0x00000100
+#define PWM_TR_CNT_LOAD         0x00000200
+#define PWM_INT_GEN_0           0x00000001
+#define PWM_INT_GEN_1           0x00000002
+
+#define PWM_OUTPUT_MODE_NO_SYNC     0x00000000
+#define PWM_OUTPUT_MODE_SYNC_LOCAL  0x00000002
+#define PWM_OUTPUT_MODE_SYNC_GLOBAL 0x00000003
+
+extern void PWMGenConfigure(uint32_t ui32Base, uint32_t ui32Gen,
+                            uint32_t ui32Config);
+extern void PWMGenPeriodSet(uint32_t ui32Base, uint32_t ui32Gen,
+                            uint32_t ui32Period);
+extern uint32_t PWMGenPeriodGet(uint32_t ui32Base, uint32_t ui32Gen);
+extern void PWMGenEnable(uint32_t ui32Base, uint32_t ui32Gen);
+extern void PWMGenDisable(uint32_t ui32Base, uint32_t ui32Gen);
+extern void PWMPulseWidthSet(uint32_t ui32Base, uint32_t ui32PWMOut,
+                             uint32_t ui32Width);
+extern void PWMOutputState(uint32_t ui32Base, uint32_t ui32PWMOutBits,
+                           bool bEnable);
+extern void PWMOutputUpdateMode(uint32_t ui32Base, uint32_t ui32PWMOutBits,
+                                uint32_t ui32Mode);
+extern void PWMGenIntTrigEnable(uint32_t ui32Base, uint32_t ui32Gen,
+                                uint32_t ui32IntTrig);
+extern void PWMGenIntClear(uint32_t ui32Base, uint32_t ui32Gen,
+                           uint32_t ui32Ints);
+extern void PWMIntEnable(uint32_t ui32Base, uint32_t ui32GenFault);
+
+#endif // __DRIVERLIB_PWM_H__
@@ -0,0 +1,47 @@
+//*****************************************************************************
+//
+// qei.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  The functions are
+// implemented in host/hal.c.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_QEI_H__
+#define __DRIVERLIB_QEI_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define QEI_CONFIG_CAPTURE_A    0x00000000
+#define QEI_CONFIG_CAPTURE_A_B  0x00000008
+#define QEI_CONFIG_NO_RESET     0x00000000
+#define QEI_CONFIG_QUADRATURE   0x00000000
+#define QEI_CONFIG_NO_SWAP      0x00000000
+
+#define QEI_VELDIV_1            0x00000000
+#define QEI_VELDIV_2            0x00000040
+#define QEI_VELDIV_4            0x00000080
+#define QEI_VELDIV_8            0x000000C0
+#define QEI_VELDIV_16           0x00000100
+
+#define QEI_INTERROR            0x00000008
+#define QEI_INTDIR              0x00000004
+#define QEI_INTTIMER            0x00000002
+#define QEI_INTINDEX            0x00000001
+
+extern void QEIEnable(uint32_t ui32Base);
+extern void QEIDisable(uint32_t ui32Base);
+extern void QEIConfigure(uint32_t ui32Base, uint32_t ui32Config,
+                         uint32_t ui32MaxPosition);
+extern uint32_t QEIPositionGet(uint32_t ui32Base);
+extern void QEIPositionSet(uint32_t ui32Base, uint32_t ui32Position);
+extern int32_t QEIDirectionGet(uint32_t ui32Base);
+extern void QEIVelocityEnable(uint32_t ui32Base);
+extern void QEIVelocityDisable(uint32_t ui32Base);
+extern void QEIVelocityConfigure(uint32_t ui32Base, uint32_t ui32PreDiv,
+                                 uint32_t ui32Period);
+extern uint32_t QEIVelocityGet(uint32_t ui32Base);
+extern void QEIIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags);
+
+#endif // __DRIVERLIB_QEI_H__
@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+// rom.h - Host stand-in for the TivaWare header of the same name.
+//
+// There is no ROM on the host; rom_map.h maps every MAP_ call to the
+// function itself.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ROM_H__
+#define __DRIVERLIB_ROM_H__
+
+#endif // __DRIVERLIB_ROM_H__
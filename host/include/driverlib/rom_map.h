@@ -0,0 +1,46 @@
+//*****************************************************************************
+//
+// rom_map.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only the MAP_ calls uartstdio.c makes, each to the function itself.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ROM_MAP_H__
+#define __DRIVERLIB_ROM_MAP_H__
+
+#define MAP_IntEnable                   IntEnable
+#define MAP_IntMasterDisable            IntMasterDisable
+#define MAP_IntMasterEnable             IntMasterEnable
+#define MAP_IntPendSet                  IntPendSet
+#define MAP_IntPriorityGet              IntPriorityGet
+#define MAP_IntPriorityMaskGet          IntPriorityMaskGet
+#define MAP_IntPriorityMaskSet          IntPriorityMaskSet
+#define MAP_SysCtlPeripheralEnable      SysCtlPeripheralEnable
+#define MAP_SysCtlPeripheralPresent     SysCtlPeripheralPresent
+#define MAP_UARTCharGet                 UARTCharGet
+#define MAP_UARTCharGetNonBlocking      UARTCharGetNonBlocking
+#define MAP_UARTCharPut                 UARTCharPut
+#define MAP_UARTCharPutNonBlocking      UARTCharPutNonBlocking
+#define MAP_UARTCharsAvail              UARTCharsAvail
+#define MAP_UARTConfigSetExpClk         UARTConfigSetExpClk
+#define MAP_UARTDMAEnable               UARTDMAEnable
+#define MAP_UARTEnable                  UARTEnable
+#define MAP_UARTFIFOLevelSet            UARTFIFOLevelSet
+#define MAP_UARTIntClear                UARTIntClear
+#define MAP_UARTIntDisable              UARTIntDisable
+#define MAP_UARTIntEnable               UARTIntEnable
+#define MAP_UARTIntStatus               UARTIntStatus
+#define MAP_UARTSpaceAvail              UARTSpaceAvail
+#define MAP_uDMAChannelAssign           uDMAChannelAssign
+#define MAP_uDMAChannelAttributeDisable uDMAChannelAttributeDisable
+#define MAP_uDMAChannelControlSet       uDMAChannelControlSet
+#define MAP_uDMAChannelDisable          uDMAChannelDisable
+#define MAP_uDMAChannelEnable           uDMAChannelEnable
+#define MAP_uDMAChannelIsEnabled        uDMAChannelIsEnabled
+#define MAP_uDMAChannelModeGet          uDMAChannelModeGet
+#define MAP_uDMAChannelTransferSet      uDMAChannelTransferSet
+#define MAP_uDMAIntClear                uDMAIntClear
+#define MAP_uDMAIntStatus               uDMAIntStatus
+
+#endif // __DRIVERLIB_ROM_MAP_H__
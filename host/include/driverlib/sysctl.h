@@ -0,0 +1,50 @@
+//*****************************************************************************
+//
+// sysctl.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  The functions are
+// implemented in host/hal.c.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYSCTL_PERIPH_TIMER0    0xF0000400
+#define SYSCTL_PERIPH_GPIOA     0xF0000800
+#define SYSCTL_PERIPH_GPIOB     0xF0000801
+#define SYSCTL_PERIPH_GPIOC     0xF0000802
+#define SYSCTL_PERIPH_GPIOD     0xF0000803
+#define SYSCTL_PERIPH_GPIOE     0xF0000804
+#define SYSCTL_PERIPH_GPIOF     0xF0000805
+#define SYSCTL_PERIPH_UDMA      0xF0000C00
+#define SYSCTL_PERIPH_UART0     0xF0001800
+#define SYSCTL_PERIPH_UART1     0xF0001801
+#define SYSCTL_PERIPH_UART2     0xF0001802
+#define SYSCTL_PERIPH_ADC0      0xF0003800
+#define SYSCTL_PERIPH_PWM0      0xF0004000
+#define SYSCTL_PERIPH_PWM1      0xF0004001
+#define SYSCTL_PERIPH_QEI0      0xF0004400
+#define SYSCTL_PERIPH_QEI1      0xF0004401
+#define SYSCTL_PERIPH_EEPROM0   0xF0005800
+
+#define SYSCTL_SYSDIV_2_5       0xC1000000
+#define SYSCTL_SYSDIV_4         0x01C00000
+#define SYSCTL_SYSDIV_5         0x02400000
+#define SYSCTL_USE_PLL          0x00000000
+#define SYSCTL_XTAL_16MHZ       0x00000540
+#define SYSCTL_OSC_MAIN         0x00000000
+
+#define SYSCTL_PWMDIV_1         0x00000000
+
+extern void SysCtlClockSet(uint32_t ui32Config);
+extern void SysCtlDelay(uint32_t ui32Count);
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralPresent(uint32_t ui32Peripheral);
+extern void SysCtlPWMClockSet(uint32_t ui32Config);
+
+#endif // __DRIVERLIB_SYSCTL_H__
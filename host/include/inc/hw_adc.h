@@ -0,0 +1,15 @@
+//*****************************************************************************
+//
+// hw_adc.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_ADC_H__
+#define __HW_ADC_H__
+
+#define ADC_O_SSFIFO0           0x00000048  // Sample sequence 0 FIFO
+#define ADC_O_SSFIFO1           0x00000068  // Sample sequence 1 FIFO
+
+#endif // __HW_ADC_H__
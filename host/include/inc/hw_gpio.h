@@ -0,0 +1,21 @@
+//*****************************************************************************
+//
+// hw_gpio.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_GPIO_H__
+#define __HW_GPIO_H__
+
+#define GPIO_O_DATA             0x00000000  // Data, masked by address 9:2
+#define GPIO_O_DIR              0x00000400  // Direction
+#define GPIO_O_AFSEL            0x00000420  // Alternate function select
+#define GPIO_O_DEN              0x0000051C  // Digital enable
+#define GPIO_O_LOCK             0x00000520  // Lock
+#define GPIO_O_CR               0x00000524  // Commit
+
+#define GPIO_LOCK_KEY           0x4C4F434B  // Unlocks the GPIO_CR register
+
+#endif // __HW_GPIO_H__
@@ -0,0 +1,24 @@
+//*****************************************************************************
+//
+// hw_ints.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define FAULT_PENDSV            14
+#define INT_UART0               21
+#define INT_UART1               22
+#define INT_PWM0_1              27
+#define INT_ADC0SS0             30
+#define INT_ADC0SS1             31
+#define INT_TIMER0A             35
+#define INT_UART2               49
+#define INT_UDMAERR             63
+
+#define NUM_INTERRUPTS          155
+
+#endif // __HW_INTS_H__
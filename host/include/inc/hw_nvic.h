@@ -0,0 +1,16 @@
+//*****************************************************************************
+//
+// hw_nvic.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_NVIC_H__
+#define __HW_NVIC_H__
+
+#define NVIC_INT_CTRL           0xE000ED04  // Interrupt Control and State
+#define NVIC_VTABLE             0xE000ED08  // Vector Table Offset
+#define NVIC_INT_CTRL_PEND_SV   0x10000000  // Set PendSV pending
+
+#endif // __HW_NVIC_H__
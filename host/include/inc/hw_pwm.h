@@ -0,0 +1,26 @@
+//*****************************************************************************
+//
+// hw_pwm.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_PWM_H__
+#define __HW_PWM_H__
+
+#define PWM_O_CTL               0x00000000  // Master control
+#define PWM_O_ENABLE            0x00000008  // Output enable
+#define PWM_O_ENUPD             0x00000028  // Enable update
+#define PWM_O_X_CTL             0x00000000  // Generator control
+#define PWM_O_X_INTEN           0x00000004  // Generator interrupt enable
+#define PWM_O_X_ISC             0x0000000C  // Generator interrupt status
+#define PWM_O_X_LOAD            0x00000010  // Generator load
+#define PWM_O_X_COUNT           0x00000014  // Generator counter
+#define PWM_O_X_CMPA            0x00000018  // Generator compare A
+#define PWM_O_X_CMPB            0x0000001C  // Generator compare B
+
+#define PWM_X_CTL_ENABLE        0x00000001  // Generator enable
+#define PWM_X_CTL_MODE          0x00000002  // Up/down counting
+
+#endif // __HW_PWM_H__
@@ -0,0 +1,22 @@
+//*****************************************************************************
+//
+// hw_qei.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_QEI_H__
+#define __HW_QEI_H__
+
+#define QEI_O_CTL               0x00000000  // Control
+#define QEI_O_STAT              0x00000004  // Status
+#define QEI_O_POS               0x00000008  // Position
+#define QEI_O_MAXPOS            0x0000000C  // Maximum position
+#define QEI_O_LOAD              0x00000010  // Timer load
+#define QEI_O_SPEED             0x0000001C  // Velocity
+
+#define QEI_STAT_DIRECTION      0x00000002  // Direction of rotation
+#define QEI_CTL_VELDIV_S        6
+
+#endif // __HW_QEI_H__
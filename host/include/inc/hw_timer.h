@@ -0,0 +1,15 @@
+//*****************************************************************************
+//
+// hw_timer.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_TIMER_H__
+#define __HW_TIMER_H__
+
+#define TIMER_O_TAILR           0x00000028  // Timer A interval load
+#define TIMER_O_TAV             0x00000050  // Timer A value
+
+#endif // __HW_TIMER_H__
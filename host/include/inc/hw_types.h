@@ -0,0 +1,27 @@
+//*****************************************************************************
+//
+// hw_types.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+//
+// Register access goes through the register file of the host HAL
+//
+//*****************************************************************************
+extern volatile uint32_t *HostReg(uint32_t ui32Addr);
+
+#define HWREG(x)                (*HostReg((uint32_t)(x)))
+#define HWREGBITW(x, b)                                                       \
+    HWREG(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                         \
+          (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
+
+#endif // __HW_TYPES_H__
@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// hw_uart.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+#define UART_O_DR               0x00000000  // Data
+
+#endif // __HW_UART_H__
@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// tm4c123gh6pm.h - Host stand-in for the TivaWare header of the same name.
+//
+// Only what the firmware uses, with the TivaWare values.  See host/hal.h.
+//
+//*****************************************************************************
+
+#ifndef __TM4C123GH6PM_H__
+#define __TM4C123GH6PM_H__
+
+#include "inc/hw_ints.h"
+
+#endif // __TM4C123GH6PM_H__
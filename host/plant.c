@@ -0,0 +1,481 @@
+//*****************************************************************************
+//
+// plant.c - DC motor and encoder model of the host build.
+//
+// Each axis is a brushed DC motor driven by a sign/magnitude bridge:
+//
+//   L di/dt = V - R i - Kt w
+//   J dw/dt = Kt i - B w - Load
+//
+// where V = +/- Supply * duty, integrated with forward Euler.  Each control
+// tick is integrated in pieces between the PWM events that fall in it: at
+// every zero of the PWM counter the duty in the compare registers takes
+// effect, and at every load event the current sensors are converted when
+// the firmware runs the current sequencer.  The shaft angle is turned into
+// quadrature counts, and the QEI velocity register is emulated (counts per
+// velocity period after the pre-divider) so the control code sees the same
+// stale/quantized velocity it gets from the real peripheral.
+//
+// With MOTOR_CURRENT_LOOP the conversions are of the model currents, scaled
+// like the sensors described in motor_config.h.  The electrical time
+// constant L/R (0.5 ms) is then what the current loop works against.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_pwm.h"
+#include "inc/hw_qei.h"
+#include "motor.h"
+#include "current.h"
+#include "hal.h"
+#include "plant.h"
+
+//*****************************************************************************
+//
+// Model parameters - a small 12V gearmotor with a 500 line encoder
+// (2000 counts/rev).  Call PlantReset() after changing them.
+//
+// CountsPerRad is negative: the encoder counts down while the direction
+// pin is high, which is the polarity the controllers in motor.c
+// (drive = -u) are written for.
+//
+//*****************************************************************************
+#define PLANT_MOTOR                                                           \
+    { 12.0f, 2.0f, 1.0e-3f, 0.02f, 2.0e-5f, 1.0e-5f, 0.0f, -318.31f }
+
+tPlantParams g_psPlantParams[MOTOR_NUM_AXES] =
+{
+    PLANT_MOTOR,
+    PLANT_MOTOR,
+#if MOTOR_NUM_AXES > 2
+    PLANT_MOTOR,
+#endif
+#if MOTOR_NUM_AXES > 3
+    PLANT_MOTOR,
+#endif
+};
+
+tPlantState g_psPlantState[MOTOR_NUM_AXES];
+
+tPlantLatency g_sPlantLatency;          // Sample to actuation [clocks]
+
+//*****************************************************************************
+//
+// Actuation timing in system clocks.  Phases are measured from the last
+// zero of the PWM counter of the first axis; the generators of all axes are
+// started together, so their zeros coincide.
+//
+//*****************************************************************************
+#define PLANT_ENTRY_CLOCKS      30      // Tick event to sample
+
+static uint32_t g_ui32PlantComputeClocks = PLANT_COMPUTE_CLOCKS;
+static uint32_t g_ui32PlantSamplePhase = PLANT_ENTRY_CLOCKS;
+
+//*****************************************************************************
+//
+// Integration step and the per-step coefficients derived from it
+//
+//*****************************************************************************
+static uint32_t g_ui32PlantTickClocks = 0;
+static float g_fPlantDt = 1.0e-4f;                  // [s]
+static float g_pfPlantDtOverL[MOTOR_NUM_AXES];
+static float g_pfPlantDtOverJ[MOTOR_NUM_AXES];
+static float g_pfPlantCountsPerStep[MOTOR_NUM_AXES];    // per (rad/s)
+
+
+//*****************************************************************************
+//
+// Clear the latency statistics
+//
+//*****************************************************************************
+static void PlantLatencyReset(void)
+{
+    uint32_t i;
+
+    g_sPlantLatency.Count = 0;
+    g_sPlantLatency.Min = 0xFFFFFFFF;
+    g_sPlantLatency.Max = 0;
+    g_sPlantLatency.Sum = 0;
+    for (i = 0; i < PLANT_LATENCY_BUCKETS; i++)
+        g_sPlantLatency.Histogram[i] = 0;
+}
+
+
+//*****************************************************************************
+//
+// Recompute the integration coefficients for the tick length
+//
+//*****************************************************************************
+static void PlantCoefficientsUpdate(uint32_t ui32TickClocks)
+{
+    uint32_t i;
+
+    g_ui32PlantTickClocks = ui32TickClocks;
+    if (ui32TickClocks)
+        g_fPlantDt = (float)ui32TickClocks / (float)SYSTEM_CLOCK_HZ;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        g_pfPlantDtOverL[i] = g_fPlantDt / g_psPlantParams[i].L;
+        g_pfPlantDtOverJ[i] = g_fPlantDt / g_psPlantParams[i].J;
+        g_pfPlantCountsPerStep[i] = g_fPlantDt *
+                                    g_psPlantParams[i].CountsPerRad;
+    }
+}
+
+
+//*****************************************************************************
+//
+// Reset the motor dynamics, the latency statistics and the coefficients.
+// Encoder counts are left alone; they are owned by QEIPositionSet().
+//
+//*****************************************************************************
+void PlantReset(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        g_psPlantState[i].Current = 0.0f;
+        g_psPlantState[i].Speed = 0.0f;
+        g_psPlantState[i].Voltage = 0.0f;
+        g_psPlantState[i].CountFraction = 0.0f;
+        g_psPlantState[i].Travel = 0;
+        g_psPlantState[i].VelocityAccum = 0;
+        g_psPlantState[i].VelocityCountdown = 0;
+    }
+
+    PlantCoefficientsUpdate(HostTickClocks());
+    PlantLatencyReset();
+}
+
+
+//*****************************************************************************
+//
+// Bridge duty cycle of one axis, read back from the PWM generator and the
+// direction pin so that it does not matter how the motor code wrote them.
+// Positive when the direction pin is high.
+//
+//*****************************************************************************
+static float PlantBridgeDuty(const tMotorAxis *psAxis)
+{
+    uint32_t ui32Gen, ui32Load, ui32Compare;
+    float fDuty;
+
+    ui32Gen = psAxis->PWMBase + psAxis->PWMGen;
+    ui32Load = HWREG(ui32Gen + PWM_O_X_LOAD);
+    if (!(HWREG(ui32Gen + PWM_O_X_CTL) & PWM_X_CTL_ENABLE) ||
+        !(HWREG(psAxis->PWMBase + PWM_O_ENABLE) & psAxis->PWMOutBit) ||
+        !ui32Load)
+        return 0.0f;
+
+    //
+    // Up/down and down counting both give a high time of LOAD - CMP for
+    // every LOAD clocks
+    //
+    ui32Compare = HWREG(ui32Gen + ((psAxis->PWMOut & 1) ? PWM_O_X_CMPB :
+                                                          PWM_O_X_CMPA));
+    if (ui32Compare >= ui32Load)
+        return 0.0f;
+    fDuty = (float)(ui32Load - ui32Compare) / (float)ui32Load;
+
+    if (!HWREG(psAxis->DirPort + GPIO_O_DATA + (psAxis->DirPin << 2)))
+        fDuty = -fDuty;
+
+    return fDuty;
+}
+
+
+//*****************************************************************************
+//
+// PWM period of the first axis [clocks], 0 while its generator is off
+//
+//*****************************************************************************
+static uint32_t PlantPWMPeriod(void)
+{
+    uint32_t ui32Gen, ui32Ctl;
+
+    ui32Gen = g_psMotorAxes[0].PWMBase + g_psMotorAxes[0].PWMGen;
+    ui32Ctl = HWREG(ui32Gen + PWM_O_X_CTL);
+    if (!(ui32Ctl & PWM_X_CTL_ENABLE))
+        return 0;
+
+    return (ui32Ctl & PWM_X_CTL_MODE) ? 2 * HWREG(ui32Gen + PWM_O_X_LOAD) :
+                                        HWREG(ui32Gen + PWM_O_X_LOAD) + 1;
+}
+
+
+//*****************************************************************************
+//
+// Add a sample to actuation latency [clocks] to the statistics
+//
+//*****************************************************************************
+static void PlantLatencyAdd(uint32_t ui32Latency)
+{
+    uint32_t ui32Bucket;
+
+    g_sPlantLatency.Count++;
+    g_sPlantLatency.Sum += ui32Latency;
+    if (ui32Latency < g_sPlantLatency.Min)
+        g_sPlantLatency.Min = ui32Latency;
+    if (ui32Latency > g_sPlantLatency.Max)
+        g_sPlantLatency.Max = ui32Latency;
+    ui32Bucket = ui32Latency / PLANT_LATENCY_BUCKET_CLOCKS;
+    if (ui32Bucket >= PLANT_LATENCY_BUCKETS)
+        ui32Bucket = PLANT_LATENCY_BUCKETS - 1;
+    g_sPlantLatency.Histogram[ui32Bucket]++;
+}
+
+
+//*****************************************************************************
+//
+// Phase in the PWM period at which the tick that just ended sampled the
+// encoders [clocks]
+//
+//*****************************************************************************
+static uint32_t PlantSamplePhase(uint32_t ui32Period)
+{
+    uint32_t ui32Sample;
+
+#ifdef CONTROL_TICK_PWM
+    //
+    // Sampled on the load event, half a period after the zero
+    //
+    ui32Sample = ui32Period / 2 + PLANT_ENTRY_CLOCKS;
+#else
+    //
+    // The timer runs on its own, its phase moves by the tick length
+    //
+    ui32Sample = g_ui32PlantSamplePhase % ui32Period;
+    g_ui32PlantSamplePhase = ui32Sample + g_ui32PlantTickClocks;
+#endif
+
+    return ui32Sample;
+}
+
+
+//*****************************************************************************
+//
+// ADC conversion of the current sensors on a load event
+//
+//*****************************************************************************
+static void PlantADCConvert(void)
+{
+    uint16_t pui16Samples[MOTOR_NUM_AXES];
+    int32_t i32Count;
+    uint32_t i;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        i32Count = MOTOR_CURRENT_ZERO_COUNT +
+                   (int32_t)(g_psPlantState[i].Current *
+                             (1000.0f / MOTOR_CURRENT_MA_PER_COUNT));
+        if (i32Count < 0)
+            i32Count = 0;
+        else if (i32Count > 4095)
+            i32Count = 4095;
+        pui16Samples[i] = (uint16_t)i32Count;
+    }
+
+    HostADCConvert(ADC0_BASE, CURRENT_SEQUENCE, pui16Samples, MOTOR_NUM_AXES);
+}
+
+
+//*****************************************************************************
+//
+// Integrate the dynamics of one axis over a fraction of the tick at the
+// applied voltage
+//
+//*****************************************************************************
+static void PlantAxisAdvance(uint32_t ui32Axis, float fFraction)
+{
+    const tPlantParams *psP = &g_psPlantParams[ui32Axis];
+    tPlantState *psS = &g_psPlantState[ui32Axis];
+    float fTorque;
+
+    psS->Current += fFraction * g_pfPlantDtOverL[ui32Axis] *
+                    (psS->Voltage - psP->R * psS->Current -
+                     psP->Kt * psS->Speed);
+
+    fTorque = psP->Kt * psS->Current - psP->B * psS->Speed;
+    if (psS->Speed > 0.0f)
+        fTorque -= psP->Load;
+    else if (psS->Speed < 0.0f)
+        fTorque += psP->Load;
+    psS->Speed += fFraction * g_pfPlantDtOverJ[ui32Axis] * fTorque;
+
+    psS->CountFraction += fFraction * psS->Speed *
+                          g_pfPlantCountsPerStep[ui32Axis];
+}
+
+
+//*****************************************************************************
+//
+// Apply the duty in the PWM registers of every axis.  A disabled output is
+// treated as 0V (braking).
+//
+//*****************************************************************************
+static void PlantVoltagesUpdate(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        g_psPlantState[i].Voltage = g_psPlantParams[i].Supply *
+                                    PlantBridgeDuty(&g_psMotorAxes[i]);
+}
+
+
+//*****************************************************************************
+//
+// Turn the motion of one axis over the tick into encoder counts and the
+// QEI velocity capture
+//
+//*****************************************************************************
+static void PlantEncoderUpdate(uint32_t ui32Axis)
+{
+    tPlantState *psS = &g_psPlantState[ui32Axis];
+    uint32_t ui32QEI = g_psMotorAxes[ui32Axis].QEIBase;
+    uint32_t ui32Ticks, ui32Shift;
+    int32_t i32Counts;
+
+    //
+    // Keep the fractional count so slow motion is not lost
+    //
+    i32Counts = (int32_t)psS->CountFraction;
+    if ((float)i32Counts > psS->CountFraction)
+        i32Counts--;
+    psS->CountFraction -= (float)i32Counts;
+
+    if (i32Counts)
+    {
+        HWREG(ui32QEI + QEI_O_POS) += (uint32_t)i32Counts;
+        psS->Travel += i32Counts;
+        if (i32Counts > 0)
+            HWREG(ui32QEI + QEI_O_STAT) &= ~QEI_STAT_DIRECTION;
+        else
+            HWREG(ui32QEI + QEI_O_STAT) |= QEI_STAT_DIRECTION;
+    }
+
+    //
+    // QEI velocity capture: edges in the period after the pre-divider
+    //
+    psS->VelocityAccum += i32Counts;
+    if (psS->VelocityCountdown)
+        psS->VelocityCountdown--;
+    if (!psS->VelocityCountdown)
+    {
+        ui32Ticks = 1;
+        if (g_ui32PlantTickClocks)
+            ui32Ticks = (HWREG(ui32QEI + QEI_O_LOAD) + 1) /
+                        g_ui32PlantTickClocks;
+        psS->VelocityCountdown = ui32Ticks ? ui32Ticks : 1;
+
+        ui32Shift = (HWREG(ui32QEI + QEI_O_CTL) >> QEI_CTL_VELDIV_S) & 7;
+        HWREG(ui32QEI + QEI_O_SPEED) =
+            (uint32_t)((psS->VelocityAccum < 0) ? -psS->VelocityAccum :
+                                                  psS->VelocityAccum) >>
+            ui32Shift;
+        psS->VelocityAccum = 0;
+    }
+}
+
+
+//*****************************************************************************
+//
+// Advance every axis by one control tick, from the sample of the tick that
+// just ended to the sample of the next one
+//
+//*****************************************************************************
+void PlantStep(void)
+{
+    uint32_t ui32Period, ui32Time, ui32End, ui32Write, ui32Zero, ui32Load;
+    uint32_t ui32Next, i;
+    bool bADC;
+
+    if (g_ui32PlantTickClocks != HostTickClocks())
+        PlantCoefficientsUpdate(HostTickClocks());
+
+    ui32Period = PlantPWMPeriod();
+    if (!ui32Period || !g_ui32PlantTickClocks)
+    {
+        //
+        // Nothing to line up with, the whole tick at the present duty
+        //
+        PlantVoltagesUpdate();
+        for (i = 0; i < MOTOR_NUM_AXES; i++)
+            PlantAxisAdvance(i, 1.0f);
+    }
+    else
+    {
+        //
+        // Events from the sample on, in clocks from the last zero of the
+        // PWM counter.  The duty the controllers wrote in the tick takes
+        // effect at the first zero after ui32Write, the earlier zeros keep
+        // the previous one.  The current loop instead writes on the load
+        // events, before each zero.
+        //
+        bADC = HostADCRunning(ADC0_BASE, CURRENT_SEQUENCE);
+        ui32Time = PlantSamplePhase(ui32Period);
+        ui32End = ui32Time + g_ui32PlantTickClocks;
+        ui32Write = ui32Time + g_ui32PlantComputeClocks;
+        ui32Zero = (ui32Time / ui32Period + 1) * ui32Period;
+        ui32Load = (ui32Time / ui32Period) * ui32Period + ui32Period / 2;
+        if (ui32Load <= ui32Time)
+            ui32Load += ui32Period;
+
+        if (!bADC)
+            PlantLatencyAdd((ui32Write / ui32Period + 1) * ui32Period -
+                            ui32Time);
+
+        while (ui32Time < ui32End)
+        {
+            ui32Next = (ui32Zero < ui32Load) ? ui32Zero : ui32Load;
+            if (ui32Next > ui32End)
+                ui32Next = ui32End;
+
+            for (i = 0; i < MOTOR_NUM_AXES; i++)
+                PlantAxisAdvance(i, (float)(ui32Next - ui32Time) /
+                                    (float)g_ui32PlantTickClocks);
+            ui32Time = ui32Next;
+
+            if (ui32Time == ui32Zero)
+            {
+                if (bADC || (ui32Zero > ui32Write))
+                    PlantVoltagesUpdate();
+                ui32Zero += ui32Period;
+            }
+
+            if (ui32Time == ui32Load)
+            {
+                if (bADC)
+                {
+                    PlantADCConvert();
+                    PlantLatencyAdd(ui32Zero - ui32Load);
+                }
+                ui32Load += ui32Period;
+            }
+        }
+    }
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        PlantEncoderUpdate(i);
+}
+
+
+//*****************************************************************************
+//
+// Set the time from the sample to the duty update and, for the Timer 0
+// tick, the phase of the timer in the PWM period, and clear the latency
+// statistics
+//
+//*****************************************************************************
+void PlantTimingSet(uint32_t ui32ComputeClocks, uint32_t ui32TimerPhase)
+{
+    g_ui32PlantComputeClocks = ui32ComputeClocks;
+    g_ui32PlantSamplePhase = ui32TimerPhase + PLANT_ENTRY_CLOCKS;
+    PlantLatencyReset();
+}
@@ -0,0 +1,109 @@
+//*****************************************************************************
+//
+// plant.h - DC motor and encoder model of the host build.
+//
+// One brushed DC motor with a quadrature encoder per axis of
+// g_psMotorAxes[].  The model reads the duty cycle and direction of each
+// axis from the PWM generator and GPIO registers the firmware writes, and
+// counts in the QEI position and velocity registers it reads, so the
+// firmware runs closed loop on it unchanged.  HostTick() advances it by one
+// control tick.
+//
+// The model also follows the timing of the duty updates: a new compare
+// value takes effect at the next zero of the PWM counter after the
+// controllers write it, a compute time set with PlantTimingSet() after the
+// sample.  Until then the plant keeps the previous duty.  The latency from
+// the sample to that update is collected in g_sPlantLatency.
+//
+// With MOTOR_CURRENT_LOOP the ADC conversions of the current sensors
+// happen on every load event of the PWM counter instead: the model
+// currents go through HostADCConvert() to the uDMA buffers of current.c
+// and its interrupt, and g_sPlantLatency holds the latency from those
+// samples to the duty update.
+//
+//*****************************************************************************
+
+#ifndef __PLANT_H__
+#define __PLANT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor_config.h"
+#include "clock_config.h"
+
+//*****************************************************************************
+//
+// Electrical and mechanical parameters of one axis (SI units)
+//
+//*****************************************************************************
+typedef struct
+{
+    float Supply;               // Bridge supply voltage [V]
+    float R;                    // Winding resistance [Ohm]
+    float L;                    // Winding inductance [H]
+    float Kt;                   // Torque / back-EMF constant [Nm/A]
+    float J;                    // Rotor + load inertia [kg m^2]
+    float B;                    // Viscous friction [Nm s/rad]
+    float Load;                 // Constant load torque [Nm]
+    float CountsPerRad;         // Quadrature counts per shaft radian
+}
+tPlantParams;
+
+//*****************************************************************************
+//
+// State of one axis.  The encoder count itself is the QEI position
+// register.
+//
+//*****************************************************************************
+typedef struct
+{
+    float Current;              // Winding current [A]
+    float Speed;                // Shaft speed [rad/s]
+    float Voltage;              // Applied voltage [V]
+    float CountFraction;        // Sub-count part of the encoder position
+    int64_t Travel;             // Counts moved since reset, not wrapped
+    int32_t VelocityAccum;      // Counts in the current velocity period
+    uint32_t VelocityCountdown; // Ticks to the end of the velocity period
+}
+tPlantState;
+
+//*****************************************************************************
+//
+// Sample to actuation latency statistics, PLANT_LATENCY_BUCKETS buckets
+// of PLANT_LATENCY_BUCKET_CLOCKS (5 us), the last one counting everything
+// above
+//
+//*****************************************************************************
+#define PLANT_LATENCY_BUCKETS       16
+#define PLANT_LATENCY_BUCKET_CLOCKS (5 * CLOCK_PER_US(SYSTEM_CLOCK_HZ))
+
+//
+// Default time from the sample to the duty write [clocks]
+//
+#define PLANT_COMPUTE_CLOCKS        1000
+
+typedef struct
+{
+    uint32_t Count;
+    uint32_t Min;
+    uint32_t Max;
+    uint64_t Sum;
+    uint32_t Histogram[PLANT_LATENCY_BUCKETS];
+}
+tPlantLatency;
+
+extern tPlantParams g_psPlantParams[MOTOR_NUM_AXES];
+extern tPlantState g_psPlantState[MOTOR_NUM_AXES];
+extern tPlantLatency g_sPlantLatency;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void PlantReset(void);
+extern void PlantStep(void);
+extern void PlantTimingSet(uint32_t ui32ComputeClocks,
+                           uint32_t ui32TimerPhase);
+
+#endif // __PLANT_H__
@@ -0,0 +1,173 @@
+//*****************************************************************************
+//
+// sim.c - Runs the firmware on the host against the plant model.
+//
+// The console input is a script, one command per line, sent once the
+// firmware has taken the previous one.  Lines starting with '@' are for
+// the runner:
+//
+//   @run <ticks>               let the control tick run, ticks of 100 us
+//   @timing <clocks> [phase]   sample to duty write time and Timer 0 phase
+//                              in the PWM period [clocks], clears the
+//                              latency statistics (plant.h)
+//   @latency                   print the sample to actuation latency
+//   @quit                      stop, as the end of the script does
+//
+// and lines starting with '#' are comments.  The output is the console
+// output of the firmware.
+//
+// Usage:
+//   motor_sim [-e eeprom.bin] [script]     the script defaults to stdin
+//
+// With -e the EEPROM is loaded from the file if it exists and saved to it
+// at the end, so "commit" survives between runs.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "clock_config.h"
+#include "hal.h"
+#include "plant.h"
+
+//*****************************************************************************
+//
+// Script state
+//
+//*****************************************************************************
+static FILE *g_psScript;
+static const char *g_pcEEPROMFile = 0;
+static uint32_t g_ui32Wait = 0;             // Ticks to run before the next line
+
+
+//*****************************************************************************
+//
+// Print the latency statistics of the plant
+//
+//*****************************************************************************
+static void SimLatencyPrint(void)
+{
+    uint32_t ui32PerUs = CLOCK_PER_US(SYSTEM_CLOCK_HZ);
+    uint32_t i;
+
+    if (!g_sPlantLatency.Count)
+    {
+        printf("No PWM updates\n");
+        return;
+    }
+
+    printf("Sample to actuation [us]: n %u min %u mean %u max %u\n ",
+           g_sPlantLatency.Count, g_sPlantLatency.Min / ui32PerUs,
+           (uint32_t)(g_sPlantLatency.Sum / g_sPlantLatency.Count) / ui32PerUs,
+           g_sPlantLatency.Max / ui32PerUs);
+
+    for (i = 0; i < PLANT_LATENCY_BUCKETS - 1; i++)
+        if (g_sPlantLatency.Histogram[i])
+            printf(" <%u:%u", (i + 1) * PLANT_LATENCY_BUCKET_CLOCKS / ui32PerUs,
+                   g_sPlantLatency.Histogram[i]);
+    if (g_sPlantLatency.Histogram[i])
+        printf(" >=%u:%u", i * PLANT_LATENCY_BUCKET_CLOCKS / ui32PerUs,
+               g_sPlantLatency.Histogram[i]);
+    printf("\n");
+}
+
+
+//*****************************************************************************
+//
+// End of the run
+//
+//*****************************************************************************
+static void SimExit(void)
+{
+    fflush(stdout);
+    if (g_pcEEPROMFile && !HostEEPROMSave(g_pcEEPROMFile))
+    {
+        fprintf(stderr, "Cannot write %s\n", g_pcEEPROMFile);
+        exit(1);
+    }
+    exit(0);
+}
+
+
+//*****************************************************************************
+//
+// Console idle - run the ticks asked for, then take the next line
+//
+//*****************************************************************************
+static void SimIdle(void)
+{
+    char pcLine[256];
+    unsigned int uiClocks, uiPhase;
+    size_t iLen;
+
+    if (g_ui32Wait)
+    {
+        g_ui32Wait--;
+        return;
+    }
+
+    while (fgets(pcLine, sizeof(pcLine) - 1, g_psScript))
+    {
+        iLen = strcspn(pcLine, "\r\n");
+        pcLine[iLen] = 0;
+
+        if ((pcLine[0] == '#') || !iLen)
+            continue;
+
+        if (pcLine[0] != '@')
+        {
+            strcat(pcLine, "\r");
+            HostConsoleInput(pcLine);
+            return;
+        }
+
+        if (sscanf(pcLine, "@run %u", &g_ui32Wait) == 1)
+            return;
+
+        uiPhase = 0;
+        if (sscanf(pcLine, "@timing %u %u", &uiClocks, &uiPhase) >= 1)
+            PlantTimingSet(uiClocks, uiPhase);
+        else if (!strcmp(pcLine, "@latency"))
+            SimLatencyPrint();
+        else if (!strcmp(pcLine, "@quit"))
+            SimExit();
+        else
+        {
+            fprintf(stderr, "Unknown directive: %s\n", pcLine);
+            exit(2);
+        }
+    }
+
+    SimExit();
+}
+
+
+int main(int argc, char *argv[])
+{
+    int i = 1;
+
+    if ((argc > 2) && !strcmp(argv[1], "-e"))
+    {
+        g_pcEEPROMFile = argv[2];
+        HostEEPROMLoad(g_pcEEPROMFile);
+        i = 3;
+    }
+
+    g_psScript = stdin;
+    if (i < argc)
+    {
+        g_psScript = fopen(argv[i], "r");
+        if (!g_psScript)
+        {
+            fprintf(stderr, "Cannot open %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    HostConsoleIdleSet(SimIdle);
+
+    return FirmwareMain();
+}
@@ -0,0 +1,142 @@
+//*****************************************************************************
+//
+// test.c - Host tests of the firmware, see test.h.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "motor_config.h"
+#include "command.h"
+#include "motor.h"
+#include "hal.h"
+#include "test.h"
+
+static void (*g_pfnTest)(void) = 0;
+static uint32_t g_ui32TestFailed = 0;
+
+
+//*****************************************************************************
+//
+// Console idle - the first time the main loop waits, run the test
+//
+//*****************************************************************************
+static void TestIdle(void)
+{
+    void (*pfnTest)(void) = g_pfnTest;
+
+    if (!pfnTest)
+        return;
+
+    g_pfnTest = 0;
+    pfnTest();
+    TestExit();
+}
+
+
+int TestMain(void (*pfnTest)(void))
+{
+    g_pfnTest = pfnTest;
+    HostConsoleQuiet(true);
+    HostConsoleIdleSet(TestIdle);
+
+    return FirmwareMain();
+}
+
+
+//*****************************************************************************
+//
+// Print a result line, PASS or FAIL first.  Returns bPass.
+//
+//*****************************************************************************
+bool TestCheck(bool bPass, const char *pcFormat, ...)
+{
+    va_list vaArgP;
+
+    printf("%s ", bPass ? "PASS" : "FAIL");
+    va_start(vaArgP, pcFormat);
+    vprintf(pcFormat, vaArgP);
+    va_end(vaArgP);
+    printf("\n");
+
+    if (!bPass)
+        g_ui32TestFailed++;
+
+    return bPass;
+}
+
+
+void TestExit(void)
+{
+    printf("%s\n", g_ui32TestFailed ? "FAILED" : "ok");
+    fflush(stdout);
+    exit(g_ui32TestFailed ? 1 : 0);
+}
+
+
+//*****************************************************************************
+//
+// Type a command line on the console and run it as the main loop would.
+// The wait for the next character afterwards lets one tick run.
+//
+//*****************************************************************************
+void TestCommand(const char *pcLine)
+{
+    HostConsoleInput(pcLine);
+    HostConsoleInput("\r");
+    CommandPoll();
+}
+
+
+//*****************************************************************************
+//
+// Run the ticks until the position error of every axis in the bit mask
+// ui32Axes (bit 0 for motor 1) has stayed within TEST_SETTLE_BAND for
+// TEST_SETTLE_HOLD ticks.  Returns the ticks before it settled, -1 if it
+// did not within TEST_SETTLE_TIMEOUT.
+//
+//*****************************************************************************
+int32_t TestSettle(uint32_t ui32Axes)
+{
+    uint32_t ui32Tick, ui32Inside = 0, i;
+    bool bInside;
+
+    for (ui32Tick = 1; ui32Tick <= TEST_SETTLE_TIMEOUT; ui32Tick++)
+    {
+        HostRun(1);
+
+        bInside = true;
+        for (i = 0; i < MOTOR_NUM_AXES; i++)
+        {
+            if ((ui32Axes & (1 << i)) &&
+                (abs(g_sMotor.Error[i]) > TEST_SETTLE_BAND))
+                bInside = false;
+        }
+
+        if (!bInside)
+            ui32Inside = 0;
+        else if (++ui32Inside == TEST_SETTLE_HOLD)
+            return ui32Tick - TEST_SETTLE_HOLD;
+    }
+
+    return -1;
+}
+
+
+//*****************************************************************************
+//
+// Host time [ns], for the benchmarks
+//
+//*****************************************************************************
+double TestNs(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return sNow.tv_sec * 1e9 + sNow.tv_nsec;
+}
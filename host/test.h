@@ -0,0 +1,33 @@
+//*****************************************************************************
+//
+// test.h - Host tests of the firmware.
+//
+// A test is a function that runs once in place of the main loop, after
+// main() has set everything up.  It lets the control ticks run with
+// HostRun(), checks what it expects with TestCheck() and ends with
+// TestExit(), which exits with 0 if every check passed.  TestCommand()
+// types a console command.  TestSettle() runs the ticks until the
+// position errors of the given axes stay within TEST_SETTLE_BAND counts
+// for TEST_SETTLE_HOLD ticks.  The console output of the firmware is kept
+// off stdout (HostConsoleOutput() still has it).
+//
+//*****************************************************************************
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TEST_SETTLE_BAND        10                      // [counts]
+#define TEST_SETTLE_HOLD        100                     // [ticks]
+#define TEST_SETTLE_TIMEOUT     (5 * CONTROL_TICK_HZ)   // [ticks]
+
+extern int TestMain(void (*pfnTest)(void));
+extern bool TestCheck(bool bPass, const char *pcFormat, ...);
+extern void TestExit(void);
+extern void TestCommand(const char *pcLine);
+extern int32_t TestSettle(uint32_t ui32Axes);
+extern double TestNs(void);
+
+#endif // __TEST_H__
@@ -0,0 +1,165 @@
+//*****************************************************************************
+//
+// test_drive.c - MotorDrive() against the driverlib calls it replaced.
+//
+// For every duty cycle from -100 % to 100 % of motor 1 both drive the
+// same output: on or off, and when on the same direction pin and compare
+// value, except that MotorDrive() stops at MOTOR_PWM_DUTY_MAX where
+// driverlib writes 0 for 100 %.  MotorDrive() must leave the generator
+// running.  The register accesses of one update (g_ui32HostRegAccesses)
+// are counted for both, and MotorDrive() must make fewer; the host time
+// per update is printed for comparison only.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_pwm.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pwm.h"
+#include "motor_config.h"
+#include "motor.h"
+#include "hal.h"
+#include "test.h"
+
+#define TEST_DRIVE_RUNS         100000
+#define TEST_DRIVE_DUTIES       201         // -100 % to 100 %
+
+//
+// What the plant sees of one axis
+//
+typedef struct
+{
+    bool On;
+    bool Forward;
+    uint32_t Compare;
+}
+tTestOutput;
+
+
+//*****************************************************************************
+//
+// The update of the driverlib version of the drive, duty in percent
+//
+//*****************************************************************************
+static void TestDriveLib(const tMotorAxis *psAxis, int32_t i32Duty)
+{
+    if (!i32Duty)
+    {
+        PWMOutputState(psAxis->PWMBase, psAxis->PWMOutBit, false);
+        PWMGenDisable(psAxis->PWMBase, psAxis->PWMGen);
+        return;
+    }
+
+    if (i32Duty < 0)
+    {
+        i32Duty = -i32Duty;
+        GPIOPinWrite(psAxis->DirPort, psAxis->DirPin, 0);
+    }
+    else
+    {
+        GPIOPinWrite(psAxis->DirPort, psAxis->DirPin, psAxis->DirPin);
+    }
+    PWMPulseWidthSet(psAxis->PWMBase, psAxis->PWMOut,
+                     PWMGenPeriodGet(psAxis->PWMBase, psAxis->PWMGen) *
+                     (uint32_t)i32Duty / 100);
+    PWMOutputState(psAxis->PWMBase, psAxis->PWMOutBit, true);
+    PWMGenEnable(psAxis->PWMBase, psAxis->PWMGen);
+}
+
+
+static void TestOutputGet(const tMotorAxis *psAxis, tTestOutput *psOut)
+{
+    uint32_t ui32Gen = psAxis->PWMBase + psAxis->PWMGen;
+
+    HostRegSync();
+    psOut->On = (HWREG(ui32Gen + PWM_O_X_CTL) & PWM_X_CTL_ENABLE) &&
+                (HWREG(psAxis->PWMBase + PWM_O_ENABLE) & psAxis->PWMOutBit);
+    psOut->Forward = GPIOPinRead(psAxis->DirPort, psAxis->DirPin) != 0;
+    psOut->Compare = HWREG(ui32Gen + ((psAxis->PWMOut & 1) ? PWM_O_X_CMPB :
+                                                             PWM_O_X_CMPA));
+}
+
+
+static void TestDrive(void)
+{
+    const tMotorAxis *psAxis = &g_psMotorAxes[0];
+    tTestOutput sLib, sFast;
+    uint32_t i, ui32Start, ui32LibAccesses = 0, ui32FastAccesses = 0;
+    uint32_t ui32Mismatch = 0, ui32Stopped = 0, ui32MinCompare;
+    int32_t i32Duty;
+    double dStart, dLibNs, dFastNs;
+
+    MotorClosedLoopSet(false);
+    ui32MinCompare = HWREG(psAxis->PWMBase + psAxis->PWMGen + PWM_O_X_LOAD) -
+                     MOTOR_PWM_DUTY_MAX / 2;
+
+    for (i32Duty = -100; i32Duty <= 100; i32Duty++)
+    {
+        ui32Start = g_ui32HostRegAccesses;
+        TestDriveLib(psAxis, i32Duty);
+        ui32LibAccesses += g_ui32HostRegAccesses - ui32Start;
+        TestOutputGet(psAxis, &sLib);
+        if (sLib.Compare < ui32MinCompare)
+            sLib.Compare = ui32MinCompare;
+
+        //
+        // The generator as MotorDrive() expects it
+        //
+        PWMGenEnable(psAxis->PWMBase, psAxis->PWMGen);
+
+        ui32Start = g_ui32HostRegAccesses;
+        MotorDrive(0, i32Duty * MOTOR_PWM_PER_PERCENT);
+        ui32FastAccesses += g_ui32HostRegAccesses - ui32Start;
+        TestOutputGet(psAxis, &sFast);
+
+        if ((sLib.On != sFast.On) ||
+            (sLib.On && ((sLib.Forward != sFast.Forward) ||
+                         (sLib.Compare != sFast.Compare))))
+        {
+            ui32Mismatch++;
+            printf("  %4d %%: driverlib %d %d %u, MotorDrive %d %d %u\n",
+                   i32Duty, sLib.On, sLib.Forward, sLib.Compare, sFast.On,
+                   sFast.Forward, sFast.Compare);
+        }
+
+        if (!(HWREG(psAxis->PWMBase + psAxis->PWMGen + PWM_O_X_CTL) &
+              PWM_X_CTL_ENABLE))
+            ui32Stopped++;
+    }
+
+    //
+    // Host time, small duty cycles of both signs as in the control loop
+    //
+    dStart = TestNs();
+    for (i = 0; i < TEST_DRIVE_RUNS; i++)
+        TestDriveLib(psAxis, (int32_t)(i % 8) - 4);
+    dLibNs = (TestNs() - dStart) / TEST_DRIVE_RUNS;
+
+    PWMGenEnable(psAxis->PWMBase, psAxis->PWMGen);
+    dStart = TestNs();
+    for (i = 0; i < TEST_DRIVE_RUNS; i++)
+        MotorDrive(0, ((int32_t)(i % 8) - 4) * MOTOR_PWM_PER_PERCENT);
+    dFastNs = (TestNs() - dStart) / TEST_DRIVE_RUNS;
+
+    MotorDriveAll(0);
+
+    printf("Drive update: MotorDrive %.1f accesses %.1f ns | "
+           "driverlib %.1f accesses %.1f ns (host)\n",
+           (double)ui32FastAccesses / TEST_DRIVE_DUTIES, dFastNs,
+           (double)ui32LibAccesses / TEST_DRIVE_DUTIES, dLibNs);
+    TestCheck(!ui32Mismatch, "%u duty cycles with a different output",
+              ui32Mismatch);
+    TestCheck(!ui32Stopped, "%u updates stopped the generator", ui32Stopped);
+    TestCheck(ui32FastAccesses < ui32LibAccesses,
+              "MotorDrive makes fewer register accesses");
+}
+
+
+int main(void)
+{
+    return TestMain(TestDrive);
+}
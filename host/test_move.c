@@ -0,0 +1,154 @@
+//*****************************************************************************
+//
+// test_move.c - Profiled moves: cost of TrajectoryStep() and settling on
+// the plant.
+//
+// The benchmark steps moves of several lengths, both ways, on a trajectory
+// of its own with the limits of the parameters and prints the host time
+// per step.  Every move must end exactly on its target, and the reference
+// must stay within the velocity and acceleration limits.
+//
+// Then motor 1 makes closed loop moves on the plant, out and back, and
+// must settle after each (TestSettle()) once the profile has ended.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "motor_config.h"
+#include "clock_config.h"
+#include "params.h"
+#include "trajectory.h"
+#include "motor.h"
+#include "hal.h"
+#include "test.h"
+
+#define TEST_BENCH_REPEAT       20
+#define TEST_LIMIT_MARGIN       1.001f
+#define TEST_MOVE_TIMEOUT       (5 * CONTROL_TICK_HZ)   // [ticks]
+
+static const int32_t g_pi32BenchMoves[] = { 10, 1000, 20000, 200000 };
+static const int32_t g_pi32PlantMoves[] = { 2000, -2000, 50000, -50000 };
+
+
+//*****************************************************************************
+//
+// Step the benchmark moves to their ends
+//
+//*****************************************************************************
+static void TestBench(void)
+{
+    static tTrajectory sTraj;
+    uint32_t i, j, ui32Steps = 0, ui32OffTarget = 0, ui32OverLimit = 0;
+    int64_t i64Target;
+    float fVelocity, fAccel;
+    double dStart, dNs;
+
+    TrajectoryInit(&sTraj, MOTOR_POSITION_START);
+    TrajectoryLimitsSet(&sTraj, g_sParams.VelocityMax, g_sParams.AccelMax,
+                        g_sParams.JerkMax);
+
+    dNs = 0;
+    for (i = 0; i < TEST_BENCH_REPEAT; i++)
+    {
+        for (j = 0; j < 2 * sizeof(g_pi32BenchMoves) / sizeof(int32_t); j++)
+        {
+            //
+            // Out with the even moves, back with the odd ones
+            //
+            i64Target = sTraj.Position +
+                        ((j & 1) ? -1 : 1) * g_pi32BenchMoves[j / 2];
+            TrajectoryMoveTo(&sTraj, i64Target);
+
+            dStart = TestNs();
+            do
+            {
+                TrajectoryStep(&sTraj);
+                ui32Steps++;
+            }
+            while (TrajectoryBusy(&sTraj));
+            dNs += TestNs() - dStart;
+
+            if ((sTraj.Position != i64Target) || (sTraj.Fraction != 0.0f))
+                ui32OffTarget++;
+        }
+    }
+
+    //
+    // The limits, once more over all moves with a check on every step
+    //
+    for (j = 0; j < sizeof(g_pi32BenchMoves) / sizeof(int32_t); j++)
+    {
+        TrajectoryMoveTo(&sTraj, sTraj.Position + g_pi32BenchMoves[j]);
+        do
+        {
+            TrajectoryStep(&sTraj);
+            fVelocity = (sTraj.Velocity < 0) ? -sTraj.Velocity :
+                                               sTraj.Velocity;
+            fAccel = (sTraj.Accel < 0) ? -sTraj.Accel : sTraj.Accel;
+            if ((fVelocity > sTraj.VelocityMax * TEST_LIMIT_MARGIN) ||
+                (fAccel > sTraj.AccelMax * TEST_LIMIT_MARGIN))
+                ui32OverLimit++;
+        }
+        while (TrajectoryBusy(&sTraj));
+    }
+
+    printf("TrajectoryStep: %u steps, %.1f ns/step (host)\n", ui32Steps,
+           dNs / ui32Steps);
+    TestCheck(!ui32OffTarget, "%u moves off target", ui32OffTarget);
+    TestCheck(!ui32OverLimit, "%u steps over the velocity or acceleration "
+              "limit", ui32OverLimit);
+}
+
+
+//*****************************************************************************
+//
+// One closed loop move of motor 1 on the plant
+//
+//*****************************************************************************
+static void TestPlantMove(int32_t i32Distance)
+{
+    tTrajectory *psTraj = &g_sMotor.Trajectory[0];
+    uint32_t ui32MoveTicks = 0;
+    int32_t i32MaxError = 0, i32Settle;
+
+    if (!TestCheck(TrajectoryMoveTo(psTraj, psTraj->Position + i32Distance),
+                   "move %d planned", i32Distance))
+        return;
+
+    while (TrajectoryBusy(psTraj) && (ui32MoveTicks < TEST_MOVE_TIMEOUT))
+    {
+        HostRun(1);
+        ui32MoveTicks++;
+
+        if (abs(g_sMotor.Error[0]) > i32MaxError)
+            i32MaxError = abs(g_sMotor.Error[0]);
+    }
+
+    i32Settle = TestSettle(1 << 0);
+    TestCheck(!TrajectoryBusy(psTraj) && (i32Settle >= 0),
+              "move %d: %u ticks, max error %d, settled %d ticks after the "
+              "end", i32Distance, ui32MoveTicks, i32MaxError, i32Settle);
+}
+
+
+static void TestMove(void)
+{
+    uint32_t i;
+
+    TestBench();
+
+    MotorClosedLoopSet(true);
+    HostRun(CONTROL_TICK_HZ / 10);
+
+    for (i = 0; i < sizeof(g_pi32PlantMoves) / sizeof(int32_t); i++)
+        TestPlantMove(g_pi32PlantMoves[i]);
+}
+
+
+int main(void)
+{
+    return TestMain(TestMove);
+}
@@ -0,0 +1,159 @@
+//*****************************************************************************
+//
+// test_path.c - Coordinated line and arc moves of motors 1 and 2 on the
+// plant.
+//
+// Through the console commands, from the start position: a line
+// TEST_PATH_SIZE counts along x, a counterclockwise full circle of half
+// that diameter, a clockwise half circle and a line back to the start.
+// Each move must end on its target within TEST_PATH_TIMEOUT ticks, the
+// reference must stay within TEST_PATH_REF_BAND counts of the line or
+// circle and the measured position within TEST_PATH_BAND, and both axes
+// must settle on the end point (TestSettle()).  An arc whose target is not
+// on the circle must be refused.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "motor_config.h"
+#include "clock_config.h"
+#include "interp.h"
+#include "motor.h"
+#include "hal.h"
+#include "test.h"
+
+#define TEST_PATH_SIZE          20000                   // [counts]
+#define TEST_PATH_MOVES         4
+#define TEST_PATH_TIMEOUT       (20 * CONTROL_TICK_HZ)  // [ticks]
+#define TEST_PATH_REF_BAND      1.0f                    // [counts]
+#define TEST_PATH_BAND          10.0f                   // [counts]
+
+
+//*****************************************************************************
+//
+// Distance of the point (i64X, i64Y) from the line or circle of a
+// coordinated move [counts]
+//
+//*****************************************************************************
+static float TestPathError(const tInterpMove *psMove, int64_t i64X,
+                           int64_t i64Y)
+{
+    float fX, fY, fDx, fDy, fLength;
+
+    if (psMove->Kind == INTERP_ARC)
+    {
+        fX = (float)(i64X - psMove->Center[0]);
+        fY = (float)(i64Y - psMove->Center[1]);
+        return fabsf(sqrtf(fX * fX + fY * fY) - psMove->Radius);
+    }
+
+    fX = (float)(i64X - psMove->Start[0]);
+    fY = (float)(i64Y - psMove->Start[1]);
+    fDx = (float)(psMove->Target[0] - psMove->Start[0]);
+    fDy = (float)(psMove->Target[1] - psMove->Start[1]);
+    fLength = sqrtf(fDx * fDx + fDy * fDy);
+
+    return fabsf(fX * fDy - fY * fDx) / fLength;
+}
+
+
+//*****************************************************************************
+//
+// Run one move to its end and through the settling of both axes
+//
+//*****************************************************************************
+static void TestPathMove(const char *pcName, const char *pcCommand,
+                         int64_t i64X, int64_t i64Y)
+{
+    const tInterpMove *psMove = &g_sMotor.Interp.Move;
+    uint32_t ui32Tick, ui32MoveTicks;
+    int32_t i32Settle;
+    float fRefError, fError, fMaxRefError = 0.0f, fMaxError = 0.0f;
+
+    TestCommand(pcCommand);
+    if (!TestCheck(InterpBusy(&g_sMotor.Interp), "%s planned: %s", pcName,
+                   pcCommand))
+        return;
+
+    for (ui32Tick = 1; ui32Tick <= TEST_PATH_TIMEOUT; ui32Tick++)
+    {
+        HostRun(1);
+
+        fRefError = TestPathError(psMove, g_sMotor.Setpoint[0],
+                                  g_sMotor.Setpoint[1]);
+        fError = TestPathError(psMove, g_sMotor.Position[0],
+                               g_sMotor.Position[1]);
+        if (fRefError > fMaxRefError)
+            fMaxRefError = fRefError;
+        if (fError > fMaxError)
+            fMaxError = fError;
+
+        if (!InterpBusy(&g_sMotor.Interp))
+            break;
+    }
+    ui32MoveTicks = ui32Tick;
+
+    i32Settle = TestSettle((1 << 0) | (1 << 1));
+
+    printf("%-14s %6u ticks | off path: ref %.2f, max %.1f counts\n",
+           pcName, ui32MoveTicks, fMaxRefError, fMaxError);
+    TestCheck((ui32MoveTicks <= TEST_PATH_TIMEOUT) &&
+              (g_sMotor.Setpoint[0] == i64X) && (g_sMotor.Setpoint[1] == i64Y),
+              "%s ends on its target", pcName);
+    TestCheck(fMaxRefError <= TEST_PATH_REF_BAND, "%s reference on the path",
+              pcName);
+    TestCheck(fMaxError <= TEST_PATH_BAND, "%s position within %d counts",
+              pcName, (int32_t)TEST_PATH_BAND);
+    TestCheck(i32Settle >= 0, "%s settled after %d ticks", pcName, i32Settle);
+}
+
+
+static void TestPath(void)
+{
+    char pcCommand[64];
+    int64_t i64X, i64Y;
+    int32_t i32Size = TEST_PATH_SIZE, i32Radius = TEST_PATH_SIZE / 2;
+
+    MotorClosedLoopSet(true);
+    HostRun(CONTROL_TICK_HZ / 10);
+
+    i64X = g_sMotor.Trajectory[0].Position;
+    i64Y = g_sMotor.Trajectory[1].Position;
+
+    snprintf(pcCommand, sizeof(pcCommand), "line %d %d",
+             (int32_t)i64X + i32Size, (int32_t)i64Y);
+    TestPathMove("line", pcCommand, i64X + i32Size, i64Y);
+
+    snprintf(pcCommand, sizeof(pcCommand), "ccw %d %d 0 %d",
+             (int32_t)i64X + i32Size, (int32_t)i64Y, i32Radius);
+    TestPathMove("ccw circle", pcCommand, i64X + i32Size, i64Y);
+
+    snprintf(pcCommand, sizeof(pcCommand), "cw %d %d 0 %d",
+             (int32_t)i64X + i32Size, (int32_t)i64Y + i32Size, i32Radius);
+    TestPathMove("cw half circle", pcCommand, i64X + i32Size, i64Y + i32Size);
+
+    snprintf(pcCommand, sizeof(pcCommand), "line %d %d", (int32_t)i64X,
+             (int32_t)i64Y);
+    TestPathMove("line back", pcCommand, i64X, i64Y);
+
+    //
+    // A target off the circle
+    //
+    HostConsoleClear();
+    snprintf(pcCommand, sizeof(pcCommand), "ccw %d %d 0 %d",
+             (int32_t)i64X + i32Radius, (int32_t)i64Y, i32Radius);
+    TestCommand(pcCommand);
+    TestCheck(!InterpBusy(&g_sMotor.Interp) &&
+              strstr(HostConsoleOutput(), "not on the arc"),
+              "arc to a target off the circle refused");
+}
+
+
+int main(void)
+{
+    return TestMain(TestPath);
+}
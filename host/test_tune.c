@@ -0,0 +1,139 @@
+//*****************************************************************************
+//
+// test_tune.c - The "tune" command on the plant.
+//
+// "tune 1" must return while the experiments run and refuse moves of the
+// motors until they end.  With the ticks running and AutotunePoll() called
+// as the main loop does, the report must say done within both timeouts,
+// the tuned gains must be positive and motor 1 must settle after a move
+// with them.  "tune 2" aborted by "tune 0" must report so and leave the
+// gains of motor 2 as they were.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "motor_config.h"
+#include "clock_config.h"
+#include "control_math.h"
+#include "params.h"
+#include "trajectory.h"
+#include "motor.h"
+#include "autotune.h"
+#include "hal.h"
+#include "test.h"
+
+#define TEST_TUNE_TICKS         (2 * AUTOTUNE_TIMEOUT + CONTROL_TICK_HZ)
+
+
+//*****************************************************************************
+//
+// Run the ticks and the autotune poll of the main loop until the report of
+// an experiment is out.  Returns the ticks it took, 0 if it never came.
+//
+//*****************************************************************************
+static uint32_t TestTuneWait(void)
+{
+    uint32_t ui32Tick;
+
+    for (ui32Tick = 1; ui32Tick <= TEST_TUNE_TICKS; ui32Tick++)
+    {
+        HostRun(1);
+        AutotunePoll();
+        if (strstr(HostConsoleOutput(), "Autotune motor"))
+            return ui32Tick;
+    }
+
+    return 0;
+}
+
+
+//*****************************************************************************
+//
+// A move of motor 1 with the tuned gains, settled (TestSettle()) after the
+// end of the profile
+//
+//*****************************************************************************
+static bool TestTuneSettle(int32_t i32Distance)
+{
+    tTrajectory *psTraj = &g_sMotor.Trajectory[0];
+    uint32_t ui32Tick;
+
+    if (!TrajectoryMoveTo(psTraj, psTraj->Position + i32Distance))
+        return false;
+
+    for (ui32Tick = 0; TrajectoryBusy(psTraj); ui32Tick++)
+    {
+        if (ui32Tick == TEST_SETTLE_TIMEOUT)
+            return false;
+        HostRun(1);
+    }
+
+    return TestSettle(1 << 0) >= 0;
+}
+
+
+static void TestTune(void)
+{
+    control_gain_t pkSaved[3];
+    uint32_t ui32Ticks;
+
+    MotorClosedLoopSet(true);
+    HostRun(CONTROL_TICK_HZ / 10);
+
+    //
+    // Tune motor 1, the command returns with the experiment running
+    //
+    HostConsoleClear();
+    TestCommand("tune 1");
+    TestCheck(g_ui32AutotuneAxis == 0, "tune 1 returns while it runs");
+
+    TestCommand("move 1 1000");
+    TestCheck(strstr(HostConsoleOutput(), "Motor 1 is moving") &&
+              !TrajectoryBusy(&g_sMotor.Trajectory[0]),
+              "moves are refused while it runs");
+
+    HostConsoleClear();
+    ui32Ticks = TestTuneWait();
+    TestCheck(ui32Ticks && strstr(HostConsoleOutput(),
+                                  "Autotune motor 1: done"),
+              "tune 1 done after %u ticks", ui32Ticks);
+    TestCheck(g_ui32AutotuneState == AUTOTUNE_IDLE, "reported once");
+    TestCheck((g_sParams.Kp[0] > 0) && (g_sParams.Kv[0] > 0) &&
+              (g_sParams.Ki[0] > 0), "kp %d | kv %d | ki %d [1e-6]",
+              ControlGainToMicro(g_sParams.Kp[0]),
+              ControlGainToMicro(g_sParams.Kv[0]),
+              ControlGainToMicroRate(g_sParams.Ki[0], CONTROL_TICK_HZ));
+    TestCheck(TestTuneSettle(2000), "motor 1 settles with the tuned gains");
+
+    //
+    // Tune motor 2 and abort
+    //
+    pkSaved[0] = g_sParams.Kp[1];
+    pkSaved[1] = g_sParams.Kv[1];
+    pkSaved[2] = g_sParams.Ki[1];
+
+    TestCommand("tune 2");
+    HostRun(CONTROL_TICK_HZ / 10);
+    HostConsoleClear();
+    TestCommand("tune 0");
+    ui32Ticks = TestTuneWait();
+    TestCheck(ui32Ticks && strstr(HostConsoleOutput(),
+                                  "Autotune motor 2: aborted"),
+              "tune 0 aborted tune 2 after %u ticks", ui32Ticks);
+    TestCheck((g_sParams.Kp[1] == pkSaved[0]) &&
+              (g_sParams.Kv[1] == pkSaved[1]) &&
+              (g_sParams.Ki[1] == pkSaved[2]), "gains of motor 2 restored");
+
+    HostConsoleClear();
+    TestCommand("tune 0");
+    TestCheck(strstr(HostConsoleOutput(), "Autotune is not running") != 0,
+              "tune 0 with nothing to abort");
+}
+
+
+int main(void)
+{
+    return TestMain(TestTune);
+}
@@ -0,0 +1,90 @@
+//*****************************************************************************
+//
+// test_wrap.c - Position unwrapping across the 32-bit wrap of the QEI.
+//
+// The encoder of each axis is loaded with 0, on the wrap, and the motor is
+// driven open loop at full duty one way for TEST_WRAP_TICKS and back for
+// twice as long, so the count crosses the wrap whichever way the encoder
+// counts.  After every tick the unwrapped position must have moved exactly
+// as far as the plant (tPlantState.Travel).
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "inc/hw_qei.h"
+#include "motor_config.h"
+#include "clock_config.h"
+#include "motor.h"
+#include "hal.h"
+#include "plant.h"
+#include "test.h"
+
+#define TEST_WRAP_TICKS         (2 * CONTROL_TICK_HZ)   // [ticks]
+
+
+static void TestWrapAxis(uint32_t ui32Axis)
+{
+    const tPlantState *psPlant = &g_psPlantState[ui32Axis];
+    uint32_t ui32QEI = g_psMotorAxes[ui32Axis].QEIBase;
+    uint32_t ui32Tick, ui32Count, ui32Raw, ui32Wraps, ui32Mismatch;
+    int64_t i64Position, i64Travel;
+    int32_t i32Step, i32MaxStep;
+
+    MotorEncoderSet(ui32Axis, 0);
+    i64Position = g_sMotor.Position[ui32Axis];
+    i64Travel = psPlant->Travel;
+    ui32Count = 0;
+
+    ui32Wraps = 0;
+    i32MaxStep = 0;
+    ui32Mismatch = 0;
+    for (ui32Tick = 0; ui32Tick < 3 * TEST_WRAP_TICKS; ui32Tick++)
+    {
+        MotorDrive(ui32Axis, (ui32Tick < TEST_WRAP_TICKS) ?
+                             MOTOR_PWM_DUTY_MAX : -MOTOR_PWM_DUTY_MAX);
+        HostRun(1);
+
+        //
+        // The raw count wrapped if it moved against the direction of travel
+        //
+        ui32Raw = HWREG(ui32QEI + QEI_O_POS);
+        i32Step = (int32_t)(ui32Raw - ui32Count);
+        if ((i32Step > 0) ? (ui32Raw < ui32Count) : (ui32Raw > ui32Count))
+            ui32Wraps++;
+        ui32Count = ui32Raw;
+
+        if (i32Step < 0)
+            i32Step = -i32Step;
+        if (i32Step > i32MaxStep)
+            i32MaxStep = i32Step;
+
+        if ((g_sMotor.Position[ui32Axis] - i64Position) !=
+            (psPlant->Travel - i64Travel))
+            ui32Mismatch++;
+    }
+
+    MotorDrive(ui32Axis, 0);
+
+    TestCheck(ui32Wraps && !ui32Mismatch,
+              "motor %u: %u wraps, up to %d counts/tick, %u ticks mismatched",
+              ui32Axis + 1, ui32Wraps, i32MaxStep, ui32Mismatch);
+}
+
+
+static void TestWrap(void)
+{
+    uint32_t i;
+
+    MotorClosedLoopSet(false);
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        TestWrapAxis(i);
+}
+
+
+int main(void)
+{
+    return TestMain(TestWrap);
+}
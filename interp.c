@@ -0,0 +1,355 @@
+//*****************************************************************************
+//
+// interp.c - Coordinated linear and circular motion of two axes.
+//
+// A move is handed to the control interrupt the same way as a trajectory:
+// the foreground plans it into Next and sets NextValid, and the interrupt
+// adopts it while idle.  The path profile is only stepped by the interrupt
+// while a move is active, so the foreground may reset it in between.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "motor_config.h"
+#include "trajectory.h"
+#include "interp.h"
+
+#define INTERP_PI               3.14159265f
+
+
+//*****************************************************************************
+//
+// Put the coordinated axes at rest with no move.  Not to be called while
+// the control interrupt steps them.
+//
+//*****************************************************************************
+void InterpInit(tInterp *psInterp)
+{
+    uint32_t i;
+
+    for (i = 0; i < INTERP_NUM_AXES; i++)
+    {
+        psInterp->Position[i] = 0;
+        psInterp->Fraction[i] = 0.0f;
+        psInterp->Velocity[i] = 0.0f;
+        psInterp->Accel[i] = 0.0f;
+    }
+
+    psInterp->Active = false;
+    psInterp->NextValid = false;
+
+    TrajectoryInit(&psInterp->Path, 0);
+    InterpLimitsSet(psInterp, TRAJECTORY_VELOCITY_MAX, TRAJECTORY_ACCEL_MAX,
+                    TRAJECTORY_JERK_MAX);
+}
+
+
+//*****************************************************************************
+//
+// Set the limits of the path profile used by the next moves, in counts/s,
+// counts/s^2 and counts/s^3 along the path
+//
+//*****************************************************************************
+void InterpLimitsSet(tInterp *psInterp, float fVelocity, float fAccel,
+                     float fJerk)
+{
+    psInterp->VelocityMax = fVelocity;
+    psInterp->AccelMax = fAccel;
+    psInterp->JerkMax = fJerk;
+}
+
+
+//*****************************************************************************
+//
+// True while a move is running or waiting to start
+//
+//*****************************************************************************
+bool InterpBusy(const tInterp *psInterp)
+{
+    return psInterp->Active || psInterp->NextValid;
+}
+
+
+//*****************************************************************************
+//
+// Plan the path profile over i64Length counts at up to fSpeed counts/s,
+// and hand the move in Next to the control interrupt
+//
+//*****************************************************************************
+static bool InterpStart(tInterp *psInterp, int64_t i64Length, float fSpeed)
+{
+    tTrajectory *psPath = &psInterp->Path;
+
+    if ((fSpeed <= 0.0f) || (fSpeed > psInterp->VelocityMax))
+        fSpeed = psInterp->VelocityMax;
+
+    psPath->Position = 0;
+    psPath->Fraction = 0.0f;
+    TrajectoryLimitsSet(psPath, fSpeed, psInterp->AccelMax,
+                        psInterp->JerkMax);
+    if (!TrajectoryMoveTo(psPath, i64Length))
+        return false;
+
+    psInterp->NextValid = true;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Plan a straight move from pi64Start to pi64Target at up to fFeed
+// counts/s along the line (0 for the velocity limit).  Returns false if a
+// move is still running.  Called from the foreground.
+//
+//*****************************************************************************
+bool InterpLineTo(tInterp *psInterp, const int64_t *pi64Start,
+                  const int64_t *pi64Target, float fFeed)
+{
+    tInterpMove *psMove = &psInterp->Next;
+    float pfDelta[INTERP_NUM_AXES], fLength;
+    int64_t i64Length;
+    uint32_t i;
+
+    if (InterpBusy(psInterp))
+        return false;
+
+    fLength = 0.0f;
+    for (i = 0; i < INTERP_NUM_AXES; i++)
+    {
+        pfDelta[i] = (float)(pi64Target[i] - pi64Start[i]);
+        fLength += pfDelta[i] * pfDelta[i];
+    }
+    if (fLength == 0.0f)
+        return true;
+
+    //
+    // The path is a whole number of counts long, and the direction
+    // cosines are scaled to it so that the axes end on the target
+    //
+    i64Length = (int64_t)(sqrtf(fLength) + 0.5f);
+
+    psMove->Kind = INTERP_LINE;
+    for (i = 0; i < INTERP_NUM_AXES; i++)
+    {
+        psMove->Start[i] = pi64Start[i];
+        psMove->Target[i] = pi64Target[i];
+        psMove->Direction[i] = pfDelta[i] / (float)i64Length;
+    }
+
+    return InterpStart(psInterp, i64Length, fFeed);
+}
+
+
+//*****************************************************************************
+//
+// Plan an arc from pi64Start to pi64Target around pi64Center, clockwise or
+// counterclockwise, at up to fFeed counts/s along the arc.  A target equal
+// to the start gives a full circle.  Returns false if a move is still
+// running or the target is not on the circle.  Called from the foreground.
+//
+//*****************************************************************************
+bool InterpArcTo(tInterp *psInterp, const int64_t *pi64Start,
+                 const int64_t *pi64Target, const int64_t *pi64Center,
+                 bool bClockwise, float fFeed)
+{
+    tInterpMove *psMove = &psInterp->Next;
+    float fStartX, fStartY, fEndX, fEndY, fStartRadius, fEndRadius;
+    float fSweep, fLength, fSpeed;
+    int64_t i64Length;
+    uint32_t i;
+
+    if (InterpBusy(psInterp))
+        return false;
+
+    fStartX = (float)(pi64Start[0] - pi64Center[0]);
+    fStartY = (float)(pi64Start[1] - pi64Center[1]);
+    fEndX = (float)(pi64Target[0] - pi64Center[0]);
+    fEndY = (float)(pi64Target[1] - pi64Center[1]);
+    fStartRadius = sqrtf(fStartX * fStartX + fStartY * fStartY);
+    fEndRadius = sqrtf(fEndX * fEndX + fEndY * fEndY);
+
+    if ((fStartRadius < 1.0f) ||
+        (fabsf(fEndRadius - fStartRadius) > INTERP_ARC_TOLERANCE))
+        return false;
+
+    //
+    // Angle swept in the direction of travel, in (0, 2 pi]
+    //
+    fSweep = atan2f(fEndY, fEndX) - atan2f(fStartY, fStartX);
+    if (bClockwise)
+        fSweep = -fSweep;
+    if (fSweep <= 0.0f)
+        fSweep += 2.0f * INTERP_PI;
+
+    fLength = 0.5f * (fStartRadius + fEndRadius) * fSweep;
+    i64Length = (int64_t)(fLength + 0.5f);
+    if (i64Length == 0)
+        i64Length = 1;
+
+    psMove->Kind = INTERP_ARC;
+    for (i = 0; i < INTERP_NUM_AXES; i++)
+    {
+        psMove->Start[i] = pi64Start[i];
+        psMove->Target[i] = pi64Target[i];
+        psMove->Center[i] = pi64Center[i];
+    }
+    psMove->Cos = fStartX / fStartRadius;
+    psMove->Sin = fStartY / fStartRadius;
+    psMove->Radius = fStartRadius;
+    psMove->RadiusRate = (fEndRadius - fStartRadius) / (float)i64Length;
+    psMove->AngleRate = (bClockwise ? -fSweep : fSweep) / (float)i64Length;
+
+    //
+    // Keep the centripetal acceleration v^2 / r within half the limit
+    //
+    fSpeed = sqrtf(0.5f * psInterp->AccelMax *
+                   ((fEndRadius < fStartRadius) ? fEndRadius : fStartRadius));
+    if ((fFeed <= 0.0f) || (fFeed > fSpeed))
+        fFeed = fSpeed;
+
+    return InterpStart(psInterp, i64Length, fFeed);
+}
+
+
+//*****************************************************************************
+//
+// Round to the nearest whole count
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(InterpRound, ".ramfunc")
+#endif
+static int32_t InterpRound(float fValue)
+{
+    return (int32_t)((fValue < 0.0f) ? (fValue - 0.5f) : (fValue + 0.5f));
+}
+
+
+//*****************************************************************************
+//
+// Advance the coordinated axes by one tick.  Returns true while a move is
+// running, including its last tick, when Position, Velocity and Accel are
+// the reference of the axes.  Called from the control interrupt.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(InterpStep, ".ramfunc")
+#endif
+bool InterpStep(tInterp *psInterp)
+{
+    tInterpMove *psMove = &psInterp->Move;
+    tTrajectory *psPath = &psInterp->Path;
+    float fStep, fVelocity, fAccel, fAngle, fAngle2, fCos, fSin, fNorm;
+    float fOmega, fAlpha, fX, fY;
+    int32_t i32Whole;
+    uint32_t i;
+
+    //
+    // Idle - start the next move if one has been planned
+    //
+    if (!psInterp->Active)
+    {
+        if (!psInterp->NextValid)
+            return false;
+
+        *psMove = psInterp->Next;
+        psInterp->NextValid = false;
+        psInterp->Active = true;
+
+        for (i = 0; i < INTERP_NUM_AXES; i++)
+        {
+            psInterp->Position[i] = psMove->Start[i];
+            psInterp->Fraction[i] = 0.0f;
+        }
+        psInterp->Cos = psMove->Cos;
+        psInterp->Sin = psMove->Sin;
+        psInterp->Radius = psMove->Radius;
+        psInterp->PathPosition = 0;
+        psInterp->PathFraction = 0.0f;
+    }
+
+    //
+    // Distance covered along the path in this tick
+    //
+    TrajectoryStep(psPath);
+    fStep = (float)(int32_t)(psPath->Position - psInterp->PathPosition) +
+            (psPath->Fraction - psInterp->PathFraction);
+    psInterp->PathPosition = psPath->Position;
+    psInterp->PathFraction = psPath->Fraction;
+    fVelocity = psPath->Velocity;
+    fAccel = psPath->Accel;
+
+    //
+    // Done - land exactly on the target
+    //
+    if (!TrajectoryBusy(psPath))
+    {
+        for (i = 0; i < INTERP_NUM_AXES; i++)
+        {
+            psInterp->Position[i] = psMove->Target[i];
+            psInterp->Fraction[i] = 0.0f;
+            psInterp->Velocity[i] = 0.0f;
+            psInterp->Accel[i] = 0.0f;
+        }
+        psInterp->Active = false;
+
+        return true;
+    }
+
+    if (psMove->Kind == INTERP_LINE)
+    {
+        for (i = 0; i < INTERP_NUM_AXES; i++)
+        {
+            psInterp->Fraction[i] += fStep * psMove->Direction[i];
+            i32Whole = (int32_t)psInterp->Fraction[i];
+            psInterp->Position[i] += i32Whole;
+            psInterp->Fraction[i] -= (float)i32Whole;
+
+            psInterp->Velocity[i] = fVelocity * psMove->Direction[i];
+            psInterp->Accel[i] = fAccel * psMove->Direction[i];
+        }
+
+        return true;
+    }
+
+    //
+    // Arc - rotate the unit vector by the angle of this step and pull it
+    // back onto the unit circle
+    //
+    fAngle = fStep * psMove->AngleRate;
+    fAngle2 = fAngle * fAngle;
+    fCos = 1.0f - fAngle2 * (0.5f - fAngle2 * (1.0f / 24.0f));
+    fSin = fAngle * (1.0f - fAngle2 * (1.0f / 6.0f));
+
+    fX = psInterp->Cos * fCos - psInterp->Sin * fSin;
+    fY = psInterp->Sin * fCos + psInterp->Cos * fSin;
+    fNorm = 1.5f - 0.5f * (fX * fX + fY * fY);
+    fX *= fNorm;
+    fY *= fNorm;
+    psInterp->Cos = fX;
+    psInterp->Sin = fY;
+
+    psInterp->Radius += fStep * psMove->RadiusRate;
+    fX *= psInterp->Radius;
+    fY *= psInterp->Radius;
+
+    psInterp->Position[0] = psMove->Center[0] + InterpRound(fX);
+    psInterp->Position[1] = psMove->Center[1] + InterpRound(fY);
+
+    //
+    // Angular velocity and acceleration about the center.  The velocity is
+    // along the tangent, the acceleration adds r * omega^2 towards the
+    // center.
+    //
+    fOmega = fVelocity * psMove->AngleRate;
+    fAlpha = fAccel * psMove->AngleRate;
+    psInterp->Velocity[0] = -fY * fOmega;
+    psInterp->Velocity[1] = fX * fOmega;
+    psInterp->Accel[0] = -fY * fAlpha - fX * fOmega * fOmega;
+    psInterp->Accel[1] = fX * fAlpha - fY * fOmega * fOmega;
+
+    return true;
+}
@@ -0,0 +1,138 @@
+//*****************************************************************************
+//
+// interp.h - Coordinated linear and circular motion of two axes.
+//
+// A coordinated move takes the first two axes from their current reference
+// positions to a target point together, along a straight line or a
+// circular arc.  The speed along the path follows a single jerk limited
+// profile, planned by trajectory.c on the path length in counts, so both
+// axes start, accelerate, cruise and arrive on the same ticks.
+//
+// Planning (square roots, divisions, atan2) is done in the foreground by
+// InterpLineTo() and InterpArcTo().  InterpStep() runs once per tick in
+// the control interrupt.  It advances the path profile by ds and maps the
+// step onto the axes with multiplications only:
+//
+// line: the direction cosines (ux, uy) are fixed, so each axis advances by
+//       ds * u, carried into whole counts like the trajectory position.
+//
+// arc:  the unit vector (c, s) from the center is rotated by
+//       d = ds * (angle per count), with the Taylor series of cos d and
+//       sin d to fourth order, and renormalized with one Newton step,
+//       (c, s) *= (3 - c^2 - s^2) / 2.  The axis positions are the center
+//       plus r * (c, s).  The radius moves linearly from the start to the
+//       end radius, so an end point that is slightly off the circle is
+//       still met without a step.
+//
+// The reference velocity of the axes is the path velocity along the
+// tangent and the reference acceleration adds the centripetal term
+// v^2 / r towards the center, so the feedforward of the controllers sees
+// the curvature.  The path speed of an arc is limited so that the
+// centripetal acceleration stays within half the acceleration limit.
+//
+// At the end of the move the axes are put exactly on the target.
+//
+//*****************************************************************************
+
+#ifndef __INTERP_H__
+#define __INTERP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "trajectory.h"
+
+//*****************************************************************************
+//
+// Number of coordinated axes, the first ones of the motor table
+//
+//*****************************************************************************
+#define INTERP_NUM_AXES         2
+
+//*****************************************************************************
+//
+// Kinds of move, and the direction of arcs
+//
+//*****************************************************************************
+#define INTERP_LINE             0
+#define INTERP_ARC              1
+
+#define INTERP_CCW              false
+#define INTERP_CW               true
+
+//*****************************************************************************
+//
+// Largest difference of the start and end radius of an arc [counts].  A
+// larger one means that the end point is not on the circle.
+//
+//*****************************************************************************
+#define INTERP_ARC_TOLERANCE    10.0f
+
+//*****************************************************************************
+//
+// Geometry of one planned move
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t Kind;                          // INTERP_LINE or INTERP_ARC
+    int64_t Start[INTERP_NUM_AXES];         // [counts]
+    int64_t Target[INTERP_NUM_AXES];        // [counts]
+    int64_t Center[INTERP_NUM_AXES];        // Arc center [counts]
+    float Direction[INTERP_NUM_AXES];       // Line, axis counts per path count
+    float Cos;                              // Arc, unit vector from the
+    float Sin;                              // center to the start point
+    float Radius;                           // Arc start radius [counts]
+    float RadiusRate;                       // Radius change per path count
+    float AngleRate;                        // Angle per path count [rad],
+                                            // negative clockwise
+}
+tInterpMove;
+
+//*****************************************************************************
+//
+// State of the coordinated axes.  Position, Velocity and Accel are the
+// reference for the controllers while Active.
+//
+//*****************************************************************************
+typedef struct
+{
+    int64_t Position[INTERP_NUM_AXES];      // [counts]
+    float Fraction[INTERP_NUM_AXES];        // Line, sub-count part
+    float Velocity[INTERP_NUM_AXES];        // [counts/tick]
+    float Accel[INTERP_NUM_AXES];           // [counts/tick^2]
+
+    bool Active;                            // A move is running
+    tInterpMove Move;                       // Move being executed
+    float Cos;                              // Arc, current unit vector and
+    float Sin;                              // radius
+    float Radius;
+    int64_t PathPosition;                   // Path profile at the last tick
+    float PathFraction;
+
+    tTrajectory Path;                       // Speed profile along the path
+    float VelocityMax;                      // Path limits [counts/s^n]
+    float AccelMax;
+    float JerkMax;
+
+    tInterpMove Next;                       // Move handed over by the
+    volatile bool NextValid;                // foreground
+}
+tInterp;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void InterpInit(tInterp *psInterp);
+extern void InterpLimitsSet(tInterp *psInterp, float fVelocity, float fAccel,
+                            float fJerk);
+extern bool InterpBusy(const tInterp *psInterp);
+extern bool InterpLineTo(tInterp *psInterp, const int64_t *pi64Start,
+                         const int64_t *pi64Target, float fFeed);
+extern bool InterpArcTo(tInterp *psInterp, const int64_t *pi64Start,
+                        const int64_t *pi64Target, const int64_t *pi64Center,
+                        bool bClockwise, float fFeed);
+extern bool InterpStep(tInterp *psInterp);
+
+#endif // __INTERP_H__
@@ -0,0 +1,237 @@
+//*****************************************************************************
+//
+// isr_timing.c - DWT cycle counter instrumentation of the control interrupt.
+//
+// Every stage keeps min / max / mean, the jitter (max - min) and a log2
+// histogram of its duration in CPU cycles.  A handler whose total time
+// exceeds the budget given to IsrTimingInit() (normally the tick period) is
+// counted as an overrun.  The report says whether the handler ran from
+// flash or, with CONTROL_RAMFUNC, from SRAM, so that the reports of the two
+// builds can be compared.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+#include "isr_timing.h"
+
+#ifdef ISR_TIMING
+
+//*****************************************************************************
+//
+// Count leading zeros, a single CLZ instruction on the Cortex-M4
+//
+//*****************************************************************************
+#if defined(__TI_ARM__)
+#define TIMING_CLZ(x)           _norm(x)
+#else
+#define TIMING_CLZ(x)           __builtin_clz(x)
+#endif
+
+//*****************************************************************************
+//
+// Where the handler runs from, to tell the reports of the two builds apart
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#define ISR_TIMING_CODE         "SRAM"
+#else
+#define ISR_TIMING_CODE         "flash"
+#endif
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+tIsrTimingStat g_psIsrTiming[ISR_NUM_STAGES];
+volatile uint32_t g_ui32IsrOverruns = 0;    // Handlers over budget
+
+static uint32_t g_ui32IsrBudget = 0;        // Allowed cycles per handler
+static uint32_t g_ui32IsrEntry;             // CYCCNT at entry
+static uint32_t g_ui32IsrLast;              // CYCCNT at the last mark
+
+static const char * const g_ppcIsrStageNames[ISR_NUM_STAGES] =
+{
+    "tasks", "output", "total", "latency"
+};
+
+
+//*****************************************************************************
+//
+// Add one sample to a statistic
+//
+//*****************************************************************************
+void IsrTimingAdd(tIsrTimingStat *psStat, uint32_t ui32Cycles)
+{
+    uint32_t ui32Bucket;
+
+    psStat->Count++;
+    psStat->Sum += ui32Cycles;
+    if (ui32Cycles < psStat->Min)
+        psStat->Min = ui32Cycles;
+    if (ui32Cycles > psStat->Max)
+        psStat->Max = ui32Cycles;
+
+    ui32Bucket = ui32Cycles ? (32 - TIMING_CLZ(ui32Cycles)) : 0;
+    if (ui32Bucket >= ISR_TIMING_BUCKETS)
+        ui32Bucket = ISR_TIMING_BUCKETS - 1;
+    psStat->Histogram[ui32Bucket]++;
+}
+
+
+//*****************************************************************************
+//
+// Clear one statistic
+//
+//*****************************************************************************
+void IsrTimingClear(tIsrTimingStat *psStat)
+{
+    uint32_t i;
+
+    psStat->Count = 0;
+    psStat->Min = 0xFFFFFFFF;
+    psStat->Max = 0;
+    psStat->Sum = 0;
+    for (i = 0; i < ISR_TIMING_BUCKETS; i++)
+        psStat->Histogram[i] = 0;
+}
+
+
+//*****************************************************************************
+//
+// Print one statistic, a copy taken with the interrupts masked
+//
+//*****************************************************************************
+void IsrTimingPrint(const char *pcName, const tIsrTimingStat *psStat)
+{
+    uint32_t i;
+
+    if (!psStat->Count)
+    {
+        UARTprintf("%8s: no samples\n", pcName);
+        return;
+    }
+
+    UARTprintf("%8s: n %u min %u mean %u max %u jitter %u\n          ",
+               pcName, psStat->Count, psStat->Min,
+               (uint32_t)(psStat->Sum / psStat->Count), psStat->Max,
+               psStat->Max - psStat->Min);
+
+    for (i = 0; i < ISR_TIMING_BUCKETS - 1; i++)
+        if (psStat->Histogram[i])
+            UARTprintf(" <%u:%u", 1 << i, psStat->Histogram[i]);
+    if (psStat->Histogram[i])
+        UARTprintf(" >=%u:%u", 1 << (i - 1), psStat->Histogram[i]);
+    UARTprintf("\n");
+}
+
+
+//*****************************************************************************
+//
+// Clear all statistics
+//
+//*****************************************************************************
+void IsrTimingReset(void)
+{
+    uint32_t i;
+    bool bMasked;
+
+    bMasked = IntMasterDisable();
+
+    for (i = 0; i < ISR_NUM_STAGES; i++)
+        IsrTimingClear(&g_psIsrTiming[i]);
+    g_ui32IsrOverruns = 0;
+
+    if (!bMasked)
+        IntMasterEnable();
+}
+
+
+//*****************************************************************************
+//
+// Start the DWT cycle counter.  ui32Budget is the number of cycles the
+// handler may take before it is counted as an overrun.
+//
+//*****************************************************************************
+void IsrTimingInit(uint32_t ui32Budget)
+{
+    HWREG(CORE_DEMCR) |= CORE_DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+
+    g_ui32IsrBudget = ui32Budget;
+    IsrTimingReset();
+}
+
+
+//*****************************************************************************
+//
+// Hooks called from the interrupt handler
+//
+//*****************************************************************************
+void IsrTimingEntry(uint32_t ui32Latency)
+{
+    g_ui32IsrEntry = ISR_TIMING_CYCLES();
+    g_ui32IsrLast = g_ui32IsrEntry;
+    IsrTimingAdd(&g_psIsrTiming[ISR_STAGE_LATENCY], ui32Latency);
+}
+
+void IsrTimingMark(uint32_t ui32Stage)
+{
+    uint32_t ui32Now = ISR_TIMING_CYCLES();
+
+    IsrTimingAdd(&g_psIsrTiming[ui32Stage], ui32Now - g_ui32IsrLast);
+    g_ui32IsrLast = ui32Now;
+}
+
+void IsrTimingExit(void)
+{
+    uint32_t ui32Total;
+
+    IsrTimingMark(ISR_STAGE_OUTPUT);
+
+    ui32Total = g_ui32IsrLast - g_ui32IsrEntry;
+    IsrTimingAdd(&g_psIsrTiming[ISR_STAGE_TOTAL], ui32Total);
+    if (ui32Total > g_ui32IsrBudget)
+        g_ui32IsrOverruns++;
+}
+
+
+//*****************************************************************************
+//
+// Print the statistics on the console and start a new measurement window
+//
+//*****************************************************************************
+void IsrTimingReport(void)
+{
+    tIsrTimingStat sStat;
+    uint32_t i;
+    uint32_t ui32Overruns;
+    bool bMasked;
+
+    ui32Overruns = g_ui32IsrOverruns;
+    UARTprintf("\nISR timing [cycles], code in %s, budget %u, overruns %u%s\n",
+               ISR_TIMING_CODE, g_ui32IsrBudget, ui32Overruns,
+               ui32Overruns ? " <-- OVERRUN" : "");
+
+    for (i = 0; i < ISR_NUM_STAGES; i++)
+    {
+        //
+        // Take a consistent copy, the handler keeps updating the original
+        //
+        bMasked = IntMasterDisable();
+        sStat = g_psIsrTiming[i];
+        if (!bMasked)
+            IntMasterEnable();
+
+        IsrTimingPrint(g_ppcIsrStageNames[i], &sStat);
+    }
+
+    IsrTimingReset();
+}
+
+#endif // ISR_TIMING
@@ -0,0 +1,105 @@
+//*****************************************************************************
+//
+// isr_timing.h - DWT cycle counter instrumentation of the control interrupt.
+//
+// Enabled by defining ISR_TIMING in motor_config.h.  When it is not defined
+// the ISR_TIMING_* macros expand to nothing, so the instrumentation costs
+// nothing in normal builds.
+//
+// Usage inside the interrupt handler:
+//
+//   ISR_TIMING_ENTRY(latency);          // first statement
+//   ...
+//   ISR_TIMING_MARK(ISR_STAGE_xxx);     // end of each stage
+//   ...
+//   ISR_TIMING_EXIT();                  // last statement
+//
+// "latency" is the number of cycles between the trigger event and the
+// first statement of the handler (e.g. read back from the timer).  The
+// scheduler (scheduler.c) times each of its tasks with IsrTimingAdd().
+//
+//*****************************************************************************
+
+#ifndef __ISR_TIMING_H__
+#define __ISR_TIMING_H__
+
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "motor_config.h"
+
+//*****************************************************************************
+//
+// Cortex-M4 DWT registers
+//
+//*****************************************************************************
+#define DWT_CTRL                0xE0001000  // DWT control
+#define DWT_CYCCNT              0xE0001004  // Cycle counter
+#define DWT_CTRL_CYCCNTENA      0x00000001  // Enable cycle counter
+#define CORE_DEMCR              0xE000EDFC  // Debug exception/monitor control
+#define CORE_DEMCR_TRCENA       0x01000000  // Enable DWT and ITM
+
+#define ISR_TIMING_CYCLES()     HWREG(DWT_CYCCNT)
+
+//*****************************************************************************
+//
+// Measured quantities.  The stage entries hold the cycles spent from the
+// previous mark to the mark named after them.
+//
+//*****************************************************************************
+#define ISR_STAGE_TASKS         0   // Entry -> end of the hard tasks
+#define ISR_STAGE_OUTPUT        1   // Last mark -> exit
+#define ISR_STAGE_TOTAL         2   // Entry -> exit
+#define ISR_STAGE_LATENCY       3   // Trigger -> entry
+#define ISR_NUM_STAGES          4
+
+//
+// Histogram bucket n counts samples in [2^(n-1), 2^n) cycles, bucket 0
+// counts zeros and the last bucket everything above
+//
+#define ISR_TIMING_BUCKETS      16
+
+//*****************************************************************************
+//
+// Statistics of one measured quantity
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t Count;
+    uint32_t Min;
+    uint32_t Max;
+    uint64_t Sum;
+    uint32_t Histogram[ISR_TIMING_BUCKETS];
+}
+tIsrTimingStat;
+
+#ifdef ISR_TIMING
+
+extern tIsrTimingStat g_psIsrTiming[ISR_NUM_STAGES];
+extern volatile uint32_t g_ui32IsrOverruns;
+
+extern void IsrTimingInit(uint32_t ui32Budget);
+extern void IsrTimingReset(void);
+extern void IsrTimingEntry(uint32_t ui32Latency);
+extern void IsrTimingMark(uint32_t ui32Stage);
+extern void IsrTimingExit(void);
+extern void IsrTimingReport(void);
+extern void IsrTimingAdd(tIsrTimingStat *psStat, uint32_t ui32Cycles);
+extern void IsrTimingClear(tIsrTimingStat *psStat);
+extern void IsrTimingPrint(const char *pcName, const tIsrTimingStat *psStat);
+
+#define ISR_TIMING_INIT(b)      IsrTimingInit(b)
+#define ISR_TIMING_ENTRY(l)     IsrTimingEntry(l)
+#define ISR_TIMING_MARK(s)      IsrTimingMark(s)
+#define ISR_TIMING_EXIT()       IsrTimingExit()
+
+#else
+
+#define ISR_TIMING_INIT(b)
+#define ISR_TIMING_ENTRY(l)
+#define ISR_TIMING_MARK(s)
+#define ISR_TIMING_EXIT()
+
+#endif
+
+#endif // __ISR_TIMING_H__
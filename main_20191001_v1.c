@@ -19,10 +19,14 @@
 // PC5 -> PhA1 Encoder 2
 // PC6 -> PhB1 Encoder 2
 //
+// PE3 -> AIN0 Current sensor 1 (MOTOR_CURRENT_LOOP)
+// PE2 -> AIN1 Current sensor 2 (MOTOR_CURRENT_LOOP)
+//
+// The pins of each motor are listed in g_psMotorAxes[] (motor.c)
+//
 //*****************************************************************************
 
 
-#include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <math.h>
@@ -31,6 +35,8 @@
 #include "inc/hw_types.h"
 #include "inc/hw_gpio.h"
 #include "inc/hw_qei.h" // ?????????????????????????????????????
+#include "inc/hw_timer.h"
+#include "inc/hw_pwm.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/fpu.h"
 #include "driverlib/gpio.h"
@@ -41,7 +47,22 @@
 #include "driverlib/timer.h"
 #include "driverlib/uart.h"
 #include "driverlib/interrupt.h"
+#include "driverlib/udma.h"
 #include "utils/uartstdio.h"
+#include "clock_config.h"
+#include "control_math.h"
+#include "isr_timing.h"
+#include "telemetry.h"
+#include "command.h"
+#include "trajectory.h"
+#include "interp.h"
+#include "motor.h"
+#include "scheduler.h"
+#include "current.h"
+#include "autotune.h"
+#include "params.h"
+#include "scope.h"
+#include "stream.h"
 
 
 //*****************************************************************************
@@ -49,29 +70,103 @@
 // Global Variables
 //
 //*****************************************************************************
-int Step1 = 0;		              	// Input from user
-uint32_t Setpoint1 = 2000000000;	// Setpoint for motor command
+int32_t planning_counter = 0;
 
-volatile int32_t Direction1;    	// Motor 1 Direction
-volatile int32_t Velocity1;     	// Motor 1 Velocity [counts/period]
-volatile uint32_t Position1;    	// Motor 1 Position [counts] 
-int32_t error1 = 0;             	// Control error [Counts]
-double Kp1 = 0.0020;            	// Kp gain for position control
-double u1 = 0;                  	// Output command(%)
+int PWM_output = 0;                 // Decimal value after conversion
 
-volatile int32_t Direction2;        // Motor 2 Direction
-volatile int32_t Velocity2;         // Motor 2 Velocity [counts/period]
-volatile uint32_t Position2;        // Motor 2 Position [counts]
-int32_t error2 = 0;                 // Control error [Counts]
-double Kp2 = 0.0020;                // Kp gain for position control
-double u2 = 0;                      // Output command(%)
+//
+// The status line and the trace channels report the first two axes
+//
+#if MOTOR_NUM_AXES < 2
+#error "The status line and the trace channels need at least two axes"
+#endif
 
-#define UpLimit 40              	// Maximum PWM output value
+//
+// The PWM tick comes from the generator of the first axis, at the system
+// clock set in main() (clock_config.h)
+//
+#if defined(CONTROL_TICK_PWM) && \
+    (MOTOR_PWM_HZ != (CONTROL_TICK_HZ * CONTROL_PWM_DIVIDER))
+#error "CONTROL_TICK_HZ must be the PWM frequency / CONTROL_PWM_DIVIDER"
+#endif
 
-int32_t planning_counter = 0;
 
-int PWM_output = 0;                 // Decimal value after conversion
+//*****************************************************************************
+//
+// uDMA control table, it must be aligned to 1024 bytes
+//
+//*****************************************************************************
+#if defined(ccs)
+#pragma DATA_ALIGN(g_pui8DMAControlTable, 1024)
+uint8_t g_pui8DMAControlTable[1024];
+#else
+uint8_t g_pui8DMAControlTable[1024] __attribute__ ((aligned(1024)));
+#endif
+
 
+//*****************************************************************************
+//
+// Stack high-water mark.  main() fills the stack below its own frame with
+// STACK_FILL before anything else runs, and "stats" reports how deep the
+// stack has reached by the lowest word that no longer holds the pattern.
+// __stack and __STACK_END bound the .stack section (--stack_size in the
+// .cproject); if main() does not run on it nothing is filled.
+//
+//*****************************************************************************
+#define STACK_FILL              0xA5A5A5A5
+#define STACK_MARGIN            16      // Words left below the fill loop
+
+extern uint32_t __stack;
+extern uint32_t __STACK_END;
+
+static bool g_bStackFilled = false;
+
+static void StackFill(void)
+{
+    uint32_t ui32Here, *pui32Word;
+
+    if ((&ui32Here <= &__stack) || (&ui32Here >= &__STACK_END))
+        return;
+
+    for (pui32Word = &__stack; pui32Word + STACK_MARGIN < &ui32Here;
+         pui32Word++)
+        *pui32Word = STACK_FILL;
+
+    g_bStackFilled = true;
+}
+
+//
+// Bytes of the stack used so far, 0 if it was not filled
+//
+static uint32_t StackUsed(void)
+{
+    const uint32_t *pui32Word;
+
+    if (!g_bStackFilled)
+        return 0;
+
+    for (pui32Word = &__stack;
+         (pui32Word < &__STACK_END) && (*pui32Word == STACK_FILL);
+         pui32Word++)
+    {
+    }
+
+    return (&__STACK_END - pui32Word) * sizeof(uint32_t);
+}
+
+
+//*****************************************************************************
+//
+// Enable the uDMA controller, used by the console transmit path and the
+// current samples
+//
+//*****************************************************************************
+void ConfigureDMA(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    uDMAEnable();
+    uDMAControlBaseSet(g_pui8DMAControlTable);
+}
 
 
 //*****************************************************************************
@@ -101,7 +196,12 @@ void ConfigureUART(void)
     //
     // Initialize the UART for console I/O
     //
-    UARTStdioConfig(0, 115200, SysCtlClockGet());
+    UARTStdioConfig(0, CONSOLE_BAUD, SYSTEM_CLOCK_HZ);
+
+    //
+    // Let the control interrupt preempt the console interrupt
+    //
+    IntPrioritySet(INT_UART0, 0x40);
 }
 
 
@@ -126,9 +226,9 @@ void ConfigureTimer0(void)
     TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
 
     //
-    // Period
+    // Period, one control tick
     //
-    ui32Period = (SysCtlClockGet() / 10000);
+    ui32Period = CLOCK_TICK_PERIOD(SYSTEM_CLOCK_HZ);
 
     //
     // Load the calculated period into the Timers Interval Load register
@@ -145,6 +245,9 @@ void ConfigureTimer0(void)
     //
     // In this case we are enabling an interrupt to be generated on a timeout of Timer 0A
     //
+    // The current loop (priority 0) preempts the control tick
+    //
+    IntPrioritySet(INT_TIMER0A, 0x20);
     IntEnable(INT_TIMER0A);
     TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
     IntMasterEnable();
@@ -157,6 +260,23 @@ void ConfigureTimer0(void)
 }
 
 
+//*****************************************************************************
+//
+// PWM tick configuration - interrupt on the load event of the generator of
+// the first axis (PWM0 generator 1, g_psMotorAxes[0]).  The generators are
+// already running.  Like the timer tick it runs below the current loop.
+//
+//*****************************************************************************
+void ConfigurePWMTick(void)
+{
+    PWMGenIntTrigEnable(PWM0_BASE, PWM_GEN_1, PWM_INT_CNT_LOAD);
+    PWMIntEnable(PWM0_BASE, PWM_INT_GEN_1);
+    IntPrioritySet(INT_PWM0_1, 0x20);
+    IntEnable(INT_PWM0_1);
+    IntMasterEnable();
+}
+
+
 //*****************************************************************************
 //
 // SW1 configuration
@@ -172,518 +292,880 @@ void ConfigureSW1(void)
 
 //*****************************************************************************
 //
-// Configure PWM Pin for motor 1
+// Task "plan" - advance the trajectories
 //
 //*****************************************************************************
-void ConfigureMotor1PWM(void)
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(TaskPlan, ".ramfunc")
+#endif
+static void TaskPlan(void)
 {
-    //
-    // Configure PWM Clock to match system's clock
-    //
-    SysCtlPWMClockSet(SYSCTL_PWMDIV_1);
-    SysCtlDelay(10);	
-	
-    //
-    // Enable the PWM0 peripheral
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_PWM0);
+    planning_counter++;
+    MotorPlan();
+}
 
-    //
-    // Enable the GPIO port B for the output PWM signal
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-    SysCtlDelay(10);
-	
-    //
-    // Pin PB5 as PWM (M0PWM3)
-    //
-    GPIOPinConfigure(GPIO_PB5_M0PWM3);
 
-    //
-    // Pin PB5 as output PWM - M0PWM3
-    //
-    GPIOPinTypePWM(GPIO_PORTB_BASE, GPIO_PIN_5);
-	
-	//
-    // Configure the PWM generator
-    //
-    //PWMGenConfigure(PWM0_BASE, PWM_GEN_1,PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
-    PWMGenConfigure(PWM0_BASE, PWM_GEN_1, PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
-    SysCtlDelay(10);
-	
-	//
-    // Set the PWM period
-    // Desired PWM frequency: 20KHz -> Period: 1/20.000s = 50us
-	// N = (1 / f) * SysClk.  Where N [cycles] is the function parameter, 
-	// f is the desired frequency, and SysClk is the system clock frequency.
-    // In this case: (1 / 20KHz) * 50MHz = 2500 cycles.
-    //
-    PWMGenPeriodSet(PWM0_BASE, PWM_GEN_1, 2500);
-    SysCtlDelay(10);
+//*****************************************************************************
+//
+// Task "trace" - record a binary trace sample when a trace is running (the
+// trace has its own decimation)
+//
+//*****************************************************************************
+static void TaskTrace(void)
+{
+    tTraceSample *psTrace;
+
+    psTrace = TraceAlloc();
+    if (psTrace)
+    {
+        psTrace->Tick = planning_counter;
+        psTrace->Value[0] = (int32_t)g_sMotor.Position[0];
+        psTrace->Value[1] = (int32_t)g_sMotor.Position[1];
+        psTrace->Value[2] = g_sMotor.Velocity[0];
+        psTrace->Value[3] = g_sMotor.Velocity[1];
+        psTrace->Value[4] = g_sMotor.Error[0];
+        psTrace->Value[5] = g_sMotor.Error[1];
+        psTrace->Value[6] = CONTROL_TO_Q16(g_sMotor.U[0]);
+        psTrace->Value[7] = CONTROL_TO_Q16(g_sMotor.U[1]);
+        TraceCommit();
+    }
 }
 
 
 //*****************************************************************************
 //
-// Configure PWM Pin for motor 2
+// Task "scope" - record a scope sample when a capture is running.  SW1
+// (PF4, low when pressed) is the switch trigger.
 //
 //*****************************************************************************
-void ConfigureMotor2PWM(void)
+static void TaskScope(void)
+{
+    tScopeSample *psScope;
+
+    psScope = ScopeAlloc();
+    if (psScope)
+    {
+        psScope->Tick = planning_counter;
+        psScope->Value[0] = (int32_t)g_sMotor.Position[0];
+        psScope->Value[1] = (int32_t)g_sMotor.Position[1];
+        psScope->Value[2] = g_sMotor.Velocity[0];
+        psScope->Value[3] = g_sMotor.Velocity[1];
+        psScope->Value[4] = g_sMotor.Error[0];
+        psScope->Value[5] = g_sMotor.Error[1];
+        psScope->Value[6] = CONTROL_TO_Q16(g_sMotor.U[0]);
+        psScope->Value[7] = CONTROL_TO_Q16(g_sMotor.U[1]);
+        psScope->Value[8] = (int32_t)g_sMotor.Setpoint[0];
+        psScope->Value[9] = (int32_t)g_sMotor.Setpoint[1];
+        ScopeCommit(GPIOPinRead(GPIO_PORTF_BASE, GPIO_PIN_4) == 0);
+    }
+}
+
+
+//*****************************************************************************
+//
+// Task "status" - queue a sample for the terminal.  Formatting and printing
+// is done later in PendSV, so only a few stores happen here.
+//
+//*****************************************************************************
+static void TaskStatus(void)
+{
+    tTelemetrySample *psSample;
+
+    psSample = TelemetryAlloc();
+    if (psSample)
+    {
+        psSample->Tick = planning_counter;
+        psSample->Position1 = (int32_t)g_sMotor.Position[0];
+        psSample->Position2 = (int32_t)g_sMotor.Position[1];
+        psSample->Error1 = g_sMotor.Error[0];
+        psSample->Error2 = g_sMotor.Error[1];
+        psSample->U1 = CONTROL_TO_INT(g_sMotor.U[0]);
+        psSample->U2 = CONTROL_TO_INT(g_sMotor.U[1]);
+        psSample->PWM = PWM_output;
+        TelemetryCommit();
+    }
+}
+
+
+//*****************************************************************************
+//
+// Periodic tasks, shortest period first (see scheduler.h).  Planning runs
+// before control so the controllers see this tick's setpoints.
+//
+//*****************************************************************************
+const tSchedTask g_psSchedTasks[] =
+{
+    { "plan",    TaskPlan,     1,                    SCHED_HARD },
+    { "control", MotorControl, 1,                    SCHED_HARD },
+    { "trace",   TaskTrace,    1,                    SCHED_HARD },
+    { "scope",   TaskScope,    1,                    SCHED_HARD },
+    { "scopeout", ScopeService, CONTROL_TICK_HZ / 100, SCHED_SOFT },
+    { "status",  TaskStatus,   CONTROL_TICK_HZ / 5,  SCHED_HARD },
+    { 0, 0, 0, 0 }
+};
+
+
+//*****************************************************************************
+//
+// Timer 0 handler
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(Timer0IntHandler, ".ramfunc")
+#endif
+void Timer0IntHandler(void)
 {
     //
-    // Configure PWM Clock to match system's clock
+    // Timestamp entry - latency is the time since the timer reloaded
     //
-    SysCtlPWMClockSet(SYSCTL_PWMDIV_1);
-    SysCtlDelay(10);
+    ISR_TIMING_ENTRY(HWREG(TIMER0_BASE + TIMER_O_TAILR) - HWREG(TIMER0_BASE + TIMER_O_TAV));
 
     //
-    // Enable the PWM1 peripheral
+    // Clear the timer interrupt
     //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_PWM1);
+    TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
 
-	//
-    // Enable the GPIO port E for the output PWM signal
     //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
-    SysCtlDelay(10);
+    // Run the hard tasks that are due and release the soft ones
+    //
+    SchedTick();
+    ISR_TIMING_MARK(ISR_STAGE_TASKS);
+
+    ISR_TIMING_EXIT();
+}
+
+
+//*****************************************************************************
+//
+// PWM0 generator 1 handler - the control tick with CONTROL_TICK_PWM
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(PWM0Gen1IntHandler, ".ramfunc")
+#endif
+void PWM0Gen1IntHandler(void)
+{
+    static uint32_t ui32Countdown = 1;
 
     //
-    // Pin PE4 as PWM (M1PWM2)
+    // Clear the interrupt, the tick runs on every CONTROL_PWM_DIVIDER-th
+    // load event
     //
-    GPIOPinConfigure(GPIO_PE4_M1PWM2);
+    PWMGenIntClear(PWM0_BASE, PWM_GEN_1, PWM_INT_CNT_LOAD);
+    if (--ui32Countdown)
+        return;
+    ui32Countdown = CONTROL_PWM_DIVIDER;
 
     //
-    // Pin PE4 as output PWM - M1PWM2
+    // Timestamp entry - latency is the time since the load event, the
+    // counter counts down from it
     //
-    GPIOPinTypePWM(GPIO_PORTE_BASE, GPIO_PIN_4);
+    ISR_TIMING_ENTRY(HWREG(PWM0_BASE + PWM_GEN_1 + PWM_O_X_LOAD) - HWREG(PWM0_BASE + PWM_GEN_1 + PWM_O_X_COUNT));
 
     //
-    // Configure the PWM generator for count down mode with immediate updates to the parameters
+    // Run the hard tasks that are due and release the soft ones
     //
-    //PWMGenConfigure(PWM1_BASE, PWM_GEN_1,PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
-    PWMGenConfigure(PWM1_BASE, PWM_GEN_1, PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
-    SysCtlDelay(10);
+    SchedTick();
+    ISR_TIMING_MARK(ISR_STAGE_TASKS);
 
-	//
-    // Set the PWM period
-    // Desired PWM frequency: 20KHz -> Period: 1/20.000s = 50us
-	// N = (1 / f) * SysClk.  Where N [cycles] is the function parameter,
-	// f is the desired frequency, and SysClk is the system clock frequency.
-    // In this case: (1 / 20KHz) * 50MHz = 2500 cycles.
-    //
-    PWMGenPeriodSet(PWM1_BASE, PWM_GEN_1, 2500);
-    SysCtlDelay(10);
+    ISR_TIMING_EXIT();
 }
 
 
 //*****************************************************************************
 //
-// Configure Direction Pin for Motor 1
+// ADC0 sequencer 1 handler - the current loop, every PWM period
 //
 //*****************************************************************************
-void ConfigureMotor1DirectionPin(void)
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(ADC0SS1IntHandler, ".ramfunc")
+#endif
+void ADC0SS1IntHandler(void)
 {
-    //
-    // Enable the GPIOF port F for the output direction signal
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    CurrentService();
+}
 
-    //
-    // Pin PF2 Direction for Motor
-    //
-    GPIOPinTypeGPIOOutput(GPIO_PORTF_BASE, GPIO_PIN_2);
+
+//*****************************************************************************
+//
+// PendSV handler - lowest priority, runs the soft tasks and the deferred
+// terminal output
+//
+//*****************************************************************************
+void PendSVIntHandler(void)
+{
+    SchedService();
+    TelemetryService();
+    TraceService();
 }
 
 
 //*****************************************************************************
 //
-// Configure Direction Pin for Motor 2
+// Console command "pwm <duty>" (or just "<duty>") - open loop drive of all
+// motors, -85..85 %
 //
 //*****************************************************************************
-void ConfigureMotor2DirectionPin(void)
+int CmdPWM(uint32_t ui32Argc, const int32_t *pi32Argv)
 {
+    if (ui32Argc != 1)
+        return COMMAND_INVALID_ARG;
+
     //
-    // Enable the GPIOF port F for the output direction signals
+    // Filter Input
     //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    if ((pi32Argv[0] > 85) || (pi32Argv[0] < -85))
+    {
+        //
+        // INVALID INPUT - Do not update motor command
+        //
+        UARTprintf("Desired PWM: %d\n", pi32Argv[0]);
+        UARTprintf("INVALID INPUT\n\n");
+        return COMMAND_OK;
+    }
 
     //
-    // Pin PF3 Direction for Motor
+    // Update motor command
     //
-    GPIOPinTypeGPIOOutput(GPIO_PORTF_BASE, GPIO_PIN_3);
+    g_bMotorClosedLoop = false;
+    PWM_output = pi32Argv[0];
+    MotorDriveAll(PWM_output * MOTOR_PWM_PER_PERCENT);
+
+    return COMMAND_OK;
 }
 
 
 //*****************************************************************************
 //
-// Configure QEI Pins for Motor 1
+// Trajectory of motor 1..MOTOR_NUM_AXES, 0 for any other number
 //
 //*****************************************************************************
-void ConfigureMotor1QEI(void)
+tTrajectory *MotorTrajectory(int32_t i32Motor)
 {
-    //
-    // Enable Peripheral port D for the encoder
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
-	
-    //
-    // Enable QEI0 Peripheral
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_QEI0);
-	
-	//
-    // Unlock GPIOD7 - Like PF0 its used for NMI - Without this step it doesn't work
-    // In Tiva include this is the same as "_DD" in older versions (0x4C4F434B)
-    //
-    HWREG(GPIO_PORTD_BASE + GPIO_O_LOCK) = GPIO_LOCK_KEY;
-    HWREG(GPIO_PORTD_BASE + GPIO_O_CR) |= 0x80;
-    HWREG(GPIO_PORTD_BASE + GPIO_O_LOCK) = 0;
-	
-	//
-    // Pin PD6 as PhA0
-	// Pin PD7 as PhB0
-    //
-    GPIOPinConfigure(GPIO_PD6_PHA0);
-    GPIOPinConfigure(GPIO_PD7_PHB0);
-    GPIOPinTypeQEI(GPIO_PORTD_BASE, GPIO_PIN_6 | GPIO_PIN_7);
-	
-	//
-    // Disable QEI0
-    //
-    QEIDisable(QEI0_BASE);
-	
-    //
-    // Disable QEI0 velocity capture
-    //
-    QEIVelocityDisable(QEI0_BASE);
-	
-    //
-    // Disable QEI0 interrupt sources
-    //
-    QEIIntDisable(QEI0_BASE, (QEI_INTERROR | QEI_INTDIR | QEI_INTTIMER | QEI_INTINDEX));
-	
-	//
-    // Configure QEI0
-    //
-    // capture on both A and B
-    // do not reset when there is an index pulse
-    // do not swap signals PHA0 and PHB0
-    // set the maximum position as 4294967200, since max value for uint32_t is 4294967295
-    //
-    QEIConfigure(QEI0_BASE,(QEI_CONFIG_CAPTURE_A_B | QEI_CONFIG_NO_RESET | QEI_CONFIG_QUADRATURE | QEI_CONFIG_NO_SWAP), 4294967200);
-    SysCtlDelay(10);
-	
-    //
-    // Configure the velocity capture for QEI0
-    // 40000 is the period at which the velocity will be measured
-    //
-    QEIVelocityConfigure(QEI0_BASE, QEI_VELDIV_16, 40000);
-    SysCtlDelay(10);
-	
-	//
-    // Enable QEI0
-    //
-    QEIEnable(QEI0_BASE);
-    SysCtlDelay(10);
+    if ((i32Motor < 1) || (i32Motor > MOTOR_NUM_AXES))
+        return 0;
 
-    //
-    // Set the current position for QEI0 somewhere in the
-    // middle of the uint32_t range [0, 4294967295]
-    //
-    QEIPositionSet(QEI0_BASE, 2000000000);
-    SysCtlDelay(10);
-	
-	//
-    // Enable velocity capture for QEI0
-    //
-    QEIVelocityEnable(QEI0_BASE);
+    return &g_sMotor.Trajectory[i32Motor - 1];
 }
 
 
 //*****************************************************************************
 //
-// Configure QEI Pins for Motor 2
+// Console commands "sp <motor> <counts>" and "move <motor> <counts>" -
+// profiled move to an absolute position or by a distance
 //
 //*****************************************************************************
-void ConfigureMotor2QEI(void)
+int CmdSetpoint(uint32_t ui32Argc, const int32_t *pi32Argv)
 {
-    //
-    // Enable Peripheral port C for the encoder
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOC);
-	
-    //
-    // Enable QEI1 peripheral
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_QEI1);
-	
-    //
-    // Pin PC5 as PhA1
-	// Pin PC6 as PhB1
-    //
-    GPIOPinConfigure(GPIO_PC5_PHA1);
-    GPIOPinConfigure(GPIO_PC6_PHB1);
-    GPIOPinTypeQEI(GPIO_PORTC_BASE, GPIO_PIN_5 | GPIO_PIN_6);
-	
-    //
-    // Disable QEI1
-    //
-    QEIDisable(QEI1_BASE);
-	
-    //
-    // Disable QEI1 velocity
-    //
-    QEIVelocityDisable(QEI1_BASE);
-	
-    //
-    // Disable QEI1 interrupt sources
-    //
-    QEIIntDisable(QEI1_BASE, (QEI_INTERROR | QEI_INTDIR | QEI_INTTIMER | QEI_INTINDEX));
-	
-    //
-    // Configure QEI1
-    //
-    // capture on both A and B
-    // do not reset when there is an index pulse
-    // do not swap signals PHA0 and PHB0
-    // set the maximum position as 4294967200, since max value for uint32_t is 4294967295
-    //
-    QEIConfigure(QEI1_BASE, (QEI_CONFIG_CAPTURE_A_B | QEI_CONFIG_NO_RESET | QEI_CONFIG_QUADRATURE | QEI_CONFIG_NO_SWAP), 4294967200);
-    SysCtlDelay(10);
-	
-    //
-    // Configure the velocity capture for QEI1
-    // 40000 is the period at which the velocity will be measured
-    //
-    QEIVelocityConfigure(QEI1_BASE, QEI_VELDIV_16, 40000);
-    SysCtlDelay(10);
-	
-    //
-    // Enable QEI1
-    //
-    QEIEnable(QEI1_BASE);
-    SysCtlDelay(10);
-	
-    //
-    // Set the current position for QEI1 somewhere in the
-    // middle of the uint32_t range [0, 4294967295]
-    //
-    QEIPositionSet(QEI1_BASE, 2000000000);
-    SysCtlDelay(10);
-	
-    //
-    // Enable velocity capture for QEI1
-    //
-    QEIVelocityEnable(QEI1_BASE);
+    tTrajectory *psTraj;
+
+    if (ui32Argc != 2)
+        return COMMAND_INVALID_ARG;
+
+    psTraj = MotorTrajectory(pi32Argv[0]);
+    if (!psTraj)
+        return COMMAND_INVALID_ARG;
+
+    if (InterpBusy(&g_sMotor.Interp) ||
+        (g_ui32AutotuneAxis != AUTOTUNE_NO_AXIS) ||
+        !TrajectoryMoveTo(psTraj, pi32Argv[1]))
+        UARTprintf("Motor %d is moving\n", pi32Argv[0]);
+
+    return COMMAND_OK;
+}
+
+int CmdMove(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    tTrajectory *psTraj;
+
+    if (ui32Argc != 2)
+        return COMMAND_INVALID_ARG;
+
+    psTraj = MotorTrajectory(pi32Argv[0]);
+    if (!psTraj)
+        return COMMAND_INVALID_ARG;
+
+    if (InterpBusy(&g_sMotor.Interp) ||
+        (g_ui32AutotuneAxis != AUTOTUNE_NO_AXIS) ||
+        !TrajectoryMoveTo(psTraj, psTraj->Position + pi32Argv[1]))
+        UARTprintf("Motor %d is moving\n", pi32Argv[0]);
+
+    return COMMAND_OK;
 }
 
 
 //*****************************************************************************
 //
-// Drive Motor 1
+// Path speed of the coordinated moves [counts/s], 0 for the velocity limit
 //
 //*****************************************************************************
-void DriveMotor1(int8_t u)
+static float g_fFeed = 0.0f;
+
+//*****************************************************************************
+//
+// Console commands "feed <v>", "line <x> <y>", "cw <x> <y> <i> <j>" and
+// "ccw <x> <y> <i> <j>" - coordinated moves of motors 1 and 2 to (x, y),
+// along a line or an arc around the point (i, j) away from the start.
+//
+//*****************************************************************************
+int CmdFeed(uint32_t ui32Argc, const int32_t *pi32Argv)
 {
-    //
-    // If duty cycle is 0 , disable the PWM generator and output
-    //
-    if(!u)
+    if ((ui32Argc != 1) || (pi32Argv[0] < 0))
+        return COMMAND_INVALID_ARG;
+
+    g_fFeed = pi32Argv[0];
+
+    return COMMAND_OK;
+}
+
+int CmdLine(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    int64_t pi64Target[INTERP_NUM_AXES];
+
+    if (ui32Argc != 2)
+        return COMMAND_INVALID_ARG;
+
+    pi64Target[0] = pi32Argv[0];
+    pi64Target[1] = pi32Argv[1];
+    if ((g_ui32AutotuneAxis != AUTOTUNE_NO_AXIS) ||
+        !MotorLineTo(pi64Target, g_fFeed))
+        UARTprintf("Motors are moving\n");
+
+    return COMMAND_OK;
+}
+
+static int CmdArc(uint32_t ui32Argc, const int32_t *pi32Argv, bool bClockwise)
+{
+    int64_t pi64Target[INTERP_NUM_AXES], pi64Center[INTERP_NUM_AXES];
+
+    if (ui32Argc != 4)
+        return COMMAND_INVALID_ARG;
+
+    pi64Target[0] = pi32Argv[0];
+    pi64Target[1] = pi32Argv[1];
+    pi64Center[0] = g_sMotor.Trajectory[0].Position + pi32Argv[2];
+    pi64Center[1] = g_sMotor.Trajectory[1].Position + pi32Argv[3];
+    if ((g_ui32AutotuneAxis != AUTOTUNE_NO_AXIS) ||
+        !MotorArcTo(pi64Target, pi64Center, bClockwise, g_fFeed))
+        UARTprintf("Motors are moving, or the target is not on the arc\n");
+
+    return COMMAND_OK;
+}
+
+int CmdArcCW(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    return CmdArc(ui32Argc, pi32Argv, INTERP_CW);
+}
+
+int CmdArcCCW(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    return CmdArc(ui32Argc, pi32Argv, INTERP_CCW);
+}
+
+
+//*****************************************************************************
+//
+// Console command "stream <n>" - switch the console to the binary setpoint
+// stream (stream.h), one point every n ticks.  tools/stream_send.cpp sends
+// the command itself.
+//
+//*****************************************************************************
+int CmdStream(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    uint32_t i;
+
+    if ((ui32Argc != 1) || (pi32Argv[0] < 1) || (pi32Argv[0] > 0xFF))
+        return COMMAND_INVALID_ARG;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
     {
-        PWMOutputState(PWM0_BASE, PWM_OUT_3_BIT, false);
-        PWMGenDisable(PWM0_BASE, PWM_GEN_1); // CHECK GENERATOR!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+        if (TrajectoryBusy(&g_sMotor.Trajectory[i]))
+            break;
     }
-    //
-    // else set direction and PWM output accordingly
-    //
-    else
+    if ((i < MOTOR_NUM_AXES) || InterpBusy(&g_sMotor.Interp) ||
+        (g_ui32AutotuneAxis != AUTOTUNE_NO_AXIS))
     {
-        //
-        // Set direction
-        //
-        if (u < 0)
-        {
-            u = -u;
-            GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, 0);
-        }
-        else
+        UARTprintf("Motors are moving\n");
+        return COMMAND_OK;
+    }
+
+    StreamStart(pi32Argv[0], g_sMotor.Setpoint);
+
+    return COMMAND_OK;
+}
+
+
+//*****************************************************************************
+//
+// Hand the trajectory limits of the parameters to the trajectories of all
+// motors, for their next moves
+//
+//*****************************************************************************
+void LimitsApply(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        TrajectoryLimitsSet(&g_sMotor.Trajectory[i], g_sParams.VelocityMax,
+                            g_sParams.AccelMax, g_sParams.JerkMax);
+
+    InterpLimitsSet(&g_sMotor.Interp, g_sParams.VelocityMax,
+                    g_sParams.AccelMax, g_sParams.JerkMax);
+}
+
+
+//*****************************************************************************
+//
+// Console command "limits <vel> <acc> <jerk>" - trajectory limits of all
+// motors in counts/s, counts/s^2 and counts/s^3
+//
+//*****************************************************************************
+int CmdLimits(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    if ((ui32Argc != 3) || (pi32Argv[0] <= 0) || (pi32Argv[1] <= 0) ||
+        (pi32Argv[2] <= 0))
+        return COMMAND_INVALID_ARG;
+
+    g_sParams.VelocityMax = pi32Argv[0];
+    g_sParams.AccelMax = pi32Argv[1];
+    g_sParams.JerkMax = pi32Argv[2];
+    LimitsApply();
+
+    return COMMAND_OK;
+}
+
+
+//*****************************************************************************
+//
+// Console command "loop <0|1>" - let the position controllers drive the
+// motors.  "pwm" switches back to open loop.
+//
+//*****************************************************************************
+int CmdLoop(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    if (ui32Argc != 1)
+        return COMMAND_INVALID_ARG;
+
+    MotorClosedLoopSet(pi32Argv[0] != 0);
+
+    return COMMAND_OK;
+}
+
+
+//*****************************************************************************
+//
+// Set gain ui32Param (params.h) from the "<motor> <gain>" arguments of the
+// gain commands.  ParamSet() converts the gain and checks it against the
+// range of the parameter.
+//
+//*****************************************************************************
+static int CmdGain(uint32_t ui32Param, uint32_t ui32Argc,
+                   const int32_t *pi32Argv)
+{
+    if (ui32Argc != 2)
+        return COMMAND_INVALID_ARG;
+
+    if ((pi32Argv[0] < 1) || (pi32Argv[0] > MOTOR_NUM_AXES))
+        return COMMAND_INVALID_ARG;
+
+    if (!ParamSet(ui32Param, pi32Argv[0] - 1, pi32Argv[1]))
+        return COMMAND_INVALID_ARG;
+
+    return COMMAND_OK;
+}
+
+//*****************************************************************************
+//
+// Console commands "kp", "kv", "ki", "kvff" and "kaff" <motor> <gain> - the
+// gains of the cascaded controllers, see motor.h.  The gains are given in
+// units of 1e-6, kaff in units of 1e-9.  ki is per second and converted to
+// the per tick gain by ParamSet().
+//
+//*****************************************************************************
+int CmdKp(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    return CmdGain(PARAM_KP, ui32Argc, pi32Argv);
+}
+
+int CmdKv(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    return CmdGain(PARAM_KV, ui32Argc, pi32Argv);
+}
+
+int CmdKi(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    return CmdGain(PARAM_KI, ui32Argc, pi32Argv);
+}
+
+int CmdKvff(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    return CmdGain(PARAM_KVFF, ui32Argc, pi32Argv);
+}
+
+int CmdKaff(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    return CmdGain(PARAM_KAFF, ui32Argc, pi32Argv);
+}
+
+
+//*****************************************************************************
+//
+// Console command "params" - list the parameters (params.h) by number, in
+// the units of "param".  A * marks those that take effect at reset.
+//
+//*****************************************************************************
+int CmdParams(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    const tParamInfo *psInfo;
+    uint32_t i, j;
+    int32_t i32Value;
+
+    for (i = 0; i < PARAM_COUNT; i++)
+    {
+        psInfo = &g_psParamInfo[i];
+        UARTprintf("%2u %6s%c", i, psInfo->pcName, psInfo->bReset ? '*' : ' ');
+        for (j = 0; j < psInfo->ui32Count; j++)
         {
-            GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_2, GPIO_PIN_2);
+            ParamGet(i, j, &i32Value);
+            UARTprintf(" %d", i32Value);
         }
-
-        //
-        // Set motor duty cycle
-        //
-        PWMPulseWidthSet(PWM0_BASE, PWM_OUT_3, PWMGenPeriodGet(PWM0_BASE, PWM_GEN_1) * (uint32_t)u / 100);
-        //PWMPulseWidthSet(PWM0_BASE, PWM_OUT_3, PWMGen1Period * (uint32_t)u / 100);
-        PWMOutputState(PWM0_BASE, PWM_OUT_3_BIT, true);
-        PWMGenEnable(PWM0_BASE, PWM_GEN_1); // CHECK GENERATOR!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+        UARTprintf("\n");
     }
+
+    return COMMAND_OK;
 }
 
 
 //*****************************************************************************
 //
-// Drive Motor 2
+// Console command "param <n> [motor] <value>" - set parameter n of the
+// "params" list, of one motor for the gains and initial positions.  The
+// change is lost at reset unless saved with "commit".
 //
 //*****************************************************************************
-void DriveMotor2(int8_t u)
+int CmdParam(uint32_t ui32Argc, const int32_t *pi32Argv)
 {
-    //
-    // If duty cycle is 0 , disable the PWM generator and output
-    //
-    if(!u)
-	{
-	    PWMOutputState(PWM1_BASE, PWM_OUT_2_BIT, false);
-        PWMGenDisable(PWM1_BASE, PWM_GEN_1);
-	}
-	//
-	// else set direction and PWM output accordingly
-	//
-	else
-	{
-		//
-		// Set direction
-		//
-		if (u < 0)
-		{
-			u = -u;
-			GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, 0);
-		}
-		else
-		{
-			GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, GPIO_PIN_3);
-		}
+    uint32_t ui32Param, ui32Index;
+    int32_t i32Value;
+
+    if ((ui32Argc < 2) || (ui32Argc > 3) || (pi32Argv[0] < 0) ||
+        (pi32Argv[0] >= PARAM_COUNT))
+        return COMMAND_INVALID_ARG;
 
-		//
-		// Set motor duty cycle
-		//
-		PWMPulseWidthSet(PWM1_BASE, PWM_OUT_2, PWMGenPeriodGet(PWM1_BASE, PWM_GEN_1) * (uint32_t)u / 100);
-		//PWMPulseWidthSet(PWM1_BASE, PWM_OUT_2, PWMGen1Period * (uint32_t)u / 100);
-		PWMOutputState(PWM1_BASE, PWM_OUT_2_BIT, true);
-		PWMGenEnable(PWM1_BASE, PWM_GEN_1);
-	}
+    ui32Param = pi32Argv[0];
+    if (ui32Argc == 3)
+    {
+        if (pi32Argv[1] < 1)
+            return COMMAND_INVALID_ARG;
+        ui32Index = pi32Argv[1] - 1;
+        i32Value = pi32Argv[2];
+    }
+    else
+    {
+        ui32Index = 0;
+        i32Value = pi32Argv[1];
+    }
+
+    if ((ui32Argc == 2) != (g_psParamInfo[ui32Param].ui32Count == 1))
+        return COMMAND_INVALID_ARG;
+
+    if (!ParamSet(ui32Param, ui32Index, i32Value))
+        return COMMAND_INVALID_ARG;
+
+    LimitsApply();
+    if (g_psParamInfo[ui32Param].bReset)
+        UARTprintf("Takes effect after a reset\n");
+
+    return COMMAND_OK;
 }
 
 
 //*****************************************************************************
 //
-// Position Control - Motor 1
+// Console commands "commit" - save the parameters in the EEPROM, and
+// "defaults" - go back to the built in parameters
 //
 //*****************************************************************************
-void Motor1PositionControl(void)
+int CmdCommit(uint32_t ui32Argc, const int32_t *pi32Argv)
 {
-    //
-    // Read encoder Position, Velocity and Direction
-    // Get direction (1 = forward, -1 = backward)
-    // Get velocity (counts per period) and multiply by direction so that it is signed
-    //
-    Position1 = QEIPositionGet(QEI0_BASE);
-    Direction1 = QEIDirectionGet(QEI0_BASE);
-    Velocity1 = (int32_t)QEIVelocityGet(QEI0_BASE) * Direction1;
+    if (!ParamsCommit())
+        UARTprintf("EEPROM write failed\n");
 
-    //
-    // Control Algorithm
-    //
-    error1 = (int32_t)(Setpoint1 - Position1);
-    //u1 = Kp1 * error1 - Kd1 * Velocity1;
-    u1 = - Kp1 * error1;
-	
-	//
-    // Apply saturation limits
-    //
-    if (u1 > UpLimit)
-        u1 = UpLimit;
-    else if (u1 < -UpLimit)
-        u1 = -UpLimit;
+    return COMMAND_OK;
+}
+
+int CmdDefaults(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    ParamsDefaults();
+    LimitsApply();
 
-	//
-	// Drive Motor 1
-	//	
-	//DriveMotor1((int8_t)u1);
+    return COMMAND_OK;
 }
 
 
 //*****************************************************************************
 //
-// Position Control - Motor 2
+// Console command "tune <motor>" - relay autotuning of the position and
+// velocity loop gains of a motor at rest (autotune.h).  The loop is closed
+// and the experiments run on, a few seconds at most; the main loop prints
+// the report when they end.  "tune 0" aborts them.
 //
 //*****************************************************************************
-void Motor2PositionControl(void)
+int CmdTune(uint32_t ui32Argc, const int32_t *pi32Argv)
 {
-    //
-    // Read encoder Position, Velocity and Direction
-    // Get direction (1 = forward, -1 = backward)
-    // Get velocity (counts per period) and multiply by direction so that it is signed
-    //
-    Position2 = QEIPositionGet(QEI1_BASE);
-    Direction2 = QEIDirectionGet(QEI1_BASE);
-    Velocity2 = (int32_t)QEIVelocityGet(QEI1_BASE) * Direction2;
+    tTrajectory *psTraj;
 
-    //
-    // Control Algorithm
-    //
-    error2 = (int32_t)(Setpoint1 - Position2);
-    u2 = - Kp2 * error2;
+    if (ui32Argc != 1)
+        return COMMAND_INVALID_ARG;
 
-    //
-    // Apply saturation limits
-    //
-    if (u2 > UpLimit)
-        u2 = UpLimit;
-    else if (u2 < -UpLimit)
-        u2 = -UpLimit;
+    if (pi32Argv[0] == 0)
+    {
+        if (!AutotuneAbort())
+            UARTprintf("Autotune is not running\n");
+        return COMMAND_OK;
+    }
 
-    //
-    // Drive Motor 2
-    //
-    //DriveMotor2((int8_t)u2);
+    psTraj = MotorTrajectory(pi32Argv[0]);
+    if (!psTraj)
+        return COMMAND_INVALID_ARG;
+
+    if (TrajectoryBusy(psTraj) || InterpBusy(&g_sMotor.Interp))
+    {
+        UARTprintf("Motor %d is moving\n", pi32Argv[0]);
+        return COMMAND_OK;
+    }
+
+    MotorClosedLoopSet(true);
+    if (!AutotuneStart(pi32Argv[0] - 1))
+        UARTprintf("Autotune is running\n");
+
+    return COMMAND_OK;
 }
 
 
 //*****************************************************************************
 //
-// Timer 0 handler
+// Console command "trace <n> [mask]" - stream the binary trace every n
+// ticks, of all channels or of the TRACE_CH_xxx bits in mask.  "trace 0"
+// stops it.
 //
 //*****************************************************************************
-void Timer0IntHandler(void)
+int CmdTrace(uint32_t ui32Argc, const int32_t *pi32Argv)
 {
-    //
-    // Clear the timer interrupt
-    //
-    TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+    uint32_t ui32Mask = TRACE_CH_ALL;
 
-	//
-    // Planning
-    //
-    planning_counter++;
-    if (planning_counter % 20 == 0)
-        Setpoint1 += Step1;
-	
-    //
-    // Control Motor 1
-    //
-    Motor1PositionControl();
+    if ((ui32Argc < 1) || (ui32Argc > 2))
+        return COMMAND_INVALID_ARG;
 
-    //
-    // Control Motor 2
-    //
-    Motor2PositionControl();
+    if (ui32Argc == 2)
+        ui32Mask = (uint32_t)pi32Argv[1];
 
-    //
-    // Print in terminal
-    //
-    if (planning_counter % 2000 == 0)
+    if (pi32Argv[0] == 0)
+    {
+        TraceStop();
+        return COMMAND_OK;
+    }
+
+    if ((pi32Argv[0] < 0) || (pi32Argv[0] > 0xFFFF) ||
+        !(ui32Mask & TRACE_CH_ALL))
+        return COMMAND_INVALID_ARG;
+
+    TraceStart(ui32Mask, pi32Argv[0]);
+
+    return COMMAND_OK;
+}
+
+
+//*****************************************************************************
+//
+// Console command "scope [mask] [pre] [post] [n]" - capture the SCOPE_CH_xxx
+// channels in mask every n ticks, pre samples before the trigger and post
+// from it (scope.h).  "scope 0" stops, "scope" alone shows the state.
+//
+// Console command "trigger <mode> [channel] [level]" - trigger of the next
+// capture: 0 now, 1 on a change of the channel (bit number in the mask),
+// 2 when its magnitude exceeds level, 3 on SW1.
+//
+// Console command "dump" - send the capture as binary frames, decoded by
+// tools/trace_decode.cpp
+//
+//*****************************************************************************
+int CmdScope(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    if (ui32Argc == 0)
     {
-        //UARTprintf("\nM1 | p: %u, e: %d, u: %d", Position1, error1, (int)u1);
-        //UARTprintf("%u, %d, %d, %d\n", Position1, error1, (int)u1, Step1);
-        //UARTprintf("M2 | p: %u, e: %d, u: %d\n\n", Position2, error2, (int)u2);
-        UARTprintf("P1 = %u | P2 = %u | PWM = %d\n", Position1, Position2, PWM_output);
+        ScopeReport();
+        return COMMAND_OK;
+    }
 
+    if (pi32Argv[0] == 0)
+    {
+        ScopeStop();
+        return COMMAND_OK;
     }
+
+    if ((ui32Argc < 3) || (pi32Argv[1] < 0) || (pi32Argv[2] <= 0) ||
+        ((ui32Argc == 4) && ((pi32Argv[3] <= 0) || (pi32Argv[3] > 0xFFFF))))
+        return COMMAND_INVALID_ARG;
+
+    if (!ScopeArm(pi32Argv[0], pi32Argv[1], pi32Argv[2],
+                  (ui32Argc == 4) ? pi32Argv[3] : 1))
+        return COMMAND_INVALID_ARG;
+
+    return COMMAND_OK;
+}
+
+int CmdTrigger(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    if ((ui32Argc < 1) || (pi32Argv[0] < SCOPE_TRIG_NOW) ||
+        (pi32Argv[0] > SCOPE_TRIG_SWITCH) ||
+        ((ui32Argc > 1) &&
+         ((pi32Argv[1] < 0) || (pi32Argv[1] >= SCOPE_NUM_CHANNELS))))
+        return COMMAND_INVALID_ARG;
+
+    ScopeTriggerSet(pi32Argv[0], (ui32Argc > 1) ? pi32Argv[1] : 0,
+                    (ui32Argc > 2) ? pi32Argv[2] : 0);
+
+    return COMMAND_OK;
+}
+
+int CmdDump(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    if (g_ui32ScopeState != SCOPE_DONE)
+    {
+        UARTprintf("No capture\n");
+        return COMMAND_OK;
+    }
+
+    ScopeDump();
+
+    return COMMAND_OK;
 }
 
 
+//*****************************************************************************
+//
+// Console command "stats" - loop state and lost output
+//
+//*****************************************************************************
+int CmdStats(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    uint32_t i;
+
+    UARTprintf("Tick %u | PWM = %d | Loop %s\n", planning_counter, PWM_output,
+               g_bMotorClosedLoop ? "closed" : "open");
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+#ifdef MOTOR_CURRENT_LOOP
+        UARTprintf("Motor %u | SP = %d | P = %d | I = %d mA (ref %d)\n",
+                   i + 1, (int32_t)g_sMotor.Setpoint[i],
+                   (int32_t)g_sMotor.Position[i], g_sMotor.Current[i],
+                   g_sMotor.CurrentRef[i]);
+    UARTprintf("Current samples %u | overruns %u\n", g_ui32CurrentSamples,
+               g_ui32CurrentOverruns);
+#else
+        UARTprintf("Motor %u | SP = %d | P = %d\n", i + 1,
+                   (int32_t)g_sMotor.Setpoint[i],
+                   (int32_t)g_sMotor.Position[i]);
+#endif
+    UARTprintf("Dropped: telemetry %u | lines %u | trace %u | "
+               "trace frames %u\n", g_ui32TelemetryDropped,
+               g_ui32TelemetryLinesLost, g_ui32TraceDropped,
+               g_ui32TraceFramesLost);
+#ifdef ISR_TIMING
+    UARTprintf("ISR overruns %u\n", g_ui32IsrOverruns);
+#endif
+    UARTprintf("Stack high water %u of %u bytes\n", StackUsed(),
+               (&__STACK_END - &__stack) * sizeof(uint32_t));
+
+    return COMMAND_OK;
+}
+
+
+//*****************************************************************************
+//
+// Console command "tasks" - print the scheduler tasks and their overruns
+// (and execution times with ISR_TIMING), and start a new window
+//
+//*****************************************************************************
+int CmdTasks(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    SchedReport();
+
+    return COMMAND_OK;
+}
+
+
+#ifdef ISR_TIMING
+//*****************************************************************************
+//
+// Console command "timing" - print the ISR timing statistics and start a
+// new window
+//
+//*****************************************************************************
+int CmdTiming(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    IsrTimingReport();
+
+    return COMMAND_OK;
+}
+#endif
+
+
+//*****************************************************************************
+//
+// Console command "help"
+//
+//*****************************************************************************
+int CmdHelp(uint32_t ui32Argc, const int32_t *pi32Argv)
+{
+    CommandHelp();
+
+    return COMMAND_OK;
+}
+
+
+//*****************************************************************************
+//
+// Console command table
+//
+//*****************************************************************************
+const tCommandEntry g_psCommandTable[] =
+{
+    { "",       CmdPWM,      0 },
+    { "pwm",    CmdPWM,      "<duty>        open loop PWM of all motors [%]" },
+    { "loop",   CmdLoop,     "<0|1>         closed loop position control" },
+    { "sp",     CmdSetpoint, "<motor> <p>   profiled move to position p" },
+    { "move",   CmdMove,     "<motor> <d>   profiled move by d counts" },
+    { "feed",   CmdFeed,     "<v>           coordinated path speed, 0 for the limit" },
+    { "line",   CmdLine,     "<x> <y>       coordinated line of motors 1 and 2" },
+    { "cw",     CmdArcCW,    "<x> <y> <i> <j> clockwise arc around start + (i, j)" },
+    { "ccw",    CmdArcCCW,   "<x> <y> <i> <j> counterclockwise arc" },
+    { "stream", CmdStream,   "<n>           binary setpoint stream, n ticks/point" },
+    { "limits", CmdLimits,   "<v> <a> <j>   trajectory limits [counts/s^n]" },
+    { "kp",     CmdKp,       "<motor> <k>   position gain [1e-6 /s]" },
+    { "kv",     CmdKv,       "<motor> <k>   velocity gain [1e-6 %/(counts/s)]" },
+    { "ki",     CmdKi,       "<motor> <k>   velocity integral gain [1e-6 %/count]" },
+    { "kvff",   CmdKvff,     "<motor> <k>   velocity feedforward [1e-6 %/(counts/s)]" },
+    { "kaff",   CmdKaff,     "<motor> <k>   accel feedforward [1e-9 %/(counts/s^2)]" },
+    { "params", CmdParams,   "              list the parameters" },
+    { "param",  CmdParam,    "<n> [m] <v>   set parameter n [of motor m]" },
+    { "commit", CmdCommit,   "              save the parameters in EEPROM" },
+    { "defaults", CmdDefaults, "              built in parameters" },
+    { "tune",   CmdTune,     "<motor>       relay autotune of kp, kv and ki, 0 aborts" },
+    { "trace",  CmdTrace,    "<n> [mask]    binary trace every n ticks, 0 stops" },
+    { "scope",  CmdScope,    "[m pre post]  RAM capture of channels m" },
+    { "trigger", CmdTrigger, "<mode> [c l]  scope trigger" },
+    { "dump",   CmdDump,     "              send the scope capture" },
+    { "stats",  CmdStats,    "              loop state, dropped output and stack use" },
+    { "tasks",  CmdTasks,    "              scheduler tasks and overruns" },
+#ifdef ISR_TIMING
+    { "timing", CmdTiming,   "              ISR timing statistics" },
+#endif
+    { "help",   CmdHelp,     "              this list" },
+    { 0, 0, 0 }
+};
+
+
 //*****************************************************************************
 //
 // Main
@@ -691,30 +1173,28 @@ void Timer0IntHandler(void)
 //*****************************************************************************
 int main(void)
 {
-	//
-	// Variables
-	//
-	char user_input[8];  		        // Buffer for storing keyboard input
-	int user_input_dec = 0;             // Decimal value after conversion
-	
+    uint32_t ui32Params;
+
+    //
+    // Mark the free stack for the high-water mark of "stats"
     //
-    // Run clock at 50MHz
+    StackFill();
+
+    //
+    // Run clock at SYSTEM_CLOCK_MHZ (clock_config.h)
     //
-    SysCtlClockSet(SYSCTL_SYSDIV_4|SYSCTL_USE_PLL|SYSCTL_XTAL_16MHZ|SYSCTL_OSC_MAIN);
+    SysCtlClockSet(SYSTEM_CLOCK_SYSDIV|SYSCTL_USE_PLL|SYSCTL_XTAL_16MHZ|SYSCTL_OSC_MAIN);
 
     //
-    // Configure PWM Pins, Direction Pins and QEI for Motor 1
+    // Read the tuning parameters, everything below depends on them
     //
-    ConfigureMotor1PWM();
-    ConfigureMotor1DirectionPin();
-    ConfigureMotor1QEI();
+    ui32Params = ParamsLoad();
 
     //
-    // Configure PWM Pins, Direction Pins and QEI for Motor 2
+    // Configure PWM Pins, Direction Pins and QEI of all motors.  The
+    // trajectories start at rest on the initial encoder positions.
     //
-    ConfigureMotor2PWM();
-    ConfigureMotor2DirectionPin();
-    ConfigureMotor2QEI();
+    MotorConfigure();
 
     //
     // Configure Switch 1
@@ -722,57 +1202,58 @@ int main(void)
     ConfigureSW1();
 
     //
-    // Initialize the UART and say hello
+    // Initialize the UART and say hello, the transmit path runs on uDMA
     //
+    ConfigureDMA();
     ConfigureUART();
     UARTprintf("\n\nHi!\n\n");
+    if (ui32Params != PARAM_LOADED)
+        UARTprintf("No valid parameters in EEPROM (%u), using defaults\n\n",
+                   ui32Params);
 
+#ifdef MOTOR_CURRENT_LOOP
     //
-    // Configure Timer 0
+    // Start the current sensing and the current loops, they drive the
+    // motors once the loop is closed
     //
-    ConfigureTimer0();
+    CurrentConfigure();
+#endif
 
     //
-    // Main loop
+    // Configure the deferred terminal output
     //
-    while(1)
-    {
-        //
-        // Ask for input
-        //
-//        UARTprintf("Give command ");
+    ConfigureTelemetry();
 
-        //
-        // Read < 8 bytes and hit enter
-        //
-        UARTgets(user_input,8);
+    //
+    // Start the ISR timing instrumentation, the budget is one tick
+    //
+    ISR_TIMING_INIT(CLOCK_TICK_PERIOD(SYSTEM_CLOCK_HZ));
 
-        //
-        // Convert input to decimal
-        //
-        sscanf(user_input,"%d",&user_input_dec);
+    //
+    // Set up the periodic tasks, then start the tick that drives them
+    //
+    SchedInit();
+#ifdef CONTROL_TICK_PWM
+    ConfigurePWMTick();
+#else
+    ConfigureTimer0();
+#endif
 
-        //
-        // Filter Input
-        //
-        if ((user_input_dec > 85) || (user_input_dec < -85))
-        {
-            //
-            // INVALID INPUT - Do not update motor command
-            //
-            UARTprintf("Desired PWM: %d\n", user_input_dec);
-            UARTprintf("INVALID INPUT\n\n");
-        }
-        else
-        {
-            //
-            // Update motor command - Change ang. rate
-            //
-            //Step1 = user_input_dec;
-            PWM_output = user_input_dec;
-            DriveMotor1(PWM_output);
-            DriveMotor2(PWM_output);
-        }
+    //
+    // List the console commands
+    //
+    CommandHelp();
+
+    //
+    // Main loop - commands are parsed as their characters arrive, so the
+    // loop never blocks waiting for a line.  A setpoint stream takes the
+    // console over until it ends.  An autotune reports when it ends.
+    //
+    while(1)
+    {
+        if (!StreamPoll())
+            CommandPoll();
+        AutotunePoll();
     }
 }
 
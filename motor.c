@@ -0,0 +1,661 @@
+//*****************************************************************************
+//
+// motor.c - Table driven position control of MOTOR_NUM_AXES motor axes.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_pwm.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pwm.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/qei.h"
+#include "driverlib/adc.h"
+#include "motor_config.h"
+#include "control_math.h"
+#include "trajectory.h"
+#include "interp.h"
+#include "stream.h"
+#include "motor.h"
+#include "autotune.h"
+#include "params.h"
+
+//*****************************************************************************
+//
+// Maximum output of the current loops [%].  That of the velocity loops is
+// a parameter (params.h).
+//
+//*****************************************************************************
+#define MOTOR_CURRENT_DUTY_LIMIT    95
+
+#if MOTOR_NUM_AXES < INTERP_NUM_AXES
+#error "The coordinated axes must be motor axes"
+#endif
+
+//*****************************************************************************
+//
+// Current sensor scale [mA per ADC count] in Q16
+//
+//*****************************************************************************
+#define MOTOR_CURRENT_SCALE_Q16                                               \
+    ((int32_t)(MOTOR_CURRENT_MA_PER_COUNT * 65536.0 + 0.5))
+
+
+//*****************************************************************************
+//
+// Wiring of the axes
+//
+// Axis 0: PB5 (M0PWM3) PWM, PF2 direction, PD6/PD7 (PhA0/PhB0) encoder,
+//         PE3 (AIN0) current
+// Axis 1: PE4 (M1PWM2) PWM, PF3 direction, PC5/PC6 (PhA1/PhB1) encoder,
+//         PE2 (AIN1) current
+//
+//*****************************************************************************
+const tMotorAxis g_psMotorAxes[MOTOR_NUM_AXES] =
+{
+    {
+        SYSCTL_PERIPH_PWM0, PWM0_BASE, PWM_GEN_1, PWM_OUT_3, PWM_OUT_3_BIT,
+        SYSCTL_PERIPH_GPIOB, GPIO_PORTB_BASE, GPIO_PB5_M0PWM3, GPIO_PIN_5,
+        GPIO_PIN_2, SYSCTL_PERIPH_GPIOF, GPIO_PORTF_BASE,
+        SYSCTL_PERIPH_QEI0, QEI0_BASE,
+        SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PD6_PHA0, GPIO_PD7_PHB0,
+        GPIO_PIN_6 | GPIO_PIN_7, true,
+        SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_3, ADC_CTL_CH0
+    },
+    {
+        SYSCTL_PERIPH_PWM1, PWM1_BASE, PWM_GEN_1, PWM_OUT_2, PWM_OUT_2_BIT,
+        SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PE4_M1PWM2, GPIO_PIN_4,
+        GPIO_PIN_3, SYSCTL_PERIPH_GPIOF, GPIO_PORTF_BASE,
+        SYSCTL_PERIPH_QEI1, QEI1_BASE,
+        SYSCTL_PERIPH_GPIOC, GPIO_PORTC_BASE, GPIO_PC5_PHA1, GPIO_PC6_PHB1,
+        GPIO_PIN_5 | GPIO_PIN_6, false,
+        SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_2, ADC_CTL_CH1
+    }
+};
+
+//*****************************************************************************
+//
+// Register addresses and values used by MotorDrive(), worked out once by
+// MotorConfigure() so that an update is three stores
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t PWMCompare[MOTOR_NUM_AXES];    // CMPA/CMPB register
+    uint32_t PWMLoad[MOTOR_NUM_AXES];       // LOAD value, half the period
+    uint32_t PWMEnable[MOTOR_NUM_AXES];     // Bit-band alias of the enable bit
+    uint32_t DirData[MOTOR_NUM_AXES];       // GPIODATA word of the pin only
+    uint32_t DirForward[MOTOR_NUM_AXES];    // Value of the pin for forward
+}
+tMotorDriveRegs;
+
+//*****************************************************************************
+//
+// Address of the bit-band alias of one bit of a peripheral register
+//
+//*****************************************************************************
+#define MOTOR_BITBAND(ui32Reg, ui32Bit)                                       \
+    (((ui32Reg) & 0xF0000000) | 0x02000000 |                                  \
+     (((ui32Reg) & 0x000FFFFF) << 5) | ((ui32Bit) << 2))
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+tMotorState g_sMotor;
+volatile bool g_bMotorClosedLoop = false;   // Controllers drive the motors
+
+static tMotorDriveRegs g_sMotorDriveRegs;
+
+
+//*****************************************************************************
+//
+// Configure the PWM generator and pin of one axis.  The generator is left
+// running with the output disabled.
+//
+//*****************************************************************************
+static void MotorConfigurePWM(const tMotorAxis *psAxis)
+{
+    //
+    // Enable the PWM peripheral and the GPIO port of the PWM signal
+    //
+    SysCtlPeripheralEnable(psAxis->PWMPeriph);
+    SysCtlPeripheralEnable(psAxis->PWMPinPeriph);
+    SysCtlDelay(10);
+
+    //
+    // PWM pin as output
+    //
+    GPIOPinConfigure(psAxis->PWMPinConfig);
+    GPIOPinTypePWM(psAxis->PWMPinPort, psAxis->PWMPin);
+
+    //
+    // Configure the PWM generator
+    //
+    PWMGenConfigure(psAxis->PWMBase, psAxis->PWMGen,
+                    PWM_GEN_MODE_UP_DOWN | PWM_GEN_MODE_NO_SYNC);
+    SysCtlDelay(10);
+
+    PWMGenPeriodSet(psAxis->PWMBase, psAxis->PWMGen, MOTOR_PWM_PERIOD);
+    SysCtlDelay(10);
+
+    //
+    // The compare registers already take effect when the counter is zero,
+    // make enabling and disabling the output do the same so that starting
+    // and stopping never cuts a pulse short
+    //
+    PWMOutputUpdateMode(psAxis->PWMBase, psAxis->PWMOutBit,
+                        PWM_OUTPUT_MODE_SYNC_LOCAL);
+    PWMOutputState(psAxis->PWMBase, psAxis->PWMOutBit, false);
+}
+
+
+//*****************************************************************************
+//
+// Configure the direction pin of one axis
+//
+//*****************************************************************************
+static void MotorConfigureDirectionPin(const tMotorAxis *psAxis)
+{
+    SysCtlPeripheralEnable(psAxis->DirPeriph);
+    GPIOPinTypeGPIOOutput(psAxis->DirPort, psAxis->DirPin);
+}
+
+
+//*****************************************************************************
+//
+// Configure the QEI module and pins of one axis
+//
+//*****************************************************************************
+static void MotorConfigureQEI(const tMotorAxis *psAxis)
+{
+    //
+    // Enable the GPIO port of the encoder and the QEI peripheral
+    //
+    SysCtlPeripheralEnable(psAxis->QEIPinPeriph);
+    SysCtlPeripheralEnable(psAxis->QEIPeriph);
+
+    //
+    // Unlock pins like PD7 that are used for NMI - Without this step they
+    // don't work.  In Tiva include this is the same as "_DD" in older
+    // versions (0x4C4F434B)
+    //
+    if (psAxis->QEIUnlock)
+    {
+        HWREG(psAxis->QEIPinPort + GPIO_O_LOCK) = GPIO_LOCK_KEY;
+        HWREG(psAxis->QEIPinPort + GPIO_O_CR) |= psAxis->QEIPins;
+        HWREG(psAxis->QEIPinPort + GPIO_O_LOCK) = 0;
+    }
+
+    //
+    // Encoder pins as PhA and PhB
+    //
+    GPIOPinConfigure(psAxis->QEIPhAConfig);
+    GPIOPinConfigure(psAxis->QEIPhBConfig);
+    GPIOPinTypeQEI(psAxis->QEIPinPort, psAxis->QEIPins);
+
+    //
+    // Disable the QEI, its velocity capture and its interrupt sources
+    //
+    QEIDisable(psAxis->QEIBase);
+    QEIVelocityDisable(psAxis->QEIBase);
+    QEIIntDisable(psAxis->QEIBase,
+                  (QEI_INTERROR | QEI_INTDIR | QEI_INTTIMER | QEI_INTINDEX));
+
+    //
+    // Configure the QEI
+    //
+    // capture on both A and B
+    // do not reset when there is an index pulse
+    // do not swap signals PHA and PHB
+    // set the maximum position as 0xFFFFFFFF, so that the counter wraps
+    // like a uint32_t and MotorControl() can unwrap it with a subtraction
+    //
+    QEIConfigure(psAxis->QEIBase,
+                 (QEI_CONFIG_CAPTURE_A_B | QEI_CONFIG_NO_RESET |
+                  QEI_CONFIG_QUADRATURE | QEI_CONFIG_NO_SWAP), 0xFFFFFFFF);
+    SysCtlDelay(10);
+
+    //
+    // Configure the velocity capture over g_sParams.VelocityPeriod us.
+    // The controllers estimate the velocity from the position instead
+    // (velocity.h), QEIVelocityGet() stays available for comparison.
+    //
+    QEIVelocityConfigure(psAxis->QEIBase, QEI_VELDIV_16,
+                         CLOCK_US_PERIOD(SYSTEM_CLOCK_HZ,
+                                         g_sParams.VelocityPeriod));
+    SysCtlDelay(10);
+
+    //
+    // Enable the QEI
+    //
+    QEIEnable(psAxis->QEIBase);
+    SysCtlDelay(10);
+
+    //
+    // Set the current position
+    //
+    QEIPositionSet(psAxis->QEIBase, MOTOR_POSITION_START);
+    SysCtlDelay(10);
+
+    //
+    // Enable velocity capture
+    //
+    QEIVelocityEnable(psAxis->QEIBase);
+}
+
+
+//*****************************************************************************
+//
+// Configure the peripherals of all axes and put them at rest, open loop,
+// with the trajectories on the initial encoder positions
+//
+//*****************************************************************************
+void MotorConfigure(void)
+{
+    const tMotorAxis *psAxis;
+    uint32_t i, ui32Gen;
+
+    //
+    // Configure PWM Clock to match system's clock
+    //
+    SysCtlPWMClockSet(SYSCTL_PWMDIV_1);
+    SysCtlDelay(10);
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        psAxis = &g_psMotorAxes[i];
+
+        MotorConfigurePWM(psAxis);
+        MotorConfigureDirectionPin(psAxis);
+        MotorConfigureQEI(psAxis);
+
+        //
+        // Odd outputs of a generator are driven by comparator B, and the
+        // enable bit of PWM_OUT_n is bit n
+        //
+        ui32Gen = psAxis->PWMBase + psAxis->PWMGen;
+        g_sMotorDriveRegs.PWMCompare[i] =
+            ui32Gen + ((psAxis->PWMOut & 1) ? PWM_O_X_CMPB : PWM_O_X_CMPA);
+        g_sMotorDriveRegs.PWMLoad[i] = HWREG(ui32Gen + PWM_O_X_LOAD);
+        g_sMotorDriveRegs.PWMEnable[i] =
+            MOTOR_BITBAND(psAxis->PWMBase + PWM_O_ENABLE, psAxis->PWMOut & 7);
+        g_sMotorDriveRegs.DirData[i] =
+            psAxis->DirPort + GPIO_O_DATA + (psAxis->DirPin << 2);
+        g_sMotorDriveRegs.DirForward[i] = psAxis->DirPin;
+
+        g_sMotor.Position[i] = g_sParams.StartPosition[i];
+        g_sMotor.Encoder[i] = MOTOR_POSITION_START;
+        g_sMotor.Velocity[i] = 0;
+        g_sMotor.Setpoint[i] = g_sParams.StartPosition[i];
+        g_sMotor.VelocityRef[i] = 0;
+        g_sMotor.AccelRef[i] = 0;
+        g_sMotor.Error[i] = 0;
+        g_sMotor.VelocityCmd[i] = 0;
+        g_sMotor.Integral[i] = 0;
+        g_sMotor.U[i] = 0;
+        VelocityInit(&g_sMotor.Estimator[i], g_sParams.StartPosition[i]);
+
+        g_sMotor.Current[i] = 0;
+        g_sMotor.CurrentRef[i] = 0;
+        g_sMotor.CurrentIntegral[i] = 0;
+
+        TrajectoryInit(&g_sMotor.Trajectory[i], g_sParams.StartPosition[i]);
+        TrajectoryLimitsSet(&g_sMotor.Trajectory[i], g_sParams.VelocityMax,
+                            g_sParams.AccelMax, g_sParams.JerkMax);
+    }
+
+    InterpInit(&g_sMotor.Interp);
+    InterpLimitsSet(&g_sMotor.Interp, g_sParams.VelocityMax,
+                    g_sParams.AccelMax, g_sParams.JerkMax);
+
+    g_sMotor.OuterCountdown = 1;
+
+    //
+    // Start the PWM generators back to back, so that the periods of all
+    // axes line up and their duty updates take effect together
+    //
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        PWMGenEnable(g_psMotorAxes[i].PWMBase, g_psMotorAxes[i].PWMGen);
+}
+
+
+//*****************************************************************************
+//
+// Drive one axis.  i32Duty is the on time in PWM clocks (see
+// MOTOR_PWM_PERIOD), its sign is the direction.  The generator keeps
+// running; a zero duty cycle only disables the output.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(MotorDrive, ".ramfunc")
+#endif
+void MotorDrive(uint32_t ui32Axis, int32_t i32Duty)
+{
+    uint32_t ui32Dir = g_sMotorDriveRegs.DirForward[ui32Axis];
+
+    if (i32Duty < 0)
+    {
+        i32Duty = -i32Duty;
+        ui32Dir = 0;
+    }
+    if (i32Duty > MOTOR_PWM_DUTY_MAX)
+        i32Duty = MOTOR_PWM_DUTY_MAX;
+
+    //
+    // Counting up/down the output is high while the counter is above the
+    // compare value, for 2 * (LOAD - CMP) clocks
+    //
+    HWREG(g_sMotorDriveRegs.DirData[ui32Axis]) = ui32Dir;
+    HWREG(g_sMotorDriveRegs.PWMCompare[ui32Axis]) =
+        g_sMotorDriveRegs.PWMLoad[ui32Axis] - ((uint32_t)i32Duty >> 1);
+    HWREG(g_sMotorDriveRegs.PWMEnable[ui32Axis]) = (i32Duty != 0);
+}
+
+
+//*****************************************************************************
+//
+// Drive all axes with the same duty cycle
+//
+//*****************************************************************************
+void MotorDriveAll(int32_t i32Duty)
+{
+    uint32_t i;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        MotorDrive(i, i32Duty);
+}
+
+
+//*****************************************************************************
+//
+// Load the QEI position register of an axis without moving its unwrapped
+// position.  Not to be called while the control interrupt runs.
+//
+//*****************************************************************************
+void MotorEncoderSet(uint32_t ui32Axis, uint32_t ui32Count)
+{
+    QEIPositionSet(g_psMotorAxes[ui32Axis].QEIBase, ui32Count);
+    g_sMotor.Encoder[ui32Axis] = ui32Count;
+}
+
+
+//*****************************************************************************
+//
+// Hand the motors to the position controllers, or stop them and leave them
+// to MotorDrive()
+//
+//*****************************************************************************
+void MotorClosedLoopSet(bool bClosed)
+{
+    g_bMotorClosedLoop = bClosed;
+    if (!bClosed)
+        MotorDriveAll(0);
+}
+
+
+//*****************************************************************************
+//
+// True if none of the coordinated axes has a move of its own
+//
+//*****************************************************************************
+static bool MotorCoordinatedIdle(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < INTERP_NUM_AXES; i++)
+        if (TrajectoryBusy(&g_sMotor.Trajectory[i]))
+            return false;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Coordinated moves of the first INTERP_NUM_AXES axes from their reference
+// positions, along a line or an arc (see interp.h).  Return false if one
+// of the axes is moving, or the target of an arc is not on its circle.
+// Called from the foreground.
+//
+//*****************************************************************************
+bool MotorLineTo(const int64_t *pi64Target, float fFeed)
+{
+    int64_t pi64Start[INTERP_NUM_AXES];
+    uint32_t i;
+
+    if (!MotorCoordinatedIdle())
+        return false;
+
+    for (i = 0; i < INTERP_NUM_AXES; i++)
+        pi64Start[i] = g_sMotor.Trajectory[i].Position;
+
+    return InterpLineTo(&g_sMotor.Interp, pi64Start, pi64Target, fFeed);
+}
+
+bool MotorArcTo(const int64_t *pi64Target, const int64_t *pi64Center,
+                bool bClockwise, float fFeed)
+{
+    int64_t pi64Start[INTERP_NUM_AXES];
+    uint32_t i;
+
+    if (!MotorCoordinatedIdle())
+        return false;
+
+    for (i = 0; i < INTERP_NUM_AXES; i++)
+        pi64Start[i] = g_sMotor.Trajectory[i].Position;
+
+    return InterpArcTo(&g_sMotor.Interp, pi64Start, pi64Target, pi64Center,
+                       bClockwise, fFeed);
+}
+
+
+//*****************************************************************************
+//
+// Advance the trajectories by one tick and take the references of the
+// controllers from them.  While a coordinated move runs, the trajectories
+// of its axes are idle and are made to follow the interpolator instead, so
+// that they rest on its end point afterwards.  Streamed axes (stream.h)
+// are handled the same way.  Called from the control interrupt.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(MotorPlan, ".ramfunc")
+#endif
+void MotorPlan(void)
+{
+    tTrajectory *psTraj;
+    uint32_t i;
+    bool bCoordinated, bStreamed;
+
+    bCoordinated = InterpStep(&g_sMotor.Interp);
+    bStreamed = StreamStep();
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        psTraj = &g_sMotor.Trajectory[i];
+
+        //
+        // A streamed axis takes the host's setpoint and feedforward.  Its
+        // trajectory is kept at rest on the setpoint, where it carries on
+        // when the stream ends.
+        //
+        if (bStreamed && (g_sStream.AxisMask & (1 << i)))
+        {
+            psTraj->Position = g_sStream.Position[i];
+            psTraj->Fraction = 0.0f;
+            psTraj->Velocity = 0.0f;
+            psTraj->Accel = 0.0f;
+
+            g_sMotor.Setpoint[i] = g_sStream.Position[i];
+            g_sMotor.VelocityRef[i] = g_sStream.Velocity[i];
+            g_sMotor.AccelRef[i] = 0;
+            continue;
+        }
+
+        if (bCoordinated && (i < INTERP_NUM_AXES))
+        {
+            psTraj->Position = g_sMotor.Interp.Position[i];
+            psTraj->Fraction = 0.0f;
+            psTraj->Velocity = g_sMotor.Interp.Velocity[i];
+            psTraj->Accel = g_sMotor.Interp.Accel[i];
+        }
+        else
+        {
+            TrajectoryStep(psTraj);
+        }
+
+        g_sMotor.Setpoint[i] = psTraj->Position;
+        g_sMotor.VelocityRef[i] = (int32_t)(psTraj->Velocity *
+                                            (float)CONTROL_TICK_HZ);
+        g_sMotor.AccelRef[i] = (int32_t)(psTraj->Accel *
+                                         ((float)CONTROL_TICK_HZ *
+                                          (float)CONTROL_TICK_HZ));
+    }
+}
+
+
+//*****************************************************************************
+//
+// Position control of all axes.  Called from the control interrupt.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(MotorControl, ".ramfunc")
+#endif
+void MotorControl(void)
+{
+    uint32_t i, ui32Encoder;
+    int32_t i32VelocityError;
+    int64_t i64Error;
+    control_t u, uIntegrate;
+    bool bOuter;
+
+    bOuter = (--g_sMotor.OuterCountdown == 0);
+    if (bOuter)
+        g_sMotor.OuterCountdown = MOTOR_POSITION_DECIMATION;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        //
+        // Read the encoder, unwrap it and estimate the velocity
+        //
+        ui32Encoder = QEIPositionGet(g_psMotorAxes[i].QEIBase);
+        g_sMotor.Position[i] += (int32_t)(ui32Encoder - g_sMotor.Encoder[i]);
+        g_sMotor.Encoder[i] = ui32Encoder;
+
+        g_sMotor.Velocity[i] = VelocityUpdate(&g_sMotor.Estimator[i],
+                                              g_sMotor.Position[i]);
+
+        //
+        // Position loop.  The error saturates rather than wrapping when the
+        // axis is more than 2^31 counts off.
+        //
+        i64Error = g_sMotor.Setpoint[i] - g_sMotor.Position[i];
+        if (i64Error > INT32_MAX)
+            i64Error = INT32_MAX;
+        else if (i64Error < INT32_MIN)
+            i64Error = INT32_MIN;
+        g_sMotor.Error[i] = (int32_t)i64Error;
+
+        if (bOuter)
+            g_sMotor.VelocityCmd[i] =
+                CONTROL_TO_INT(ControlGainMulInt(g_sParams.Kp[i],
+                                                 g_sMotor.Error[i])) +
+                g_sMotor.VelocityRef[i];
+        if (bOuter && (i == g_ui32AutotuneAxis))
+            AutotuneOuter(i);
+
+        //
+        // Velocity loop with feedforward
+        //
+        i32VelocityError = g_sMotor.VelocityCmd[i] - g_sMotor.Velocity[i];
+        u = ControlAdd(ControlGainMulInt(g_sParams.Kv[i], i32VelocityError),
+                       g_sMotor.Integral[i]);
+        u = ControlAdd(u, ControlGainMulInt(g_sParams.Kvff[i],
+                                            g_sMotor.VelocityRef[i]));
+        u = ControlAdd(u, ControlGainMulInt(g_sParams.Kaff[i],
+                                            g_sMotor.AccelRef[i]));
+
+        //
+        // Anti-windup - the integrator holds while the output is saturated
+        // in the direction it would move it.  It starts from zero every
+        // time the loop is closed.
+        //
+        uIntegrate = ControlGainMulInt(g_sParams.Ki[i], i32VelocityError);
+        if (!g_bMotorClosedLoop)
+            g_sMotor.Integral[i] = 0;
+        else if (!((u > g_sParams.OutputLimit) && (uIntegrate > 0)) &&
+                 !((u < -g_sParams.OutputLimit) && (uIntegrate < 0)))
+            g_sMotor.Integral[i] = ControlAdd(g_sMotor.Integral[i], uIntegrate);
+
+        if (i == g_ui32AutotuneAxis)
+            u = AutotuneInner(i, u);
+
+        //
+        // Apply saturation limits.  The encoders count down while the
+        // direction pin is high, so the motor is driven with -u.
+        //
+        u = -ControlClamp(u, g_sParams.OutputLimit);
+        g_sMotor.U[i] = u;
+
+#ifdef MOTOR_CURRENT_LOOP
+        g_sMotor.CurrentRef[i] = CONTROL_TO_INT(u * (MOTOR_CURRENT_MAX_MA / 100));
+#else
+        if (g_bMotorClosedLoop)
+            MotorDrive(i, CONTROL_TO_INT(u * MOTOR_PWM_PER_PERCENT));
+#endif
+    }
+}
+
+
+//*****************************************************************************
+//
+// Current control of all axes on one set of ADC samples, one per axis in
+// axis order.  Called from the ADC interrupt (current.c) every PWM period,
+// preempting MotorControl(), whose current references it follows.
+// Positive currents flow while the direction pin is high.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(MotorCurrentControl, ".ramfunc")
+#endif
+void MotorCurrentControl(const uint16_t *pui16Samples)
+{
+    uint32_t i;
+    int32_t i32Error;
+    control_t u, uIntegrate;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        g_sMotor.Current[i] = (((int32_t)pui16Samples[i] -
+                                MOTOR_CURRENT_ZERO_COUNT) *
+                               MOTOR_CURRENT_SCALE_Q16) >> 16;
+
+        i32Error = g_sMotor.CurrentRef[i] - g_sMotor.Current[i];
+        u = ControlAdd(ControlGainMulInt(g_sParams.KpCurrent[i], i32Error),
+                       g_sMotor.CurrentIntegral[i]);
+
+        //
+        // Anti-windup as in the velocity loop
+        //
+        uIntegrate = ControlGainMulInt(g_sParams.KiCurrent[i], i32Error);
+        if (!g_bMotorClosedLoop)
+            g_sMotor.CurrentIntegral[i] = 0;
+        else if (!((u > CONTROL_CONST(MOTOR_CURRENT_DUTY_LIMIT)) && (uIntegrate > 0)) &&
+                 !((u < -CONTROL_CONST(MOTOR_CURRENT_DUTY_LIMIT)) && (uIntegrate < 0)))
+            g_sMotor.CurrentIntegral[i] = ControlAdd(g_sMotor.CurrentIntegral[i],
+                                                     uIntegrate);
+
+        u = ControlClamp(u, CONTROL_CONST(MOTOR_CURRENT_DUTY_LIMIT));
+
+        if (g_bMotorClosedLoop)
+            MotorDrive(i, CONTROL_TO_INT(u * MOTOR_PWM_PER_PERCENT));
+    }
+}
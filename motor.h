@@ -0,0 +1,178 @@
+//*****************************************************************************
+//
+// motor.h - Table driven position control of MOTOR_NUM_AXES motor axes.
+//
+// Each axis is a sign/magnitude bridge (PWM + direction pin) and a
+// quadrature encoder on a QEI module.  Its wiring is a constant
+// tMotorAxis entry of g_psMotorAxes[] in motor.c, so adding an axis means
+// adding a row there and raising MOTOR_NUM_AXES in motor_config.h.
+//
+// Each axis runs a cascaded controller.  The outer loop, every
+// MOTOR_POSITION_DECIMATION ticks, turns the position error into a
+// velocity command on top of the reference velocity:
+//
+//   vc = Kp * (p_ref - p) + v_ref
+//
+// and the inner PI loop, every tick, drives the velocity error to zero
+// with velocity and acceleration feedforward from the trajectory:
+//
+//   u = Kv * (vc - v) + Ki * integral(vc - v) + Kvff * v_ref + Kaff * a_ref
+//
+// The output saturates at the OutputLimit parameter, and the integrator stops
+// while it would push the output further into saturation.  u is the duty
+// cycle in percent, or with MOTOR_CURRENT_LOOP the reference of a PI
+// current loop in percent of MOTOR_CURRENT_MAX_MA:
+//
+//   d = KpCurrent * (i_ref - i) + KiCurrent * integral(i_ref - i)
+//
+// which MotorCurrentControl() runs on every PWM period, on the currents
+// sampled by current.c.
+//
+// Each axis follows its own trajectory, or, while MotorLineTo() or
+// MotorArcTo() run a coordinated move (interp.h), the first
+// INTERP_NUM_AXES axes follow the interpolator together, or the axes a
+// host streams setpoints to (stream.h) follow those.
+//
+// The gains and limits are the parameters in g_sParams (params.h).  The
+// run time state is kept as a structure of arrays, g_sMotor, indexed by
+// axis.  Positions and setpoints are signed 64-bit counts that start at
+// the StartPosition parameters.  The QEI counters run over the full
+// 32-bit range, so the control interrupt extends them with the wrapped
+// difference to the previous reading, which is exact while an axis moves
+// less than 2^31 counts per tick.  Nothing overflows in continuous
+// rotation.
+//
+// The control interrupt walks the axes with a loop whose trip count is the
+// compile time constant MOTOR_NUM_AXES, so the compiler can unroll it, and
+// the same field of all axes sits in consecutive words.
+//
+//*****************************************************************************
+
+#ifndef __MOTOR_H__
+#define __MOTOR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor_config.h"
+#include "clock_config.h"
+#include "control_math.h"
+#include "trajectory.h"
+#include "interp.h"
+#include "velocity.h"
+
+//*****************************************************************************
+//
+// Count the QEI position registers are loaded with at start.  Any value
+// works, the unwrapped positions start at the StartPosition parameters.
+//
+//*****************************************************************************
+#define MOTOR_POSITION_START    2000000000
+
+//*****************************************************************************
+//
+// PWM period [PWM clocks]
+// Desired PWM frequency: CLOCK_PWM_HZ (20 kHz) -> Period: 50us
+// N = (1 / f) * SysClk.  Where N [cycles] is the function parameter,
+// f is the desired frequency, and SysClk is the system clock frequency,
+// e.g. (1 / 20KHz) * 80MHz = 4000 cycles (clock_config.h).
+//
+// MotorDrive() takes the duty cycle in PWM clocks, up to
+// MOTOR_PWM_DUTY_MAX.  The generator counts up/down, so the compare value
+// moves in steps of two clocks.
+//
+//*****************************************************************************
+#define MOTOR_PWM_PERIOD        CLOCK_PWM_PERIOD(SYSTEM_CLOCK_HZ)
+#define MOTOR_PWM_HZ            (SYSTEM_CLOCK_HZ / MOTOR_PWM_PERIOD)
+#define MOTOR_PWM_DUTY_MAX      (MOTOR_PWM_PERIOD - 2)
+#define MOTOR_PWM_PER_PERCENT   (MOTOR_PWM_PERIOD / 100)
+
+//*****************************************************************************
+//
+// Peripherals and pins of one axis
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t PWMPeriph;         // SYSCTL_PERIPH_PWMn
+    uint32_t PWMBase;           // PWMn_BASE
+    uint32_t PWMGen;            // PWM_GEN_n
+    uint32_t PWMOut;            // PWM_OUT_n
+    uint32_t PWMOutBit;         // PWM_OUT_n_BIT
+    uint32_t PWMPinPeriph;      // GPIO port of the PWM pin
+    uint32_t PWMPinPort;
+    uint32_t PWMPinConfig;      // GPIO_Pxn_MnPWMn
+    uint8_t PWMPin;
+
+    uint8_t DirPin;             // Direction pin, high = forward
+    uint32_t DirPeriph;
+    uint32_t DirPort;
+
+    uint32_t QEIPeriph;         // SYSCTL_PERIPH_QEIn
+    uint32_t QEIBase;           // QEIn_BASE
+    uint32_t QEIPinPeriph;      // GPIO port of the encoder pins
+    uint32_t QEIPinPort;
+    uint32_t QEIPhAConfig;      // GPIO_Pxn_PHAn
+    uint32_t QEIPhBConfig;      // GPIO_Pxn_PHBn
+    uint8_t QEIPins;
+    bool QEIUnlock;             // Pins are NMI capable and must be unlocked
+
+    uint32_t CurrentPinPeriph;  // GPIO port of the current sensor input
+    uint32_t CurrentPinPort;
+    uint8_t CurrentPin;
+    uint32_t CurrentChannel;    // ADC_CTL_CHn of the pin
+}
+tMotorAxis;
+
+//*****************************************************************************
+//
+// Run time state of all axes, one array element per axis
+//
+//*****************************************************************************
+typedef struct
+{
+    volatile int64_t Position[MOTOR_NUM_AXES];      // Unwrapped [counts]
+    uint32_t Encoder[MOTOR_NUM_AXES];               // Last QEI reading
+    volatile int32_t Velocity[MOTOR_NUM_AXES];      // [counts/s]
+    int64_t Setpoint[MOTOR_NUM_AXES];               // [counts]
+    int32_t VelocityRef[MOTOR_NUM_AXES];            // [counts/s]
+    int32_t AccelRef[MOTOR_NUM_AXES];               // [counts/s^2]
+    int32_t Error[MOTOR_NUM_AXES];                  // [counts]
+    int32_t VelocityCmd[MOTOR_NUM_AXES];            // Outer loop [counts/s]
+    control_t Integral[MOTOR_NUM_AXES];             // Velocity loop [%]
+    control_t U[MOTOR_NUM_AXES];                    // Output command [%]
+
+    volatile int32_t Current[MOTOR_NUM_AXES];       // Measured [mA]
+    int32_t CurrentRef[MOTOR_NUM_AXES];             // Current loop [mA]
+    control_t CurrentIntegral[MOTOR_NUM_AXES];      // Current loop [%]
+
+    uint32_t OuterCountdown;                        // Ticks to the outer loop
+
+    tVelocityEstimator Estimator[MOTOR_NUM_AXES];   // See velocity.h
+
+    tTrajectory Trajectory[MOTOR_NUM_AXES];         // Motion profiles
+    tInterp Interp;                                 // Coordinated moves
+}
+tMotorState;
+
+extern const tMotorAxis g_psMotorAxes[MOTOR_NUM_AXES];
+extern tMotorState g_sMotor;
+extern volatile bool g_bMotorClosedLoop;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void MotorConfigure(void);
+extern void MotorDrive(uint32_t ui32Axis, int32_t i32Duty);
+extern void MotorDriveAll(int32_t i32Duty);
+extern void MotorEncoderSet(uint32_t ui32Axis, uint32_t ui32Count);
+extern void MotorClosedLoopSet(bool bClosed);
+extern bool MotorLineTo(const int64_t *pi64Target, float fFeed);
+extern bool MotorArcTo(const int64_t *pi64Target, const int64_t *pi64Center,
+                       bool bClockwise, float fFeed);
+extern void MotorPlan(void);
+extern void MotorControl(void);
+extern void MotorCurrentControl(const uint16_t *pui16Samples);
+
+#endif // __MOTOR_H__
@@ -0,0 +1,160 @@
+//*****************************************************************************
+//
+// motor_config.h - Build-time options for the motor control firmware.
+//
+// Every option below can also be set from the project's predefined symbols
+// (--define) instead of editing this file.
+//
+//*****************************************************************************
+
+#ifndef __MOTOR_CONFIG_H__
+#define __MOTOR_CONFIG_H__
+
+//*****************************************************************************
+//
+// Arithmetic used by the position controllers.  Exactly one of these should
+// be defined:
+//
+// CONTROL_MATH_FIXED -> Q16.16 signals and Q8.24 gains, saturating integer math
+// CONTROL_MATH_FLOAT -> single precision, executed by the Cortex-M4F FPU
+//
+//*****************************************************************************
+#if !defined(CONTROL_MATH_FIXED) && !defined(CONTROL_MATH_FLOAT)
+#define CONTROL_MATH_FIXED
+#endif
+
+#if defined(CONTROL_MATH_FIXED) && defined(CONTROL_MATH_FLOAT)
+#error "Select only one of CONTROL_MATH_FIXED and CONTROL_MATH_FLOAT"
+#endif
+
+//*****************************************************************************
+//
+// Number of motor axes.  The pins and peripherals of each axis are in
+// g_psMotorAxes[] (motor.c).
+//
+//*****************************************************************************
+#define MOTOR_NUM_AXES          2
+
+//*****************************************************************************
+//
+// Control loop rate [Hz]
+//
+//*****************************************************************************
+#define CONTROL_TICK_HZ         10000
+
+//*****************************************************************************
+//
+// Source of the control tick.  By default Timer 0 runs it, free of the PWM
+// generators, so duty updates land anywhere in the PWM period and wait up
+// to a period for the next update event.  Define CONTROL_TICK_PWM to run it
+// from the load event (middle of the on time) of the PWM generator of the
+// first axis instead, every CONTROL_PWM_DIVIDER PWM periods.  The duty
+// written by the controllers then takes effect half a period after the
+// sample, at the next zero of the counter, as long as the computation fits
+// in that half period.  CONTROL_TICK_HZ must be the PWM frequency (20 kHz)
+// divided by CONTROL_PWM_DIVIDER.
+//
+//*****************************************************************************
+//#define CONTROL_TICK_PWM
+#define CONTROL_PWM_DIVIDER     2
+
+//*****************************************************************************
+//
+// The outer (position) loop of the cascaded controllers runs every
+// MOTOR_POSITION_DECIMATION control ticks, the inner (velocity) loop on
+// every tick
+//
+//*****************************************************************************
+#define MOTOR_POSITION_DECIMATION   4
+
+//*****************************************************************************
+//
+// Define MOTOR_CURRENT_LOOP to close a PI current loop per axis underneath
+// the velocity loop (current.c).  ADC0 samples the current sensor of every
+// axis on the load event of the PWM generator of the first axis, in the
+// middle of the on time where the sample is the mean winding current, and
+// uDMA moves the samples to a double buffer.  The current loop runs on
+// every PWM period and the velocity loop output becomes its reference, in
+// percent of MOTOR_CURRENT_MAX_MA.  Without it the velocity loop drives the
+// duty cycle directly.
+//
+// The current sensors are bidirectional Hall sensors in series with the
+// motors, MOTOR_CURRENT_ZERO_COUNT at 0 A and MOTOR_CURRENT_MA_PER_COUNT
+// per ADC count.
+//
+//*****************************************************************************
+//#define MOTOR_CURRENT_LOOP
+#define MOTOR_CURRENT_MAX_MA        4000
+#define MOTOR_CURRENT_ZERO_COUNT    2048
+#define MOTOR_CURRENT_MA_PER_COUNT  8.95
+
+//*****************************************************************************
+//
+// Velocity estimator of the controllers (velocity.h).  At most one of these
+// should be defined, the M/T method is used otherwise:
+//
+// VELOCITY_EST_DIFFERENCE -> position change over a fixed window
+// VELOCITY_EST_TRACKER    -> fixed point alpha-beta tracker
+//
+//*****************************************************************************
+//#define VELOCITY_EST_DIFFERENCE
+//#define VELOCITY_EST_TRACKER
+
+#if defined(VELOCITY_EST_DIFFERENCE) && defined(VELOCITY_EST_TRACKER)
+#error "Select only one of VELOCITY_EST_DIFFERENCE and VELOCITY_EST_TRACKER"
+#endif
+
+//*****************************************************************************
+//
+// Default trajectory limits in counts/s, counts/s^2 and counts/s^3.  The
+// encoders give 2000 counts/rev, so the velocity limit is 10 rev/s.
+//
+//*****************************************************************************
+#define TRAJECTORY_VELOCITY_MAX 20000.0f
+#define TRAJECTORY_ACCEL_MAX    200000.0f
+#define TRAJECTORY_JERK_MAX     4000000.0f
+
+//*****************************************************************************
+//
+// Console baud rate.  The binary trace (telemetry.c) of all eight channels
+// needs about 150 kB/s at full rate, so raise this (the UART supports up
+// to SysClk / 16) or use the trace decimation when streaming traces.
+//
+//*****************************************************************************
+#ifndef CONSOLE_BAUD
+#define CONSOLE_BAUD            115200
+#endif
+
+//*****************************************************************************
+//
+// Define ISR_TIMING to time the stages of Timer0IntHandler and the
+// scheduler tasks with the DWT cycle counter (isr_timing.c).  Type "timing"
+// or "tasks" on the console for a report.
+//
+//*****************************************************************************
+//#define ISR_TIMING
+
+//*****************************************************************************
+//
+// Define CONTROL_RAMFUNC to run the vector table and the code of the control
+// tick from SRAM: the tick handlers, the scheduler tick, the planners, the
+// controllers, the velocity estimators and MotorDrive().  Each of these
+// functions is placed in the .ramfunc section, which tm4c123gh6pm.cmd links
+// to run in SRAM and loads in flash, and the vector table is linked to run
+// at 0x20000000.  ResetISR copies both before the C initialization and
+// points the NVIC at the copy of the vector table.
+//
+// Above 40 MHz the flash has wait states that its prefetch buffer hides for
+// straight line code but not on taken branches, so the duration of the
+// handler varies with the path taken through it.  Code in SRAM has no wait
+// states but its fetches share the system bus with the data accesses, so
+// compare the "timing" report (min, max and jitter) of both builds.  The
+// driverlib and run-time library functions called on the way stay in flash.
+//
+// The linker command file needs the symbol as well: add
+// --define=CONTROL_RAMFUNC to the linker options too.
+//
+//*****************************************************************************
+//#define CONTROL_RAMFUNC
+
+#endif // __MOTOR_CONFIG_H__
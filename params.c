@@ -0,0 +1,362 @@
+//*****************************************************************************
+//
+// params.c - Tuning parameters, kept in the internal EEPROM.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "motor_config.h"
+#include "clock_config.h"
+#include "control_math.h"
+#include "motor.h"
+#include "params.h"
+
+//*****************************************************************************
+//
+// Default controller gains, see motor.h for the units.  They are tuned on
+// the model in host/plant.c: the feedforward gains invert its steady state
+// speed (1820 counts/s per %) and its inertia, the velocity loop crosses
+// over at about 100 rad/s with the integrator corner on the mechanical time
+// constant, and the position loop is four times slower.
+//
+// With the current loop u sets the torque instead, MOTOR_CURRENT_MAX_MA /
+// 100 per % or about 12700 counts/s^2 per % on the model.  The velocity
+// loop then crosses over at about 300 rad/s, and the current loop at about
+// 1 kHz with its integrator corner on the electrical time constant L/R.
+//
+//*****************************************************************************
+#ifdef MOTOR_CURRENT_LOOP
+#define PARAM_KP_DEFAULT        25.0
+#define PARAM_KV_DEFAULT        0.024
+#define PARAM_KI_DEFAULT        1.8                     // per second
+#define PARAM_KVFF_DEFAULT      0.00004
+#define PARAM_KAFF_DEFAULT      0.0000785
+#else
+#define PARAM_KP_DEFAULT        25.0
+#define PARAM_KV_DEFAULT        0.005
+#define PARAM_KI_DEFAULT        0.05                    // per second
+#define PARAM_KVFF_DEFAULT      0.00055
+#define PARAM_KAFF_DEFAULT      0.0000524
+#endif
+#define PARAM_KPC_DEFAULT       0.052
+#define PARAM_KIC_DEFAULT       105.0                   // per second
+
+//*****************************************************************************
+//
+// Other defaults: the maximum output of the velocity loops [%], and the
+// period of the QEI velocity capture [us], which does not depend on the
+// system clock.  The controllers estimate the velocity from the position
+// instead (velocity.h), the capture stays available through
+// QEIVelocityGet() for comparison.
+//
+//*****************************************************************************
+#define PARAM_OUTPUT_LIMIT_DEFAULT      40
+#define PARAM_VELOCITY_PERIOD_DEFAULT   CLOCK_QEI_VELOCITY_US
+
+//*****************************************************************************
+//
+// Conversion of the console values
+//
+//*****************************************************************************
+#define PARAM_TYPE_GAIN         0       // Gain [1e-6]
+#define PARAM_TYPE_GAIN_NANO    1       // Gain [1e-9]
+#define PARAM_TYPE_GAIN_TICK    2       // Per tick gain, given per second
+#define PARAM_TYPE_GAIN_PWM     3       // Per PWM period gain, per second
+#define PARAM_TYPE_SIGNAL       4       // control_t [%]
+#define PARAM_TYPE_FLOAT        5       // float
+#define PARAM_TYPE_INT          6       // int32_t or uint32_t
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+tParams g_sParams;
+
+//
+// Copy of the parameters being written to the EEPROM, so that a gain
+// changed meanwhile by the control interrupt (autotune.c) cannot make the
+// image disagree with its CRC
+//
+static tParams g_sParamsImage;
+
+const tParamInfo g_psParamInfo[PARAM_COUNT] =
+{
+    { "kp",     offsetof(tParams, Kp),            PARAM_TYPE_GAIN,
+      MOTOR_NUM_AXES, 0, CONTROL_GAIN_MICRO_MAX, false },
+    { "kv",     offsetof(tParams, Kv),            PARAM_TYPE_GAIN,
+      MOTOR_NUM_AXES, 0, CONTROL_GAIN_MICRO_MAX, false },
+    { "ki",     offsetof(tParams, Ki),            PARAM_TYPE_GAIN_TICK,
+      MOTOR_NUM_AXES, 0, INT32_MAX, false },
+    { "kvff",   offsetof(tParams, Kvff),          PARAM_TYPE_GAIN,
+      MOTOR_NUM_AXES, 0, CONTROL_GAIN_MICRO_MAX, false },
+    { "kaff",   offsetof(tParams, Kaff),          PARAM_TYPE_GAIN_NANO,
+      MOTOR_NUM_AXES, 0, INT32_MAX, false },
+    { "kpc",    offsetof(tParams, KpCurrent),     PARAM_TYPE_GAIN,
+      MOTOR_NUM_AXES, 0, CONTROL_GAIN_MICRO_MAX, false },
+    { "kic",    offsetof(tParams, KiCurrent),     PARAM_TYPE_GAIN_PWM,
+      MOTOR_NUM_AXES, 0, INT32_MAX, false },
+    { "ulimit", offsetof(tParams, OutputLimit),   PARAM_TYPE_SIGNAL,
+      1, 1, 100, false },
+    { "vmax",   offsetof(tParams, VelocityMax),   PARAM_TYPE_FLOAT,
+      1, 1, INT32_MAX, false },
+    { "amax",   offsetof(tParams, AccelMax),      PARAM_TYPE_FLOAT,
+      1, 1, INT32_MAX, false },
+    { "jmax",   offsetof(tParams, JerkMax),       PARAM_TYPE_FLOAT,
+      1, 1, INT32_MAX, false },
+    { "start",  offsetof(tParams, StartPosition), PARAM_TYPE_INT,
+      MOTOR_NUM_AXES, INT32_MIN, INT32_MAX, true },
+    { "velper", offsetof(tParams, VelocityPeriod), PARAM_TYPE_INT,
+      1, 1, UINT32_MAX / CLOCK_PER_US(SYSTEM_CLOCK_HZ), true }
+};
+
+//*****************************************************************************
+//
+// CRC-32 (IEEE 802.3, reflected) one nibble at a time, small enough for
+// flash and fast enough for the few hundred bytes checked at reset
+//
+//*****************************************************************************
+static const uint32_t g_pui32ParamsCrcTable[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t ParamsCrc(const tParams *psParams)
+{
+    const uint8_t *pui8Data = (const uint8_t *)psParams;
+    uint32_t ui32Crc = 0xFFFFFFFF;
+    uint32_t i;
+
+    for (i = 0; i < offsetof(tParams, Crc); i++)
+    {
+        ui32Crc ^= pui8Data[i];
+        ui32Crc = (ui32Crc >> 4) ^ g_pui32ParamsCrcTable[ui32Crc & 0x0F];
+        ui32Crc = (ui32Crc >> 4) ^ g_pui32ParamsCrcTable[ui32Crc & 0x0F];
+    }
+
+    return ~ui32Crc;
+}
+
+
+//*****************************************************************************
+//
+// Load the defaults into g_sParams
+//
+//*****************************************************************************
+void ParamsDefaults(void)
+{
+    uint32_t i;
+
+    g_sParams.Magic = PARAM_MAGIC;
+    g_sParams.Version = PARAM_VERSION;
+    g_sParams.Size = sizeof(tParams);
+    g_sParams.Format = PARAM_FORMAT;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        g_sParams.Kp[i] = CONTROL_GAIN(PARAM_KP_DEFAULT);
+        g_sParams.Kv[i] = CONTROL_GAIN(PARAM_KV_DEFAULT);
+        g_sParams.Ki[i] = CONTROL_GAIN(PARAM_KI_DEFAULT / CONTROL_TICK_HZ);
+        g_sParams.Kvff[i] = CONTROL_GAIN(PARAM_KVFF_DEFAULT);
+        g_sParams.Kaff[i] = CONTROL_GAIN(PARAM_KAFF_DEFAULT);
+        g_sParams.KpCurrent[i] = CONTROL_GAIN(PARAM_KPC_DEFAULT);
+        g_sParams.KiCurrent[i] = CONTROL_GAIN(PARAM_KIC_DEFAULT / MOTOR_PWM_HZ);
+        g_sParams.StartPosition[i] = 0;
+    }
+
+    g_sParams.OutputLimit = CONTROL_CONST(PARAM_OUTPUT_LIMIT_DEFAULT);
+    g_sParams.VelocityMax = TRAJECTORY_VELOCITY_MAX;
+    g_sParams.AccelMax = TRAJECTORY_ACCEL_MAX;
+    g_sParams.JerkMax = TRAJECTORY_JERK_MAX;
+    g_sParams.VelocityPeriod = PARAM_VELOCITY_PERIOD_DEFAULT;
+
+    g_sParams.Crc = ParamsCrc(&g_sParams);
+}
+
+
+//*****************************************************************************
+//
+// Read the parameters from the EEPROM into g_sParams, or load the defaults
+// if there is no valid image.  Called once at reset, before
+// MotorConfigure().  Returns one of the PARAM_LOADED.. codes.
+//
+//*****************************************************************************
+uint32_t ParamsLoad(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0))
+    {
+    }
+
+    if (EEPROMInit() != EEPROM_INIT_OK)
+    {
+        ParamsDefaults();
+        return PARAM_EEPROM_ERROR;
+    }
+
+    EEPROMRead((uint32_t *)&g_sParams, PARAM_EEPROM_ADDRESS, sizeof(tParams));
+
+    //
+    // An erased EEPROM reads as all ones
+    //
+    if (g_sParams.Magic != PARAM_MAGIC)
+    {
+        ParamsDefaults();
+        return PARAM_BLANK;
+    }
+
+    if ((g_sParams.Version != PARAM_VERSION) ||
+        (g_sParams.Size != sizeof(tParams)) ||
+        (g_sParams.Format != PARAM_FORMAT))
+    {
+        ParamsDefaults();
+        return PARAM_BAD_LAYOUT;
+    }
+
+    if (g_sParams.Crc != ParamsCrc(&g_sParams))
+    {
+        ParamsDefaults();
+        return PARAM_BAD_CRC;
+    }
+
+    return PARAM_LOADED;
+}
+
+
+//*****************************************************************************
+//
+// Write the running parameters to the EEPROM.  Blocks for the EEPROM
+// programming time, some milliseconds.  Returns false if it failed.
+//
+//*****************************************************************************
+bool ParamsCommit(void)
+{
+    bool bMasked;
+
+    bMasked = IntMasterDisable();
+    memcpy(&g_sParamsImage, &g_sParams, sizeof(tParams));
+    if (!bMasked)
+        IntMasterEnable();
+
+    g_sParamsImage.Magic = PARAM_MAGIC;
+    g_sParamsImage.Version = PARAM_VERSION;
+    g_sParamsImage.Size = sizeof(tParams);
+    g_sParamsImage.Format = PARAM_FORMAT;
+    g_sParamsImage.Crc = ParamsCrc(&g_sParamsImage);
+
+    return EEPROMProgram((uint32_t *)&g_sParamsImage, PARAM_EEPROM_ADDRESS,
+                         sizeof(tParams)) == 0;
+}
+
+
+//*****************************************************************************
+//
+// Element ui32Index of parameter ui32Param of g_psParamInfo[] in console
+// units.  Returns false if there is no such element.
+//
+//*****************************************************************************
+bool ParamGet(uint32_t ui32Param, uint32_t ui32Index, int32_t *pi32Value)
+{
+    const tParamInfo *psInfo;
+    void *pvField;
+
+    if ((ui32Param >= PARAM_COUNT) ||
+        (ui32Index >= g_psParamInfo[ui32Param].ui32Count))
+        return false;
+
+    psInfo = &g_psParamInfo[ui32Param];
+    pvField = (uint8_t *)&g_sParams + psInfo->ui32Offset + 4 * ui32Index;
+
+    switch (psInfo->ui32Type)
+    {
+        case PARAM_TYPE_GAIN:
+            *pi32Value = ControlGainToMicro(*(control_gain_t *)pvField);
+            break;
+        case PARAM_TYPE_GAIN_NANO:
+            *pi32Value = ControlGainToNano(*(control_gain_t *)pvField);
+            break;
+        case PARAM_TYPE_GAIN_TICK:
+            *pi32Value = ControlGainToMicroRate(*(control_gain_t *)pvField,
+                                                CONTROL_TICK_HZ);
+            break;
+        case PARAM_TYPE_GAIN_PWM:
+            *pi32Value = ControlGainToMicroRate(*(control_gain_t *)pvField,
+                                                MOTOR_PWM_HZ);
+            break;
+        case PARAM_TYPE_SIGNAL:
+            *pi32Value = CONTROL_TO_INT(*(control_t *)pvField);
+            break;
+        case PARAM_TYPE_FLOAT:
+            *pi32Value = (int32_t)*(float *)pvField;
+            break;
+        default:
+            *pi32Value = *(int32_t *)pvField;
+            break;
+    }
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Set element ui32Index of parameter ui32Param of g_psParamInfo[] from a
+// console value.  Every field is a single word, so the control interrupt
+// sees either the old or the new value.  Returns false if there is no such
+// element or the value is out of range.
+//
+//*****************************************************************************
+bool ParamSet(uint32_t ui32Param, uint32_t ui32Index, int32_t i32Value)
+{
+    const tParamInfo *psInfo;
+    void *pvField;
+
+    if ((ui32Param >= PARAM_COUNT) ||
+        (ui32Index >= g_psParamInfo[ui32Param].ui32Count))
+        return false;
+
+    psInfo = &g_psParamInfo[ui32Param];
+    if ((i32Value < psInfo->i32Min) || (i32Value > psInfo->i32Max))
+        return false;
+
+    pvField = (uint8_t *)&g_sParams + psInfo->ui32Offset + 4 * ui32Index;
+
+    switch (psInfo->ui32Type)
+    {
+        case PARAM_TYPE_GAIN:
+            *(control_gain_t *)pvField = ControlGainFromMicro(i32Value);
+            break;
+        case PARAM_TYPE_GAIN_NANO:
+            *(control_gain_t *)pvField = ControlGainFromNano(i32Value);
+            break;
+        case PARAM_TYPE_GAIN_TICK:
+            *(control_gain_t *)pvField =
+                ControlGainFromMicroRate(i32Value, CONTROL_TICK_HZ);
+            break;
+        case PARAM_TYPE_GAIN_PWM:
+            *(control_gain_t *)pvField =
+                ControlGainFromMicroRate(i32Value, MOTOR_PWM_HZ);
+            break;
+        case PARAM_TYPE_SIGNAL:
+            *(control_t *)pvField = CONTROL_FROM_INT(i32Value);
+            break;
+        case PARAM_TYPE_FLOAT:
+            *(float *)pvField = (float)i32Value;
+            break;
+        default:
+            *(int32_t *)pvField = i32Value;
+            break;
+    }
+
+    return true;
+}
@@ -0,0 +1,137 @@
+//*****************************************************************************
+//
+// params.h - Tuning parameters, kept in the internal EEPROM.
+//
+// g_sParams holds every value that used to be a compile time constant of
+// the controllers: the gains of all loops, the output limit, the
+// trajectory limits, the initial positions and the QEI velocity capture
+// period.  The control interrupt reads the gains from it directly, so it
+// is laid out like g_sMotor, one array element per axis, and every field
+// is a 32-bit word in the representation the controllers use.
+//
+// The EEPROM holds an image of the whole structure at PARAM_EEPROM_ADDRESS.
+// ParamsLoad() reads it back with a single EEPROMRead() and only checks the
+// header and the CRC, so a reset costs no parsing.  An image that is
+// blank, corrupt or of another layout (version, number of axes or control
+// arithmetic) is ignored and the defaults of params.c are used instead.
+// ParamsCommit() writes the running values back.
+//
+// The initial positions and the velocity capture period are applied by
+// MotorConfigure(), so changes to them take effect at the next reset.
+//
+//*****************************************************************************
+
+#ifndef __PARAMS_H__
+#define __PARAMS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor_config.h"
+#include "control_math.h"
+
+//*****************************************************************************
+//
+// Identification of the EEPROM image.  Raise PARAM_VERSION whenever the
+// layout of tParams changes.
+//
+//*****************************************************************************
+#define PARAM_MAGIC             0x4D505241
+#define PARAM_VERSION           2
+#define PARAM_EEPROM_ADDRESS    0
+
+#ifdef CONTROL_MATH_FLOAT
+#define PARAM_FORMAT            (0x100 | MOTOR_NUM_AXES)
+#else
+#define PARAM_FORMAT            (0x000 | MOTOR_NUM_AXES)
+#endif
+
+//*****************************************************************************
+//
+// Parameter block.  All fields are 32 bits wide, so the size is a whole
+// number of EEPROM words.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t Magic;                                 // PARAM_MAGIC
+    uint32_t Version;                               // PARAM_VERSION
+    uint32_t Size;                                  // sizeof(tParams)
+    uint32_t Format;                                // PARAM_FORMAT
+
+    control_gain_t Kp[MOTOR_NUM_AXES];              // [(counts/s)/count]
+    control_gain_t Kv[MOTOR_NUM_AXES];              // [%/(counts/s)]
+    control_gain_t Ki[MOTOR_NUM_AXES];              // [%/(counts/s) per tick]
+    control_gain_t Kvff[MOTOR_NUM_AXES];            // [%/(counts/s)]
+    control_gain_t Kaff[MOTOR_NUM_AXES];            // [%/(counts/s^2)]
+    control_gain_t KpCurrent[MOTOR_NUM_AXES];       // [%/mA]
+    control_gain_t KiCurrent[MOTOR_NUM_AXES];       // [%/mA per PWM period]
+    control_t OutputLimit;                          // Velocity loop [%]
+
+    float VelocityMax;                              // [counts/s]
+    float AccelMax;                                 // [counts/s^2]
+    float JerkMax;                                  // [counts/s^3]
+
+    int32_t StartPosition[MOTOR_NUM_AXES];          // At reset [counts]
+    uint32_t VelocityPeriod;                        // QEI capture [us]
+
+    uint32_t Crc;                                   // CRC-32 of the above
+}
+tParams;
+
+//*****************************************************************************
+//
+// Result of ParamsLoad()
+//
+//*****************************************************************************
+#define PARAM_LOADED            0       // Image read from the EEPROM
+#define PARAM_BLANK             1       // No image, defaults used
+#define PARAM_BAD_LAYOUT        2       // Other version or build, defaults
+#define PARAM_BAD_CRC           3       // Corrupt image, defaults used
+#define PARAM_EEPROM_ERROR      4       // EEPROM failed, defaults used
+
+//*****************************************************************************
+//
+// Parameters as seen from the console.  Each is one value, or one value
+// per axis, shown and set as an integer in the units of the gain commands.
+//
+//*****************************************************************************
+#define PARAM_COUNT             13
+
+//
+// Numbers of the gains the gain commands set
+//
+#define PARAM_KP                0
+#define PARAM_KV                1
+#define PARAM_KI                2
+#define PARAM_KVFF              3
+#define PARAM_KAFF              4
+
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32Offset;        // Of the first element in tParams
+    uint32_t ui32Type;          // How console values are converted
+    uint32_t ui32Count;         // 1 or MOTOR_NUM_AXES
+    int32_t i32Min;             // Range of the console value
+    int32_t i32Max;
+    bool bReset;                // Takes effect at the next reset
+}
+tParamInfo;
+
+extern tParams g_sParams;
+extern const tParamInfo g_psParamInfo[PARAM_COUNT];
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern uint32_t ParamsLoad(void);
+extern bool ParamsCommit(void);
+extern void ParamsDefaults(void);
+extern bool ParamGet(uint32_t ui32Param, uint32_t ui32Index,
+                     int32_t *pi32Value);
+extern bool ParamSet(uint32_t ui32Param, uint32_t ui32Index,
+                     int32_t i32Value);
+
+#endif // __PARAMS_H__
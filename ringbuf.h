@@ -0,0 +1,272 @@
+//*****************************************************************************
+//
+// ringbuf.h - Single producer, single consumer byte ring buffers.
+//
+// The capacity is a power of two, checked when the buffer is defined with
+// RINGBUF_DEFINE(), so a position in the buffer is an index masked with
+// Size - 1.  Write and Read run freely over the whole 32-bit range and are
+// only masked on access; Write - Read is the number of bytes held, also
+// across the wrap of the indices, and a full buffer needs no spare byte.
+//
+// Only the producer writes Write and only the consumer writes Read, so
+// neither side masks interrupts.  The indices are published in order:
+//
+//   producer: check Read, store the bytes, release, store Write
+//   consumer: load Write, acquire, load the bytes, release, store Read
+//
+// RINGBUF_ACQUIRE() and RINGBUF_RELEASE() are a DMB on the Cortex-M, which
+// also orders the buffer against a uDMA transfer started after the index
+// is read, and the matching fences of the host compiler, where the two
+// sides are threads (tools/ringbuf_stress.cpp).
+//
+// The producer can hold bytes back: RingBufStage() stores a byte after the
+// ones already staged without publishing it, RingBufUnstage() takes the
+// last staged byte back and RingBufPublish() hands all of them to the
+// consumer at once.  RingBufPut() and RingBufWrite() stage and publish in
+// one go.
+//
+//*****************************************************************************
+
+#ifndef __RINGBUF_H__
+#define __RINGBUF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+//
+// Memory barriers
+//
+//*****************************************************************************
+#if defined(ccs)
+#define RINGBUF_ACQUIRE()       __asm("    dmb")
+#define RINGBUF_RELEASE()       __asm("    dmb")
+#elif defined(__GNUC__)
+#define RINGBUF_ACQUIRE()       __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define RINGBUF_RELEASE()       __atomic_thread_fence(__ATOMIC_RELEASE)
+#else
+#error "No memory barrier for this compiler"
+#endif
+
+//*****************************************************************************
+//
+// One ring buffer
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t *Data;
+    uint32_t Mask;              // Size - 1
+    volatile uint32_t Write;    // Published by the producer
+    volatile uint32_t Read;     // Released by the consumer
+    uint32_t Stage;             // Producer only, end of the staged bytes
+}
+tRingBuf;
+
+//*****************************************************************************
+//
+// Define an empty ring buffer sName of ui32Size bytes, and its storage.
+// The size must be a power of two.
+//
+//*****************************************************************************
+#define RINGBUF_DEFINE(sName, ui32Size)                                       \
+    typedef char sName##SizeCheck[(((ui32Size) & ((ui32Size) - 1)) == 0) &&   \
+                                  ((ui32Size) >= 2) ? 1 : -1];                \
+    static uint8_t sName##Data[ui32Size];                                     \
+    static tRingBuf sName = { sName##Data, (ui32Size) - 1, 0, 0, 0 }
+
+//*****************************************************************************
+//
+// Either side
+//
+//*****************************************************************************
+
+//
+// Bytes published and not yet released
+//
+static inline uint32_t
+RingBufUsed(const tRingBuf *psRing)
+{
+    uint32_t ui32Read = psRing->Read;
+
+    return psRing->Write - ui32Read;
+}
+
+//*****************************************************************************
+//
+// Producer side
+//
+//*****************************************************************************
+
+//
+// Bytes that can still be staged
+//
+static inline uint32_t
+RingBufFree(const tRingBuf *psRing)
+{
+    return psRing->Mask + 1 - (psRing->Stage - psRing->Read);
+}
+
+static inline bool
+RingBufStage(tRingBuf *psRing, uint8_t ui8Byte)
+{
+    uint32_t ui32Stage = psRing->Stage;
+
+    if (ui32Stage - psRing->Read > psRing->Mask)
+        return false;
+
+    psRing->Data[ui32Stage & psRing->Mask] = ui8Byte;
+    psRing->Stage = ui32Stage + 1;
+
+    return true;
+}
+
+static inline bool
+RingBufUnstage(tRingBuf *psRing)
+{
+    if (psRing->Stage == psRing->Write)
+        return false;
+
+    psRing->Stage--;
+
+    return true;
+}
+
+static inline void
+RingBufPublish(tRingBuf *psRing)
+{
+    RINGBUF_RELEASE();
+    psRing->Write = psRing->Stage;
+}
+
+static inline bool
+RingBufPut(tRingBuf *psRing, uint8_t ui8Byte)
+{
+    if (!RingBufStage(psRing, ui8Byte))
+        return false;
+
+    RingBufPublish(psRing);
+
+    return true;
+}
+
+//
+// Stage and publish all of ui32Len bytes, or none if they do not fit
+//
+static inline bool
+RingBufWrite(tRingBuf *psRing, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    uint32_t ui32Stage, ui32Index, ui32Span, i;
+
+    if (RingBufFree(psRing) < ui32Len)
+        return false;
+
+    //
+    // Copy up to the end of the storage, then from its start
+    //
+    ui32Stage = psRing->Stage;
+    ui32Index = ui32Stage & psRing->Mask;
+    ui32Span = psRing->Mask + 1 - ui32Index;
+    if (ui32Span > ui32Len)
+        ui32Span = ui32Len;
+
+    for (i = 0; i < ui32Span; i++)
+        psRing->Data[ui32Index + i] = pui8Data[i];
+    for (; i < ui32Len; i++)
+        psRing->Data[i - ui32Span] = pui8Data[i];
+
+    psRing->Stage = ui32Stage + ui32Len;
+    RingBufPublish(psRing);
+
+    return true;
+}
+
+//*****************************************************************************
+//
+// Consumer side
+//
+//*****************************************************************************
+
+static inline bool
+RingBufGet(tRingBuf *psRing, uint8_t *pui8Byte)
+{
+    uint32_t ui32Read = psRing->Read;
+
+    if (psRing->Write == ui32Read)
+        return false;
+
+    RINGBUF_ACQUIRE();
+    *pui8Byte = psRing->Data[ui32Read & psRing->Mask];
+    RINGBUF_RELEASE();
+    psRing->Read = ui32Read + 1;
+
+    return true;
+}
+
+//
+// Byte ui32Offset after the oldest one, which must have been published
+//
+static inline uint8_t
+RingBufPeek(const tRingBuf *psRing, uint32_t ui32Offset)
+{
+    RINGBUF_ACQUIRE();
+
+    return psRing->Data[(psRing->Read + ui32Offset) & psRing->Mask];
+}
+
+//
+// Published bytes from the free running index ui32From that are contiguous
+// in the storage, which start at *ppui8Data.  ui32From is Read, or a
+// position between Read and Write the consumer keeps itself.
+//
+static inline uint32_t
+RingBufSpan(const tRingBuf *psRing, uint32_t ui32From, uint8_t **ppui8Data)
+{
+    uint32_t ui32Len, ui32Index;
+
+    ui32Len = psRing->Write - ui32From;
+    RINGBUF_ACQUIRE();
+
+    ui32Index = ui32From & psRing->Mask;
+    if (ui32Len > psRing->Mask + 1 - ui32Index)
+        ui32Len = psRing->Mask + 1 - ui32Index;
+
+    *ppui8Data = &psRing->Data[ui32Index];
+
+    return ui32Len;
+}
+
+//
+// Release the ui32Len oldest bytes
+//
+static inline void
+RingBufRelease(tRingBuf *psRing, uint32_t ui32Len)
+{
+    RINGBUF_RELEASE();
+    psRing->Read += ui32Len;
+}
+
+//
+// Release everything published so far
+//
+static inline void
+RingBufFlush(tRingBuf *psRing)
+{
+    RingBufRelease(psRing, psRing->Write - psRing->Read);
+}
+
+//*****************************************************************************
+//
+// Empty the buffer from neither side.  Neither the producer nor the
+// consumer may run meanwhile.
+//
+//*****************************************************************************
+static inline void
+RingBufReset(tRingBuf *psRing)
+{
+    psRing->Write = 0;
+    psRing->Read = 0;
+    psRing->Stage = 0;
+}
+
+#endif // __RINGBUF_H__
@@ -0,0 +1,194 @@
+//*****************************************************************************
+//
+// scheduler.c - Static multi-rate scheduler driven by the control tick.
+//
+// Released is only written by SchedTick() and Completed only by the runner
+// of the task (SchedTick() for hard tasks, SchedService() for soft ones),
+// so a soft task is pending while the two differ and no interrupt masking
+// is needed.  The time of a soft task includes the interrupts that
+// preempted it.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+#include "isr_timing.h"
+#include "scheduler.h"
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+tSchedState g_psSchedState[SCHED_MAX_TASKS];
+
+static uint32_t g_ui32SchedNumTasks = 0;
+
+
+//*****************************************************************************
+//
+// Count the tasks and release each of them on the first tick.  Call before
+// the control interrupt is enabled.
+//
+//*****************************************************************************
+void SchedInit(void)
+{
+    uint32_t i;
+
+    for (i = 0; g_psSchedTasks[i].pfnTask; i++)
+    {
+        ASSERT(i < SCHED_MAX_TASKS);
+        ASSERT(g_psSchedTasks[i].ui32Period > 0);
+        ASSERT((i == 0) || (g_psSchedTasks[i].ui32Period >=
+                            g_psSchedTasks[i - 1].ui32Period));
+
+        g_psSchedState[i].Countdown = 1;
+        g_psSchedState[i].Released = 0;
+        g_psSchedState[i].Completed = 0;
+        g_psSchedState[i].Overruns = 0;
+#ifdef ISR_TIMING
+        IsrTimingClear(&g_psSchedState[i].Cycles);
+#endif
+    }
+
+    g_ui32SchedNumTasks = i;
+}
+
+
+//*****************************************************************************
+//
+// Run one released task
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(SchedRun, ".ramfunc")
+#endif
+static void SchedRun(uint32_t ui32Task)
+{
+#ifdef ISR_TIMING
+    uint32_t ui32Start = ISR_TIMING_CYCLES();
+
+    g_psSchedTasks[ui32Task].pfnTask();
+    IsrTimingAdd(&g_psSchedState[ui32Task].Cycles,
+                 ISR_TIMING_CYCLES() - ui32Start);
+#else
+    g_psSchedTasks[ui32Task].pfnTask();
+#endif
+
+    g_psSchedState[ui32Task].Completed++;
+}
+
+
+//*****************************************************************************
+//
+// Release the tasks that are due, run the hard ones and pend PendSV for the
+// soft ones.  Called once per tick from the control interrupt.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(SchedTick, ".ramfunc")
+#endif
+void SchedTick(void)
+{
+    tSchedState *psState;
+    bool bSoft = false;
+    uint32_t i;
+
+    for (i = 0; i < g_ui32SchedNumTasks; i++)
+    {
+        psState = &g_psSchedState[i];
+
+        if (--psState->Countdown)
+            continue;
+        psState->Countdown = g_psSchedTasks[i].ui32Period;
+
+        if (g_psSchedTasks[i].ui32Kind == SCHED_HARD)
+        {
+            psState->Released++;
+            SchedRun(i);
+        }
+        else if (psState->Released != psState->Completed)
+        {
+            psState->Overruns++;
+        }
+        else
+        {
+            psState->Released++;
+            bSoft = true;
+        }
+    }
+
+    if (bSoft)
+        HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PEND_SV;
+}
+
+
+//*****************************************************************************
+//
+// Run the pending soft tasks, shortest period first.  Called from the
+// PendSV handler.
+//
+//*****************************************************************************
+void SchedService(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < g_ui32SchedNumTasks; i++)
+    {
+        if ((g_psSchedTasks[i].ui32Kind == SCHED_SOFT) &&
+            (g_psSchedState[i].Released != g_psSchedState[i].Completed))
+            SchedRun(i);
+    }
+}
+
+
+//*****************************************************************************
+//
+// Print the tasks, their overruns and (with ISR_TIMING) their execution
+// times on the console, then start a new measurement window
+//
+//*****************************************************************************
+void SchedReport(void)
+{
+    const tSchedTask *psTask;
+    uint32_t i, ui32Released, ui32Overruns;
+#ifdef ISR_TIMING
+    tIsrTimingStat sCycles;
+#endif
+    bool bMasked;
+
+    UARTprintf("\nTasks [ticks / cycles]\n");
+
+    for (i = 0; i < g_ui32SchedNumTasks; i++)
+    {
+        psTask = &g_psSchedTasks[i];
+
+        //
+        // Take a consistent copy, the handlers keep updating the original
+        //
+        bMasked = IntMasterDisable();
+        ui32Released = g_psSchedState[i].Released;
+        ui32Overruns = g_psSchedState[i].Overruns;
+        g_psSchedState[i].Overruns = 0;
+#ifdef ISR_TIMING
+        sCycles = g_psSchedState[i].Cycles;
+        IsrTimingClear(&g_psSchedState[i].Cycles);
+#endif
+        if (!bMasked)
+            IntMasterEnable();
+
+        UARTprintf("%8s: %s every %u, released %u, overruns %u%s\n",
+                   psTask->pcName,
+                   (psTask->ui32Kind == SCHED_HARD) ? "hard" : "soft",
+                   psTask->ui32Period, ui32Released, ui32Overruns,
+                   ui32Overruns ? " <-- OVERRUN" : "");
+#ifdef ISR_TIMING
+        IsrTimingPrint("", &sCycles);
+#endif
+    }
+}
@@ -0,0 +1,92 @@
+//*****************************************************************************
+//
+// scheduler.h - Static multi-rate scheduler driven by the control tick.
+//
+// The application lists its periodic work in g_psSchedTasks[], terminated
+// with a zero entry, in rate-monotonic order: shortest period first.  Each
+// task has a period in control ticks and runs either
+//
+// SCHED_HARD -> inside the control interrupt, in table order, or
+// SCHED_SOFT -> deferred to the PendSV handler, below every other interrupt
+//
+// SchedTick() is called once per tick from the timer interrupt.  It keeps a
+// countdown per task, so releasing a task costs a decrement and a compare
+// rather than a division.  A soft task that is released again before its
+// previous release has run is counted as an overrun and the new release is
+// dropped.  Hard tasks cannot fall behind on their own; a handler running
+// over its tick shows up in the isr_timing overrun counter instead.
+//
+// With ISR_TIMING defined the execution time of every task is measured
+// with the DWT cycle counter.  SchedReport() prints it.
+//
+//*****************************************************************************
+
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <stdint.h>
+#include "isr_timing.h"
+
+//*****************************************************************************
+//
+// Maximum number of entries of g_psSchedTasks[]
+//
+//*****************************************************************************
+#define SCHED_MAX_TASKS         8
+
+//*****************************************************************************
+//
+// Where a task runs
+//
+//*****************************************************************************
+#define SCHED_HARD              0   // Control interrupt
+#define SCHED_SOFT              1   // PendSV
+
+//*****************************************************************************
+//
+// One entry of the task table
+//
+//*****************************************************************************
+typedef void (*pfnSchedTask)(void);
+
+typedef struct
+{
+    const char *pcName;         // Name in the report
+    pfnSchedTask pfnTask;       // Called once per period
+    uint32_t ui32Period;        // [ticks]
+    uint32_t ui32Kind;          // SCHED_HARD or SCHED_SOFT
+}
+tSchedTask;
+
+extern const tSchedTask g_psSchedTasks[];
+
+//*****************************************************************************
+//
+// Run time state of one task
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t Countdown;                 // Ticks to the next release
+    volatile uint32_t Released;         // Written by SchedTick()
+    volatile uint32_t Completed;        // Written by the task's runner
+    volatile uint32_t Overruns;         // Releases dropped
+#ifdef ISR_TIMING
+    tIsrTimingStat Cycles;              // Execution time
+#endif
+}
+tSchedState;
+
+extern tSchedState g_psSchedState[SCHED_MAX_TASKS];
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void SchedInit(void);
+extern void SchedTick(void);
+extern void SchedService(void);
+extern void SchedReport(void);
+
+#endif // __SCHEDULER_H__
@@ -0,0 +1,474 @@
+//*****************************************************************************
+//
+// scope.c - Triggered capture of the loop signals into RAM.
+//
+// Recording and triggering run in the control interrupt, arming and
+// dumping in the foreground and in PendSV.  The foreground only
+// reconfigures the scope with g_ui32ScopeState at SCOPE_IDLE, where the
+// interrupt leaves it alone, and the dump only reads a capture in
+// SCOPE_DONE, which the interrupt no longer writes.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "utils/uartstdio.h"
+#include "frame.h"
+#include "scope.h"
+
+//*****************************************************************************
+//
+// Size of a block frame payload: header plus the block
+//
+//*****************************************************************************
+#define SCOPE_HEADER_SIZE       16
+#define SCOPE_PAYLOAD_SIZE      (SCOPE_HEADER_SIZE + SCOPE_BLOCK_SIZE)
+
+#if SCOPE_PAYLOAD_SIZE > FRAME_MAX_PAYLOAD
+#error "Scope blocks do not fit in FRAME_MAX_PAYLOAD"
+#endif
+
+//*****************************************************************************
+//
+// Largest encoding of one channel of a sample, a five byte varint.  A block
+// has to hold the first sample of a block and one more.
+//
+//*****************************************************************************
+#define SCOPE_CHANNEL_MAX       5
+
+#if SCOPE_BLOCK_SIZE < ((4 + SCOPE_CHANNEL_MAX) * SCOPE_NUM_CHANNELS)
+#error "SCOPE_BLOCK_SIZE is too small for the channels"
+#endif
+
+//*****************************************************************************
+//
+// Bookkeeping of one block of the ring
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t FirstTick;         // Tick of the first sample
+    uint32_t FirstSample;       // Samples recorded before it since arming
+    uint16_t Samples;           // Samples in the block
+    uint16_t Length;            // Bytes used
+}
+tScopeBlock;
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+static uint8_t g_ppui8ScopeData[SCOPE_NUM_BLOCKS][SCOPE_BLOCK_SIZE];
+static tScopeBlock g_psScopeBlocks[SCOPE_NUM_BLOCKS];
+static uint32_t g_ui32ScopeOldest;          // Ring of the used blocks
+static uint32_t g_ui32ScopeNewest;
+static uint32_t g_ui32ScopeUsed;
+
+static tScopeSample g_sScopeSample;         // Sample being handed over
+static int32_t g_pi32ScopeLast[SCOPE_NUM_CHANNELS];
+
+//
+// Configuration, only written while the scope is idle
+//
+static uint32_t g_ui32ScopeMask = SCOPE_CH_ALL;
+static uint8_t g_pui8ScopeChannels[SCOPE_NUM_CHANNELS];    // Selected
+static uint32_t g_ui32ScopeNumChannels;
+static uint32_t g_ui32ScopeSampleMax;       // Largest encoded sample
+static uint32_t g_ui32ScopePre;
+static uint32_t g_ui32ScopePost;
+static uint32_t g_ui32ScopeDecimation = 1;
+static uint32_t g_ui32ScopeTrigMode = SCOPE_TRIG_NOW;
+static uint32_t g_ui32ScopeTrigChannel = 0;
+static int32_t g_i32ScopeTrigLevel = 0;
+
+//
+// Recording
+//
+static uint32_t g_ui32ScopeCountdown;       // Ticks to the next sample
+static uint32_t g_ui32ScopeSamples;         // Recorded since arming
+static uint32_t g_ui32ScopeTrigSample;      // Sample number of the trigger
+static uint32_t g_ui32ScopeTrigTick;
+static int32_t g_i32ScopeTrigLast;          // Trigger channel, last sample
+
+//
+// Dump, run by ScopeService()
+//
+static volatile bool g_bScopeDumping = false;
+static uint32_t g_ui32ScopeDumpBlock;
+
+volatile uint32_t g_ui32ScopeState = SCOPE_IDLE;
+
+
+//*****************************************************************************
+//
+// Set the trigger.  ui32Channel is the bit number of a SCOPE_CH_xxx
+// channel, which does not need to be recorded.  Takes effect at the next
+// ScopeArm().
+//
+//*****************************************************************************
+void ScopeTriggerSet(uint32_t ui32Mode, uint32_t ui32Channel, int32_t i32Level)
+{
+    g_ui32ScopeTrigMode = ui32Mode;
+    g_ui32ScopeTrigChannel = (ui32Channel < SCOPE_NUM_CHANNELS) ?
+                             ui32Channel : 0;
+    g_i32ScopeTrigLevel = i32Level;
+}
+
+
+//*****************************************************************************
+//
+// Start a capture of the channels in ui32Mask, one sample every
+// ui32Decimation ticks, with ui32Pre samples before the trigger and
+// ui32Post samples from it.  The pre-trigger samples are kept as long as
+// the buffer holds them alongside the post-trigger ones; if the buffer
+// fills first the capture ends early.  Returns false for an empty mask or
+// no post-trigger samples.
+//
+//*****************************************************************************
+bool ScopeArm(uint32_t ui32Mask, uint32_t ui32Pre, uint32_t ui32Post,
+              uint32_t ui32Decimation)
+{
+    uint32_t i;
+
+    ui32Mask &= SCOPE_CH_ALL;
+    if (!ui32Mask || !ui32Post)
+        return false;
+
+    g_ui32ScopeState = SCOPE_IDLE;
+    g_bScopeDumping = false;
+
+    g_ui32ScopeMask = ui32Mask;
+    g_ui32ScopeNumChannels = 0;
+    for (i = 0; i < SCOPE_NUM_CHANNELS; i++)
+        if (ui32Mask & (1 << i))
+            g_pui8ScopeChannels[g_ui32ScopeNumChannels++] = (uint8_t)i;
+    g_ui32ScopeSampleMax = SCOPE_CHANNEL_MAX * g_ui32ScopeNumChannels;
+
+    g_ui32ScopePre = ui32Pre;
+    g_ui32ScopePost = ui32Post;
+    g_ui32ScopeDecimation = ui32Decimation ? ui32Decimation : 1;
+    g_ui32ScopeCountdown = 1;
+    g_ui32ScopeSamples = 0;
+    g_ui32ScopeOldest = 0;
+    g_ui32ScopeNewest = 0;
+    g_ui32ScopeUsed = 0;
+
+    g_ui32ScopeState = SCOPE_ARMED;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Abandon the capture or the dump in progress
+//
+//*****************************************************************************
+void ScopeStop(void)
+{
+    g_ui32ScopeState = SCOPE_IDLE;
+    g_bScopeDumping = false;
+}
+
+
+//*****************************************************************************
+//
+// Producer side - returns the sample to fill when one is due, or 0 if the
+// scope is not recording or the sample is decimated away
+//
+//*****************************************************************************
+tScopeSample *ScopeAlloc(void)
+{
+    if ((g_ui32ScopeState != SCOPE_ARMED) &&
+        (g_ui32ScopeState != SCOPE_TRIGGERED))
+        return 0;
+
+    if (--g_ui32ScopeCountdown)
+        return 0;
+    g_ui32ScopeCountdown = g_ui32ScopeDecimation;
+
+    return &g_sScopeSample;
+}
+
+
+//*****************************************************************************
+//
+// Make room for a new block.  While armed the oldest block is overwritten
+// freely; after the trigger only while the blocks after it still reach
+// back to the first pre-trigger sample.  Returns false when the buffer is
+// full.
+//
+//*****************************************************************************
+static bool ScopeBlockNew(void)
+{
+    uint32_t ui32Next;
+
+    if (g_ui32ScopeUsed < SCOPE_NUM_BLOCKS)
+    {
+        if (g_ui32ScopeUsed++ && (++g_ui32ScopeNewest == SCOPE_NUM_BLOCKS))
+            g_ui32ScopeNewest = 0;
+        return true;
+    }
+
+    ui32Next = g_ui32ScopeOldest + 1;
+    if (ui32Next == SCOPE_NUM_BLOCKS)
+        ui32Next = 0;
+
+    if ((g_ui32ScopeState == SCOPE_TRIGGERED) &&
+        (g_psScopeBlocks[ui32Next].FirstSample >
+         g_ui32ScopeTrigSample - g_ui32ScopePre))
+        return false;
+
+    g_ui32ScopeNewest = g_ui32ScopeOldest;
+    g_ui32ScopeOldest = ui32Next;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Store a sample, whole at the start of a block and as varint coded
+// differences after that.  Returns false when the buffer is full.
+//
+//*****************************************************************************
+static bool ScopeStore(const tScopeSample *psSample)
+{
+    tScopeBlock *psBlock = &g_psScopeBlocks[g_ui32ScopeNewest];
+    uint8_t *pui8Data;
+    uint32_t ui32Delta, i;
+    int32_t i32Value;
+
+    if (!g_ui32ScopeUsed ||
+        (psBlock->Length + g_ui32ScopeSampleMax > SCOPE_BLOCK_SIZE))
+    {
+        if (!ScopeBlockNew())
+            return false;
+
+        psBlock = &g_psScopeBlocks[g_ui32ScopeNewest];
+        pui8Data = g_ppui8ScopeData[g_ui32ScopeNewest];
+
+        for (i = 0; i < g_ui32ScopeNumChannels; i++)
+        {
+            i32Value = psSample->Value[g_pui8ScopeChannels[i]];
+            pui8Data[0] = (uint8_t)i32Value;
+            pui8Data[1] = (uint8_t)(i32Value >> 8);
+            pui8Data[2] = (uint8_t)(i32Value >> 16);
+            pui8Data[3] = (uint8_t)(i32Value >> 24);
+            pui8Data += 4;
+            g_pi32ScopeLast[i] = i32Value;
+        }
+
+        psBlock->FirstTick = psSample->Tick;
+        psBlock->FirstSample = g_ui32ScopeSamples;
+        psBlock->Samples = 1;
+        psBlock->Length = 4 * g_ui32ScopeNumChannels;
+
+        return true;
+    }
+
+    pui8Data = &g_ppui8ScopeData[g_ui32ScopeNewest][psBlock->Length];
+
+    for (i = 0; i < g_ui32ScopeNumChannels; i++)
+    {
+        i32Value = psSample->Value[g_pui8ScopeChannels[i]];
+
+        //
+        // Zigzag: 0, -1, 1, -2.. map to 0, 1, 2, 3..  The difference wraps
+        // like the decoder's sum does.
+        //
+        ui32Delta = (uint32_t)i32Value - (uint32_t)g_pi32ScopeLast[i];
+        ui32Delta = (ui32Delta << 1) ^ (uint32_t)((int32_t)ui32Delta >> 31);
+        g_pi32ScopeLast[i] = i32Value;
+
+        while (ui32Delta >= 0x80)
+        {
+            *pui8Data++ = (uint8_t)(ui32Delta | 0x80);
+            ui32Delta >>= 7;
+        }
+        *pui8Data++ = (uint8_t)ui32Delta;
+    }
+
+    psBlock->Length = pui8Data - g_ppui8ScopeData[g_ui32ScopeNewest];
+    psBlock->Samples++;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Producer side - check the trigger and record the sample returned by
+// ScopeAlloc().  bSwitch is the input of SCOPE_TRIG_SWITCH.
+//
+//*****************************************************************************
+void ScopeCommit(bool bSwitch)
+{
+    const tScopeSample *psSample = &g_sScopeSample;
+    int32_t i32Trig = psSample->Value[g_ui32ScopeTrigChannel];
+    bool bTrigger = false;
+
+    if (!g_ui32ScopeSamples)
+        g_i32ScopeTrigLast = i32Trig;
+
+    if ((g_ui32ScopeState == SCOPE_ARMED) &&
+        (g_ui32ScopeSamples >= g_ui32ScopePre))
+    {
+        switch (g_ui32ScopeTrigMode)
+        {
+            case SCOPE_TRIG_CHANGE:
+                bTrigger = (i32Trig != g_i32ScopeTrigLast);
+                break;
+            case SCOPE_TRIG_LEVEL:
+                bTrigger = (i32Trig > g_i32ScopeTrigLevel) ||
+                           (i32Trig < -g_i32ScopeTrigLevel);
+                break;
+            case SCOPE_TRIG_SWITCH:
+                bTrigger = bSwitch;
+                break;
+            default:
+                bTrigger = true;
+                break;
+        }
+    }
+    g_i32ScopeTrigLast = i32Trig;
+
+    if (!ScopeStore(psSample))
+    {
+        g_ui32ScopeState = SCOPE_DONE;
+        return;
+    }
+
+    if (bTrigger)
+    {
+        g_ui32ScopeTrigSample = g_ui32ScopeSamples;
+        g_ui32ScopeTrigTick = psSample->Tick;
+        g_ui32ScopeState = SCOPE_TRIGGERED;
+    }
+
+    g_ui32ScopeSamples++;
+
+    if ((g_ui32ScopeState == SCOPE_TRIGGERED) &&
+        (g_ui32ScopeSamples - g_ui32ScopeTrigSample >= g_ui32ScopePost))
+        g_ui32ScopeState = SCOPE_DONE;
+}
+
+
+//*****************************************************************************
+//
+// Start sending a completed capture, ScopeService() does the work
+//
+//*****************************************************************************
+void ScopeDump(void)
+{
+    if (g_ui32ScopeState != SCOPE_DONE)
+        return;
+
+    g_ui32ScopeDumpBlock = 0;
+    g_bScopeDumping = true;
+}
+
+
+//*****************************************************************************
+//
+// Store a little endian value
+//
+//*****************************************************************************
+static void ScopePut16(uint8_t *pui8Dst, uint32_t ui32Value)
+{
+    pui8Dst[0] = (uint8_t)ui32Value;
+    pui8Dst[1] = (uint8_t)(ui32Value >> 8);
+}
+
+static void ScopePut32(uint8_t *pui8Dst, uint32_t ui32Value)
+{
+    ScopePut16(pui8Dst, ui32Value);
+    ScopePut16(pui8Dst + 2, ui32Value >> 16);
+}
+
+
+//*****************************************************************************
+//
+// Send the blocks of a dump as long as they fit in the UART transmit
+// buffer.  Called periodically from PendSV (a soft task), so the dump goes
+// out at the pace of the UART without ever waiting for it.
+//
+//*****************************************************************************
+void ScopeService(void)
+{
+    static uint8_t pui8Payload[SCOPE_PAYLOAD_SIZE];
+    static uint8_t pui8Frame[1 + FRAME_MAX_ENCODED(SCOPE_PAYLOAD_SIZE)];
+    const tScopeBlock *psBlock;
+    uint32_t ui32Block, ui32Len, i;
+
+    while (g_bScopeDumping)
+    {
+        if (g_ui32ScopeDumpBlock >= g_ui32ScopeUsed)
+        {
+            g_bScopeDumping = false;
+            break;
+        }
+
+        if (UARTTxBytesFree() <= (int)sizeof(pui8Frame))
+            break;
+
+        ui32Block = g_ui32ScopeOldest + g_ui32ScopeDumpBlock;
+        if (ui32Block >= SCOPE_NUM_BLOCKS)
+            ui32Block -= SCOPE_NUM_BLOCKS;
+        psBlock = &g_psScopeBlocks[ui32Block];
+
+        pui8Payload[0] = SCOPE_FRAME_BLOCK;
+        ScopePut16(&pui8Payload[1], g_ui32ScopeMask);
+        pui8Payload[3] = (uint8_t)g_ui32ScopeDumpBlock;
+        ScopePut32(&pui8Payload[4], psBlock->FirstTick);
+        ScopePut16(&pui8Payload[8], g_ui32ScopeDecimation);
+        ScopePut32(&pui8Payload[10], g_ui32ScopeTrigTick);
+        ScopePut16(&pui8Payload[14], psBlock->Samples);
+        for (i = 0; i < psBlock->Length; i++)
+            pui8Payload[SCOPE_HEADER_SIZE + i] = g_ppui8ScopeData[ui32Block][i];
+
+        //
+        // A delimiter first ends any console text sent since the last frame
+        //
+        pui8Frame[0] = 0;
+        ui32Len = FrameEncode(pui8Payload, SCOPE_HEADER_SIZE + psBlock->Length,
+                              &pui8Frame[1]);
+        UARTwriteRaw(pui8Frame, ui32Len + 1);
+
+        g_ui32ScopeDumpBlock++;
+    }
+}
+
+
+//*****************************************************************************
+//
+// Print the state of the scope
+//
+//*****************************************************************************
+void ScopeReport(void)
+{
+    static const char *const ppcState[] =
+    {
+        "idle", "armed", "triggered", "done"
+    };
+    uint32_t ui32Bytes, ui32Samples, i;
+
+    ui32Bytes = 0;
+    ui32Samples = 0;
+    for (i = 0; i < g_ui32ScopeUsed; i++)
+    {
+        ui32Bytes += g_psScopeBlocks[i].Length;
+        ui32Samples += g_psScopeBlocks[i].Samples;
+    }
+
+    UARTprintf("Scope %s | mask 0x%03x | trigger %u on channel %u, level %d\n",
+               ppcState[g_ui32ScopeState], g_ui32ScopeMask,
+               g_ui32ScopeTrigMode, g_ui32ScopeTrigChannel,
+               g_i32ScopeTrigLevel);
+    UARTprintf("  %u samples in %u/%u blocks, %u bytes", ui32Samples,
+               g_ui32ScopeUsed, SCOPE_NUM_BLOCKS, ui32Bytes);
+    if (g_ui32ScopeState >= SCOPE_TRIGGERED)
+        UARTprintf(" | trigger at tick %u", g_ui32ScopeTrigTick);
+    UARTprintf("\n");
+}
@@ -0,0 +1,140 @@
+//*****************************************************************************
+//
+// scope.h - Triggered capture of the loop signals into RAM.
+//
+// The binary trace (telemetry.h) is limited by the UART to a few channels
+// at full rate.  The scope records the selected channels at the control
+// rate into a RAM buffer instead, keeping a number of samples before a
+// trigger and up to a number of samples from it, and sends the capture
+// afterwards at whatever rate the UART allows.
+//
+// The control interrupt hands over one sample per tick the same way as the
+// trace:
+//
+//   psSample = ScopeAlloc();
+//   if (psSample)
+//   {
+//       psSample->Value[...] = ...;
+//       ScopeCommit(bSwitch);
+//   }
+//
+// A trigger fires when, after the pre-trigger samples have been recorded,
+//
+// SCOPE_TRIG_NOW    -> always (forced capture)
+// SCOPE_TRIG_CHANGE -> the trigger channel changes, e.g. a setpoint
+// SCOPE_TRIG_LEVEL  -> the magnitude of the trigger channel exceeds the
+//                      level, e.g. an error threshold
+// SCOPE_TRIG_SWITCH -> the bSwitch argument of ScopeCommit() is set, SW1
+//
+// The buffer is a ring of SCOPE_BLOCK_SIZE byte blocks.  Each block starts
+// with the selected channels of its first sample as int32, and every
+// further sample stores the difference of each channel to the previous
+// sample, zigzag mapped to unsigned and written as a base 128 varint.
+// Small changes, which is what the loop signals are from one tick to the
+// next, take a single byte.  Blocks decode on their own, so the oldest can
+// be overwritten while waiting for the trigger.
+//
+// ScopeDump() sends the capture oldest block first, one COBS/CRC frame
+// (see frame.h) per block, each preceded by a frame delimiter so console
+// text sent in between cannot damage a frame.  Payload, little endian:
+//
+//   [0]      SCOPE_FRAME_BLOCK
+//   [1..2]   Channel mask (SCOPE_CH_xxx)
+//   [3]      Block number in the dump, from 0
+//   [4..7]   Tick of the first sample
+//   [8..9]   Decimation, ticks between samples
+//   [10..13] Tick of the trigger sample
+//   [14..15] Number of samples n
+//   [16..]   The block data described above
+//
+// tools/trace_decode.cpp turns the frames into CSV.
+//
+//*****************************************************************************
+
+#ifndef __SCOPE_H__
+#define __SCOPE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+//
+// Channels.  Bits 0..7 are those of the binary trace, controller outputs
+// are Q16.16 percent.
+//
+//*****************************************************************************
+#define SCOPE_CH_POSITION1      0x001
+#define SCOPE_CH_POSITION2      0x002
+#define SCOPE_CH_VELOCITY1      0x004
+#define SCOPE_CH_VELOCITY2      0x008
+#define SCOPE_CH_ERROR1         0x010
+#define SCOPE_CH_ERROR2         0x020
+#define SCOPE_CH_U1             0x040
+#define SCOPE_CH_U2             0x080
+#define SCOPE_CH_SETPOINT1      0x100
+#define SCOPE_CH_SETPOINT2      0x200
+#define SCOPE_CH_ALL            0x3FF
+#define SCOPE_NUM_CHANNELS      10
+
+//*****************************************************************************
+//
+// Capture buffer.  It is the largest object in the 32 KB of SRAM, next to
+// about 14 KB of other data (the console buffers among them) and the 4 KB
+// stack of the .cproject, which leaves about 6 KB free.  The stack high
+// water mark of "stats" shows how much of the stack is really used before
+// any of it goes to the buffer.
+//
+//*****************************************************************************
+#define SCOPE_BUFFER_SIZE       8192    // Bytes
+#define SCOPE_BLOCK_SIZE        256     // Bytes, at most 65535
+#define SCOPE_NUM_BLOCKS        (SCOPE_BUFFER_SIZE / SCOPE_BLOCK_SIZE)
+
+#define SCOPE_FRAME_BLOCK       0x02    // Frame type of a capture block
+
+//*****************************************************************************
+//
+// Trigger modes and scope states
+//
+//*****************************************************************************
+#define SCOPE_TRIG_NOW          0
+#define SCOPE_TRIG_CHANGE       1
+#define SCOPE_TRIG_LEVEL        2
+#define SCOPE_TRIG_SWITCH       3
+
+#define SCOPE_IDLE              0
+#define SCOPE_ARMED             1       // Recording, waiting for the trigger
+#define SCOPE_TRIGGERED         2       // Recording after the trigger
+#define SCOPE_DONE              3       // Capture complete
+
+//*****************************************************************************
+//
+// One sample, all channels are recorded, the mask is applied when it is
+// stored
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t Tick;
+    int32_t Value[SCOPE_NUM_CHANNELS];
+}
+tScopeSample;
+
+extern volatile uint32_t g_ui32ScopeState;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void ScopeTriggerSet(uint32_t ui32Mode, uint32_t ui32Channel,
+                            int32_t i32Level);
+extern bool ScopeArm(uint32_t ui32Mask, uint32_t ui32Pre, uint32_t ui32Post,
+                     uint32_t ui32Decimation);
+extern void ScopeStop(void);
+extern tScopeSample *ScopeAlloc(void);
+extern void ScopeCommit(bool bSwitch);
+extern void ScopeDump(void);
+extern void ScopeService(void);
+extern void ScopeReport(void);
+
+#endif // __SCOPE_H__
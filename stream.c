@@ -0,0 +1,546 @@
+//*****************************************************************************
+//
+// stream.c - Setpoint streaming from a host planner.
+//
+// StreamPoll() runs in the main loop in place of the command parser while
+// a stream is on.  It collects the received bytes into frames, queues the
+// points and sends the credit reports.  StreamStep() runs in the control
+// interrupt.  The foreground owns Write, AxisMask, Ended and Abort, the
+// interrupt owns Read, Phase, the setpoints and State from STREAM_FILLING
+// on.  The interrupt only looks at the stream while Enabled, which the
+// foreground sets last when it starts a stream and clears first when it
+// ends one.  The point FIFOs publish Write and Read in the order of the
+// byte rings (ringbuf.h).
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "utils/uartstdio.h"
+#include "ringbuf.h"
+#include "frame.h"
+#include "telemetry.h"
+#include "stream.h"
+
+#ifndef UART_BUFFERED
+#error "Streaming needs the buffered uartstdio (UART_BUFFERED)"
+#endif
+
+#if (STREAM_FIFO_SIZE & (STREAM_FIFO_SIZE - 1)) != 0
+#error "STREAM_FIFO_SIZE must be a power of two"
+#endif
+
+#if (3 + STREAM_POINTS_MAX * STREAM_POINT_SIZE) > FRAME_MAX_PAYLOAD
+#error "Point frames do not fit in FRAME_MAX_PAYLOAD"
+#endif
+
+//*****************************************************************************
+//
+// Size of a credit report
+//
+//*****************************************************************************
+#define STREAM_REPORT_HEADER    8
+#define STREAM_REPORT_SIZE      (STREAM_REPORT_HEADER + MOTOR_NUM_AXES * 8)
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+tStream g_sStream;
+
+//
+// Foreground only
+//
+static uint8_t g_pui8StreamFrame[FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD)];
+static uint32_t g_ui32StreamFrameLen;           // Bytes of the frame so far
+static bool g_bStreamFrameLong;                 // Frame did not fit
+static uint8_t g_ui8StreamSequence;             // Next expected
+static uint32_t g_ui32StreamError;              // STREAM_ERR_xxx
+static uint32_t g_ui32StreamLastFrame;          // Ticks at the last frame
+static uint32_t g_pui32StreamLast[MOTOR_NUM_AXES];  // Last point received
+
+//
+// What the last report said
+//
+static uint32_t g_ui32StreamReportState;
+static uint32_t g_ui32StreamReportError;
+static uint32_t g_pui32StreamReportRead[MOTOR_NUM_AXES];
+static uint32_t g_pui32StreamReportUnderruns[MOTOR_NUM_AXES];
+
+
+//*****************************************************************************
+//
+// Little endian fields
+//
+//*****************************************************************************
+static uint32_t StreamGet32(const uint8_t *pui8Src)
+{
+    return (uint32_t)pui8Src[0] | ((uint32_t)pui8Src[1] << 8) |
+           ((uint32_t)pui8Src[2] << 16) | ((uint32_t)pui8Src[3] << 24);
+}
+
+static void StreamPut32(uint8_t *pui8Dst, uint32_t ui32Value)
+{
+    pui8Dst[0] = (uint8_t)ui32Value;
+    pui8Dst[1] = (uint8_t)(ui32Value >> 8);
+    pui8Dst[2] = (uint8_t)(ui32Value >> 16);
+    pui8Dst[3] = (uint8_t)(ui32Value >> 24);
+}
+
+
+//*****************************************************************************
+//
+// Send a credit report if anything the host needs to know has changed, or
+// always with bForce.  A report that does not fit in the UART buffer is
+// tried again on the next call.
+//
+//*****************************************************************************
+static void StreamReport(bool bForce)
+{
+    static uint8_t pui8Payload[STREAM_REPORT_SIZE];
+    static uint8_t pui8Frame[FRAME_MAX_ENCODED(STREAM_REPORT_SIZE)];
+    uint32_t pui32Read[MOTOR_NUM_AXES], pui32Underruns[MOTOR_NUM_AXES];
+    uint32_t ui32State, ui32Len, i;
+    bool bDue = bForce;
+
+    ui32State = g_sStream.State;
+    if ((ui32State != g_ui32StreamReportState) ||
+        (g_ui32StreamError != g_ui32StreamReportError))
+        bDue = true;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        pui32Read[i] = g_sStream.Read[i];
+        pui32Underruns[i] = g_sStream.Underruns[i];
+        if (((pui32Read[i] - g_pui32StreamReportRead[i]) >=
+             STREAM_CREDIT_BATCH) ||
+            (pui32Underruns[i] != g_pui32StreamReportUnderruns[i]))
+            bDue = true;
+    }
+
+    if (!bDue)
+        return;
+
+    pui8Payload[0] = STREAM_FRAME_CREDITS;
+    pui8Payload[1] = (uint8_t)ui32State;
+    pui8Payload[2] = (uint8_t)g_ui32StreamError;
+    pui8Payload[3] = g_ui8StreamSequence;
+    pui8Payload[4] = (uint8_t)STREAM_FIFO_SIZE;
+    pui8Payload[5] = (uint8_t)(STREAM_FIFO_SIZE >> 8);
+    pui8Payload[6] = MOTOR_NUM_AXES;
+    pui8Payload[7] = (uint8_t)g_sStream.Period;
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        StreamPut32(&pui8Payload[STREAM_REPORT_HEADER + i * 8], pui32Read[i]);
+        StreamPut32(&pui8Payload[STREAM_REPORT_HEADER + i * 8 + 4],
+                    pui32Underruns[i]);
+    }
+
+    ui32Len = FrameEncode(pui8Payload, STREAM_REPORT_SIZE, pui8Frame);
+    if (UARTwriteRaw(pui8Frame, ui32Len) != (int)ui32Len)
+        return;
+
+    g_ui32StreamReportState = ui32State;
+    g_ui32StreamReportError = g_ui32StreamError;
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        g_pui32StreamReportRead[i] = pui32Read[i];
+        g_pui32StreamReportUnderruns[i] = pui32Underruns[i];
+    }
+}
+
+
+//*****************************************************************************
+//
+// Stop the stream with an error, the setpoints hold where they are
+//
+//*****************************************************************************
+static void StreamFail(uint32_t ui32Error)
+{
+    if (g_ui32StreamError == STREAM_ERR_NONE)
+        g_ui32StreamError = ui32Error;
+    g_sStream.Abort = true;
+}
+
+
+//*****************************************************************************
+//
+// Queue the points of a STREAM_FRAME_POINTS payload
+//
+//*****************************************************************************
+static void StreamPoints(const uint8_t *pui8Payload, uint32_t ui32Len)
+{
+    const uint8_t *pui8Point;
+    tStreamPoint *psPoint;
+    uint32_t ui32Count, ui32Axis, ui32Write, ui32Position, i;
+
+    ui32Count = pui8Payload[2];
+    if ((ui32Count > STREAM_POINTS_MAX) ||
+        (ui32Len != 3 + ui32Count * STREAM_POINT_SIZE))
+    {
+        StreamFail(STREAM_ERR_FRAME);
+        return;
+    }
+
+    for (i = 0; i < ui32Count; i++)
+    {
+        pui8Point = &pui8Payload[3 + i * STREAM_POINT_SIZE];
+        ui32Axis = pui8Point[0];
+        if (ui32Axis >= MOTOR_NUM_AXES)
+        {
+            StreamFail(STREAM_ERR_AXIS);
+            return;
+        }
+
+        ui32Write = g_sStream.Write[ui32Axis];
+        if ((ui32Write - g_sStream.Read[ui32Axis]) >= STREAM_FIFO_SIZE)
+        {
+            StreamFail(STREAM_ERR_OVERFLOW);
+            return;
+        }
+
+        //
+        // The position is extended like an encoder reading, by the wrapped
+        // difference to the previous point of the axis
+        //
+        ui32Position = StreamGet32(&pui8Point[1]);
+        psPoint = &g_sStream.Fifo[ui32Axis][ui32Write &
+                                            (STREAM_FIFO_SIZE - 1)];
+        psPoint->Delta = (int32_t)(ui32Position -
+                                   g_pui32StreamLast[ui32Axis]);
+        psPoint->Velocity = (int32_t)StreamGet32(&pui8Point[5]);
+        g_pui32StreamLast[ui32Axis] = ui32Position;
+
+        g_sStream.AxisMask |= 1 << ui32Axis;
+        RINGBUF_RELEASE();
+        g_sStream.Write[ui32Axis] = ui32Write + 1;
+    }
+}
+
+
+//*****************************************************************************
+//
+// Handle one received frame (without its delimiter)
+//
+//*****************************************************************************
+static void StreamFrame(const uint8_t *pui8Frame, uint32_t ui32Len)
+{
+    static uint8_t pui8Payload[FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD)];
+    int32_t i32Len;
+
+    //
+    // Empty frames are only delimiters
+    //
+    if (ui32Len == 0)
+        return;
+
+    i32Len = FrameDecode(pui8Frame, ui32Len, pui8Payload);
+    if (i32Len < 1)
+    {
+        StreamFail(STREAM_ERR_FRAME);
+        return;
+    }
+
+    g_ui32StreamLastFrame = g_sStream.Ticks;
+
+    switch (pui8Payload[0])
+    {
+        case STREAM_FRAME_POINTS:
+        case STREAM_FRAME_END:
+        {
+            if ((i32Len < 2) || g_sStream.Ended)
+            {
+                StreamFail(STREAM_ERR_FRAME);
+                break;
+            }
+            if (pui8Payload[1] != g_ui8StreamSequence)
+            {
+                StreamFail(STREAM_ERR_SEQUENCE);
+                break;
+            }
+            g_ui8StreamSequence++;
+
+            if (pui8Payload[0] == STREAM_FRAME_END)
+                g_sStream.Ended = true;
+            else if (i32Len < 3)
+                StreamFail(STREAM_ERR_FRAME);
+            else
+                StreamPoints(pui8Payload, (uint32_t)i32Len);
+            break;
+        }
+
+        case STREAM_FRAME_ABORT:
+        {
+            StreamFail(STREAM_ERR_ABORT);
+            break;
+        }
+
+        default:
+        {
+            StreamFail(STREAM_ERR_FRAME);
+            break;
+        }
+    }
+}
+
+
+//*****************************************************************************
+//
+// Switch the console to the stream protocol, with the streamed axes
+// starting at the setpoints pi64Start.  One point is taken every
+// ui32Period ticks.  Returns false if a stream is already on or the period
+// is out of range.  The trajectories must be at rest.
+//
+//*****************************************************************************
+bool StreamStart(uint32_t ui32Period, const int64_t *pi64Start)
+{
+    static const uint8_t ui8Delimiter = 0;
+    uint32_t i;
+
+    if ((g_sStream.State != STREAM_OFF) || (ui32Period == 0) ||
+        (ui32Period > 0xFF))
+        return false;
+
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        g_sStream.Write[i] = 0;
+        g_sStream.Read[i] = 0;
+        g_sStream.Start[i] = pi64Start[i];
+        g_sStream.Delta[i] = 0;
+        g_sStream.Position[i] = pi64Start[i];
+        g_sStream.Velocity[i] = 0;
+        g_sStream.Underruns[i] = 0;
+        g_pui32StreamLast[i] = (uint32_t)pi64Start[i];
+        g_pui32StreamReportRead[i] = 0;
+        g_pui32StreamReportUnderruns[i] = 0;
+    }
+    g_sStream.AxisMask = 0;
+    g_sStream.Ended = false;
+    g_sStream.Abort = false;
+    g_sStream.Period = ui32Period;
+    g_sStream.Reciprocal = 0xFFFFFFFF / ui32Period;
+    g_sStream.Phase = 0;
+    g_sStream.State = STREAM_FILLING;
+
+    g_ui32StreamFrameLen = 0;
+    g_bStreamFrameLong = false;
+    g_ui8StreamSequence = 0;
+    g_ui32StreamError = STREAM_ERR_NONE;
+    g_ui32StreamLastFrame = g_sStream.Ticks;
+    g_ui32StreamReportState = STREAM_OFF;
+    g_ui32StreamReportError = STREAM_ERR_NONE;
+
+    //
+    // Binary from here on: no echo, no status lines, and a delimiter to
+    // end the echoed command before the first report
+    //
+    UARTEchoSet(false);
+    TelemetryTextSet(false);
+    UARTwriteRaw(&ui8Delimiter, 1);
+
+    g_sStream.Enabled = true;
+    StreamReport(true);
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Run the stream protocol.  Returns false, and does nothing, while the
+// console is in text mode.  Called from the main loop.
+//
+//*****************************************************************************
+bool StreamPoll(void)
+{
+    uint8_t ui8Byte;
+    uint32_t i;
+    bool bEmpty;
+
+    if (g_sStream.State == STREAM_OFF)
+        return false;
+
+    //
+    // Collect frames up to their delimiters.  A frame too long to be valid
+    // is dropped as a whole.
+    //
+    while (UARTRxBytesAvail() && !g_sStream.Abort)
+    {
+        ui8Byte = UARTgetc();
+        if (ui8Byte == 0)
+        {
+            if (g_bStreamFrameLong)
+                StreamFail(STREAM_ERR_FRAME);
+            else
+                StreamFrame(g_pui8StreamFrame, g_ui32StreamFrameLen);
+            g_ui32StreamFrameLen = 0;
+            g_bStreamFrameLong = false;
+        }
+        else if (g_ui32StreamFrameLen < sizeof(g_pui8StreamFrame))
+            g_pui8StreamFrame[g_ui32StreamFrameLen++] = ui8Byte;
+        else
+            g_bStreamFrameLong = true;
+    }
+
+    //
+    // A host that had room to send and did not for STREAM_TIMEOUT_TICKS
+    // is gone
+    //
+    bEmpty = true;
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        if (g_sStream.Write[i] != g_sStream.Read[i])
+            bEmpty = false;
+    if (bEmpty && !g_sStream.Ended &&
+        ((g_sStream.Ticks - g_ui32StreamLastFrame) > STREAM_TIMEOUT_TICKS))
+        StreamFail(STREAM_ERR_TIMEOUT);
+
+    if (g_sStream.State != STREAM_DONE)
+    {
+        StreamReport(false);
+        return true;
+    }
+
+    //
+    // Finished - the last report must get out before the console goes
+    // back to text
+    //
+    if (g_ui32StreamReportState != STREAM_DONE)
+    {
+        StreamReport(true);
+        if (g_ui32StreamReportState != STREAM_DONE)
+            return true;
+    }
+
+    g_sStream.Enabled = false;
+    g_sStream.State = STREAM_OFF;
+    UARTFlushRx();
+    UARTEchoSet(true);
+    TelemetryTextSet(true);
+
+    UARTprintf("\nStream %s (%u), points taken", g_ui32StreamError ?
+               "stopped" : "done", g_ui32StreamError);
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        UARTprintf(" %u", g_sStream.Read[i]);
+    UARTprintf(", underruns");
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+        UARTprintf(" %u", g_sStream.Underruns[i]);
+    UARTprintf("\n");
+
+    return false;
+}
+
+
+//*****************************************************************************
+//
+// Advance the stream by one tick.  Returns true while it drives the
+// setpoints of the axes in AxisMask.  Called from the control interrupt.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(StreamStep, ".ramfunc")
+#endif
+bool StreamStep(void)
+{
+    uint32_t ui32Mask, ui32Read, ui32Taken, i;
+    const tStreamPoint *psPoint;
+
+    if (!g_sStream.Enabled)
+        return false;
+
+    g_sStream.Ticks++;
+
+    if (g_sStream.State == STREAM_DONE)
+        return false;
+
+    ui32Mask = g_sStream.AxisMask;
+
+    //
+    // Stop where the setpoints are
+    //
+    if (g_sStream.Abort)
+    {
+        for (i = 0; i < MOTOR_NUM_AXES; i++)
+            g_sStream.Velocity[i] = 0;
+        g_sStream.State = STREAM_DONE;
+        return true;
+    }
+
+    //
+    // Start when a FIFO is half full, or when all points have arrived
+    //
+    if (g_sStream.State == STREAM_FILLING)
+    {
+        for (i = 0; i < MOTOR_NUM_AXES; i++)
+            if ((g_sStream.Write[i] - g_sStream.Read[i]) >=
+                STREAM_FIFO_SIZE / 2)
+                g_sStream.State = STREAM_RUNNING;
+        if (g_sStream.Ended)
+            g_sStream.State = STREAM_RUNNING;
+        if (g_sStream.State != STREAM_RUNNING)
+            return true;
+    }
+
+    //
+    // Take the next point of every streamed axis at the start of a period.
+    // An axis without one holds its setpoint.
+    //
+    if (g_sStream.Phase == 0)
+    {
+        ui32Taken = 0;
+        for (i = 0; i < MOTOR_NUM_AXES; i++)
+        {
+            if (!(ui32Mask & (1 << i)))
+                continue;
+
+            g_sStream.Start[i] = g_sStream.Position[i];
+            ui32Read = g_sStream.Read[i];
+            if (ui32Read != g_sStream.Write[i])
+            {
+                RINGBUF_ACQUIRE();
+                psPoint = &g_sStream.Fifo[i][ui32Read &
+                                             (STREAM_FIFO_SIZE - 1)];
+                g_sStream.Delta[i] = psPoint->Delta;
+                g_sStream.Velocity[i] = psPoint->Velocity;
+                RINGBUF_RELEASE();
+                g_sStream.Read[i] = ui32Read + 1;
+                ui32Taken++;
+            }
+            else
+            {
+                g_sStream.Delta[i] = 0;
+                g_sStream.Velocity[i] = 0;
+                if (!g_sStream.Ended)
+                    g_sStream.Underruns[i]++;
+            }
+        }
+
+        if (!ui32Taken && g_sStream.Ended)
+        {
+            g_sStream.State = STREAM_DONE;
+            return true;
+        }
+
+        g_sStream.Phase = g_sStream.Period;
+    }
+
+    //
+    // Straight line to the point over the period, exactly on it at the end
+    //
+    g_sStream.Phase--;
+    for (i = 0; i < MOTOR_NUM_AXES; i++)
+    {
+        if (!(ui32Mask & (1 << i)))
+            continue;
+
+        if (g_sStream.Phase == 0)
+            g_sStream.Position[i] = g_sStream.Start[i] + g_sStream.Delta[i];
+        else
+            g_sStream.Position[i] = g_sStream.Start[i] +
+                (((int64_t)g_sStream.Delta[i] *
+                  (int64_t)((g_sStream.Period - g_sStream.Phase) *
+                            g_sStream.Reciprocal)) >> 32);
+    }
+
+    return true;
+}
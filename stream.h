@@ -0,0 +1,168 @@
+//*****************************************************************************
+//
+// stream.h - Setpoint streaming from a host planner.
+//
+// "stream <n>" switches the console to a binary protocol of COBS/CRC
+// frames (frame.h) over which the host sends setpoints planned off the
+// target, one point per axis every n control ticks.  Each point is an
+// axis, a position (low 32 bits, in counts) and a velocity feedforward
+// (counts/s).  The points of each axis go into a FIFO of
+// STREAM_FIFO_SIZE entries, and the control interrupt takes one per axis
+// every n ticks and moves the setpoint to it in a straight line over the
+// n ticks, with the point's velocity as the feedforward.  Setpoints do not
+// need a tick each: at 115200 baud a point costs 9 bytes, so two axes at
+// 10 kHz would need 180 kB/s.
+//
+// Flow control is by credits.  The host may have STREAM_FIFO_SIZE points
+// per axis outstanding; the target reports how many it has taken from each
+// FIFO, and the host sends a new point for every one taken:
+//
+//   credits = STREAM_FIFO_SIZE - (points sent - points taken)
+//
+// so with a host that keeps up the FIFOs stay full and never run dry.
+// Consumption starts once a FIFO is half full, or at the end of a short
+// stream.
+//
+// Host to target, little endian:
+//
+//   STREAM_FRAME_POINTS   [1] sequence number, [2] number of points n,
+//                         n times { [0] axis (0 based), [1..4] position,
+//                         [5..8] velocity }
+//   STREAM_FRAME_END      [1] sequence number - no more points, finish
+//                         the ones queued
+//   STREAM_FRAME_ABORT    stop now and hold the current setpoints
+//
+// The sequence number counts POINTS and END frames from 0.  Target to
+// host, whenever STREAM_CREDIT_BATCH points of an axis have been taken,
+// the state changes or an axis runs dry:
+//
+//   STREAM_FRAME_CREDITS  [1] state, [2] error, [3] next sequence number,
+//                         [4..5] STREAM_FIFO_SIZE, [6] number of axes,
+//                         [7] ticks per point, then per axis
+//                         { [0..3] points taken, [4..7] periods without a
+//                         point (underruns) }
+//
+// The first CREDITS frame, right after the command, says that the target
+// is in binary mode; the last one has the state STREAM_DONE, after which
+// the console returns to text.  A bad frame, a lost frame (sequence gap),
+// more points than credits, a bad axis or a host that stays silent for
+// STREAM_TIMEOUT_TICKS with the FIFOs empty ends the stream with an error,
+// holding the setpoints where they are.  The text status lines are
+// suppressed while streaming.
+//
+// tools/stream_send.cpp is the host side sender, and tools/stream_link.cpp
+// runs this file behind a pty for testing without a target.
+//
+//*****************************************************************************
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Sizes
+//
+//*****************************************************************************
+#define STREAM_FIFO_SIZE        128     // Points per axis, power of two
+#define STREAM_POINTS_MAX       32      // Points in one frame
+#define STREAM_POINT_SIZE       9       // Bytes of one point in a frame
+#define STREAM_CREDIT_BATCH     16      // Points taken before a report
+#define STREAM_TIMEOUT_TICKS    (2 * CONTROL_TICK_HZ)
+
+//*****************************************************************************
+//
+// Frame types, after those of telemetry.h and scope.h
+//
+//*****************************************************************************
+#define STREAM_FRAME_POINTS     0x03
+#define STREAM_FRAME_END        0x04
+#define STREAM_FRAME_ABORT      0x05
+#define STREAM_FRAME_CREDITS    0x06
+
+//*****************************************************************************
+//
+// States and errors
+//
+//*****************************************************************************
+#define STREAM_OFF              0       // Console in text mode
+#define STREAM_FILLING          1       // Waiting for the FIFOs to fill
+#define STREAM_RUNNING          2       // Taking points
+#define STREAM_DONE             3       // Finished or stopped
+
+#define STREAM_ERR_NONE         0
+#define STREAM_ERR_FRAME        1       // Bad CRC or malformed frame
+#define STREAM_ERR_SEQUENCE     2       // Frame lost
+#define STREAM_ERR_OVERFLOW     3       // Points beyond the credits
+#define STREAM_ERR_AXIS         4       // No such axis
+#define STREAM_ERR_TIMEOUT      5       // Host silent, FIFOs empty
+#define STREAM_ERR_ABORT        6       // STREAM_FRAME_ABORT received
+
+//*****************************************************************************
+//
+// One queued point, as the step from the previous point of the axis
+//
+//*****************************************************************************
+typedef struct
+{
+    int32_t Delta;              // [counts]
+    int32_t Velocity;           // Feedforward [counts/s]
+}
+tStreamPoint;
+
+//*****************************************************************************
+//
+// Stream state.  The foreground fills the FIFOs and the control interrupt
+// empties them, each FIFO with free running indices as in telemetry.c.
+// Position and Velocity are the setpoint and feedforward of the axes in
+// AxisMask while StreamStep() returns true.
+//
+//*****************************************************************************
+typedef struct
+{
+    tStreamPoint Fifo[MOTOR_NUM_AXES][STREAM_FIFO_SIZE];
+    volatile uint32_t Write[MOTOR_NUM_AXES];    // Written by the foreground
+    volatile uint32_t Read[MOTOR_NUM_AXES];     // Written by the interrupt,
+                                                // points taken
+    volatile uint32_t AxisMask;                 // Axes that received points
+    volatile bool Enabled;                      // Interrupt steps the stream
+    volatile bool Ended;                        // No more points will come
+    volatile bool Abort;                        // Stop now
+    volatile uint32_t State;                    // STREAM_xxx
+    uint32_t Period;                            // Ticks per point
+    uint32_t Reciprocal;                        // (2^32 - 1) / Period
+
+    uint32_t Phase;                             // Ticks left in the period
+    int64_t Start[MOTOR_NUM_AXES];              // Setpoint at its start
+    int32_t Delta[MOTOR_NUM_AXES];              // Step over the period
+    int64_t Position[MOTOR_NUM_AXES];           // Setpoint [counts]
+    int32_t Velocity[MOTOR_NUM_AXES];           // Feedforward [counts/s]
+    volatile uint32_t Underruns[MOTOR_NUM_AXES];
+    volatile uint32_t Ticks;                    // Ticks while enabled
+}
+tStream;
+
+extern tStream g_sStream;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern bool StreamStart(uint32_t ui32Period, const int64_t *pi64Start);
+extern bool StreamPoll(void);
+extern bool StreamStep(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __STREAM_H__
@@ -0,0 +1,330 @@
+//*****************************************************************************
+//
+// telemetry.c - Deferred status output from the control interrupt.
+//
+// The queue indices run freely and are masked on access.  Only the
+// producer (control interrupt) writes g_ui32TelemetryWrite and only the
+// consumer (PendSV) writes g_ui32TelemetryRead, so no interrupt masking
+// is needed.  A sample is published by the index store in
+// TelemetryCommit(), after all of its fields have been written.  The
+// binary trace queue works the same way.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+#include "fmt.h"
+#include "frame.h"
+#include "telemetry.h"
+
+#if (TELEMETRY_QUEUE_SIZE & (TELEMETRY_QUEUE_SIZE - 1)) != 0
+#error "TELEMETRY_QUEUE_SIZE must be a power of two"
+#endif
+
+#if (TRACE_QUEUE_SIZE & (TRACE_QUEUE_SIZE - 1)) != 0
+#error "TRACE_QUEUE_SIZE must be a power of two"
+#endif
+
+//*****************************************************************************
+//
+// Size of a trace frame payload: header plus all channels of every sample
+//
+//*****************************************************************************
+#define TRACE_HEADER_SIZE       10
+#define TRACE_PAYLOAD_SIZE      (TRACE_HEADER_SIZE + TRACE_SAMPLES_PER_FRAME * \
+                                 TRACE_NUM_CHANNELS * 4)
+
+#if TRACE_PAYLOAD_SIZE > FRAME_MAX_PAYLOAD
+#error "Trace frames do not fit in FRAME_MAX_PAYLOAD"
+#endif
+
+//*****************************************************************************
+//
+// Global Variables
+//
+//*****************************************************************************
+static tTelemetrySample g_psTelemetryQueue[TELEMETRY_QUEUE_SIZE];
+static volatile uint32_t g_ui32TelemetryWrite = 0;  // Written by producer
+static volatile uint32_t g_ui32TelemetryRead = 0;   // Written by consumer
+static volatile bool g_bTelemetryText = true;       // Status lines on
+
+volatile uint32_t g_ui32TelemetryDropped = 0;       // Samples lost (full)
+volatile uint32_t g_ui32TelemetryLinesLost = 0;     // Lines lost (UART)
+
+static tTraceSample g_psTraceQueue[TRACE_QUEUE_SIZE];
+static volatile uint32_t g_ui32TraceWrite = 0;      // Written by producer
+static volatile uint32_t g_ui32TraceRead = 0;       // Written by consumer
+static volatile bool g_bTraceOn = false;            // Trace running
+static volatile uint32_t g_ui32TraceMask = TRACE_CH_ALL;
+static volatile uint32_t g_ui32TraceDecimation = 1;
+static volatile uint32_t g_ui32TraceCountdown = 1;  // Ticks to next sample
+static volatile bool g_bTraceResync = false;        // Delimiter needed
+
+volatile uint32_t g_ui32TraceDropped = 0;           // Samples lost (full)
+volatile uint32_t g_ui32TraceFramesLost = 0;        // Frames lost (UART)
+
+
+//*****************************************************************************
+//
+// Run PendSV (the telemetry consumer) below every other interrupt
+//
+//*****************************************************************************
+void ConfigureTelemetry(void)
+{
+    IntPrioritySet(FAULT_PENDSV, 0xE0);
+}
+
+
+//*****************************************************************************
+//
+// Producer side - returns the next free slot, or 0 if the queue is full
+// (the sample is then dropped and counted)
+//
+//*****************************************************************************
+tTelemetrySample *TelemetryAlloc(void)
+{
+    uint32_t ui32Write = g_ui32TelemetryWrite;
+
+    if ((ui32Write - g_ui32TelemetryRead) >= TELEMETRY_QUEUE_SIZE)
+    {
+        g_ui32TelemetryDropped++;
+        return 0;
+    }
+
+    return &g_psTelemetryQueue[ui32Write & (TELEMETRY_QUEUE_SIZE - 1)];
+}
+
+
+//*****************************************************************************
+//
+// Producer side - publish the slot returned by TelemetryAlloc() and wake
+// the consumer
+//
+//*****************************************************************************
+void TelemetryCommit(void)
+{
+    g_ui32TelemetryWrite++;
+    HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PEND_SV;
+}
+
+
+//*****************************************************************************
+//
+// Consumer side - format and transmit everything queued.  Called from the
+// PendSV handler.
+//
+//*****************************************************************************
+void TelemetryService(void)
+{
+    static uint32_t ui32Reported = 0;
+    const tTelemetrySample *psSample;
+    uint32_t ui32Read = g_ui32TelemetryRead;
+    char pcLine[FMT_RECORD_SIZE(TELEMETRY_STATUS_FORMAT)];
+    char *pcEnd;
+
+    while (ui32Read != g_ui32TelemetryWrite)
+    {
+        psSample = &g_psTelemetryQueue[ui32Read & (TELEMETRY_QUEUE_SIZE - 1)];
+
+        //UARTprintf("\nM1 | p: %u, e: %d, u: %d", psSample->Position1, psSample->Error1, psSample->U1);
+        //UARTprintf("M2 | p: %u, e: %d, u: %d\n\n", psSample->Position2, psSample->Error2, psSample->U2);
+        if (!g_bTraceOn && g_bTelemetryText)
+        {
+            pcEnd = pcLine;
+            FMT_RECORD(pcEnd, TELEMETRY_STATUS_FORMAT, psSample);
+            if (UARTwriteRaw((const unsigned char *)pcLine,
+                             pcEnd - pcLine) == 0)
+                g_ui32TelemetryLinesLost++;
+        }
+
+        g_ui32TelemetryRead = ++ui32Read;
+    }
+
+    if ((g_ui32TelemetryDropped != ui32Reported) && !g_bTraceOn &&
+        g_bTelemetryText)
+    {
+        ui32Reported = g_ui32TelemetryDropped;
+        UARTprintf("Telemetry dropped %u\n", ui32Reported);
+    }
+}
+
+
+//*****************************************************************************
+//
+// Turn the text status lines on or off, for binary protocols that own the
+// console (stream.h)
+//
+//*****************************************************************************
+void TelemetryTextSet(bool bEnable)
+{
+    g_bTelemetryText = bEnable;
+}
+
+
+//*****************************************************************************
+//
+// Start the binary trace of the channels in ui32Mask, one sample every
+// ui32Decimation ticks
+//
+//*****************************************************************************
+void TraceStart(uint32_t ui32Mask, uint32_t ui32Decimation)
+{
+    g_bTraceOn = false;
+
+    g_ui32TraceMask = ui32Mask & TRACE_CH_ALL;
+    g_ui32TraceDecimation = ui32Decimation ? ui32Decimation : 1;
+    g_ui32TraceCountdown = 1;
+    g_bTraceResync = true;
+
+    g_bTraceOn = true;
+}
+
+
+//*****************************************************************************
+//
+// Stop the binary trace, samples already queued are still sent
+//
+//*****************************************************************************
+void TraceStop(void)
+{
+    g_bTraceOn = false;
+}
+
+
+//*****************************************************************************
+//
+// Producer side - returns a slot when a trace sample is due, or 0 if the
+// trace is off, the sample is decimated away or the queue is full
+//
+//*****************************************************************************
+tTraceSample *TraceAlloc(void)
+{
+    uint32_t ui32Write;
+
+    if (!g_bTraceOn || --g_ui32TraceCountdown)
+        return 0;
+
+    g_ui32TraceCountdown = g_ui32TraceDecimation;
+
+    ui32Write = g_ui32TraceWrite;
+    if ((ui32Write - g_ui32TraceRead) >= TRACE_QUEUE_SIZE)
+    {
+        g_ui32TraceDropped++;
+        return 0;
+    }
+
+    return &g_psTraceQueue[ui32Write & (TRACE_QUEUE_SIZE - 1)];
+}
+
+
+//*****************************************************************************
+//
+// Producer side - publish the slot returned by TraceAlloc()
+//
+//*****************************************************************************
+void TraceCommit(void)
+{
+    g_ui32TraceWrite++;
+    HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PEND_SV;
+}
+
+
+//*****************************************************************************
+//
+// Store a little endian 32-bit value
+//
+//*****************************************************************************
+static void TracePut32(uint8_t *pui8Dst, uint32_t ui32Value)
+{
+    pui8Dst[0] = (uint8_t)ui32Value;
+    pui8Dst[1] = (uint8_t)(ui32Value >> 8);
+    pui8Dst[2] = (uint8_t)(ui32Value >> 16);
+    pui8Dst[3] = (uint8_t)(ui32Value >> 24);
+}
+
+
+//*****************************************************************************
+//
+// Consumer side - pack queued trace samples into frames and transmit them.
+// Called from the PendSV handler.
+//
+//*****************************************************************************
+void TraceService(void)
+{
+    static uint8_t pui8Payload[TRACE_PAYLOAD_SIZE];
+    static uint8_t pui8Frame[FRAME_MAX_ENCODED(TRACE_PAYLOAD_SIZE)];
+    static uint32_t ui32DropReported = 0;
+    static const uint8_t ui8Delimiter = 0;
+    const tTraceSample *psSample;
+    uint32_t ui32Read = g_ui32TraceRead;
+    uint32_t ui32Mask, ui32Decimation, ui32Dropped, ui32Tick;
+    uint32_t ui32Count, ui32Pos, ui32Len, i;
+
+    while (ui32Read != g_ui32TraceWrite)
+    {
+        ui32Mask = g_ui32TraceMask;
+        ui32Decimation = g_ui32TraceDecimation;
+
+        ui32Dropped = g_ui32TraceDropped - ui32DropReported;
+        ui32DropReported += ui32Dropped;
+
+        //
+        // Pack consecutive samples, a gap in the ticks starts a new frame
+        //
+        ui32Tick = g_psTraceQueue[ui32Read & (TRACE_QUEUE_SIZE - 1)].Tick;
+        ui32Count = 0;
+        ui32Pos = TRACE_HEADER_SIZE;
+
+        while ((ui32Read != g_ui32TraceWrite) &&
+               (ui32Count < TRACE_SAMPLES_PER_FRAME))
+        {
+            psSample = &g_psTraceQueue[ui32Read & (TRACE_QUEUE_SIZE - 1)];
+            if (psSample->Tick != ui32Tick + ui32Count * ui32Decimation)
+                break;
+
+            for (i = 0; i < TRACE_NUM_CHANNELS; i++)
+            {
+                if (ui32Mask & (1 << i))
+                {
+                    TracePut32(&pui8Payload[ui32Pos], psSample->Value[i]);
+                    ui32Pos += 4;
+                }
+            }
+
+            ui32Count++;
+            ui32Read++;
+        }
+
+        //
+        // The samples are copied, hand the slots back before transmitting
+        //
+        g_ui32TraceRead = ui32Read;
+
+        pui8Payload[0] = TRACE_FRAME_SAMPLES;
+        pui8Payload[1] = (uint8_t)ui32Mask;
+        pui8Payload[2] = (uint8_t)ui32Count;
+        pui8Payload[3] = (uint8_t)((ui32Dropped > 255) ? 255 : ui32Dropped);
+        TracePut32(&pui8Payload[4], ui32Tick);
+        pui8Payload[8] = (uint8_t)ui32Decimation;
+        pui8Payload[9] = (uint8_t)(ui32Decimation >> 8);
+
+        //
+        // Terminate any console text sent before the trace started, so the
+        // first frame is not glued to it
+        //
+        if (g_bTraceResync)
+        {
+            g_bTraceResync = false;
+            UARTwriteRaw(&ui8Delimiter, 1);
+        }
+
+        ui32Len = FrameEncode(pui8Payload, ui32Pos, pui8Frame);
+        if (UARTwriteRaw(pui8Frame, ui32Len) != (int)ui32Len)
+            g_ui32TraceFramesLost++;
+    }
+}
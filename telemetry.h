@@ -0,0 +1,138 @@
+//*****************************************************************************
+//
+// telemetry.h - Deferred status output from the control interrupt.
+//
+// The control interrupt must not format strings or wait for the UART.
+// Instead it claims a slot in a single-producer / single-consumer queue,
+// stores a fixed-size sample record and commits it:
+//
+//   psSample = TelemetryAlloc();
+//   if (psSample)
+//   {
+//       psSample->Position1 = ...;
+//       TelemetryCommit();
+//   }
+//
+// TelemetryCommit() pends the PendSV exception.  PendSV runs at the lowest
+// priority and calls TelemetryService(), which formats and transmits all
+// queued samples.  Each status line is built by fmt.h from
+// TELEMETRY_STATUS_FORMAT and queued whole with UARTwriteRaw(); a line
+// that does not fit in the UART buffer is counted as lost.
+//
+// For tuning there is also a binary trace of the loop signals.  Once
+// started with TraceStart(), TraceAlloc() hands out a slot every
+// "decimation" ticks, and TraceService() packs the committed samples into
+// COBS/CRC frames (see frame.h) with this payload, little endian:
+//
+//   [0]     TRACE_FRAME_SAMPLES
+//   [1]     Channel mask (TRACE_CH_xxx)
+//   [2]     Number of samples n
+//   [3]     Samples dropped since the previous frame (saturated at 255)
+//   [4..7]  Tick of the first sample
+//   [8..9]  Decimation, ticks between samples
+//   [10..]  n samples, each holding the selected channels as int32 in bit
+//           order
+//
+// The text status lines are suppressed while a trace is running so that
+// the stream stays clean, and while TelemetryTextSet(false) is in effect.
+// tools/trace_decode.cpp turns the stream back into CSV on the host.
+//
+//*****************************************************************************
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+//
+// Number of queued samples, must be a power of two
+//
+//*****************************************************************************
+#define TELEMETRY_QUEUE_SIZE    16
+
+//*****************************************************************************
+//
+// One sample of the control loop
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t Tick;              // planning_counter when taken
+    int32_t Position1;          // Low 32 bits [counts]
+    int32_t Position2;          // Low 32 bits [counts]
+    int32_t Error1;             // [counts]
+    int32_t Error2;             // [counts]
+    int32_t U1;                 // Controller output [%]
+    int32_t U2;                 // Controller output [%]
+    int32_t PWM;                // Open loop PWM command [%]
+}
+tTelemetrySample;
+
+//*****************************************************************************
+//
+// Layout of a status line (see fmt.h)
+//
+//*****************************************************************************
+#define TELEMETRY_STATUS_FORMAT(TEXT, INT, UINT, pcOut, psSample)             \
+    TEXT(pcOut, "P1 = ")        INT(pcOut, (psSample)->Position1)             \
+    TEXT(pcOut, " | P2 = ")     INT(pcOut, (psSample)->Position2)             \
+    TEXT(pcOut, " | PWM = ")    INT(pcOut, (psSample)->PWM)                   \
+    TEXT(pcOut, "\r\n")
+
+//*****************************************************************************
+//
+// Binary trace channels.  Controller outputs are sent as Q16.16 percent.
+//
+//*****************************************************************************
+#define TRACE_CH_POSITION1      0x01
+#define TRACE_CH_POSITION2      0x02
+#define TRACE_CH_VELOCITY1      0x04
+#define TRACE_CH_VELOCITY2      0x08
+#define TRACE_CH_ERROR1         0x10
+#define TRACE_CH_ERROR2         0x20
+#define TRACE_CH_U1             0x40
+#define TRACE_CH_U2             0x80
+#define TRACE_CH_ALL            0xFF
+#define TRACE_NUM_CHANNELS      8
+
+#define TRACE_FRAME_SAMPLES     0x01    // Frame type of a sample frame
+#define TRACE_QUEUE_SIZE        64      // Queued samples, power of two
+#define TRACE_SAMPLES_PER_FRAME 8       // Samples packed into one frame
+
+//*****************************************************************************
+//
+// One trace sample - all channels are recorded, the mask is applied when
+// the frame is built
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t Tick;
+    int32_t Value[TRACE_NUM_CHANNELS];
+}
+tTraceSample;
+
+extern volatile uint32_t g_ui32TelemetryDropped;
+extern volatile uint32_t g_ui32TelemetryLinesLost;
+extern volatile uint32_t g_ui32TraceDropped;
+extern volatile uint32_t g_ui32TraceFramesLost;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void ConfigureTelemetry(void);
+extern tTelemetrySample *TelemetryAlloc(void);
+extern void TelemetryCommit(void);
+extern void TelemetryService(void);
+extern void TelemetryTextSet(bool bEnable);
+extern void TraceStart(uint32_t ui32Mask, uint32_t ui32Decimation);
+extern void TraceStop(void);
+extern tTraceSample *TraceAlloc(void);
+extern void TraceCommit(void);
+extern void TraceService(void);
+
+#endif // __TELEMETRY_H__
@@ -24,18 +24,34 @@ MEMORY
 /* --stack_size=256                                                          */
 /* --library=rtsv7M4_T_le_eabi.lib                                           */
 
-/* Section allocation in memory */
+/* Section allocation in memory                                              */
+/*                                                                           */
+/* With CONTROL_RAMFUNC (motor_config.h, given to the linker as well with    */
+/* --define=CONTROL_RAMFUNC) the vector table and the .ramfunc section are   */
+/* loaded in flash and run from SRAM.  ResetISR copies them.                 */
 
 SECTIONS
 {
+#ifdef CONTROL_RAMFUNC
+    .intvecs:   load = 0x00000000, run = 0x20000000,
+                LOAD_START(__RAMVECS_LOAD), SIZE(__RAMVECS_SIZE)
+    .ramfunc:   load = FLASH, run = SRAM,
+                LOAD_START(__RAMFUNC_LOAD), RUN_START(__RAMFUNC_RUN),
+                SIZE(__RAMFUNC_SIZE)
+#else
     .intvecs:   > 0x00000000
+#endif
     .text   :   > FLASH
     .const  :   > FLASH
     .cinit  :   > FLASH
     .pinit  :   > FLASH
     .init_array : > FLASH
 
+#ifdef CONTROL_RAMFUNC
+    .vtable :   > SRAM
+#else
     .vtable :   > 0x20000000
+#endif
     .data   :   > SRAM
     .bss    :   > SRAM
     .sysmem :   > SRAM
@@ -23,6 +23,9 @@
 //*****************************************************************************
 
 #include <stdint.h>
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "motor_config.h"
 
 //*****************************************************************************
 //
@@ -42,6 +45,10 @@ static void IntDefaultHandler(void);
 //*****************************************************************************
 extern void _c_int00(void);
 extern void Timer0IntHandler(void);
+extern void PWM0Gen1IntHandler(void);
+extern void ADC0SS1IntHandler(void);
+extern void PendSVIntHandler(void);
+extern void UARTStdioIntHandler(void);
 
 //*****************************************************************************
 //
@@ -50,6 +57,20 @@ extern void Timer0IntHandler(void);
 //*****************************************************************************
 extern uint32_t __STACK_TOP;
 
+#ifdef CONTROL_RAMFUNC
+//*****************************************************************************
+//
+// Linker variables that locate the flash images of the vector table and the
+// .ramfunc section and their copies in SRAM (tm4c123gh6pm.cmd).
+//
+//*****************************************************************************
+extern uint32_t __RAMVECS_LOAD;
+extern uint32_t __RAMVECS_SIZE;
+extern uint32_t __RAMFUNC_LOAD;
+extern uint32_t __RAMFUNC_RUN;
+extern uint32_t __RAMFUNC_SIZE;
+#endif
+
 //*****************************************************************************
 //
 // External declarations for the interrupt handlers used by the application.
@@ -82,24 +103,24 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // SVCall handler
     IntDefaultHandler,                      // Debug monitor handler
     0,                                      // Reserved
-    IntDefaultHandler,                      // The PendSV handler
+    PendSVIntHandler,                       // The PendSV handler
     IntDefaultHandler,                      // The SysTick handler
     IntDefaultHandler,                      // GPIO Port A
     IntDefaultHandler,                      // GPIO Port B
     IntDefaultHandler,                      // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
-    IntDefaultHandler,                      // UART0 Rx and Tx
+    UARTStdioIntHandler,                    // UART0 Rx and Tx
     IntDefaultHandler,                      // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
     IntDefaultHandler,                      // I2C0 Master and Slave
     IntDefaultHandler,                      // PWM Fault
     IntDefaultHandler,                      // PWM Generator 0
-    IntDefaultHandler,                      // PWM Generator 1
+    PWM0Gen1IntHandler,                     // PWM Generator 1
     IntDefaultHandler,                      // PWM Generator 2
     IntDefaultHandler,                      // Quadrature Encoder 0
     IntDefaultHandler,                      // ADC Sequence 0
-    IntDefaultHandler,                      // ADC Sequence 1
+    ADC0SS1IntHandler,                      // ADC Sequence 1
     IntDefaultHandler,                      // ADC Sequence 2
     IntDefaultHandler,                      // ADC Sequence 3
     IntDefaultHandler,                      // Watchdog timer
@@ -225,6 +246,24 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler                       // PWM 1 Fault
 };
 
+#ifdef CONTROL_RAMFUNC
+//*****************************************************************************
+//
+// Copy a section from its flash image to its place in SRAM
+//
+//*****************************************************************************
+static void
+CopySection(uint32_t *pui32Dst, const uint32_t *pui32Src, uint32_t ui32Size)
+{
+    uint32_t *pui32End = pui32Dst + (ui32Size + 3) / 4;
+
+    while(pui32Dst < pui32End)
+    {
+        *pui32Dst++ = *pui32Src++;
+    }
+}
+#endif
+
 //*****************************************************************************
 //
 // This is the code that gets called when the processor first starts execution
@@ -238,6 +277,18 @@ void (* const g_pfnVectors[])(void) =
 void
 ResetISR(void)
 {
+#ifdef CONTROL_RAMFUNC
+    //
+    // Copy the vector table and the functions that run from SRAM, and move
+    // the vector table to its copy.  This is done before anything else so
+    // that no interrupt or call can reach an empty copy.
+    //
+    CopySection((uint32_t *)g_pfnVectors, &__RAMVECS_LOAD,
+                (uint32_t)&__RAMVECS_SIZE);
+    CopySection(&__RAMFUNC_RUN, &__RAMFUNC_LOAD, (uint32_t)&__RAMFUNC_SIZE);
+    HWREG(NVIC_VTABLE) = (uint32_t)g_pfnVectors;
+#endif
+
     //
     // Jump to the CCS C initialization routine.  This will enable the
     // floating-point unit as well, so that does not need to be done here.
@@ -0,0 +1,111 @@
+//*****************************************************************************
+//
+// clock_check.cpp - Host check of the clock derived constants.
+//
+// For every clock in CLOCK_SUPPORTED_MHZ, takes the periods of
+// clock_config.h and checks them against the rates they are meant to give,
+// computed here in double precision:
+//
+//   pwm    - CLOCK_PWM_HZ exactly, a period the generators can count
+//            (even, 16-bit load, whole clocks per percent) and, for
+//            CONTROL_TICK_PWM, CONTROL_TICK_HZ * CONTROL_PWM_DIVIDER
+//   tick   - the Timer 0 period gives CONTROL_TICK_HZ exactly
+//   qei    - the velocity capture window is 800 us exactly, also when it
+//            is converted from CLOCK_QEI_VELOCITY_US (the velper parameter)
+//   us     - clocks per microsecond
+//   uart   - the divisor UARTStdioConfig() programs for CONSOLE_BAUD is in
+//            range and within 1 % of the rate
+//
+// The selected clock, SYSTEM_CLOCK_MHZ, is also checked by the firmware
+// build itself (clock_config.h).  At 50 MHz the periods must be those the
+// firmware used before they were derived: 2500, 5000 and 40000.
+//
+// Build:
+//   g++ -std=c++17 -O2 -I.. -o clock_check clock_check.cpp
+//
+//*****************************************************************************
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "clock_config.h"
+
+namespace
+{
+
+uint32_t g_errors = 0;
+
+void Expect(bool ok, uint32_t mhz, const char *what)
+{
+    if (!ok)
+    {
+        std::printf("  %u MHz: %s FAILED\n", mhz, what);
+        g_errors++;
+    }
+}
+
+//
+// Baud rate divisor of UARTConfigSetExpClk() in 1/64ths, and the rate it
+// gives
+//
+double UartBaud(uint32_t clock, uint32_t baud, uint32_t *div)
+{
+    *div = (((clock * 8ull) / baud) + 1) / 2;
+    return clock * 4.0 / *div;
+}
+
+void CheckClock(uint32_t mhz)
+{
+    const uint32_t clock = mhz * 1000000;
+    const uint32_t pwm = CLOCK_PWM_PERIOD(clock);
+    const uint32_t tick = CLOCK_TICK_PERIOD(clock);
+    const uint32_t qei = CLOCK_QEI_VELOCITY_PERIOD(clock);
+    const uint32_t perUs = CLOCK_PER_US(clock);
+    uint32_t div;
+    double baud = UartBaud(clock, CONSOLE_BAUD, &div);
+
+    std::printf("  %3u MHz %8u %8u %8u %6u %10.1f\n", mhz, pwm, tick, qei,
+                perUs, baud);
+
+    Expect(CLOCK_EXACT(clock, CLOCK_PWM_HZ) &&
+           (double)clock / pwm == CLOCK_PWM_HZ, mhz, "pwm rate");
+    Expect(CLOCK_PWM_PERIOD_VALID(pwm) && (pwm % 2 == 0) &&
+           (pwm / 2 <= 0xFFFF) && (pwm % 100 == 0), mhz, "pwm period");
+    Expect(clock / pwm == CONTROL_TICK_HZ * CONTROL_PWM_DIVIDER, mhz,
+           "pwm tick");
+    Expect(CLOCK_EXACT(clock, CONTROL_TICK_HZ) &&
+           (double)clock / tick == CONTROL_TICK_HZ, mhz, "tick rate");
+    Expect(CLOCK_EXACT(clock, CLOCK_QEI_VELOCITY_HZ) &&
+           std::fabs(qei * 1e6 / clock - 800.0) < 1e-9, mhz, "qei window");
+    Expect(CLOCK_US_PERIOD(clock, CLOCK_QEI_VELOCITY_US) == qei, mhz,
+           "qei window in us");
+    Expect((uint64_t)perUs * 1000000 == clock, mhz, "clocks per us");
+    Expect((div / 64 >= 1) && (div / 64 <= 0xFFFF) &&
+           (clock >= 16u * CONSOLE_BAUD) &&
+           std::fabs(baud / CONSOLE_BAUD - 1.0) < 0.01, mhz, "uart baud");
+
+    if (mhz == 50)
+        Expect((pwm == 2500) && (tick == 5000) && (qei == 40000), mhz,
+               "50 MHz periods");
+}
+
+} // namespace
+
+int main()
+{
+    const uint32_t supported[] = CLOCK_SUPPORTED_MHZ;
+    bool selected = false;
+
+    std::printf("  clock       pwm     tick      qei  clk/us  baud\n");
+    for (uint32_t mhz : supported)
+    {
+        CheckClock(mhz);
+        if (mhz == SYSTEM_CLOCK_MHZ)
+            selected = true;
+    }
+    Expect(selected, SYSTEM_CLOCK_MHZ, "selected clock supported");
+
+    std::printf("%s\n", g_errors ? "FAILED" : "ok");
+    return g_errors ? 1 : 0;
+}
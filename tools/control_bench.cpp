@@ -0,0 +1,388 @@
+//*****************************************************************************
+//
+// control_bench.cpp - Host comparison of the fixed and float control math.
+//
+// Builds control_math.h both ways, CONTROL_MATH_FIXED and
+// CONTROL_MATH_FLOAT, and runs the two controller kernels of motor.c on
+// each over ranges of gains and errors:
+//
+//   position  - velocity command = CONTROL_TO_INT(Kp * error)
+//   velocity  - duty = CONTROL_TO_INT(-clamp(Kv * e + Kvff * v + Kaff * a,
+//               limit) * MOTOR_PWM_PER_PERCENT), the path to MotorDrive()
+//
+// The gains go over 1e-5 to 100, 16 steps per decade, and the errors are
+// the edge values plus random values over every power of two up to 2^31.
+// Each path is also compared with a double precision reference.
+//
+// The fixed path can only agree with the others where its number formats
+// resolve the result, so the inputs are split in two:
+//
+//   in range  - every product is inside the Q16.16 signal range (below
+//               32768), and the Q8.24 rounding of the gains moves the
+//               output by at most half a unit (|error| * 2^-25 * scale).
+//               Both paths must agree within one unit of the integer
+//               output here.
+//   beyond    - the rest, where the fixed path saturates or the gain
+//               rounding shows.  Only reported.
+//
+// It then prints the host time per kernel for each path (not target
+// cycles; use "tasks" with ISR_TIMING on the target for those).
+//
+// Last it checks the conversions of the gains of the console and back:
+// ControlGainFromMicro() up to CONTROL_GAIN_MICRO_MAX, and
+// ControlGainFromNano() and ControlGainFromMicroRate() over the whole
+// int32_t range.
+//
+// Exits with 1 if any output in range differs by more than one unit, or a
+// converted gain by more than its resolution.
+//
+// Build:
+//   g++ -std=c++17 -O2 -I.. -o control_bench control_bench.cpp
+//
+//*****************************************************************************
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "clock_config.h"
+
+//
+// The header twice, once per implementation.  Its macros are wrapped in
+// functions of each namespace before the second copy redefines them.
+//
+namespace fixed
+{
+#undef CONTROL_MATH_FLOAT
+#define CONTROL_MATH_FIXED
+#include "control_math.h"
+
+int32_t ToInt(control_t x) { return CONTROL_TO_INT(x); }
+control_gain_t Gain(double x) { return CONTROL_GAIN(x); }
+control_t Const(double x) { return CONTROL_CONST(x); }
+}
+
+#undef __CONTROL_MATH_H__
+#undef CONTROL_MATH_FIXED
+#undef CONTROL_CONST
+#undef CONTROL_GAIN
+#undef CONTROL_FROM_INT
+#undef CONTROL_TO_INT
+#undef CONTROL_TO_Q16
+
+namespace single
+{
+#define CONTROL_MATH_FLOAT
+#include "control_math.h"
+
+int32_t ToInt(control_t x) { return CONTROL_TO_INT(x); }
+control_gain_t Gain(double x) { return CONTROL_GAIN(x); }
+control_t Const(double x) { return CONTROL_CONST(x); }
+}
+
+namespace
+{
+
+//
+// PWM clocks per percent of duty cycle and the output limit [%], as in
+// motor.h and params.c
+//
+const int32_t kPwmPerPercent = CLOCK_PWM_PERIOD(SYSTEM_CLOCK_HZ) / 100;
+const double kLimit = 40.0;
+
+//
+// One set of kernel inputs
+//
+struct Input
+{
+    double kp, kv, kvff, kaff;
+    int32_t error, velocityError, velocityRef, accelRef;
+};
+
+//
+// The kernels, written once for both namespaces as in motor.c
+//
+#define POSITION_KERNEL(ns, in)                                               \
+    ns::ToInt(ns::ControlGainMulInt(ns::Gain((in).kp), (in).error))
+
+#define VELOCITY_KERNEL(ns, in)                                               \
+    ns::ToInt(-ns::ControlClamp(                                              \
+        ns::ControlAdd(                                                       \
+            ns::ControlAdd(ns::ControlGainMulInt(ns::Gain((in).kv),           \
+                                                 (in).velocityError),         \
+                           ns::ControlGainMulInt(ns::Gain((in).kvff),         \
+                                                 (in).velocityRef)),          \
+            ns::ControlGainMulInt(ns::Gain((in).kaff), (in).accelRef)),       \
+        ns::Const(kLimit)) * kPwmPerPercent)
+
+int32_t PositionFixed(const Input &in) { return POSITION_KERNEL(fixed, in); }
+int32_t PositionFloat(const Input &in) { return POSITION_KERNEL(single, in); }
+int32_t VelocityFixed(const Input &in) { return VELOCITY_KERNEL(fixed, in); }
+int32_t VelocityFloat(const Input &in) { return VELOCITY_KERNEL(single, in); }
+
+double PositionExact(const Input &in)
+{
+    return std::trunc(in.kp * in.error);
+}
+
+double VelocityExact(const Input &in)
+{
+    double u = in.kv * in.velocityError + in.kvff * in.velocityRef +
+               in.kaff * in.accelRef;
+
+    u = std::fmax(-kLimit, std::fmin(kLimit, u));
+    return std::trunc(-u * kPwmPerPercent);
+}
+
+//
+// Output units moved by the Q8.24 rounding of a gain applied to x, and
+// whether the product fits the Q16.16 signal range
+//
+double GainRounding(int32_t x, double scale)
+{
+    return std::fabs((double)x) * std::ldexp(1.0, -25) * scale;
+}
+
+bool InSignalRange(double k, int32_t x)
+{
+    return std::fabs(k * x) < 32767.0;
+}
+
+//
+// Largest difference of each path to the other and to the reference
+//
+struct Result
+{
+    uint64_t n = 0, failed = 0, beyond = 0;
+    double maxPaths = 0, maxFixed = 0, maxFloat = 0, maxBeyond = 0;
+};
+
+void Compare(Result &r, bool inRange, int32_t fx, int32_t fl, double exact)
+{
+    double paths = std::fabs((double)fx - fl);
+
+    if (!inRange)
+    {
+        r.beyond++;
+        r.maxBeyond = std::fmax(r.maxBeyond, paths);
+        return;
+    }
+
+    r.n++;
+    r.maxPaths = std::fmax(r.maxPaths, paths);
+    r.maxFixed = std::fmax(r.maxFixed, std::fabs(fx - exact));
+    r.maxFloat = std::fmax(r.maxFloat, std::fabs(fl - exact));
+    if (paths > 1)
+    {
+        if (r.failed++ < 5)
+            std::printf("  differ: fixed %d float %d exact %.0f\n", fx, fl,
+                        exact);
+    }
+}
+
+//
+// Edge values and random values over every power of two up to 2^31
+//
+std::vector<int32_t> Errors(std::mt19937 &rng)
+{
+    std::vector<int32_t> out = { 0, 1, -1, 2, -2, INT32_MAX, INT32_MIN + 1 };
+    int b, i;
+
+    for (b = 1; b < 32; b++)
+    {
+        std::uniform_int_distribution<int64_t> d(-(1LL << b), (1LL << b) - 1);
+
+        for (i = 0; i < 64; i++)
+            out.push_back((int32_t)std::max<int64_t>(d(rng), INT32_MIN + 1));
+    }
+    return out;
+}
+
+std::vector<double> Gains()
+{
+    std::vector<double> out;
+    int i;
+
+    for (i = -5 * 16; i <= 2 * 16; i++)
+        out.push_back(std::pow(10.0, i / 16.0));
+    return out;
+}
+
+//
+// The integral gain conversion of the console, a gain per second [1e-6]
+// to the fixed gain per tick and back.  The gain must be within one unit
+// of Q8.24 of the exact one over the whole int32_t range, and come back
+// within one step of the gain per tick (1e6 * CONTROL_TICK_HZ / 2^24 in
+// units of 1e-6).  Returns the number of values that fail.
+//
+uint64_t CheckIntegralGain(const std::vector<int32_t> &values)
+{
+    const double step = 1e6 * CONTROL_TICK_HZ / 16777216.0;
+    uint64_t failed = 0;
+
+    for (int32_t micro : values)
+    {
+        fixed::control_gain_t k =
+            fixed::ControlGainFromMicroRate(micro, CONTROL_TICK_HZ);
+        int32_t back = fixed::ControlGainToMicroRate(k, CONTROL_TICK_HZ);
+        double exact = micro * 16777216.0 / (1e6 * CONTROL_TICK_HZ);
+
+        if ((std::fabs(k - exact) > 1.0) ||
+            (std::fabs((double)back - micro) > step + 1.0))
+        {
+            if (failed++ < 5)
+                std::printf("  ki %d: gain %d (exact %.1f), back %d\n",
+                            micro, k, exact, back);
+        }
+    }
+    return failed;
+}
+
+//
+// The gain conversion of the console in units of 1 / unit to the fixed gain
+// and back, for the values up to max.  The gain must be within one unit of
+// Q8.24 of the exact one, so it must not saturate below max, and come back
+// within one step (unit / 2^24).  Returns the number of values that fail.
+//
+uint64_t CheckGain(const char *name, const std::vector<int32_t> &values,
+                   double unit, int32_t max,
+                   fixed::control_gain_t (*from)(int32_t),
+                   int32_t (*to)(fixed::control_gain_t))
+{
+    const double step = unit / 16777216.0;
+    uint64_t failed = 0;
+
+    for (int32_t value : values)
+    {
+        if ((value > max) || (value < -max))
+            continue;
+
+        fixed::control_gain_t k = from(value);
+        int32_t back = to(k);
+        double exact = value * 16777216.0 / unit;
+
+        if ((std::fabs(k - exact) > 1.0) ||
+            (std::fabs((double)back - value) > step + 1.0))
+        {
+            if (failed++ < 5)
+                std::printf("  %s %d: gain %d (exact %.1f), back %d\n",
+                            name, value, k, exact, back);
+        }
+    }
+    return failed;
+}
+
+//
+// Host time per call of a kernel
+//
+template <typename F>
+double NsPerOp(F f, const std::vector<Input> &inputs)
+{
+    volatile int32_t sink = 0;
+    int r;
+
+    auto start = std::chrono::steady_clock::now();
+    for (r = 0; r < 20; r++)
+        for (const Input &in : inputs)
+            sink = sink + f(in);
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+           (20.0 * inputs.size());
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 rng(1);
+    std::vector<int32_t> errors = Errors(rng);
+    std::vector<double> gains = Gains();
+    std::vector<Input> positionInputs, velocityInputs;
+    Result position, velocity;
+    uint64_t converted;
+    size_t i;
+
+    //
+    // Position loop
+    //
+    for (double k : gains)
+        for (int32_t e : errors)
+        {
+            Input in = { k, 0, 0, 0, e, 0, 0, 0 };
+            bool inRange = InSignalRange(k, e) && (GainRounding(e, 1) <= 0.5);
+
+            Compare(position, inRange, PositionFixed(in), PositionFloat(in),
+                    PositionExact(in));
+            positionInputs.push_back(in);
+        }
+
+    //
+    // Velocity loop: every gain as Kv, with the feedforward gains and
+    // references drawn at random from the same ranges
+    //
+    std::uniform_int_distribution<size_t> pickGain(0, gains.size() - 1);
+    std::uniform_int_distribution<size_t> pickError(0, errors.size() - 1);
+
+    for (double k : gains)
+        for (i = 0; i < errors.size(); i++)
+        {
+            Input in = { 0, k, gains[pickGain(rng)] / 1000,
+                         gains[pickGain(rng)] / 1000, 0, errors[i],
+                         errors[pickError(rng)], errors[pickError(rng)] };
+            bool inRange =
+                InSignalRange(in.kv, in.velocityError) &&
+                InSignalRange(in.kvff, in.velocityRef) &&
+                InSignalRange(in.kaff, in.accelRef) &&
+                (GainRounding(in.velocityError, kPwmPerPercent) +
+                 GainRounding(in.velocityRef, kPwmPerPercent) +
+                 GainRounding(in.accelRef, kPwmPerPercent) <= 0.5);
+
+            Compare(velocity, inRange, VelocityFixed(in), VelocityFloat(in),
+                    VelocityExact(in));
+            velocityInputs.push_back(in);
+        }
+
+    std::printf("%-10s %8s %6s %6s %6s %8s %8s %8s %8s\n", "kernel",
+                "in range", "fx-fl", "fx-ref", "fl-ref", "beyond", "fx-fl",
+                "fixed ns", "float ns");
+    std::printf("%-10s %8llu %6.0f %6.0f %6.0f %8llu %8.0f %8.2f %8.2f\n",
+                "position", (unsigned long long)position.n, position.maxPaths,
+                position.maxFixed, position.maxFloat,
+                (unsigned long long)position.beyond, position.maxBeyond,
+                NsPerOp(PositionFixed, positionInputs),
+                NsPerOp(PositionFloat, positionInputs));
+    std::printf("%-10s %8llu %6.0f %6.0f %6.0f %8llu %8.0f %8.2f %8.2f\n",
+                "velocity", (unsigned long long)velocity.n, velocity.maxPaths,
+                velocity.maxFixed, velocity.maxFloat,
+                (unsigned long long)velocity.beyond, velocity.maxBeyond,
+                NsPerOp(VelocityFixed, velocityInputs),
+                NsPerOp(VelocityFloat, velocityInputs));
+
+    errors.push_back(CONTROL_GAIN_MICRO_MAX);
+    errors.push_back(-CONTROL_GAIN_MICRO_MAX);
+    converted = CheckIntegralGain(errors);
+    std::printf("ki conversion: %zu values, %llu off\n", errors.size(),
+                (unsigned long long)converted);
+    converted += CheckGain("k", errors, 1e6, CONTROL_GAIN_MICRO_MAX,
+                           fixed::ControlGainFromMicro,
+                           fixed::ControlGainToMicro);
+    converted += CheckGain("kaff", errors, 1e9, INT32_MAX,
+                           fixed::ControlGainFromNano,
+                           fixed::ControlGainToNano);
+    std::printf("gain conversions: %llu off\n",
+                (unsigned long long)converted);
+
+    if (position.failed || velocity.failed || converted)
+    {
+        std::printf("FAILED: %llu inputs differ by more than one unit\n",
+                    (unsigned long long)(position.failed + velocity.failed +
+                                         converted));
+        return 1;
+    }
+    std::printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,383 @@
+//*****************************************************************************
+//
+// fmt_bench.cpp - Host check and benchmark of fmt.c.
+//
+// check: FMT_DIV100() against a division for every 32-bit value, and
+// FmtInt() / FmtUint() against snprintf() on the limits, the powers of ten
+// and random values.
+//
+// bench: the status line of telemetry.c, built from TELEMETRY_STATUS_FORMAT
+// and queued with one ring buffer write, against UARTprintf() with the
+// format string it used before.  UARTvprintf() is reproduced from
+// uartstdio.c for the conversions the status lines use (%c, %d, %i, %s, %u
+// and %%), and writes through the buffered UARTwrite() of uartstdio.c: each
+// call stages its characters with "\n" to "\r\n" translation and publishes
+// them.  The console lock and the wakeup of the UART interrupt, which each
+// UARTwrite() call also pays on the target, are left out.  Both must give
+// the same bytes.  Host numbers only compare the two; they are not target
+// cycles.
+//
+// Build:
+//   g++ -std=c++17 -O2 -I.. -o fmt_bench fmt_bench.cpp ../fmt.c
+//
+// Usage:
+//   fmt_bench [lines]               default 1000000
+//
+//*****************************************************************************
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ringbuf.h"
+#include "fmt.h"
+#include "telemetry.h"
+
+namespace
+{
+
+//
+// Console transmit buffer of uartstdio.c
+//
+uint8_t g_pui8TxData[2048];
+tRingBuf g_sTx = { g_pui8TxData, sizeof(g_pui8TxData) - 1, 0, 0, 0 };
+
+//
+// UARTwrite() of the buffered uartstdio.c
+//
+int UARTwrite(const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t uIdx;
+
+    for (uIdx = 0; uIdx < ui32Len; uIdx++)
+    {
+        if ((pcBuf[uIdx] == '\n') && !RingBufStage(&g_sTx, '\r'))
+            break;
+        if (!RingBufStage(&g_sTx, pcBuf[uIdx]))
+            break;
+    }
+    RingBufPublish(&g_sTx);
+
+    return uIdx;
+}
+
+//
+// UARTvprintf() of uartstdio.c, decimal, character and string conversions
+//
+const char *const g_pcHex = "0123456789abcdef";
+
+void UARTvprintf(const char *pcString, va_list vaArgP)
+{
+    uint32_t ui32Idx, ui32Value, ui32Pos, ui32Count, ui32Base, ui32Neg;
+    char *pcStr, pcBuf[16], cFill;
+
+    while (*pcString)
+    {
+        for (ui32Idx = 0;
+             (pcString[ui32Idx] != '%') && (pcString[ui32Idx] != '\0');
+             ui32Idx++)
+        {
+        }
+        UARTwrite(pcString, ui32Idx);
+        pcString += ui32Idx;
+
+        if (*pcString == '%')
+        {
+            pcString++;
+            ui32Count = 0;
+            cFill = ' ';
+again:
+            switch (*pcString++)
+            {
+                case '0': case '1': case '2': case '3': case '4':
+                case '5': case '6': case '7': case '8': case '9':
+                {
+                    if ((pcString[-1] == '0') && (ui32Count == 0))
+                        cFill = '0';
+                    ui32Count *= 10;
+                    ui32Count += pcString[-1] - '0';
+                    goto again;
+                }
+                case 'c':
+                {
+                    ui32Value = va_arg(vaArgP, uint32_t);
+                    UARTwrite((char *)&ui32Value, 1);
+                    break;
+                }
+                case 'd':
+                case 'i':
+                {
+                    ui32Value = va_arg(vaArgP, uint32_t);
+                    ui32Pos = 0;
+                    if ((int32_t)ui32Value < 0)
+                    {
+                        ui32Value = -(int32_t)ui32Value;
+                        ui32Neg = 1;
+                    }
+                    else
+                    {
+                        ui32Neg = 0;
+                    }
+                    ui32Base = 10;
+                    goto convert;
+                }
+                case 's':
+                {
+                    pcStr = va_arg(vaArgP, char *);
+                    for (ui32Idx = 0; pcStr[ui32Idx] != '\0'; ui32Idx++)
+                    {
+                    }
+                    UARTwrite(pcStr, ui32Idx);
+                    if (ui32Count > ui32Idx)
+                    {
+                        ui32Count -= ui32Idx;
+                        while (ui32Count--)
+                            UARTwrite(" ", 1);
+                    }
+                    break;
+                }
+                case 'u':
+                {
+                    ui32Value = va_arg(vaArgP, uint32_t);
+                    ui32Pos = 0;
+                    ui32Base = 10;
+                    ui32Neg = 0;
+convert:
+                    for (ui32Idx = 1;
+                         (((ui32Idx * ui32Base) <= ui32Value) &&
+                          (((ui32Idx * ui32Base) / ui32Base) == ui32Idx));
+                         ui32Idx *= ui32Base, ui32Count--)
+                    {
+                    }
+                    if (ui32Neg)
+                        ui32Count--;
+                    if (ui32Neg && (cFill == '0'))
+                    {
+                        pcBuf[ui32Pos++] = '-';
+                        ui32Neg = 0;
+                    }
+                    if ((ui32Count > 1) && (ui32Count < 16))
+                    {
+                        for (ui32Count--; ui32Count; ui32Count--)
+                            pcBuf[ui32Pos++] = cFill;
+                    }
+                    if (ui32Neg)
+                        pcBuf[ui32Pos++] = '-';
+                    for (; ui32Idx; ui32Idx /= ui32Base)
+                        pcBuf[ui32Pos++] =
+                            g_pcHex[(ui32Value / ui32Idx) % ui32Base];
+                    UARTwrite(pcBuf, ui32Pos);
+                    break;
+                }
+                case '%':
+                {
+                    UARTwrite(pcString - 1, 1);
+                    break;
+                }
+                default:
+                {
+                    UARTwrite("ERROR", 5);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void UARTprintf(const char *pcString, ...)
+{
+    va_list vaArgP;
+
+    va_start(vaArgP, pcString);
+    UARTvprintf(pcString, vaArgP);
+    va_end(vaArgP);
+}
+
+//
+// The two ways of sending a status line
+//
+void StatusPrintf(const tTelemetrySample *psSample)
+{
+    UARTprintf("P1 = %d | P2 = %d | PWM = %d\n",
+               psSample->Position1, psSample->Position2, psSample->PWM);
+}
+
+void StatusRecord(const tTelemetrySample *psSample)
+{
+    char pcLine[FMT_RECORD_SIZE(TELEMETRY_STATUS_FORMAT)];
+    char *pcEnd = pcLine;
+
+    FMT_RECORD(pcEnd, TELEMETRY_STATUS_FORMAT, psSample);
+    RingBufWrite(&g_sTx, reinterpret_cast<const uint8_t *>(pcLine),
+                 static_cast<uint32_t>(pcEnd - pcLine));
+}
+
+//
+// Drain the transmit buffer as the UART interrupt would
+//
+std::string Drain()
+{
+    std::string sOut;
+    uint8_t *pui8Data;
+    uint32_t ui32Len;
+
+    while ((ui32Len = RingBufSpan(&g_sTx, g_sTx.Read, &pui8Data)) != 0)
+    {
+        sOut.append(reinterpret_cast<char *>(pui8Data), ui32Len);
+        RingBufRelease(&g_sTx, ui32Len);
+    }
+    return sOut;
+}
+
+uint64_t CheckValue(int64_t i64Value)
+{
+    char pcExpected[16], pcBuf[16];
+    char *pcEnd;
+
+    if (i64Value >= 0 && i64Value <= UINT32_MAX)
+    {
+        std::snprintf(pcExpected, sizeof(pcExpected), "%u",
+                      static_cast<uint32_t>(i64Value));
+        pcEnd = FmtUint(pcBuf, static_cast<uint32_t>(i64Value));
+        if (std::string(pcBuf, pcEnd) != pcExpected)
+            return 1;
+    }
+    if (i64Value >= INT32_MIN && i64Value <= INT32_MAX)
+    {
+        std::snprintf(pcExpected, sizeof(pcExpected), "%d",
+                      static_cast<int32_t>(i64Value));
+        pcEnd = FmtInt(pcBuf, static_cast<int32_t>(i64Value));
+        if (std::string(pcBuf, pcEnd) != pcExpected)
+            return 1;
+    }
+    return 0;
+}
+
+uint64_t Check()
+{
+    uint64_t errors = 0;
+    std::mt19937 rng(1);
+
+    for (uint64_t x = 0; x <= UINT32_MAX; x++)
+        if (FMT_DIV100(x) != x / 100)
+            errors++;
+
+    for (int64_t p = 1; p <= 10000000000LL; p *= 10)
+        for (int64_t d = -1; d <= 1; d++)
+            errors += CheckValue(p + d) + CheckValue(-(p + d));
+    errors += CheckValue(0) + CheckValue(UINT32_MAX) +
+              CheckValue(INT32_MIN) + CheckValue(INT32_MAX);
+    for (uint32_t i = 0; i < 2000000; i++)
+    {
+        uint32_t value = rng() >> (rng() % 32);
+
+        errors += CheckValue(value) +
+                  CheckValue(static_cast<int32_t>(value));
+    }
+
+    std::printf("check   %llu errors\n",
+                static_cast<unsigned long long>(errors));
+    return errors;
+}
+
+//
+// Status samples of a cruising axis, a slow one and an open loop command,
+// with a few large and negative values
+//
+std::vector<tTelemetrySample> Samples(uint32_t ui32Count)
+{
+    std::vector<tTelemetrySample> samples(ui32Count);
+    std::mt19937 rng(2);
+    int32_t i32P1 = -50000, i32P2 = 0;
+
+    for (uint32_t i = 0; i < ui32Count; i++)
+    {
+        tTelemetrySample &s = samples[i];
+
+        i32P1 += 2500;
+        i32P2 += static_cast<int32_t>(rng() % 21) - 10;
+        s.Tick = i;
+        s.Position1 = (i % 97 == 0) ? INT32_MIN + static_cast<int32_t>(i) :
+                      i32P1;
+        s.Position2 = i32P2;
+        s.PWM = static_cast<int32_t>(rng() % 201) - 100;
+        s.Error1 = s.Error2 = s.U1 = s.U2 = 0;
+    }
+    return samples;
+}
+
+template <typename Send>
+double BenchLines(const std::vector<tTelemetrySample> &samples, Send send)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (const tTelemetrySample &s : samples)
+    {
+        send(&s);
+        RingBufFlush(&g_sTx);
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count() * 1e9 /
+           samples.size();
+}
+
+uint64_t Bench(uint32_t ui32Lines)
+{
+    std::vector<tTelemetrySample> samples = Samples(ui32Lines);
+    uint64_t errors = 0, bytes = 0;
+
+    //
+    // Same output, line by line
+    //
+    for (const tTelemetrySample &s : samples)
+    {
+        StatusPrintf(&s);
+        std::string sPrintf = Drain();
+        StatusRecord(&s);
+        std::string sRecord = Drain();
+
+        if (sPrintf != sRecord)
+        {
+            if (errors++ == 0)
+                std::printf("mismatch: \"%s\" \"%s\"\n", sPrintf.c_str(),
+                            sRecord.c_str());
+        }
+        bytes += sRecord.size();
+    }
+
+    double fPrintf = BenchLines(samples, StatusPrintf);
+    double fRecord = BenchLines(samples, StatusRecord);
+
+    std::printf("bench   %u status lines, %.1f bytes each, %llu mismatched\n",
+                ui32Lines, static_cast<double>(bytes) / ui32Lines,
+                static_cast<unsigned long long>(errors));
+    std::printf("  %-10s %10s\n", "", "ns/line");
+    std::printf("  %-10s %10.1f\n", "UARTprintf", fPrintf);
+    std::printf("  %-10s %10.1f   %.1fx\n", "fmt", fRecord, fPrintf / fRecord);
+
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t ui32Lines = 1000000;
+    uint64_t errors = 0;
+
+    if (argc > 1)
+        ui32Lines = static_cast<uint32_t>(std::strtoul(argv[1], 0, 0));
+
+    errors += Check();
+    errors += Bench(ui32Lines);
+
+    std::printf("%s\n", errors ? "FAILED" : "ok");
+    return errors ? 1 : 0;
+}
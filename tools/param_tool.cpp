@@ -0,0 +1,277 @@
+//*****************************************************************************
+//
+// param_tool.cpp - Host side access to the parameter EEPROM image.
+//
+// Runs params.c against a file-backed stand-in for the TM4C123 EEPROM, so
+// that images can be prepared, inspected and checked on the host with the
+// same code the firmware boots with.  The file holds the 2 KB of the
+// EEPROM; a missing file reads as erased.
+//
+// Build:
+//   gcc -O2 -I.. -I../host/include -c ../params.c
+//   g++ -std=c++17 -O2 -I.. -o param_tool param_tool.cpp params.o
+//
+// Usage:
+//   param_tool eeprom.bin show              load as at reset and list
+//   param_tool eeprom.bin set <n> <m> <v>   set parameter n of motor m
+//                                           (1 for single values), commit
+//   param_tool eeprom.bin defaults          commit the defaults
+//   param_tool eeprom.bin check             load/commit round trip, and
+//                                           rejection of damaged images
+//
+// Parameter numbers and units are those of the "params" console command.
+// "check" works on a copy of the image and leaves the file alone.
+//
+//*****************************************************************************
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "params.h"
+}
+
+namespace
+{
+
+const uint32_t kEepromSize = 2048;
+
+const char *const kLoadResult[] =
+{
+    "loaded", "blank", "bad layout", "bad CRC", "EEPROM error"
+};
+
+//
+// The EEPROM stand-in: the image in memory, and the file it came from
+//
+std::vector<uint8_t> g_eeprom(kEepromSize, 0xFF);
+uint32_t g_programCount = 0;
+
+bool EepromFileRead(const std::string &path)
+{
+    std::fill(g_eeprom.begin(), g_eeprom.end(), 0xFF);
+
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    std::fread(g_eeprom.data(), 1, g_eeprom.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+bool EepromFileWrite(const std::string &path)
+{
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::perror(path.c_str());
+        return false;
+    }
+    std::fwrite(g_eeprom.data(), 1, g_eeprom.size(), file);
+    return std::fclose(file) == 0;
+}
+
+void List()
+{
+    for (uint32_t i = 0; i < PARAM_COUNT; i++)
+    {
+        const tParamInfo &info = g_psParamInfo[i];
+
+        std::printf("%2u %6s%c", i, info.pcName, info.bReset ? '*' : ' ');
+        for (uint32_t j = 0; j < info.ui32Count; j++)
+        {
+            int32_t value;
+            ParamGet(i, j, &value);
+            std::printf(" %d", value);
+        }
+        std::printf("\n");
+    }
+}
+
+//
+// One step of the self check
+//
+bool Expect(const char *what, bool ok)
+{
+    std::printf("%-40s %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int Check()
+{
+    bool ok = true;
+    tParams saved;
+
+    //
+    // Erased EEPROM
+    //
+    std::fill(g_eeprom.begin(), g_eeprom.end(), 0xFF);
+    ok &= Expect("blank EEPROM gives the defaults",
+                 ParamsLoad() == PARAM_BLANK);
+
+    //
+    // Round trip of a changed parameter.  The load must be the image as
+    // committed, word for word.
+    //
+    int32_t before = 0, after = 0;
+    ok &= Expect("set kp of motor 2", ParamSet(0, 1, 1234567));
+    ParamGet(0, 1, &before);
+    ok &= Expect("commit", ParamsCommit());
+    std::memcpy(&saved, &g_sParams, sizeof(tParams));
+    ParamsDefaults();
+    ok &= Expect("load after commit", ParamsLoad() == PARAM_LOADED);
+    ok &= Expect("loaded image matches the committed one",
+                 std::memcmp(&saved.Kp, &g_sParams.Kp,
+                             offsetof(tParams, Crc) -
+                             offsetof(tParams, Kp)) == 0);
+
+    ParamGet(0, 1, &after);
+    ok &= Expect("kp of motor 2 survives", after == before);
+
+    //
+    // Out of range values are refused
+    //
+    ok &= Expect("negative gain refused", !ParamSet(0, 0, -1));
+    ok &= Expect("motor out of range refused",
+                 !ParamSet(0, MOTOR_NUM_AXES, 1));
+
+    //
+    // Damage every byte of the image in turn
+    //
+    uint32_t missed = 0;
+    for (uint32_t i = 0; i < sizeof(tParams); i++)
+    {
+        g_eeprom[PARAM_EEPROM_ADDRESS + i] ^= 0x10;
+        if (ParamsLoad() == PARAM_LOADED)
+            missed++;
+        g_eeprom[PARAM_EEPROM_ADDRESS + i] ^= 0x10;
+    }
+    ok &= Expect("every damaged byte rejected", missed == 0);
+
+    //
+    // Image of another version
+    //
+    uint32_t version = PARAM_VERSION + 1;
+    std::memcpy(&g_eeprom[PARAM_EEPROM_ADDRESS + offsetof(tParams, Version)],
+                &version, sizeof(version));
+    ok &= Expect("other version rejected",
+                 ParamsLoad() == PARAM_BAD_LAYOUT);
+
+    std::printf("image %u bytes, %u programs\n",
+                static_cast<unsigned>(sizeof(tParams)), g_programCount);
+
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+//
+// TivaWare functions used by params.c
+//
+extern "C"
+{
+
+void SysCtlPeripheralEnable(uint32_t)
+{
+}
+
+bool SysCtlPeripheralReady(uint32_t)
+{
+    return true;
+}
+
+bool IntMasterDisable(void)
+{
+    return false;
+}
+
+bool IntMasterEnable(void)
+{
+    return false;
+}
+
+uint32_t EEPROMInit(void)
+{
+    return 0;
+}
+
+void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    std::memcpy(pui32Data, &g_eeprom[ui32Address], ui32Count);
+}
+
+uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address,
+                       uint32_t ui32Count)
+{
+    if ((ui32Address & 3) || (ui32Count & 3) ||
+        (ui32Address + ui32Count > kEepromSize))
+        return 1;
+
+    std::memcpy(&g_eeprom[ui32Address], pui32Data, ui32Count);
+    g_programCount++;
+    return 0;
+}
+
+} // extern "C"
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s <image> show|set <n> <m> <v>|defaults|check\n",
+                     argv[0]);
+        return 1;
+    }
+
+    std::string path = argv[1];
+    std::string command = argv[2];
+
+    EepromFileRead(path);
+
+    if (command == "check")
+        return Check();
+
+    uint32_t result = ParamsLoad();
+
+    if (command == "show")
+    {
+        std::printf("%s: %s\n", path.c_str(), kLoadResult[result]);
+        List();
+        return 0;
+    }
+
+    if (command == "set" && argc == 6)
+    {
+        if (!ParamSet(std::stoul(argv[3]), std::stoul(argv[4]) - 1,
+                      std::stol(argv[5])))
+        {
+            std::fprintf(stderr, "Invalid parameter or value\n");
+            return 1;
+        }
+    }
+    else if (command == "defaults")
+    {
+        ParamsDefaults();
+    }
+    else
+    {
+        std::fprintf(stderr, "Unknown command %s\n", command.c_str());
+        return 1;
+    }
+
+    if (!ParamsCommit())
+    {
+        std::fprintf(stderr, "EEPROM write failed\n");
+        return 1;
+    }
+
+    List();
+    return EepromFileWrite(path) ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+//*****************************************************************************
+//
+// ringbuf_stress.cpp - Host stress test and benchmark of ringbuf.h.
+//
+// stress: a producer and a consumer thread, standing in for the console
+// interrupt and the application, stream a known byte sequence through
+// small and large rings.  The producer mixes single bytes, whole blocks
+// and staged bytes that are partly taken back before publishing (the line
+// editing of uartstdio.c); the consumer mixes single bytes, contiguous
+// spans released in parts (the uDMA path) and look-ahead.  Every byte must
+// arrive once, in order, and the fill level must never exceed the size.
+// The indices start just below the 32-bit wrap.
+//
+// bench: host throughput of the ring against the modulo indexed buffer
+// uartstdio.c used before, per byte on one thread and streaming between
+// two threads.  Host numbers only compare the two; they are not target
+// cycles.
+//
+// Build:
+//   g++ -std=c++17 -O2 -pthread -I.. -o ringbuf_stress ringbuf_stress.cpp
+//
+// Usage:
+//   ringbuf_stress [megabytes]      default 8 per stress run
+//
+//*****************************************************************************
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "ringbuf.h"
+
+namespace
+{
+
+//
+// Byte number i of the test sequence
+//
+inline uint8_t Expected(uint64_t i)
+{
+    return static_cast<uint8_t>((i * 2654435761u) >> 13);
+}
+
+//
+// Small deterministic generator, one per thread
+//
+struct Random
+{
+    uint32_t state;
+
+    uint32_t Next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+tRingBuf MakeRing(std::vector<uint8_t> &storage, uint32_t start)
+{
+    tRingBuf ring = { storage.data(),
+                      static_cast<uint32_t>(storage.size() - 1), 0, 0, 0 };
+
+    ring.Write = ring.Read = ring.Stage = start;
+    return ring;
+}
+
+//
+// Stream total bytes through a ring of the given size.  Returns the number
+// of errors.
+//
+uint64_t Stress(uint32_t size, uint64_t total)
+{
+    std::vector<uint8_t> storage(size);
+    tRingBuf ring = MakeRing(storage, 0xFFFFFF00u);
+    std::atomic<uint64_t> errors(0);
+    std::atomic<uint32_t> maxUsed(0);
+
+    std::thread producer([&]()
+    {
+        Random rng = { 1 };
+        uint64_t sent = 0;
+        uint8_t block[64];
+
+        while (sent < total)
+        {
+            uint64_t before = sent;
+            uint32_t kind = rng.Next() % 4;
+            uint32_t n = 1 + rng.Next() % 48;
+
+            if (n > total - sent)
+                n = static_cast<uint32_t>(total - sent);
+
+            if (kind == 0)
+            {
+                if (RingBufPut(&ring, Expected(sent)))
+                    sent++;
+            }
+            else if (kind == 1)
+            {
+                for (uint32_t i = 0; i < n; i++)
+                    block[i] = Expected(sent + i);
+                if (RingBufWrite(&ring, block, n))
+                    sent += n;
+            }
+            else
+            {
+                //
+                // Stage n bytes with a few wrong ones in between that are
+                // taken back, like a line edited with backspace
+                //
+                uint32_t staged = 0;
+
+                while (staged < n)
+                {
+                    if (rng.Next() % 5 == 0)
+                    {
+                        if (!RingBufStage(&ring, 0xEE))
+                            break;
+                        if (!RingBufUnstage(&ring))
+                            errors++;
+                        continue;
+                    }
+                    if (!RingBufStage(&ring, Expected(sent + staged)))
+                        break;
+                    staged++;
+                }
+                RingBufPublish(&ring);
+                sent += staged;
+            }
+
+            if (sent == before)
+                std::this_thread::yield();
+        }
+    });
+
+    std::thread consumer([&]()
+    {
+        Random rng = { 2 };
+        uint64_t received = 0;
+
+        while (received < total)
+        {
+            uint32_t used = RingBufUsed(&ring);
+            uint32_t seen = maxUsed.load();
+
+            if (used > seen)
+                maxUsed.store(used);
+            if (used == 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            uint32_t kind = rng.Next() % 3;
+
+            if (kind == 0)
+            {
+                uint8_t byte;
+
+                if (RingBufGet(&ring, &byte))
+                {
+                    if (byte != Expected(received))
+                        errors++;
+                    received++;
+                }
+            }
+            else if (kind == 1)
+            {
+                uint8_t *data;
+                uint32_t len = RingBufSpan(&ring, ring.Read, &data);
+
+                len = 1 + rng.Next() % len;
+                for (uint32_t i = 0; i < len; i++)
+                    if (data[i] != Expected(received + i))
+                        errors++;
+                RingBufRelease(&ring, len);
+                received += len;
+            }
+            else
+            {
+                uint32_t offset = rng.Next() % used;
+
+                if (RingBufPeek(&ring, offset) != Expected(received + offset))
+                    errors++;
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    if (RingBufUsed(&ring) != 0)
+        errors++;
+    if (maxUsed.load() > size)
+        errors++;
+
+    std::printf("stress  %5u bytes  %8.1f MB  max used %5u  errors %llu\n",
+                size, total / 1e6, maxUsed.load(),
+                static_cast<unsigned long long>(errors.load()));
+
+    return errors.load();
+}
+
+//
+// The transmit buffer of uartstdio.c as it was: indices kept below the
+// size with a modulo, one byte left free to tell full from empty
+//
+struct ModuloRing
+{
+    uint8_t *data;
+    uint32_t size;
+    volatile uint32_t write;
+    volatile uint32_t read;
+};
+
+bool ModuloPut(ModuloRing &r, uint8_t byte)
+{
+    uint32_t write = r.write;
+
+    if ((write + 1) % r.size == r.read)
+        return false;
+    r.data[write] = byte;
+    r.write = (write + 1) % r.size;
+    return true;
+}
+
+bool ModuloGet(ModuloRing &r, uint8_t *byte)
+{
+    uint32_t read = r.read;
+
+    if (read == r.write)
+        return false;
+    *byte = r.data[read];
+    r.read = (read + 1) % r.size;
+    return true;
+}
+
+double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count();
+}
+
+//
+// One thread, fill and drain in bursts of 100 bytes, ns per byte
+//
+template <typename Put, typename Get>
+double BenchSingle(uint64_t total, Put put, Get get)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint32_t sum = 0;
+    uint8_t byte;
+
+    for (uint64_t i = 0; i < total; i += 100)
+    {
+        for (uint32_t j = 0; j < 100; j++)
+            put(static_cast<uint8_t>(j));
+        for (uint32_t j = 0; j < 100; j++)
+            if (get(&byte))
+                sum += byte;
+    }
+
+    if (sum == 1)
+        std::printf(" ");
+    return Seconds(start) * 1e9 / total;
+}
+
+//
+// Two threads, byte at a time, MB/s
+//
+template <typename Put, typename Get>
+double BenchStream(uint64_t total, Put put, Get get)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&]()
+    {
+        for (uint64_t i = 0; i < total; )
+            if (put(static_cast<uint8_t>(i)))
+                i++;
+            else
+                std::this_thread::yield();
+    });
+
+    uint8_t byte;
+    for (uint64_t i = 0; i < total; )
+        if (get(&byte))
+            i++;
+        else
+            std::this_thread::yield();
+
+    producer.join();
+    return total / Seconds(start) / 1e6;
+}
+
+void Bench(uint64_t total)
+{
+    const uint32_t kSize = 2048;
+    std::vector<uint8_t> storage(kSize), moduloStorage(kSize);
+    tRingBuf ring = MakeRing(storage, 0);
+    ModuloRing modulo = { moduloStorage.data(), kSize, 0, 0 };
+
+    auto ringPut = [&](uint8_t b) { return RingBufPut(&ring, b); };
+    auto ringGet = [&](uint8_t *b) { return RingBufGet(&ring, b); };
+    auto moduloPut = [&](uint8_t b) { return ModuloPut(modulo, b); };
+    auto moduloGet = [&](uint8_t *b) { return ModuloGet(modulo, b); };
+
+    std::printf("bench   %u byte buffer, %.0f MB\n", kSize, total / 1e6);
+    std::printf("  %-8s %10s %12s\n", "", "ns/byte", "stream MB/s");
+    std::printf("  %-8s %10.2f %12.1f\n", "ringbuf",
+                BenchSingle(total, ringPut, ringGet),
+                BenchStream(total, ringPut, ringGet));
+    std::printf("  %-8s %10.2f %12.1f\n", "modulo",
+                BenchSingle(total, moduloPut, moduloGet),
+                BenchStream(total, moduloPut, moduloGet));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t total = 8;
+    uint64_t errors = 0;
+
+    if (argc > 1)
+        total = std::strtoull(argv[1], 0, 0);
+    total *= 1000000;
+
+    errors += Stress(2, total / 16);
+    errors += Stress(16, total / 4);
+    errors += Stress(128, total);
+    errors += Stress(2048, total);
+
+    Bench(total);
+
+    std::printf("%s\n", errors ? "FAILED" : "ok");
+    return errors ? 1 : 0;
+}
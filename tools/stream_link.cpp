@@ -0,0 +1,342 @@
+//*****************************************************************************
+//
+// stream_link.cpp - The setpoint stream of stream.c behind a pty.
+//
+// Runs stream.c on the host in place of the target, for trying
+// tools/stream_send.cpp without a board.  The console is a pty whose name
+// is printed at start.  Control ticks run in real time at CONTROL_TICK_HZ,
+// and the bytes in each direction are paced at the baud rate (10 bits a
+// byte) through a receive buffer of UART_RX_BUFFER_SIZE and a transmit
+// buffer of UART_TX_BUFFER_SIZE, so the credits and underruns come out as
+// they would on the target.  Of the console it only knows "stream <n>".
+//
+// Every point the control interrupt takes is written as an
+// "axis,position,velocity" line, which gives back the sender's input when
+// no point was lost.
+//
+// Build:
+//   gcc -O2 -DUART_BUFFERED -I.. -c ../stream.c ../frame.c
+//   g++ -std=c++17 -O2 -I.. -o stream_link stream_link.cpp stream.o frame.o
+//
+// Usage:
+//   stream_link [-b baud] [-o points.csv] [-1]
+//
+// -1 exits after the first stream.
+//
+//*****************************************************************************
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+//
+// Console options of the project
+//
+#define UART_BUFFERED
+#define UART_TX_BUFFER_SIZE     2048
+
+#include "utils/uartstdio.h"
+#include "stream.h"
+
+namespace
+{
+
+const size_t kRxSize = UART_RX_BUFFER_SIZE;
+const size_t kTxSize = UART_TX_BUFFER_SIZE;
+
+std::deque<uint8_t> g_rx, g_tx;
+bool g_echo = true;
+uint32_t g_rxOverruns = 0;
+
+} // namespace
+
+//*****************************************************************************
+//
+// The parts of uartstdio.c and telemetry.c that stream.c uses
+//
+//*****************************************************************************
+extern "C"
+{
+
+int UARTRxBytesAvail(void)
+{
+    return (int)g_rx.size();
+}
+
+unsigned char UARTgetc(void)
+{
+    unsigned char c = g_rx.front();
+
+    g_rx.pop_front();
+    return c;
+}
+
+int UARTwriteRaw(const unsigned char *pucBuf, uint32_t ui32Len)
+{
+    if (kTxSize - g_tx.size() < ui32Len)
+        return 0;
+    g_tx.insert(g_tx.end(), pucBuf, pucBuf + ui32Len);
+    return (int)ui32Len;
+}
+
+void UARTFlushRx(void)
+{
+    g_rx.clear();
+}
+
+void UARTEchoSet(bool bEnable)
+{
+    g_echo = bEnable;
+}
+
+void UARTprintf(const char *pcString, ...)
+{
+    char buf[256];
+    va_list args;
+
+    va_start(args, pcString);
+    std::vsnprintf(buf, sizeof(buf), pcString, args);
+    va_end(args);
+
+    for (const char *p = buf; *p && g_tx.size() + 2 <= kTxSize; p++)
+    {
+        if (*p == '\n')
+            g_tx.push_back('\r');
+        g_tx.push_back((uint8_t)*p);
+    }
+}
+
+void TelemetryTextSet(bool bEnable)
+{
+    (void)bEnable;
+}
+
+} // extern "C"
+
+namespace
+{
+
+//
+// Open a pty in raw mode, the name of the other side goes to *name
+//
+int OpenPty(std::string *name)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if ((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0))
+        return -1;
+    *name = ptsname(fd);
+
+    //
+    // Keep a handle on the other side so that the pty stays up between
+    // senders, and make it raw before any sender opens it
+    //
+    int slave = open(name->c_str(), O_RDWR | O_NOCTTY);
+    if ((slave < 0) || (tcgetattr(slave, &tio) != 0))
+        return -1;
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+//
+// Console in text mode: echo, and "stream <n>" on a line
+//
+void TextChar(uint8_t c, std::string &line)
+{
+    static const int64_t start[MOTOR_NUM_AXES] = { 0 };
+
+    if (g_echo && (c != '\r'))
+        g_tx.push_back(c);
+
+    if ((c != '\r') && (c != '\n'))
+    {
+        if (line.size() < 64)
+            line.push_back((char)c);
+        return;
+    }
+
+    unsigned long period;
+
+    if (std::sscanf(line.c_str(), "stream %lu", &period) == 1)
+    {
+        if (!StreamStart(period, start))
+            UARTprintf("\nBad argument\n");
+    }
+    else if (!line.empty())
+        UARTprintf("\nBad command!\n");
+    line.clear();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    unsigned long baud = 115200;
+    FILE *out = stdout;
+    bool once = false;
+    std::string name, line;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string opt = argv[i];
+
+        if ((opt == "-b") && (i + 1 < argc))
+            baud = std::strtoul(argv[++i], 0, 0);
+        else if ((opt == "-o") && (i + 1 < argc))
+        {
+            out = std::fopen(argv[++i], "w");
+            if (!out)
+            {
+                std::perror(argv[i]);
+                return 1;
+            }
+        }
+        else if (opt == "-1")
+            once = true;
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [-b baud] [-o points.csv] [-1]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    int fd = OpenPty(&name);
+    if (fd < 0)
+    {
+        std::perror("pty");
+        return 1;
+    }
+    std::fprintf(stderr, "%s\n", name.c_str());
+
+    //
+    // Bytes per tick in each direction, in 1/CONTROL_TICK_HZ of a byte
+    //
+    const uint64_t bytesPerSecond = baud / 10;
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t tick = 0, rxBudget = 0, txBudget = 0;
+    uint32_t taken[MOTOR_NUM_AXES] = { 0 };
+    std::deque<uint8_t> wire;
+    bool streamed = false;
+
+    for (;;)
+    {
+        uint64_t due = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - begin).count() *
+                       CONTROL_TICK_HZ / 1000000;
+
+        if (tick >= due)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        //
+        // What the host has written is on the wire until the baud rate
+        // lets it through
+        //
+        uint8_t buf[512];
+        ssize_t got;
+
+        while ((got = read(fd, buf, sizeof(buf))) > 0)
+            wire.insert(wire.end(), buf, buf + got);
+
+        for (; tick < due; tick++)
+        {
+            rxBudget += bytesPerSecond;
+            while ((rxBudget >= CONTROL_TICK_HZ) && !wire.empty())
+            {
+                if (g_rx.size() < kRxSize)
+                    g_rx.push_back(wire.front());
+                else
+                    g_rxOverruns++;
+                wire.pop_front();
+                rxBudget -= CONTROL_TICK_HZ;
+            }
+            if (wire.empty())
+                rxBudget = 0;
+
+            txBudget += bytesPerSecond;
+            while ((txBudget >= CONTROL_TICK_HZ) && !g_tx.empty())
+            {
+                uint8_t c = g_tx.front();
+
+                if (write(fd, &c, 1) != 1)
+                    break;
+                g_tx.pop_front();
+                txBudget -= CONTROL_TICK_HZ;
+            }
+            if (g_tx.empty())
+                txBudget = 0;
+
+            //
+            // The control interrupt, then the main loop
+            //
+            if (StreamStep())
+            {
+                for (uint32_t a = 0; a < MOTOR_NUM_AXES; a++)
+                {
+                    if (g_sStream.Read[a] == taken[a])
+                        continue;
+                    taken[a] = g_sStream.Read[a];
+                    std::fprintf(out, "%u,%d,%d\n", a,
+                                 (int32_t)(uint32_t)(g_sStream.Start[a] +
+                                                     g_sStream.Delta[a]),
+                                 g_sStream.Velocity[a]);
+                }
+            }
+
+            if (StreamPoll())
+            {
+                streamed = true;
+                continue;
+            }
+            while (!g_rx.empty() && (g_sStream.State == STREAM_OFF))
+                TextChar(UARTgetc(), line);
+        }
+
+        if (streamed && (g_sStream.State == STREAM_OFF))
+        {
+            streamed = false;
+            for (uint32_t a = 0; a < MOTOR_NUM_AXES; a++)
+                taken[a] = 0;
+            std::fflush(out);
+            if (g_rxOverruns)
+                std::fprintf(stderr, "%u bytes lost to receive overruns\n",
+                             g_rxOverruns);
+            if (once)
+            {
+                while (!g_tx.empty())
+                {
+                    uint8_t c = g_tx.front();
+
+                    if (write(fd, &c, 1) != 1)
+                        break;
+                    g_tx.pop_front();
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                break;
+            }
+        }
+    }
+
+    if (out != stdout)
+        std::fclose(out);
+    close(fd);
+    return 0;
+}
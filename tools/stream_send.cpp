@@ -0,0 +1,448 @@
+//*****************************************************************************
+//
+// stream_send.cpp - Host side sender of the setpoint stream.
+//
+// Switches the target to the binary setpoint stream (see stream.h) with
+// "stream <n>" and sends a list of points under credit flow control: a
+// point of an axis is only sent while fewer than STREAM_FIFO_SIZE points of
+// that axis are outstanding, counted from the points taken that the target
+// reports.  Points are sent in the order they are listed, up to
+// STREAM_POINTS_MAX per frame.
+//
+// The points are either read from a CSV file, one "axis,position,velocity"
+// line per point in counts and counts/s, or generated as circles on motors
+// 1 and 2 (axes 0 and 1) starting at (x, y) and turning counterclockwise
+// around (x - r, y), with the velocity feedforward along the tangent.
+//
+// Build:
+//   g++ -std=c++17 -O2 -I.. -o stream_send stream_send.cpp ../frame.c
+//
+// Usage:
+//   stream_send <device> [-b baud] [-n ticks] -f points.csv
+//   stream_send <device> [-b baud] [-n ticks] -c r points revs [x y]
+//
+// -n is the number of control ticks per point (default 20).  The exit code
+// is 0 if the stream ended without an error and without underruns.
+//
+// tools/stream_link.cpp stands in for the target on a pty.
+//
+//*****************************************************************************
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "frame.h"
+#include "stream.h"
+
+namespace
+{
+
+struct Point
+{
+    uint32_t axis;
+    int32_t position;
+    int32_t velocity;
+};
+
+//
+// What the target last reported
+//
+struct Report
+{
+    bool valid = false;
+    uint32_t state = STREAM_OFF;
+    uint32_t error = STREAM_ERR_NONE;
+    uint32_t fifoSize = 0;
+    uint32_t axes = 0;
+    std::vector<uint32_t> taken;
+    std::vector<uint32_t> underruns;
+};
+
+const int kReportTimeoutMs = 5000;
+
+const char *const kErrors[] =
+{
+    "none", "bad frame", "frame lost", "overflow", "bad axis", "timeout",
+    "aborted"
+};
+
+uint32_t Get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void Put32(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 24));
+}
+
+speed_t BaudToSpeed(unsigned long baud)
+{
+    switch (baud)
+    {
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        case 1000000: return B1000000;
+        case 1500000: return B1500000;
+        case 2000000: return B2000000;
+        default:      return 0;
+    }
+}
+
+//
+// Put a tty into raw mode at the requested baud rate
+//
+bool ConfigurePort(int fd, unsigned long baud)
+{
+    struct termios tio;
+    speed_t speed;
+
+    speed = BaudToSpeed(baud);
+    if (speed == 0)
+    {
+        std::fprintf(stderr, "Unsupported baud rate %lu\n", baud);
+        return false;
+    }
+
+    if (tcgetattr(fd, &tio) != 0)
+        return false;
+
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+bool WriteAll(int fd, const uint8_t *data, size_t len)
+{
+    while (len)
+    {
+        ssize_t n = write(fd, data, len);
+
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool SendFrame(int fd, const std::vector<uint8_t> &payload)
+{
+    std::vector<uint8_t> frame(FRAME_MAX_ENCODED(payload.size()));
+
+    return WriteAll(fd, frame.data(),
+                    FrameEncode(payload.data(), payload.size(), frame.data()));
+}
+
+//
+// Receives the target's frames.  Console text and anything else that does
+// not decode is skipped.
+//
+class Receiver
+{
+public:
+    explicit Receiver(int fd) : fd_(fd) {}
+
+    //
+    // Wait up to timeoutMs for data and take in all reports that arrive.
+    // Returns false if nothing came.
+    //
+    bool Poll(Report &report, int timeoutMs)
+    {
+        struct pollfd pfd = { fd_, POLLIN, 0 };
+        uint8_t buf[512];
+        uint8_t payload[FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD)];
+
+        if (poll(&pfd, 1, timeoutMs) <= 0)
+            return false;
+
+        ssize_t got = read(fd_, buf, sizeof(buf));
+        if (got <= 0)
+            return false;
+
+        for (ssize_t i = 0; i < got; i++)
+        {
+            if (buf[i] != 0)
+            {
+                if (frame_.size() < FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD))
+                    frame_.push_back(buf[i]);
+                continue;
+            }
+
+            int32_t len = frame_.empty() ? -1 :
+                          FrameDecode(frame_.data(), frame_.size(), payload);
+            frame_.clear();
+
+            if ((len < 8) || (payload[0] != STREAM_FRAME_CREDITS) ||
+                (len != (int32_t)(8 + payload[6] * 8)))
+                continue;
+
+            report.valid = true;
+            report.state = payload[1];
+            report.error = payload[2];
+            report.fifoSize = payload[4] | (payload[5] << 8);
+            report.axes = payload[6];
+            report.taken.resize(report.axes);
+            report.underruns.resize(report.axes);
+            for (uint32_t a = 0; a < report.axes; a++)
+            {
+                report.taken[a] = Get32(&payload[8 + a * 8]);
+                report.underruns[a] = Get32(&payload[8 + a * 8 + 4]);
+            }
+        }
+        return true;
+    }
+
+private:
+    int fd_;
+    std::vector<uint8_t> frame_;
+};
+
+bool ReadPoints(const char *path, std::vector<Point> &points)
+{
+    FILE *file = std::fopen(path, "r");
+    long axis, position, velocity;
+    char line[128];
+
+    if (!file)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    while (std::fgets(line, sizeof(line), file))
+    {
+        if (std::sscanf(line, "%ld,%ld,%ld", &axis, &position, &velocity) != 3)
+            continue;
+        points.push_back({ (uint32_t)axis, (int32_t)position,
+                           (int32_t)velocity });
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+void CirclePoints(double r, uint32_t perRev, double revs, int32_t x, int32_t y,
+                  uint32_t ticks, std::vector<Point> &points)
+{
+    const double kPi = 3.14159265358979323846;
+    double omega = 2.0 * kPi * CONTROL_TICK_HZ / (perRev * (double)ticks);
+    uint32_t count = (uint32_t)(perRev * revs + 0.5);
+
+    for (uint32_t k = 1; k <= count; k++)
+    {
+        double angle = 2.0 * kPi * k / perRev;
+        double speed = (k == count) ? 0.0 : r * omega;
+
+        points.push_back({ 0, x + (int32_t)std::lround(r * (std::cos(angle) - 1.0)),
+                           (int32_t)std::lround(-speed * std::sin(angle)) });
+        points.push_back({ 1, y + (int32_t)std::lround(r * std::sin(angle)),
+                           (int32_t)std::lround(speed * std::cos(angle)) });
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    unsigned long baud = 115200;
+    uint32_t ticks = 20;
+    std::vector<Point> points;
+    int arg = 2;
+
+    if (argc < 3)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s <device> [-b baud] [-n ticks] -f points.csv\n"
+                     "       %s <device> [-b baud] [-n ticks] -c r points revs"
+                     " [x y]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    while (arg < argc)
+    {
+        std::string opt = argv[arg++];
+
+        if ((opt == "-b") && (arg < argc))
+            baud = std::strtoul(argv[arg++], 0, 0);
+        else if ((opt == "-n") && (arg < argc))
+            ticks = std::strtoul(argv[arg++], 0, 0);
+        else if ((opt == "-f") && (arg < argc))
+        {
+            if (!ReadPoints(argv[arg++], points))
+                return 1;
+        }
+        else if ((opt == "-c") && (arg + 2 < argc))
+        {
+            double r = std::atof(argv[arg]);
+            uint32_t perRev = std::strtoul(argv[arg + 1], 0, 0);
+            double revs = std::atof(argv[arg + 2]);
+            int32_t x = 0, y = 0;
+
+            arg += 3;
+            if (arg + 1 < argc && argv[arg][0] != '-')
+            {
+                x = std::strtol(argv[arg], 0, 0);
+                y = std::strtol(argv[arg + 1], 0, 0);
+                arg += 2;
+            }
+            CirclePoints(r, perRev, revs, x, y, ticks, points);
+        }
+        else
+        {
+            std::fprintf(stderr, "Bad argument %s\n", opt.c_str());
+            return 1;
+        }
+    }
+
+    if (points.empty() || (ticks < 1) || (ticks > 0xFF))
+    {
+        std::fprintf(stderr, "Nothing to send, or ticks not in 1..255\n");
+        return 1;
+    }
+
+    int fd = open(argv[1], O_RDWR | O_NOCTTY);
+    if (fd < 0)
+    {
+        std::perror(argv[1]);
+        return 1;
+    }
+    if (!ConfigurePort(fd, baud))
+    {
+        std::fprintf(stderr, "Cannot configure %s\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    //
+    // Switch the target over and wait for its first report
+    //
+    std::string command = "\rstream " + std::to_string(ticks) + "\r";
+    WriteAll(fd, (const uint8_t *)command.data(), command.size());
+
+    Receiver receiver(fd);
+    Report report;
+
+    while (!report.valid)
+    {
+        if (!receiver.Poll(report, kReportTimeoutMs))
+        {
+            std::fprintf(stderr, "No answer from the target\n");
+            close(fd);
+            return 1;
+        }
+    }
+
+    for (const Point &p : points)
+    {
+        if (p.axis >= report.axes)
+        {
+            std::fprintf(stderr, "The target has no axis %u\n", p.axis);
+            std::vector<uint8_t> abort = { STREAM_FRAME_ABORT };
+            SendFrame(fd, abort);
+            close(fd);
+            return 1;
+        }
+    }
+
+    //
+    // Send points as the credits allow, then the end of the stream, and
+    // wait for the target to finish
+    //
+    std::vector<uint32_t> sent(report.axes, 0);
+    size_t next = 0;
+    uint8_t sequence = 0;
+    uint32_t frames = 0;
+    bool ended = false;
+    const uint8_t delimiter = 0;
+
+    WriteAll(fd, &delimiter, 1);
+
+    while (report.state != STREAM_DONE)
+    {
+        std::vector<uint8_t> payload = { STREAM_FRAME_POINTS, sequence, 0 };
+        std::vector<uint32_t> outstanding(report.axes);
+
+        for (uint32_t a = 0; a < report.axes; a++)
+            outstanding[a] = sent[a] - report.taken[a];
+
+        while ((next < points.size()) && (payload[2] < STREAM_POINTS_MAX) &&
+               (outstanding[points[next].axis] < report.fifoSize))
+        {
+            const Point &p = points[next++];
+
+            payload.push_back((uint8_t)p.axis);
+            Put32(payload, (uint32_t)p.position);
+            Put32(payload, (uint32_t)p.velocity);
+            payload[2]++;
+            outstanding[p.axis]++;
+            sent[p.axis]++;
+        }
+
+        if (payload[2])
+        {
+            SendFrame(fd, payload);
+            sequence++;
+            frames++;
+            continue;
+        }
+
+        if ((next == points.size()) && !ended)
+        {
+            std::vector<uint8_t> end = { STREAM_FRAME_END, sequence++ };
+            SendFrame(fd, end);
+            frames++;
+            ended = true;
+        }
+
+        if (!receiver.Poll(report, kReportTimeoutMs))
+        {
+            std::fprintf(stderr, "The target stopped reporting\n");
+            std::vector<uint8_t> abort = { STREAM_FRAME_ABORT };
+            SendFrame(fd, abort);
+            close(fd);
+            return 1;
+        }
+    }
+
+    close(fd);
+
+    uint32_t underruns = 0;
+
+    std::printf("%zu of %zu points in %u frames, error %s, taken",
+                next, points.size(), frames,
+                (report.error < sizeof(kErrors) / sizeof(kErrors[0])) ?
+                kErrors[report.error] : "?");
+    for (uint32_t a = 0; a < report.axes; a++)
+        std::printf(" %u", report.taken[a]);
+    std::printf(", underruns");
+    for (uint32_t a = 0; a < report.axes; a++)
+    {
+        std::printf(" %u", report.underruns[a]);
+        underruns += report.underruns[a];
+    }
+    std::printf("\n");
+
+    return (report.error == STREAM_ERR_NONE && underruns == 0) ? 0 : 1;
+}
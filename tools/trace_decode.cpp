@@ -0,0 +1,368 @@
+//*****************************************************************************
+//
+// trace_decode.cpp - Host side decoder for the binary control loop trace.
+//
+// Reads the framed trace stream (see telemetry.h and frame.h) from a serial
+// port or from a capture file and writes one CSV line per sample.  Scope
+// captures sent with "dump" (scope.h) are decoded the same way, with a
+// comment line giving the tick of the trigger.
+//
+// Build:
+//   g++ -std=c++17 -O2 -I.. -o trace_decode trace_decode.cpp ../frame.c
+//
+// Usage:
+//   trace_decode /dev/ttyACM0 [baud] > trace.csv
+//   trace_decode capture.bin > trace.csv
+//
+// Start the trace on the target with "b<decimation>[,<mask>]" and stop it
+// with "b0".  Data that does not decode (console text, frames with a bad
+// CRC) is skipped; it is counted on stderr together with the samples the
+// target dropped.
+//
+//*****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "frame.h"
+
+namespace
+{
+
+const char *const kChannelNames[10] =
+{
+    "position1", "position2", "velocity1", "velocity2",
+    "error1", "error2", "u1", "u2", "setpoint1", "setpoint2"
+};
+
+//
+// Channels 6 and 7 (u1, u2) are Q16.16
+//
+const uint32_t kQ16Channels = 0xC0;
+
+const uint8_t kFrameSamples = 0x01;
+const size_t kHeaderSize = 10;
+
+//
+// Scope blocks.  The column header of a scope capture is told apart from
+// that of a trace with the same channels by kScopeMaskFlag.
+//
+const uint8_t kFrameScopeBlock = 0x02;
+const size_t kScopeHeaderSize = 16;
+const int kScopeChannels = 10;
+const uint32_t kScopeMaskFlag = 0x10000;
+
+struct Stats
+{
+    unsigned long frames = 0;
+    unsigned long rejected = 0;
+    unsigned long samples = 0;
+    unsigned long dropped = 0;
+};
+
+uint32_t Get16(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+uint32_t Get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+speed_t BaudToSpeed(unsigned long baud)
+{
+    switch (baud)
+    {
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        case 1000000: return B1000000;
+        case 1500000: return B1500000;
+        case 2000000: return B2000000;
+        default:      return 0;
+    }
+}
+
+//
+// Put a tty into raw mode at the requested baud rate.  Plain files are left
+// alone.
+//
+bool ConfigurePort(int fd, unsigned long baud)
+{
+    struct termios tio;
+    speed_t speed;
+
+    if (!isatty(fd))
+        return true;
+
+    speed = BaudToSpeed(baud);
+    if (speed == 0)
+    {
+        std::fprintf(stderr, "Unsupported baud rate %lu\n", baud);
+        return false;
+    }
+
+    if (tcgetattr(fd, &tio) != 0)
+        return false;
+
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+//
+// Print the column header for a channel mask
+//
+void PrintHeader(uint32_t mask)
+{
+    std::printf("tick");
+    for (int ch = 0; ch < kScopeChannels; ch++)
+        if (mask & (1u << ch))
+            std::printf(",%s", kChannelNames[ch]);
+    std::printf("\n");
+}
+
+//
+// Print one sample of the channels in mask
+//
+void PrintSample(uint32_t tick, uint32_t mask, const int32_t *values)
+{
+    std::printf("%u", tick);
+    for (int ch = 0; ch < kScopeChannels; ch++)
+    {
+        if (!(mask & (1u << ch)))
+            continue;
+
+        if (kQ16Channels & (1u << ch))
+            std::printf(",%.5f", *values / 65536.0);
+        else
+            std::printf(",%d", *values);
+        values++;
+    }
+    std::printf("\n");
+}
+
+//
+// Base 128 varint, false if it runs past the end
+//
+bool GetVarint(const uint8_t *&p, const uint8_t *end, uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (p == end)
+            return false;
+        value |= (uint32_t)(*p & 0x7F) << shift;
+        if (!(*p++ & 0x80))
+            return true;
+    }
+    return false;
+}
+
+//
+// Decode a scope block: the first sample whole, then zigzag coded
+// differences
+//
+void HandleScopeBlock(const uint8_t *payload, int32_t len, uint32_t &lastMask,
+                      Stats &stats)
+{
+    uint32_t mask, tick, decimation, trigger, count, channels;
+    const uint8_t *p, *end;
+    int32_t values[kScopeChannels];
+
+    if (len < (int32_t)kScopeHeaderSize)
+    {
+        stats.rejected++;
+        return;
+    }
+
+    mask = Get16(&payload[1]);
+    tick = Get32(&payload[4]);
+    decimation = Get16(&payload[8]);
+    trigger = Get32(&payload[10]);
+    count = Get16(&payload[14]);
+
+    channels = 0;
+    for (int ch = 0; ch < kScopeChannels; ch++)
+        if (mask & (1u << ch))
+            channels++;
+
+    p = &payload[kScopeHeaderSize];
+    end = payload + len;
+    if ((count == 0) || (end - p < (ptrdiff_t)(channels * 4)))
+    {
+        stats.rejected++;
+        return;
+    }
+
+    if (payload[3] == 0)
+        std::printf("# scope trigger at tick %u\n", trigger);
+    if ((mask | kScopeMaskFlag) != lastMask)
+    {
+        PrintHeader(mask);
+        lastMask = mask | kScopeMaskFlag;
+    }
+
+    for (uint32_t c = 0; c < channels; c++, p += 4)
+        values[c] = (int32_t)Get32(p);
+    PrintSample(tick, mask, values);
+
+    for (uint32_t n = 1; n < count; n++)
+    {
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            uint32_t zigzag;
+            if (!GetVarint(p, end, zigzag))
+            {
+                stats.rejected++;
+                return;
+            }
+            values[c] += (int32_t)((zigzag >> 1) ^ (0u - (zigzag & 1)));
+        }
+        PrintSample(tick + n * decimation, mask, values);
+    }
+
+    stats.frames++;
+    stats.samples += count;
+}
+
+//
+// Decode one frame (without its delimiter) and print its samples
+//
+void HandleFrame(const std::vector<uint8_t> &frame, uint32_t &lastMask,
+                 Stats &stats)
+{
+    std::vector<uint8_t> payload(frame.size());
+    int32_t len;
+    uint32_t mask, count, tick, decimation, channels;
+    const uint8_t *p;
+
+    len = FrameDecode(frame.data(), (uint32_t)frame.size(), payload.data());
+    if ((len > 0) && (payload[0] == kFrameScopeBlock))
+    {
+        HandleScopeBlock(payload.data(), len, lastMask, stats);
+        return;
+    }
+
+    if ((len < (int32_t)kHeaderSize) || (payload[0] != kFrameSamples))
+    {
+        //
+        // Console text between frames ends up here as well
+        //
+        stats.rejected++;
+        return;
+    }
+
+    mask = payload[1];
+    count = payload[2];
+    tick = Get32(&payload[4]);
+    decimation = payload[8] | ((uint32_t)payload[9] << 8);
+
+    channels = 0;
+    for (int ch = 0; ch < 8; ch++)
+        if (mask & (1u << ch))
+            channels++;
+
+    if ((size_t)len != kHeaderSize + count * channels * 4)
+    {
+        stats.rejected++;
+        return;
+    }
+
+    if (mask != lastMask)
+    {
+        PrintHeader(mask);
+        lastMask = mask;
+    }
+
+    stats.frames++;
+    stats.dropped += payload[3];
+
+    p = &payload[kHeaderSize];
+    for (uint32_t n = 0; n < count; n++)
+    {
+        int32_t values[8];
+
+        for (uint32_t c = 0; c < channels; c++, p += 4)
+            values[c] = (int32_t)Get32(p);
+        PrintSample(tick + n * decimation, mask, values);
+        stats.samples++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s <device|file> [baud]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned long baud = (argc > 2) ? std::stoul(argv[2]) : 115200;
+
+    int fd = open(argv[1], O_RDONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        std::perror(argv[1]);
+        return 1;
+    }
+
+    if (!ConfigurePort(fd, baud))
+    {
+        std::fprintf(stderr, "Cannot configure %s\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    std::vector<uint8_t> frame;
+    uint8_t buf[512];
+    uint32_t lastMask = 0;
+    Stats stats;
+    ssize_t got;
+
+    while ((got = read(fd, buf, sizeof(buf))) > 0)
+    {
+        for (ssize_t i = 0; i < got; i++)
+        {
+            if (buf[i] != 0)
+            {
+                //
+                // Anything longer than the largest frame is not a frame
+                //
+                if (frame.size() < FRAME_MAX_ENCODED(FRAME_MAX_PAYLOAD))
+                    frame.push_back(buf[i]);
+                continue;
+            }
+
+            if (!frame.empty())
+                HandleFrame(frame, lastMask, stats);
+            frame.clear();
+        }
+        std::fflush(stdout);
+    }
+
+    close(fd);
+
+    std::fprintf(stderr, "%lu frames, %lu samples, %lu dropped, %lu rejected\n",
+                 stats.frames, stats.samples, stats.dropped, stats.rejected);
+
+    return 0;
+}
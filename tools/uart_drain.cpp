@@ -0,0 +1,607 @@
+//*****************************************************************************
+//
+// uart_drain.cpp - Host model of the console transmit drain of uartstdio.c.
+//
+// Runs uartstdio.c itself, built with UART_BUFFERED for the interrupt
+// drain or with UART_BUFFERED and UART_BUFFERED_DMA for the uDMA drain,
+// against a model of UART0 and its uDMA channel timed in byte times of the
+// line (10 bits a byte):
+//
+// - the UART sends one byte of its 16 byte transmit FIFO per byte time and
+//   raises the transmit interrupt when the FIFO drains to 2 bytes, the
+//   UART_FIFO_TX1_8 level uartstdio.c sets;
+// - the uDMA channel fills the FIFO whenever it has room, in bursts of up
+//   to four, from the primary or alternate control structure in turn.  A
+//   completed structure goes to stop, pends the UART interrupt and hands
+//   over to the other one.  If that one is stopped too the channel
+//   disables itself before the interrupt can load it, the race the restart
+//   in UARTPrimeTransmit() is there for;
+// - UARTStdioIntHandler() runs as soon as it is pending and not masked,
+//   by BASEPRI at the priority main() gives it (0x40) while a writer holds
+//   the transmit buffer, or by PRIMASK.
+//
+// A writer in place of the main loop queues blocks with UARTwriteRaw(),
+// which drops a block that does not fit, as the telemetry does.  Every
+// queued byte must leave the line once and in order, the line must not
+// idle while bytes are queued, and the CPU must not copy a byte into the
+// FIFO in the uDMA build, nor the uDMA controller in the other.
+//
+// Two loads run for the given line time each: status lines of 80 bytes
+// every 100 ms at CONSOLE_BAUD, and a trace stream at 921600 baud offered
+// 25 % faster than the line sends it, in blocks of 16 to 200 bytes.  Per
+// load the table gives the line use, the blocks dropped, and per kilobyte
+// sent the console interrupts, the bytes the CPU copied into the FIFO and
+// the control structures loaded, then the host time spent in
+// UARTStdioIntHandler() per byte.  Host time only compares the two drains;
+// it is not target cycles.
+//
+// Build, once per drain:
+//   gcc -O2 -DUART_BUFFERED [-DUART_BUFFERED_DMA] -DUART_TX_BUFFER_SIZE=2048
+//       -I.. -I../host/include -c ../uartstdio.c
+//   g++ -std=c++17 -O2 -I.. -I../host/include -DUART_TX_BUFFER_SIZE=2048
+//       -o uart_drain uart_drain.cpp uartstdio.o
+//
+// Usage:
+//   uart_drain [seconds]            default 10 of line time per load
+//
+//*****************************************************************************
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+extern "C"
+{
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "utils/uartstdio.h"
+
+//
+// In the vector table of tm4c123gh6pm_startup_ccs.c
+//
+extern void UARTStdioIntHandler(void);
+}
+
+#include "clock_config.h"
+#include "motor_config.h"
+
+namespace
+{
+
+const uint32_t kFifoSize = 16;
+const uint32_t kFifoTxLevel = 2;            // UART_FIFO_TX1_8
+const uint32_t kDMABurst = 4;               // UDMA_ARB_4
+const uint8_t kUARTPriority = 0x40;         // IntPrioritySet() in main()
+
+//
+// UART0 transmit side
+//
+struct Uart
+{
+    uint32_t base;
+    bool dmaTx;
+    std::deque<uint8_t> fifo;
+    uint32_t ris;
+    uint32_t im;
+};
+
+//
+// The uDMA channel of the UART, its primary (0) and alternate (1) control
+// structures
+//
+struct Structure
+{
+    uint32_t mode;
+    const uint8_t *src;
+    uint32_t count;
+};
+
+struct Dma
+{
+    bool assigned;
+    uint32_t channel;
+    bool enabled;
+    uint32_t active;
+    uint32_t status;
+    Structure s[2];
+};
+
+//
+// The UART interrupt in the NVIC, and the masks of the CPU
+//
+struct Nvic
+{
+    bool enabled;
+    bool pending;
+    bool active;
+    bool primask;
+    uint32_t basepri;
+};
+
+//
+// Counts of one load
+//
+struct Stats
+{
+    uint64_t interrupts;
+    uint64_t cpuBytes;
+    uint64_t dmaBytes;
+    uint64_t loads;
+    double handlerNs;
+};
+
+Uart g_uart;
+Dma g_dma;
+Nvic g_nvic;
+Stats g_stats;
+double g_clockNs;
+
+inline uint8_t Expected(uint64_t i)
+{
+    return static_cast<uint8_t>((i * 2654435761u) >> 13);
+}
+
+//
+// Small deterministic generator
+//
+struct Random
+{
+    uint32_t state;
+
+    uint32_t Next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+double Now()
+{
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//
+// Run the console interrupt for as long as it is pending and unmasked
+//
+void Dispatch()
+{
+    while (g_nvic.enabled && !g_nvic.active && !g_nvic.primask &&
+           (g_nvic.pending || (g_uart.ris & g_uart.im)) &&
+           ((g_nvic.basepri == 0) || (kUARTPriority < g_nvic.basepri)))
+    {
+        double start;
+
+        g_nvic.pending = false;
+        g_nvic.active = true;
+        g_stats.interrupts++;
+
+        start = Now();
+        UARTStdioIntHandler();
+        g_stats.handlerNs += Now() - start - g_clockNs;
+
+        g_nvic.active = false;
+    }
+}
+
+//
+// Let the uDMA controller fill the FIFO from the active structure
+//
+void DmaService()
+{
+    while (g_dma.enabled && g_uart.dmaTx && (g_uart.fifo.size() < kFifoSize))
+    {
+        Structure &s = g_dma.s[g_dma.active];
+        uint32_t n;
+
+        if (s.mode == UDMA_MODE_STOP)
+        {
+            g_dma.enabled = false;
+            break;
+        }
+
+        n = std::min({ kDMABurst, s.count,
+                       static_cast<uint32_t>(kFifoSize - g_uart.fifo.size()) });
+        g_uart.fifo.insert(g_uart.fifo.end(), s.src, s.src + n);
+        s.src += n;
+        s.count -= n;
+        g_stats.dmaBytes += n;
+
+        if (s.count == 0)
+        {
+            bool pingPong = (s.mode == UDMA_MODE_PINGPONG);
+
+            s.mode = UDMA_MODE_STOP;
+            g_dma.status |= 1u << g_dma.channel;
+            g_nvic.pending = true;
+            if (pingPong)
+                g_dma.active ^= 1;
+            else
+                g_dma.enabled = false;
+        }
+    }
+}
+
+//
+// One byte time of the line: the next byte leaves the FIFO.  Returns false
+// if the line stays idle.
+//
+bool LineStep(uint8_t *byte)
+{
+    if (g_uart.fifo.empty())
+        return false;
+
+    *byte = g_uart.fifo.front();
+    g_uart.fifo.pop_front();
+    if (g_uart.fifo.size() == kFifoTxLevel)
+        g_uart.ris |= UART_INT_TX;
+
+    DmaService();
+    Dispatch();
+    return true;
+}
+
+//
+// Calibrate the cost of the two clock reads around the handler
+//
+void CalibrateClock()
+{
+    const int kReads = 10000;
+    double start = Now();
+
+    for (int i = 0; i < kReads; i++)
+        Now();
+    g_clockNs = (Now() - start) / kReads;
+}
+
+//
+// A load of the writer
+//
+struct Load
+{
+    const char *name;
+    uint32_t baud;
+    double period;          // Seconds between blocks, 0 for a stream
+    double rate;            // Offered bytes per byte time of a stream
+    uint32_t minLen;
+    uint32_t maxLen;
+};
+
+//
+// Run a load for the given line time.  Returns the number of errors.
+//
+uint64_t Run(const Load &load, double seconds)
+{
+    const uint32_t kDrainSlots = 2 * UART_TX_BUFFER_SIZE + 100;
+    uint64_t slots = static_cast<uint64_t>(seconds * load.baud / 10);
+    uint64_t period = static_cast<uint64_t>(load.period * load.baud / 10);
+    std::deque<uint8_t> expected;
+    std::vector<uint8_t> block(load.maxLen);
+    Random rng = { 7 };
+    uint64_t offered = 0, blocks = 0, dropped = 0, sent = 0, starved = 0;
+    uint64_t errors = 0, slot, idle, window;
+    uint32_t len = load.minLen;
+    double credit = 0, kb;
+    uint8_t byte;
+
+    g_stats = Stats();
+
+    for (slot = 0; slot < slots; slot++)
+    {
+        //
+        // The writer
+        //
+        credit += load.period ? 0 : load.rate;
+        if (load.period ? (slot % period == 0) : (credit >= len))
+        {
+            for (uint32_t i = 0; i < len; i++)
+                block[i] = Expected(offered + i);
+            offered += len;
+            credit -= load.period ? 0 : len;
+            blocks++;
+
+            if (UARTwriteRaw(block.data(), len) == static_cast<int>(len))
+                expected.insert(expected.end(), block.begin(),
+                                block.begin() + len);
+            else
+                dropped++;
+
+            len = load.minLen + rng.Next() % (load.maxLen - load.minLen + 1);
+        }
+
+        //
+        // The line
+        //
+        if (LineStep(&byte))
+        {
+            if (expected.empty() || (byte != expected.front()))
+                errors++;
+            if (!expected.empty())
+                expected.pop_front();
+            sent++;
+        }
+        else if (!expected.empty())
+            starved++;
+    }
+
+    //
+    // Let the rest out
+    //
+    window = sent;
+    for (idle = 0; !expected.empty() && (idle < kDrainSlots); idle++)
+        if (LineStep(&byte))
+        {
+            if (byte != expected.front())
+                errors++;
+            expected.pop_front();
+            sent++;
+        }
+        else
+            starved++;
+
+    errors += expected.size() + starved;
+    kb = std::max<uint64_t>(sent, 1) / 1024.0;
+    if (g_dma.assigned ? (g_stats.cpuBytes != 0) : (g_stats.dmaBytes != 0))
+        errors++;
+
+    std::printf("  %-7s %7u %7.1f %9llu %9.1f %9.1f %9.2f %9.1f %7llu\n",
+                load.name, load.baud, 100.0 * window / slots,
+                static_cast<unsigned long long>(dropped),
+                g_stats.interrupts / kb, g_stats.cpuBytes / kb,
+                g_stats.loads / kb, g_stats.handlerNs / 1024 / kb,
+                static_cast<unsigned long long>(errors));
+
+    return errors;
+}
+
+} // namespace
+
+//*****************************************************************************
+//
+// The driverlib calls of uartstdio.c, on the model
+//
+//*****************************************************************************
+extern "C"
+{
+
+bool IntMasterEnable(void)
+{
+    bool wasDisabled = g_nvic.primask;
+
+    g_nvic.primask = false;
+    Dispatch();
+    return wasDisabled;
+}
+
+bool IntMasterDisable(void)
+{
+    bool wasDisabled = g_nvic.primask;
+
+    g_nvic.primask = true;
+    return wasDisabled;
+}
+
+void IntEnable(uint32_t ui32Interrupt)
+{
+    if (ui32Interrupt == INT_UART0)
+        g_nvic.enabled = true;
+}
+
+void IntPendSet(uint32_t ui32Interrupt)
+{
+    if (ui32Interrupt == INT_UART0)
+        g_nvic.pending = true;
+}
+
+int32_t IntPriorityGet(uint32_t ui32Interrupt)
+{
+    return kUARTPriority;
+}
+
+void IntPriorityMaskSet(uint32_t ui32PriorityMask)
+{
+    g_nvic.basepri = ui32PriorityMask;
+    Dispatch();
+}
+
+uint32_t IntPriorityMaskGet(void)
+{
+    return g_nvic.basepri;
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+bool SysCtlPeripheralPresent(uint32_t ui32Peripheral)
+{
+    return ui32Peripheral == SYSCTL_PERIPH_UART0;
+}
+
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                         uint32_t ui32Baud, uint32_t ui32Config)
+{
+    g_uart.base = ui32Base;
+}
+
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                      uint32_t ui32RxLevel)
+{
+}
+
+void UARTEnable(uint32_t ui32Base)
+{
+}
+
+void UARTDMAEnable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    g_uart.dmaTx = (ui32DMAFlags & UART_DMA_TX) != 0;
+}
+
+bool UARTCharsAvail(uint32_t ui32Base)
+{
+    return false;
+}
+
+bool UARTSpaceAvail(uint32_t ui32Base)
+{
+    return g_uart.fifo.size() < kFifoSize;
+}
+
+int32_t UARTCharGet(uint32_t ui32Base)
+{
+    std::fprintf(stderr, "UARTCharGet() with nothing to receive\n");
+    std::exit(2);
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    return -1;
+}
+
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    //
+    // Only the unbuffered build of uartstdio.c polls the FIFO
+    //
+    std::fprintf(stderr, "UARTCharPut() in a buffered build\n");
+    std::exit(2);
+}
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    if (g_uart.fifo.size() >= kFifoSize)
+        return false;
+
+    g_uart.fifo.push_back(ucData);
+    g_stats.cpuBytes++;
+    return true;
+}
+
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    g_uart.im |= ui32IntFlags;
+}
+
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    g_uart.im &= ~ui32IntFlags;
+}
+
+uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    return bMasked ? (g_uart.ris & g_uart.im) : g_uart.ris;
+}
+
+void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    g_uart.ris &= ~ui32IntFlags;
+}
+
+void uDMAChannelAssign(uint32_t ui32Mapping)
+{
+    g_dma.assigned = true;
+    g_dma.channel = ui32Mapping & 0x1F;
+}
+
+void uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    if (ui32Attr & UDMA_ATTR_ALTSELECT)
+        g_dma.active = 0;
+}
+
+void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex,
+                           uint32_t ui32Control)
+{
+}
+
+void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex,
+                            uint32_t ui32Mode, void *pvSrcAddr,
+                            void *pvDstAddr, uint32_t ui32TransferSize)
+{
+    Structure &s = g_dma.s[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0];
+
+    if (reinterpret_cast<uintptr_t>(pvDstAddr) != g_uart.base + UART_O_DR)
+    {
+        std::fprintf(stderr, "uDMA transfer not to the UART data register\n");
+        std::exit(2);
+    }
+
+    s.mode = ui32Mode;
+    s.src = static_cast<const uint8_t *>(pvSrcAddr);
+    s.count = ui32TransferSize;
+    g_stats.loads++;
+}
+
+void uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    g_dma.enabled = true;
+    DmaService();
+}
+
+void uDMAChannelDisable(uint32_t ui32ChannelNum)
+{
+    g_dma.enabled = false;
+}
+
+bool uDMAChannelIsEnabled(uint32_t ui32ChannelNum)
+{
+    return g_dma.enabled;
+}
+
+uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    return g_dma.s[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0].mode;
+}
+
+uint32_t uDMAIntStatus(void)
+{
+    return g_dma.status;
+}
+
+void uDMAIntClear(uint32_t ui32ChanMask)
+{
+    g_dma.status &= ~ui32ChanMask;
+}
+
+} // extern "C"
+
+int main(int argc, char **argv)
+{
+    const Load loads[] =
+    {
+        { "status", CONSOLE_BAUD, 0.1, 0, 80, 80 },
+        { "trace", 921600, 0, 1.25, 16, 200 },
+    };
+    double seconds = 10;
+    uint64_t errors = 0;
+
+    if (argc > 1)
+        seconds = std::strtod(argv[1], 0);
+
+    CalibrateClock();
+    UARTStdioConfig(0, CONSOLE_BAUD, SYSTEM_CLOCK_HZ);
+
+    std::printf("drain   %s, %u byte buffer, %.0f s per load\n",
+                g_dma.assigned ? "uDMA" : "interrupt", UART_TX_BUFFER_SIZE,
+                seconds);
+    std::printf("  %-7s %7s %7s %9s %9s %9s %9s %9s %7s\n", "load", "baud",
+                "line %", "dropped", "ints/KB", "cpu B/KB", "loads/KB",
+                "ns/byte", "errors");
+    for (const Load &load : loads)
+        errors += Run(load, seconds);
+
+    std::printf("%s\n", errors ? "FAILED" : "ok");
+    return errors ? 1 : 0;
+}
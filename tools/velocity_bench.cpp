@@ -0,0 +1,205 @@
+//*****************************************************************************
+//
+// velocity_bench.cpp - Host comparison of the velocity estimators.
+//
+// Runs the estimators of velocity.c, and a model of the QEI velocity
+// capture they replace, on synthetic encoder signals sampled at
+// CONTROL_TICK_HZ and prints, per method:
+//
+//   slow  - RMS error [counts/s] at a constant 150 counts/s
+//   fast  - RMS error [counts/s] at a constant 14321 counts/s
+//   lag   - mean lag [ms] while accelerating at 200000 counts/s^2
+//   ns    - host time per estimate (not target cycles; use "tasks" with
+//           ISR_TIMING on the target for those)
+//
+// The encoder position is the floor of the true position, with a random
+// phase per run so that the results do not depend on a lucky alignment.
+//
+// Build:
+//   g++ -std=c++17 -O2 -I.. -o velocity_bench velocity_bench.cpp ../velocity.c
+//
+//*****************************************************************************
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "clock_config.h"
+#include "velocity.h"
+
+namespace
+{
+
+const double kTick = 1.0 / CONTROL_TICK_HZ;
+
+//
+// QEI velocity capture as configured in motor.c: edges predivided by 16,
+// counted over the default capture window of 800 us (8 ticks,
+// clock_config.h) and latched at the end of each period
+//
+struct QeiCapture
+{
+    int64_t start = 0;
+    int32_t latched = 0;
+    uint32_t ticks = 0;
+};
+
+int32_t QeiCaptureUpdate(QeiCapture &q, int64_t position)
+{
+    const uint32_t kPeriodTicks = CONTROL_TICK_HZ / CLOCK_QEI_VELOCITY_HZ;
+
+    if (++q.ticks == kPeriodTicks)
+    {
+        int64_t pulses = (position >> 4) - (q.start >> 4);
+        q.latched = (int32_t)(pulses * 16 * CONTROL_TICK_HZ / kPeriodTicks);
+        q.start = position;
+        q.ticks = 0;
+    }
+    return q.latched;
+}
+
+enum Method { kQei, kDifference, kMT, kTracker, kNumMethods };
+
+const char *const kMethodNames[kNumMethods] =
+{
+    "qei", "difference", "mt", "tracker"
+};
+
+//
+// Run one method over a velocity profile and return the estimates
+//
+std::vector<int32_t> Run(Method m, const std::vector<int64_t> &positions)
+{
+    std::vector<int32_t> out(positions.size());
+    tVelocityEstimator est;
+    QeiCapture qei;
+
+    VelocityInit(&est, positions[0]);
+    qei.start = positions[0];
+
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        switch (m)
+        {
+            case kQei:
+                out[i] = QeiCaptureUpdate(qei, positions[i]);
+                break;
+            case kDifference:
+                out[i] = VelocityDifference(&est, positions[i]);
+                break;
+            case kMT:
+                out[i] = VelocityMT(&est, positions[i]);
+                break;
+            default:
+                out[i] = VelocityTracker(&est, positions[i]);
+                break;
+        }
+    }
+    return out;
+}
+
+//
+// Sampled encoder positions and true velocities of a profile starting at
+// v0 with constant acceleration a
+//
+void Profile(double v0, double a, size_t n, double phase,
+             std::vector<int64_t> &positions, std::vector<double> &velocity)
+{
+    positions.resize(n);
+    velocity.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        double t = i * kTick;
+        positions[i] = (int64_t)std::floor(phase + v0 * t + 0.5 * a * t * t);
+        velocity[i] = v0 + a * t;
+    }
+}
+
+//
+// RMS error after the estimator has settled
+//
+double RmsError(Method m, double v, double phase)
+{
+    std::vector<int64_t> positions;
+    std::vector<double> velocity;
+    double sum = 0;
+    size_t i, skip = CONTROL_TICK_HZ / 2, n = 4 * CONTROL_TICK_HZ;
+
+    Profile(v, 0, n, phase, positions, velocity);
+    std::vector<int32_t> est = Run(m, positions);
+    for (i = skip; i < n; i++)
+        sum += (est[i] - velocity[i]) * (est[i] - velocity[i]);
+    return std::sqrt(sum / (n - skip));
+}
+
+//
+// Mean lag while accelerating, from the mean velocity error
+//
+double LagMs(Method m, double phase)
+{
+    const double kAccel = 200000.0;
+    std::vector<int64_t> positions;
+    std::vector<double> velocity;
+    double sum = 0;
+    size_t i, skip = CONTROL_TICK_HZ / 50, n = CONTROL_TICK_HZ / 10;
+
+    Profile(0, kAccel, n, phase, positions, velocity);
+    std::vector<int32_t> est = Run(m, positions);
+    for (i = skip; i < n; i++)
+        sum += velocity[i] - est[i];
+    return 1000.0 * sum / (n - skip) / kAccel;
+}
+
+//
+// Host time per estimate
+//
+double NsPerEstimate(Method m)
+{
+    std::vector<int64_t> positions;
+    std::vector<double> velocity;
+    volatile int32_t sink = 0;
+    int r;
+
+    Profile(5000, 0, 1000000, 0.5, positions, velocity);
+    auto start = std::chrono::steady_clock::now();
+    for (r = 0; r < 5; r++)
+        sink = sink + Run(m, positions).back();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+           (5.0 * positions.size());
+}
+
+} // namespace
+
+int main()
+{
+    const int kRuns = 8;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> phase(0.0, 1.0);
+    int m, r;
+
+    std::printf("%-12s %10s %10s %8s %6s\n", "method", "slow", "fast", "lag",
+                "ns");
+
+    for (m = 0; m < kNumMethods; m++)
+    {
+        double slow = 0, fast = 0, lag = 0;
+
+        for (r = 0; r < kRuns; r++)
+        {
+            double p = phase(rng);
+            slow += RmsError((Method)m, 150.0, p);
+            fast += RmsError((Method)m, 14321.0, p);
+            lag += LagMs((Method)m, p);
+        }
+
+        std::printf("%-12s %10.1f %10.1f %8.3f %6.1f\n", kMethodNames[m],
+                    slow / kRuns, fast / kRuns, lag / kRuns,
+                    NsPerEstimate((Method)m));
+    }
+
+    return 0;
+}
@@ -0,0 +1,269 @@
+//*****************************************************************************
+//
+// trajectory.c - Jerk limited point to point trajectories.
+//
+// Planning (square roots and divisions) is done in the foreground.  The
+// finished move is handed to the control interrupt through Next/NextValid,
+// and the interrupt only adopts it while the axis is idle, so the two never
+// write the same fields at the same time.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "motor_config.h"
+#include "trajectory.h"
+
+//*****************************************************************************
+//
+// Direction of the jerk in each segment
+//
+//*****************************************************************************
+static const float g_pfTrajectoryJerkSign[TRAJECTORY_SEGMENTS] =
+{
+    1.0f, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f
+};
+
+
+//*****************************************************************************
+//
+// Put the axis at rest at i64Position.  Not to be called while the control
+// interrupt steps the axis.
+//
+//*****************************************************************************
+void TrajectoryInit(tTrajectory *psTraj, int64_t i64Position)
+{
+    psTraj->Position = i64Position;
+    psTraj->Fraction = 0.0f;
+    psTraj->Velocity = 0.0f;
+    psTraj->Accel = 0.0f;
+    psTraj->Segment = TRAJECTORY_SEGMENTS;
+    psTraj->Remaining = 0;
+    psTraj->NextValid = false;
+
+    TrajectoryLimitsSet(psTraj, TRAJECTORY_VELOCITY_MAX, TRAJECTORY_ACCEL_MAX,
+                        TRAJECTORY_JERK_MAX);
+}
+
+
+//*****************************************************************************
+//
+// Set the limits used by the next moves, in counts/s, counts/s^2 and
+// counts/s^3
+//
+//*****************************************************************************
+void TrajectoryLimitsSet(tTrajectory *psTraj, float fVelocity, float fAccel,
+                         float fJerk)
+{
+    const float fDt = 1.0f / CONTROL_TICK_HZ;
+
+    psTraj->VelocityMax = fVelocity * fDt;
+    psTraj->AccelMax = fAccel * fDt * fDt;
+    psTraj->JerkMax = fJerk * fDt * fDt * fDt;
+}
+
+
+//*****************************************************************************
+//
+// True while a move is running or waiting to start
+//
+//*****************************************************************************
+bool TrajectoryBusy(const tTrajectory *psTraj)
+{
+    return (psTraj->Segment < TRAJECTORY_SEGMENTS) || psTraj->NextValid;
+}
+
+
+//*****************************************************************************
+//
+// Plan a move from the current (resting) position to i64Target.  Returns
+// false if the axis is still busy.  Called from the foreground.
+//
+//*****************************************************************************
+bool TrajectoryMoveTo(tTrajectory *psTraj, int64_t i64Target)
+{
+    tTrajectoryMove *psMove = &psTraj->Next;
+    float fDistance, fSign, fV, fA, fJ, fTj, fTa, fTv;
+    uint32_t ui32Tj, ui32Ta, ui32Tv, i;
+
+    if (TrajectoryBusy(psTraj))
+        return false;
+
+    fDistance = (float)(i64Target - psTraj->Position);
+    if (fDistance == 0.0f)
+        return true;
+
+    fSign = 1.0f;
+    if (fDistance < 0.0f)
+    {
+        fSign = -1.0f;
+        fDistance = -fDistance;
+    }
+
+    fV = psTraj->VelocityMax;
+    fA = psTraj->AccelMax;
+    fJ = psTraj->JerkMax;
+
+    //
+    // Jerk and constant acceleration phases.  If the velocity limit is
+    // reached while the acceleration is still ramping up, the acceleration
+    // limit is never reached.
+    //
+    fTj = fA / fJ;
+    if (fV < fA * fTj)
+    {
+        fTj = sqrtf(fV / fJ);
+        fA = fJ * fTj;
+        fTa = 0.0f;
+    }
+    else
+    {
+        fTa = fV / fA - fTj;
+    }
+
+    //
+    // Cruise phase, or a shorter profile that does not reach the velocity
+    // limit.  The distance of the accelerate and decelerate phases is
+    // fA * (fTj + fTa) * (2 * fTj + fTa).
+    //
+    if (fDistance >= fV * (2.0f * fTj + fTa))
+    {
+        fTv = (fDistance - fV * (2.0f * fTj + fTa)) / fV;
+    }
+    else if (fDistance >= 2.0f * fA * fTj * fTj)
+    {
+        fTa = 0.5f * (sqrtf(fTj * fTj + 4.0f * fDistance / fA) - 3.0f * fTj);
+        fTv = 0.0f;
+    }
+    else
+    {
+        fTj = cbrtf(fDistance / (2.0f * fJ));
+        fTa = 0.0f;
+        fTv = 0.0f;
+    }
+
+    //
+    // Round up to whole ticks and scale the jerk down so that the move
+    // covers the distance exactly.  Longer segments only lower the peak
+    // jerk, acceleration and velocity.
+    //
+    ui32Tj = (uint32_t)ceilf(fTj);
+    ui32Ta = (uint32_t)ceilf(fTa);
+    ui32Tv = (uint32_t)ceilf(fTv);
+    if (ui32Tj == 0)
+        ui32Tj = 1;
+
+    fJ = fSign * fDistance /
+         ((float)ui32Tj * (float)(ui32Tj + ui32Ta) *
+          (float)(2 * ui32Tj + ui32Ta + ui32Tv));
+
+    psMove->Target = i64Target;
+    psMove->Ticks[0] = ui32Tj;
+    psMove->Ticks[1] = ui32Ta;
+    psMove->Ticks[2] = ui32Tj;
+    psMove->Ticks[3] = ui32Tv;
+    psMove->Ticks[4] = ui32Tj;
+    psMove->Ticks[5] = ui32Ta;
+    psMove->Ticks[6] = ui32Tj;
+
+    fV = 0.0f;
+    fA = 0.0f;
+    for (i = 0; i < TRAJECTORY_SEGMENTS; i++)
+    {
+        psMove->Jerk[i] = g_pfTrajectoryJerkSign[i] * fJ;
+        psMove->JerkHalf[i] = psMove->Jerk[i] * 0.5f;
+        psMove->JerkSixth[i] = psMove->Jerk[i] * (1.0f / 6.0f);
+
+        psMove->Velocity[i] = fV;
+        psMove->Accel[i] = fA;
+        fV += (fA + psMove->JerkHalf[i] * psMove->Ticks[i]) * psMove->Ticks[i];
+        fA += psMove->Jerk[i] * psMove->Ticks[i];
+    }
+
+    //
+    // Hand the move to the control interrupt
+    //
+    psTraj->NextValid = true;
+
+    return true;
+}
+
+
+//*****************************************************************************
+//
+// Move on to the next segment that is not empty, or finish the move
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(TrajectoryNextSegment, ".ramfunc")
+#endif
+static void TrajectoryNextSegment(tTrajectory *psTraj)
+{
+    while (++psTraj->Segment < TRAJECTORY_SEGMENTS)
+    {
+        psTraj->Remaining = psTraj->Move.Ticks[psTraj->Segment];
+        if (psTraj->Remaining)
+        {
+            psTraj->Velocity = psTraj->Move.Velocity[psTraj->Segment];
+            psTraj->Accel = psTraj->Move.Accel[psTraj->Segment];
+            return;
+        }
+    }
+
+    //
+    // Done - land exactly on the target
+    //
+    psTraj->Position = psTraj->Move.Target;
+    psTraj->Fraction = 0.0f;
+    psTraj->Velocity = 0.0f;
+    psTraj->Accel = 0.0f;
+}
+
+
+//*****************************************************************************
+//
+// Advance the reference by one tick.  Called from the control interrupt.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(TrajectoryStep, ".ramfunc")
+#endif
+void TrajectoryStep(tTrajectory *psTraj)
+{
+    uint32_t ui32Segment;
+    int32_t i32Whole;
+    float fStep;
+
+    //
+    // Idle - start the next move if one has been planned
+    //
+    if (psTraj->Segment >= TRAJECTORY_SEGMENTS)
+    {
+        if (!psTraj->NextValid)
+            return;
+
+        psTraj->Move = psTraj->Next;
+        psTraj->NextValid = false;
+        psTraj->Segment = (uint32_t)-1;
+        TrajectoryNextSegment(psTraj);
+    }
+
+    ui32Segment = psTraj->Segment;
+
+    fStep = psTraj->Velocity + psTraj->Accel * 0.5f +
+            psTraj->Move.JerkSixth[ui32Segment];
+    psTraj->Velocity += psTraj->Accel + psTraj->Move.JerkHalf[ui32Segment];
+    psTraj->Accel += psTraj->Move.Jerk[ui32Segment];
+
+    //
+    // Carry whole counts from the fraction into the position
+    //
+    psTraj->Fraction += fStep;
+    i32Whole = (int32_t)psTraj->Fraction;
+    psTraj->Position += i32Whole;
+    psTraj->Fraction -= (float)i32Whole;
+
+    if (--psTraj->Remaining == 0)
+        TrajectoryNextSegment(psTraj);
+}
@@ -0,0 +1,90 @@
+//*****************************************************************************
+//
+// trajectory.h - Jerk limited point to point trajectories.
+//
+// A move is planned in the foreground by TrajectoryMoveTo() as a seven
+// segment S-curve: jerk up, constant acceleration, jerk down, cruise and
+// the mirror image to stop.  Segment lengths are whole control ticks, and
+// the jerk is scaled so that the move ends exactly on the target while no
+// limit is exceeded.  With the jerk limit set very high the profile
+// degenerates to a trapezoid.
+//
+// TrajectoryStep() runs once per tick in the control interrupt.  Within a
+// segment the jerk is constant, so position, velocity and acceleration
+// are advanced with the exact polynomial increments and no division:
+//
+//   p += v + a/2 + j/6
+//   v += a + j/2
+//   a += j
+//
+// The position is kept as 64-bit whole counts plus a float fraction so
+// that the precision does not depend on where the axis is.  Velocity and
+// acceleration are reloaded with their planned values at every segment
+// boundary, so rounding errors do not build up over long moves.
+//
+//*****************************************************************************
+
+#ifndef __TRAJECTORY_H__
+#define __TRAJECTORY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRAJECTORY_SEGMENTS     7
+
+//*****************************************************************************
+//
+// One planned move - segment lengths and the jerk terms of each segment
+//
+//*****************************************************************************
+typedef struct
+{
+    int64_t Target;                         // [counts]
+    uint32_t Ticks[TRAJECTORY_SEGMENTS];    // Segment lengths [ticks]
+    float Jerk[TRAJECTORY_SEGMENTS];        // j
+    float JerkHalf[TRAJECTORY_SEGMENTS];    // j/2
+    float JerkSixth[TRAJECTORY_SEGMENTS];   // j/6
+    float Velocity[TRAJECTORY_SEGMENTS];    // Planned velocity at the start
+    float Accel[TRAJECTORY_SEGMENTS];       // Planned acceleration at the start
+}
+tTrajectoryMove;
+
+//*****************************************************************************
+//
+// State of one axis.  Position, Velocity and Accel are the reference for
+// the controller.
+//
+//*****************************************************************************
+typedef struct
+{
+    int64_t Position;           // Reference position [counts]
+    float Fraction;             // Sub-count part of the position
+    float Velocity;             // Reference velocity [counts/tick]
+    float Accel;                // Reference acceleration [counts/tick^2]
+
+    uint32_t Segment;           // Running segment, TRAJECTORY_SEGMENTS if idle
+    uint32_t Remaining;         // Ticks left in the segment
+    tTrajectoryMove Move;       // Move being executed
+
+    tTrajectoryMove Next;       // Move handed over by the foreground
+    volatile bool NextValid;
+
+    float VelocityMax;          // [counts/tick]
+    float AccelMax;             // [counts/tick^2]
+    float JerkMax;              // [counts/tick^3]
+}
+tTrajectory;
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void TrajectoryInit(tTrajectory *psTraj, int64_t i64Position);
+extern void TrajectoryLimitsSet(tTrajectory *psTraj, float fVelocity,
+                                float fAccel, float fJerk);
+extern bool TrajectoryBusy(const tTrajectory *psTraj);
+extern bool TrajectoryMoveTo(tTrajectory *psTraj, int64_t i64Target);
+extern void TrajectoryStep(tTrajectory *psTraj);
+
+#endif // __TRAJECTORY_H__
@@ -35,7 +35,9 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
+#include "driverlib/udma.h"
 #include "utils/uartstdio.h"
+#include "ringbuf.h"
 
 //*****************************************************************************
 //
@@ -65,57 +67,15 @@ static bool g_bDisableEcho;
 
 //*****************************************************************************
 //
-// Output ring buffer.  Buffer is full if g_ui32UARTTxReadIndex is one ahead of
-// g_ui32UARTTxWriteIndex.  Buffer is empty if the two indices are the same.
+// Output and input ring buffers (ringbuf.h).  The console interrupt is the
+// only consumer of the output buffer and the only producer of the input
+// buffer.  The output buffer is written by the application, by PendSV and
+// by the console interrupt echoing input; they take turns with
+// UARTTxLock().
 //
 //*****************************************************************************
-static unsigned char g_pcUARTTxBuffer[UART_TX_BUFFER_SIZE];
-static volatile uint32_t g_ui32UARTTxWriteIndex = 0;
-static volatile uint32_t g_ui32UARTTxReadIndex = 0;
-
-//*****************************************************************************
-//
-// Input ring buffer.  Buffer is full if g_ui32UARTTxReadIndex is one ahead of
-// g_ui32UARTTxWriteIndex.  Buffer is empty if the two indices are the same.
-//
-//*****************************************************************************
-static unsigned char g_pcUARTRxBuffer[UART_RX_BUFFER_SIZE];
-static volatile uint32_t g_ui32UARTRxWriteIndex = 0;
-static volatile uint32_t g_ui32UARTRxReadIndex = 0;
-
-//*****************************************************************************
-//
-// Macros to determine number of free and used bytes in the transmit buffer.
-//
-//*****************************************************************************
-#define TX_BUFFER_USED          (GetBufferCount(&g_ui32UARTTxReadIndex,  \
-                                                &g_ui32UARTTxWriteIndex, \
-                                                UART_TX_BUFFER_SIZE))
-#define TX_BUFFER_FREE          (UART_TX_BUFFER_SIZE - TX_BUFFER_USED)
-#define TX_BUFFER_EMPTY         (IsBufferEmpty(&g_ui32UARTTxReadIndex,   \
-                                               &g_ui32UARTTxWriteIndex))
-#define TX_BUFFER_FULL          (IsBufferFull(&g_ui32UARTTxReadIndex,  \
-                                              &g_ui32UARTTxWriteIndex, \
-                                              UART_TX_BUFFER_SIZE))
-#define ADVANCE_TX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_TX_BUFFER_SIZE
-
-//*****************************************************************************
-//
-// Macros to determine number of free and used bytes in the receive buffer.
-//
-//*****************************************************************************
-#define RX_BUFFER_USED          (GetBufferCount(&g_ui32UARTRxReadIndex,  \
-                                                &g_ui32UARTRxWriteIndex, \
-                                                UART_RX_BUFFER_SIZE))
-#define RX_BUFFER_FREE          (UART_RX_BUFFER_SIZE - RX_BUFFER_USED)
-#define RX_BUFFER_EMPTY         (IsBufferEmpty(&g_ui32UARTRxReadIndex,   \
-                                               &g_ui32UARTRxWriteIndex))
-#define RX_BUFFER_FULL          (IsBufferFull(&g_ui32UARTRxReadIndex,  \
-                                              &g_ui32UARTRxWriteIndex, \
-                                              UART_RX_BUFFER_SIZE))
-#define ADVANCE_RX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_RX_BUFFER_SIZE
+RINGBUF_DEFINE(g_sUARTTx, UART_TX_BUFFER_SIZE);
+RINGBUF_DEFINE(g_sUARTRx, UART_RX_BUFFER_SIZE);
 #endif
 
 //*****************************************************************************
@@ -162,6 +122,41 @@ static const uint32_t g_ui32UARTInt[3] =
 static uint32_t g_ui32PortNum;
 #endif
 
+#ifdef UART_BUFFERED_DMA
+//*****************************************************************************
+//
+// The list of uDMA transmit channels for the console UART.
+//
+//*****************************************************************************
+static const uint32_t g_ui32UARTDMATxChannel[3] =
+{
+    UDMA_CH9_UART0TX, UDMA_CH23_UART1TX, UDMA_CH13_UART2TX
+};
+
+#define UART_DMA_CHANNEL        (g_ui32UARTDMATxChannel[g_ui32PortNum] & 0x1F)
+
+//*****************************************************************************
+//
+// The longest span a single uDMA control structure can transfer.
+//
+//*****************************************************************************
+#define UART_DMA_MAX_SPAN       1024
+
+//*****************************************************************************
+//
+// State of the ping-pong transfer.  The bytes between the read index of the
+// transmit buffer and g_ui32UARTTxDMAIndex, which runs freely like the
+// indices of the buffer, have been handed to the uDMA controller, split
+// over the primary (0) and alternate (1) control structures.  The read index
+// only advances when a structure completes.  g_ui32UARTTxDMANext is the
+// structure to load next, which is also the order the controller runs them.
+//
+//*****************************************************************************
+static uint32_t g_ui32UARTTxDMAIndex = 0;
+static uint32_t g_pui32UARTTxDMALen[2];
+static uint32_t g_ui32UARTTxDMANext = 0;
+#endif
+
 //*****************************************************************************
 //
 // The list of UART peripherals.
@@ -172,137 +167,176 @@ static const uint32_t g_ui32UARTPeriph[3] =
     SYSCTL_PERIPH_UART0, SYSCTL_PERIPH_UART1, SYSCTL_PERIPH_UART2
 };
 
+#ifdef UART_BUFFERED
 //*****************************************************************************
 //
-//! Determines whether the ring buffer whose pointers and size are provided
-//! is full or not.
-//!
-//! \param pui32Read points to the read index for the buffer.
-//! \param pui32Write points to the write index for the buffer.
-//! \param ui32Size is the size of the buffer in bytes.
-//!
-//! This function is used to determine whether or not a given ring buffer is
-//! full.  The structure of the code is specifically to ensure that we do not
-//! see warnings from the compiler related to the order of volatile accesses
-//! being undefined.
-//!
-//! \return Returns \b true if the buffer is full or \b false otherwise.
+// Take turns with the other writers of the transmit buffer.  BASEPRI masks
+// the console interrupt and every interrupt below it, PendSV included,
+// while the interrupts above it, the control tick, keep running.  The
+// console interrupt must therefore not be at priority 0, which BASEPRI
+// cannot mask.  Returns the mask to restore with UARTTxUnlock().
 //
 //*****************************************************************************
-#ifdef UART_BUFFERED
-static bool
-IsBufferFull(volatile uint32_t *pui32Read,
-             volatile uint32_t *pui32Write, uint32_t ui32Size)
+static uint32_t
+UARTTxLock(void)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
+    uint32_t ui32Mask, ui32Priority;
 
-    ui32Write = *pui32Write;
-    ui32Read = *pui32Read;
+    ui32Mask = MAP_IntPriorityMaskGet();
+    ui32Priority = (uint32_t)MAP_IntPriorityGet(g_ui32UARTInt[g_ui32PortNum]);
+    ASSERT(ui32Priority != 0);
 
-    return((((ui32Write + 1) % ui32Size) == ui32Read) ? true : false);
+    if((ui32Mask == 0) || (ui32Mask > ui32Priority))
+    {
+        MAP_IntPriorityMaskSet(ui32Priority);
+    }
+
+    return(ui32Mask);
+}
+
+static void
+UARTTxUnlock(uint32_t ui32Mask)
+{
+    MAP_IntPriorityMaskSet(ui32Mask);
+}
+
+//*****************************************************************************
+//
+// Have the console interrupt send what has been published in the transmit
+// buffer.  Called with the transmit buffer locked.
+//
+//*****************************************************************************
+static void
+UARTTxKick(void)
+{
+#ifndef UART_BUFFERED_DMA
+    MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
+#endif
+    MAP_IntPendSet(g_ui32UARTInt[g_ui32PortNum]);
 }
 #endif
 
 //*****************************************************************************
 //
-//! Determines whether the ring buffer whose pointers and size are provided
-//! is empty or not.
-//!
-//! \param pui32Read points to the read index for the buffer.
-//! \param pui32Write points to the write index for the buffer.
-//!
-//! This function is used to determine whether or not a given ring buffer is
-//! empty.  The structure of the code is specifically to ensure that we do not
-//! see warnings from the compiler related to the order of volatile accesses
-//! being undefined.
-//!
-//! \return Returns \b true if the buffer is empty or \b false otherwise.
+// Hand the data waiting in the transmit buffer to the uDMA controller, one
+// contiguous span per idle control structure.  Only called from the console
+// interrupt, the consumer of the transmit buffer.
 //
 //*****************************************************************************
-#ifdef UART_BUFFERED
-static bool
-IsBufferEmpty(volatile uint32_t *pui32Read,
-              volatile uint32_t *pui32Write)
+#ifdef UART_BUFFERED_DMA
+static void
+UARTPrimeTransmit(uint32_t ui32Base)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
+    uint32_t ui32Channel, ui32Span, ui32Select;
+    uint8_t *pui8Data;
 
-    ui32Write = *pui32Write;
-    ui32Read = *pui32Read;
+    ui32Channel = UART_DMA_CHANNEL;
+
+    //
+    // If the channel has stopped with nothing pending, start over with the
+    // primary structure.
+    //
+    if(!MAP_uDMAChannelIsEnabled(ui32Channel) &&
+       (g_pui32UARTTxDMALen[0] == 0) && (g_pui32UARTTxDMALen[1] == 0))
+    {
+        MAP_uDMAChannelAttributeDisable(ui32Channel, UDMA_ATTR_ALTSELECT);
+        g_ui32UARTTxDMANext = 0;
+    }
+
+    //
+    // Load the idle structures, in turn, with the data that has not been
+    // handed to the controller yet.  A span ends at the write index or at
+    // the end of the buffer.
+    //
+    while((g_pui32UARTTxDMALen[g_ui32UARTTxDMANext] == 0) &&
+          ((ui32Span = RingBufSpan(&g_sUARTTx, g_ui32UARTTxDMAIndex,
+                                   &pui8Data)) != 0))
+    {
+        if(ui32Span > UART_DMA_MAX_SPAN)
+        {
+            ui32Span = UART_DMA_MAX_SPAN;
+        }
 
-    return((ui32Write == ui32Read) ? true : false);
+        ui32Select = g_ui32UARTTxDMANext ? UDMA_ALT_SELECT : UDMA_PRI_SELECT;
+        MAP_uDMAChannelTransferSet(ui32Channel | ui32Select,
+                                   UDMA_MODE_PINGPONG,
+                                   pui8Data, (void *)(ui32Base + UART_O_DR),
+                                   ui32Span);
+
+        g_pui32UARTTxDMALen[g_ui32UARTTxDMANext] = ui32Span;
+        g_ui32UARTTxDMAIndex += ui32Span;
+        g_ui32UARTTxDMANext ^= 1;
+    }
+
+    //
+    // (Re)start the channel.  This also covers a structure that was loaded
+    // just after the controller found it idle and stopped.
+    //
+    if(((g_pui32UARTTxDMALen[0] != 0) || (g_pui32UARTTxDMALen[1] != 0)) &&
+       !MAP_uDMAChannelIsEnabled(ui32Channel))
+    {
+        MAP_uDMAChannelEnable(ui32Channel);
+    }
 }
-#endif
 
 //*****************************************************************************
 //
-//! Determines the number of bytes of data contained in a ring buffer.
-//!
-//! \param pui32Read points to the read index for the buffer.
-//! \param pui32Write points to the write index for the buffer.
-//! \param ui32Size is the size of the buffer in bytes.
-//!
-//! This function is used to determine how many bytes of data a given ring
-//! buffer currently contains.  The structure of the code is specifically to
-//! ensure that we do not see warnings from the compiler related to the order
-//! of volatile accesses being undefined.
-//!
-//! \return Returns the number of bytes of data currently in the buffer.
+// Release the buffer space of the control structures that have completed.
+// They always complete in the order they were loaded, so the bytes they
+// carried are at the read index.
 //
 //*****************************************************************************
-#ifdef UART_BUFFERED
-static uint32_t
-GetBufferCount(volatile uint32_t *pui32Read,
-               volatile uint32_t *pui32Write, uint32_t ui32Size)
+static void
+UARTDMATransmitDone(void)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
+    uint32_t ui32Idx, ui32Channel;
 
-    ui32Write = *pui32Write;
-    ui32Read = *pui32Read;
+    ui32Channel = UART_DMA_CHANNEL;
 
-    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
-           (ui32Size - (ui32Read - ui32Write)));
+    for(ui32Idx = 0; ui32Idx < 2; ui32Idx++)
+    {
+        if((g_pui32UARTTxDMALen[ui32Idx] != 0) &&
+           (MAP_uDMAChannelModeGet(ui32Channel |
+                                   (ui32Idx ? UDMA_ALT_SELECT :
+                                              UDMA_PRI_SELECT)) ==
+            UDMA_MODE_STOP))
+        {
+            RingBufRelease(&g_sUARTTx, g_pui32UARTTxDMALen[ui32Idx]);
+            g_pui32UARTTxDMALen[ui32Idx] = 0;
+        }
+    }
 }
-#endif
+#elif defined(UART_BUFFERED)
 
 //*****************************************************************************
 //
 // Take as many bytes from the transmit buffer as we have space for and move
-// them into the UART transmit FIFO.
+// them into the UART transmit FIFO.  Only called from the console
+// interrupt, the consumer of the transmit buffer.
 //
 //*****************************************************************************
-#ifdef UART_BUFFERED
 static void
 UARTPrimeTransmit(uint32_t ui32Base)
 {
+    uint32_t ui32Span, ui32Sent;
+    uint8_t *pui8Data;
+
     //
-    // Do we have any data to transmit?
+    // Feed the FIFO from each contiguous span of published data in turn,
+    // and release what went out.
     //
-    if(!TX_BUFFER_EMPTY)
+    while(MAP_UARTSpaceAvail(ui32Base) &&
+          ((ui32Span = RingBufSpan(&g_sUARTTx, g_sUARTTx.Read,
+                                   &pui8Data)) != 0))
     {
-        //
-        // Disable the UART interrupt.  If we don't do this there is a race
-        // condition which can cause the read index to be corrupted.
-        //
-        MAP_IntDisable(g_ui32UARTInt[g_ui32PortNum]);
-
-        //
-        // Yes - take some characters out of the transmit buffer and feed
-        // them to the UART transmit FIFO.
-        //
-        while(MAP_UARTSpaceAvail(ui32Base) && !TX_BUFFER_EMPTY)
+        ui32Sent = 0;
+        while((ui32Sent < ui32Span) && MAP_UARTSpaceAvail(ui32Base))
         {
-            MAP_UARTCharPutNonBlocking(ui32Base,
-                                      g_pcUARTTxBuffer[g_ui32UARTTxReadIndex]);
-            ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxReadIndex);
+            MAP_UARTCharPutNonBlocking(ui32Base, pui8Data[ui32Sent]);
+            ui32Sent++;
         }
 
-        //
-        // Reenable the UART interrupt.
-        //
-        MAP_IntEnable(g_ui32UARTInt[g_ui32PortNum]);
+        RingBufRelease(&g_sUARTTx, ui32Sent);
     }
 }
 #endif
@@ -379,15 +413,15 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     MAP_UARTFIFOLevelSet(g_ui32Base, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
 
     //
-    // Flush both the buffers.
+    // Remember which interrupt we are dealing with.
     //
-    UARTFlushRx();
-    UARTFlushTx(true);
+    g_ui32PortNum = ui32PortNum;
 
     //
-    // Remember which interrupt we are dealing with.
+    // Flush both the buffers.
     //
-    g_ui32PortNum = ui32PortNum;
+    UARTFlushRx();
+    UARTFlushTx(true);
 
     //
     // We are configured for buffered output so enable the master interrupt
@@ -400,6 +434,23 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     MAP_IntEnable(g_ui32UARTInt[ui32PortNum]);
 #endif
 
+#ifdef UART_BUFFERED_DMA
+    //
+    // Set up the uDMA transmit channel: bytes from memory to the UART data
+    // register, in bursts of four while the FIFO has room.  The transfers
+    // themselves are set up by UARTPrimeTransmit().
+    //
+    MAP_uDMAChannelAssign(g_ui32UARTDMATxChannel[ui32PortNum]);
+    MAP_uDMAChannelAttributeDisable(UART_DMA_CHANNEL, UDMA_ATTR_ALL);
+    MAP_uDMAChannelControlSet(UART_DMA_CHANNEL | UDMA_PRI_SELECT,
+                              (UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                               UDMA_DST_INC_NONE | UDMA_ARB_4));
+    MAP_uDMAChannelControlSet(UART_DMA_CHANNEL | UDMA_ALT_SELECT,
+                              (UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                               UDMA_DST_INC_NONE | UDMA_ARB_4));
+    MAP_UARTDMAEnable(g_ui32Base, UART_DMA_TX);
+#endif
+
     //
     // Enable the UART operation.
     //
@@ -437,6 +488,7 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
 {
 #ifdef UART_BUFFERED
     unsigned int uIdx;
+    uint32_t ui32Mask;
 
     //
     // Check for valid arguments.
@@ -444,6 +496,8 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
     ASSERT(pcBuf != 0);
     ASSERT(g_ui32Base != 0);
 
+    ui32Mask = UARTTxLock();
+
     //
     // Send the characters
     //
@@ -451,51 +505,35 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
     {
         //
         // If the character to the UART is \n, then add a \r before it so that
-        // \n is translated to \n\r in the output.
+        // \n is translated to \n\r in the output.  If the buffer is full,
+        // discard the remaining characters.
         //
-        if(pcBuf[uIdx] == '\n')
+        if((pcBuf[uIdx] == '\n') && !RingBufStage(&g_sUARTTx, '\r'))
         {
-            if(!TX_BUFFER_FULL)
-            {
-                g_pcUARTTxBuffer[g_ui32UARTTxWriteIndex] = '\r';
-                ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxWriteIndex);
-            }
-            else
-            {
-                //
-                // Buffer is full - discard remaining characters and return.
-                //
-                break;
-            }
+            break;
         }
 
         //
         // Send the character to the UART output.
         //
-        if(!TX_BUFFER_FULL)
+        if(!RingBufStage(&g_sUARTTx, pcBuf[uIdx]))
         {
-            g_pcUARTTxBuffer[g_ui32UARTTxWriteIndex] = pcBuf[uIdx];
-            ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxWriteIndex);
-        }
-        else
-        {
-            //
-            // Buffer is full - discard remaining characters and return.
-            //
             break;
         }
     }
 
     //
-    // If we have anything in the buffer, make sure that the UART is set
-    // up to transmit it.
+    // Publish the characters all at once and make sure that the UART is set
+    // up to transmit them.
     //
-    if(!TX_BUFFER_EMPTY)
+    RingBufPublish(&g_sUARTTx);
+    if(RingBufUsed(&g_sUARTTx) != 0)
     {
-        UARTPrimeTransmit(g_ui32Base);
-        MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
+        UARTTxKick();
     }
 
+    UARTTxUnlock(ui32Mask);
+
     //
     // Return the number of characters written.
     //
@@ -536,6 +574,81 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
 #endif
 }
 
+//*****************************************************************************
+//
+//! Writes a block of binary data to the UART output.
+//!
+//! \param pucBuf points to the data to transmit.
+//! \param ui32Len is the number of bytes to transmit.
+//!
+//! Unlike UARTwrite(), this function transmits the bytes exactly as given;
+//! no LF to CRLF translation is performed.  It is intended for binary
+//! protocols sharing the console UART.
+//!
+//! In non-buffered mode, this function is blocking and will not return until
+//! all the bytes have been written to the output FIFO.  In buffered mode,
+//! the block is either queued completely or, if the transmit buffer does not
+//! have room for all of it, not at all.
+//!
+//! \return Returns the count of bytes written (0 or \e ui32Len in buffered
+//! mode).
+//
+//*****************************************************************************
+int
+UARTwriteRaw(const unsigned char *pucBuf, uint32_t ui32Len)
+{
+#ifdef UART_BUFFERED
+    uint32_t ui32Mask;
+    bool bQueued;
+
+    //
+    // Check for valid arguments.
+    //
+    ASSERT(pucBuf != 0);
+    ASSERT(g_ui32Base != 0);
+
+    //
+    // Only queue the block if it fits completely, and make sure that the
+    // UART is set up to transmit it.
+    //
+    ui32Mask = UARTTxLock();
+
+    bQueued = RingBufWrite(&g_sUARTTx, pucBuf, ui32Len);
+    if(bQueued)
+    {
+        UARTTxKick();
+    }
+
+    UARTTxUnlock(ui32Mask);
+
+    //
+    // Return the number of bytes written.
+    //
+    return(bQueued ? ui32Len : 0);
+#else
+    unsigned int uIdx;
+
+    //
+    // Check for valid UART base address, and valid arguments.
+    //
+    ASSERT(g_ui32Base != 0);
+    ASSERT(pucBuf != 0);
+
+    //
+    // Send the bytes.
+    //
+    for(uIdx = 0; uIdx < ui32Len; uIdx++)
+    {
+        MAP_UARTCharPut(g_ui32Base, pucBuf[uIdx]);
+    }
+
+    //
+    // Return the number of bytes written.
+    //
+    return(uIdx);
+#endif
+}
+
 //*****************************************************************************
 //
 //! A simple UART based get string function, with some line processing.
@@ -570,6 +683,7 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
 {
 #ifdef UART_BUFFERED
     uint32_t ui32Count = 0;
+    uint8_t ui8Char;
     int8_t cChar;
 
     //
@@ -593,10 +707,9 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
         //
         // Read the next character from the receive buffer.
         //
-        if(!RX_BUFFER_EMPTY)
+        if(RingBufGet(&g_sUARTRx, &ui8Char))
         {
-            cChar = g_pcUARTRxBuffer[g_ui32UARTRxReadIndex];
-            ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxReadIndex);
+            cChar = (int8_t)ui8Char;
 
             //
             // See if a newline or escape character was received.
@@ -786,12 +899,12 @@ unsigned char
 UARTgetc(void)
 {
 #ifdef UART_BUFFERED
-    unsigned char cChar;
+    uint8_t cChar;
 
     //
-    // Wait for a character to be received.
+    // Wait for a character to be received and read it from the buffer.
     //
-    while(RX_BUFFER_EMPTY)
+    while(!RingBufGet(&g_sUARTRx, &cChar))
     {
         //
         // Block waiting for a character to be received (if the buffer is
@@ -799,12 +912,6 @@ UARTgetc(void)
         //
     }
 
-    //
-    // Read a character from the buffer.
-    //
-    cChar = g_pcUARTRxBuffer[g_ui32UARTRxReadIndex];
-    ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxReadIndex);
-
     //
     // Return the character to the caller.
     //
@@ -1321,7 +1428,7 @@ UARTprintf(const char *pcString, ...)
 int
 UARTRxBytesAvail(void)
 {
-    return(RX_BUFFER_USED);
+    return(RingBufUsed(&g_sUARTRx));
 }
 #endif
 
@@ -1340,7 +1447,7 @@ UARTRxBytesAvail(void)
 int
 UARTTxBytesFree(void)
 {
-    return(TX_BUFFER_FREE);
+    return(RingBufFree(&g_sUARTTx));
 }
 #endif
 
@@ -1369,33 +1476,24 @@ UARTPeek(unsigned char ucChar)
 {
     int iCount;
     int iAvail;
-    uint32_t ui32ReadIndex;
 
     //
     // How many characters are there in the receive buffer?
     //
-    iAvail = (int)RX_BUFFER_USED;
-    ui32ReadIndex = g_ui32UARTRxReadIndex;
+    iAvail = (int)RingBufUsed(&g_sUARTRx);
 
     //
     // Check all the unread characters looking for the one passed.
     //
     for(iCount = 0; iCount < iAvail; iCount++)
     {
-        if(g_pcUARTRxBuffer[ui32ReadIndex] == ucChar)
+        if(RingBufPeek(&g_sUARTRx, iCount) == ucChar)
         {
             //
             // We found it so return the index
             //
             return(iCount);
         }
-        else
-        {
-            //
-            // This one didn't match so move on to the next character.
-            //
-            ADVANCE_RX_BUFFER_INDEX(ui32ReadIndex);
-        }
     }
 
     //
@@ -1421,27 +1519,11 @@ UARTPeek(unsigned char ucChar)
 void
 UARTFlushRx(void)
 {
-    uint32_t ui32Int;
-
     //
-    // Temporarily turn off interrupts.
+    // Flush the receive buffer.  This is the consumer releasing everything
+    // received so far, so the interrupts can stay on.
     //
-    ui32Int = MAP_IntMasterDisable();
-
-    //
-    // Flush the receive buffer.
-    //
-    g_ui32UARTRxReadIndex = 0;
-    g_ui32UARTRxWriteIndex = 0;
-
-    //
-    // If interrupts were enabled when we turned them off, turn them
-    // back on again.
-    //
-    if(!ui32Int)
-    {
-        MAP_IntMasterEnable();
-    }
+    RingBufFlush(&g_sUARTRx);
 }
 #endif
 
@@ -1481,8 +1563,17 @@ UARTFlushTx(bool bDiscard)
         //
         // Flush the transmit buffer.
         //
-        g_ui32UARTTxReadIndex = 0;
-        g_ui32UARTTxWriteIndex = 0;
+        RingBufReset(&g_sUARTTx);
+
+#ifdef UART_BUFFERED_DMA
+        //
+        // Abandon any transfer in progress.
+        //
+        MAP_uDMAChannelDisable(UART_DMA_CHANNEL);
+        g_ui32UARTTxDMAIndex = 0;
+        g_pui32UARTTxDMALen[0] = 0;
+        g_pui32UARTTxDMALen[1] = 0;
+#endif
 
         //
         // If interrupts were enabled when we turned them off, turn them
@@ -1498,7 +1589,7 @@ UARTFlushTx(bool bDiscard)
         //
         // Wait for all remaining data to be transmitted before returning.
         //
-        while(!TX_BUFFER_EMPTY)
+        while(RingBufUsed(&g_sUARTTx) != 0)
         {
         }
     }
@@ -1540,7 +1631,14 @@ UARTEchoSet(bool bEnable)
 //! This function handles interrupts from the UART.  It will copy data from the
 //! transmit buffer to the UART transmit FIFO if space is available, and it
 //! will copy data from the UART receive FIFO to the receive buffer if data is
-//! available.
+//! available.  When built with \b UART_BUFFERED_DMA, it instead
+//! retires completed uDMA transfers and starts the next ones.
+//!
+//! The writers of the transmit buffer pend this interrupt after publishing
+//! data, so that it is the only consumer of the transmit buffer.  With echo
+//! enabled, the line being typed is staged in the receive buffer and only
+//! published at its end, so that backspace can take characters back without
+//! touching data the application may be reading.
 //!
 //! \return None.
 //
@@ -1560,24 +1658,17 @@ UARTStdioIntHandler(void)
     ui32Ints = MAP_UARTIntStatus(g_ui32Base, true);
     MAP_UARTIntClear(g_ui32Base, ui32Ints);
 
+#ifdef UART_BUFFERED_DMA
     //
-    // Are we being interrupted because the TX FIFO has space available?
+    // Has a uDMA transmit structure completed?  If so, free its part of the
+    // transmit buffer.
     //
-    if(ui32Ints & UART_INT_TX)
+    if(MAP_uDMAIntStatus() & (1 << UART_DMA_CHANNEL))
     {
-        //
-        // Move as many bytes as we can into the transmit FIFO.
-        //
-        UARTPrimeTransmit(g_ui32Base);
-
-        //
-        // If the output buffer is empty, turn off the transmit interrupt.
-        //
-        if(TX_BUFFER_EMPTY)
-        {
-            MAP_UARTIntDisable(g_ui32Base, UART_INT_TX);
-        }
+        MAP_uDMAIntClear(1 << UART_DMA_CHANNEL);
+        UARTDMATransmitDone();
     }
+#endif
 
     //
     // Are we being interrupted due to a received character?
@@ -1609,28 +1700,16 @@ UARTStdioIntHandler(void)
                 if(cChar == '\b')
                 {
                     //
-                    // If there are any characters already in the buffer, then
-                    // delete the last.
+                    // If there are any characters of this line left in the
+                    // buffer, then delete the last.
                     //
-                    if(!RX_BUFFER_EMPTY)
+                    if(RingBufUnstage(&g_sUARTRx))
                     {
                         //
                         // Rub out the previous character on the users
                         // terminal.
                         //
                         UARTwrite("\b \b", 3);
-
-                        //
-                        // Decrement the number of characters in the buffer.
-                        //
-                        if(g_ui32UARTRxWriteIndex == 0)
-                        {
-                            g_ui32UARTRxWriteIndex = UART_RX_BUFFER_SIZE - 1;
-                        }
-                        else
-                        {
-                            g_ui32UARTRxWriteIndex--;
-                        }
                     }
 
                     //
@@ -1682,15 +1761,8 @@ UARTStdioIntHandler(void)
             // If there is space in the receive buffer, put the character
             // there, otherwise throw it away.
             //
-            if(!RX_BUFFER_FULL)
+            if(RingBufStage(&g_sUARTRx, (uint8_t)(i32Char & 0xFF)))
             {
-                //
-                // Store the new character in the receive buffer
-                //
-                g_pcUARTRxBuffer[g_ui32UARTRxWriteIndex] =
-                    (unsigned char)(i32Char & 0xFF);
-                ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxWriteIndex);
-
                 //
                 // If echo is enabled, write the character to the transmit
                 // buffer so that the user gets some immediate feedback.
@@ -1700,15 +1772,34 @@ UARTStdioIntHandler(void)
                     UARTwrite((const char *)&cChar, 1);
                 }
             }
+
+            //
+            // Hand the character to the application, with echo enabled only
+            // at the end of the line, or when a line fills the buffer.
+            //
+            if(g_bDisableEcho || (cChar == '\r') ||
+               (RingBufFree(&g_sUARTRx) == 0))
+            {
+                RingBufPublish(&g_sUARTRx);
+            }
         }
+    }
 
-        //
-        // If we wrote anything to the transmit buffer, make sure it actually
-        // gets transmitted.
-        //
-        UARTPrimeTransmit(g_ui32Base);
-        MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
+    //
+    // Move as many bytes as we can from the transmit buffer to the UART,
+    // the echo above included.
+    //
+    UARTPrimeTransmit(g_ui32Base);
+
+#ifndef UART_BUFFERED_DMA
+    //
+    // If the output buffer is empty, turn off the transmit interrupt.
+    //
+    if(RingBufUsed(&g_sUARTTx) == 0)
+    {
+        MAP_UARTIntDisable(g_ui32Base, UART_INT_TX);
     }
+#endif
 }
 #endif
 
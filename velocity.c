@@ -0,0 +1,174 @@
+//*****************************************************************************
+//
+// velocity.c - Per tick velocity estimation from the unwrapped encoder
+// position.
+//
+// All estimators are integer only.  The M/T method divides once per tick,
+// which the Cortex-M4 does in hardware.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "velocity.h"
+
+#if (VELOCITY_WINDOW & (VELOCITY_WINDOW - 1)) != 0
+#error "VELOCITY_WINDOW must be a power of two"
+#endif
+
+#if ((VELOCITY_MT_EVENTS & (VELOCITY_MT_EVENTS - 1)) != 0) || \
+    (VELOCITY_MT_EVENTS <= VELOCITY_MT_MIN_TICKS)
+#error "VELOCITY_MT_EVENTS must be a power of two above VELOCITY_MT_MIN_TICKS"
+#endif
+
+
+//*****************************************************************************
+//
+// Start all estimators at rest on the given position
+//
+//*****************************************************************************
+void VelocityInit(tVelocityEstimator *psEst, int64_t i64Position)
+{
+    uint32_t i;
+
+    for (i = 0; i < VELOCITY_WINDOW; i++)
+        psEst->History[i] = (uint32_t)i64Position;
+    psEst->Slot = 0;
+
+    psEst->EdgePosition[0] = (uint32_t)i64Position;
+    psEst->EdgeTick[0] = 0;
+    psEst->EdgeHead = 1;
+    psEst->EdgeStart = 0;
+    psEst->Tick = 0;
+    psEst->MTVelocity = 0;
+
+    psEst->TrackPosition = i64Position * 65536;
+    psEst->TrackVelocity = 0;
+}
+
+
+//*****************************************************************************
+//
+// Position differencing over VELOCITY_WINDOW ticks.  Only the low 32 bits
+// are kept, their wrapped difference is exact.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(VelocityDifference, ".ramfunc")
+#endif
+int32_t VelocityDifference(tVelocityEstimator *psEst, int64_t i64Position)
+{
+    uint32_t ui32Position = (uint32_t)i64Position;
+    int32_t i32Delta;
+
+    i32Delta = (int32_t)(ui32Position - psEst->History[psEst->Slot]);
+    psEst->History[psEst->Slot] = ui32Position;
+    psEst->Slot = (psEst->Slot + 1) & (VELOCITY_WINDOW - 1);
+
+    return i32Delta * (CONTROL_TICK_HZ / VELOCITY_WINDOW);
+}
+
+
+//*****************************************************************************
+//
+// M/T method.  The event indices run freely and are masked on access.  The
+// start event only moves forward, so finding it is a step or two per tick.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(VelocityMT, ".ramfunc")
+#endif
+int32_t VelocityMT(tVelocityEstimator *psEst, int64_t i64Position)
+{
+    uint32_t ui32Position = (uint32_t)i64Position;
+    uint32_t ui32Newest, ui32Start, ui32Ticks;
+    int32_t i32Bound;
+
+    psEst->Tick++;
+
+    //
+    // Record an event when the position changed
+    //
+    ui32Newest = (psEst->EdgeHead - 1) & (VELOCITY_MT_EVENTS - 1);
+    if (ui32Position != psEst->EdgePosition[ui32Newest])
+    {
+        ui32Newest = psEst->EdgeHead & (VELOCITY_MT_EVENTS - 1);
+        psEst->EdgePosition[ui32Newest] = ui32Position;
+        psEst->EdgeTick[ui32Newest] = psEst->Tick;
+        psEst->EdgeHead++;
+    }
+
+    //
+    // Move the start to the newest event that is old enough
+    //
+    while ((psEst->EdgeStart + 1 != psEst->EdgeHead) &&
+           ((psEst->Tick -
+             psEst->EdgeTick[(psEst->EdgeStart + 1) &
+                             (VELOCITY_MT_EVENTS - 1)]) >=
+            VELOCITY_MT_MIN_TICKS))
+        psEst->EdgeStart++;
+
+    //
+    // Counts over the ticks from the start event to the newest one
+    //
+    ui32Start = psEst->EdgeStart & (VELOCITY_MT_EVENTS - 1);
+    if (ui32Start != ui32Newest)
+        psEst->MTVelocity =
+            (int32_t)(psEst->EdgePosition[ui32Newest] -
+                      psEst->EdgePosition[ui32Start]) * CONTROL_TICK_HZ /
+            (int32_t)(psEst->EdgeTick[ui32Newest] - psEst->EdgeTick[ui32Start]);
+
+    //
+    // No edge for ui32Ticks, so the axis moves at most one count in that
+    // time
+    //
+    ui32Ticks = psEst->Tick - psEst->EdgeTick[ui32Newest];
+    if (ui32Ticks >= VELOCITY_MT_MAX_TICKS)
+    {
+        psEst->MTVelocity = 0;
+    }
+    else if (ui32Ticks)
+    {
+        i32Bound = CONTROL_TICK_HZ / ui32Ticks;
+        if (psEst->MTVelocity > i32Bound)
+            psEst->MTVelocity = i32Bound;
+        else if (psEst->MTVelocity < -i32Bound)
+            psEst->MTVelocity = -i32Bound;
+    }
+
+    return psEst->MTVelocity;
+}
+
+
+//*****************************************************************************
+//
+// Alpha-beta tracker.  The residual saturates at +-32767 counts, far more
+// than the axes move in a tick.
+//
+//*****************************************************************************
+#ifdef CONTROL_RAMFUNC
+#pragma CODE_SECTION(VelocityTracker, ".ramfunc")
+#endif
+int32_t VelocityTracker(tVelocityEstimator *psEst, int64_t i64Position)
+{
+    int64_t i64Residual;
+    int32_t i32Residual;
+
+    //
+    // Predict, then correct with the measured position
+    //
+    psEst->TrackPosition += psEst->TrackVelocity;
+
+    i64Residual = i64Position * 65536 - psEst->TrackPosition;
+    if (i64Residual > INT32_MAX)
+        i32Residual = INT32_MAX;
+    else if (i64Residual < INT32_MIN)
+        i32Residual = INT32_MIN;
+    else
+        i32Residual = (int32_t)i64Residual;
+
+    psEst->TrackPosition += ((int64_t)VELOCITY_TRACKER_ALPHA * i32Residual) >> 16;
+    psEst->TrackVelocity += (int32_t)(((int64_t)VELOCITY_TRACKER_BETA *
+                                       i32Residual) >> 16);
+
+    return (int32_t)(((int64_t)psEst->TrackVelocity * CONTROL_TICK_HZ) >> 16);
+}
@@ -0,0 +1,125 @@
+//*****************************************************************************
+//
+// velocity.h - Per tick velocity estimation from the unwrapped encoder
+// position.
+//
+// The QEI velocity capture only latches a new edge count every capture
+// period and reads zero below one edge per period, so the controllers
+// estimate the velocity themselves from the position read every tick.
+// Three estimators are provided, each called once per tick with the
+// current position and returning counts/s:
+//
+// VelocityDifference() - position change over the last VELOCITY_WINDOW
+//     ticks.  Quantized to TICK_HZ / VELOCITY_WINDOW and lagging by half
+//     the window.
+//
+// VelocityMT() - M/T method.  The ticks on which the position changed are
+//     kept as edge events, and the velocity is the counts between the
+//     newest event and the newest one at least VELOCITY_MT_MIN_TICKS older,
+//     over the ticks between them.  At speed this is position differencing
+//     over VELOCITY_MT_MIN_TICKS; at low speed the interval stretches from
+//     edge to edge, so the resolution is much finer.  While no edge arrives
+//     the estimate is bounded by one count per elapsed time, so it decays
+//     to zero when the axis stops.  The TM4C123 QEI has no edge time
+//     stamps, so edge times are known to one tick.
+//
+// VelocityTracker() - alpha-beta tracker in fixed point, a second order
+//     observer of position and velocity with a bandwidth of
+//     VELOCITY_TRACKER_HZ.  No lag at constant velocity and the encoder
+//     quantization is filtered.
+//
+// Each estimator only touches its own fields of tVelocityEstimator.  The
+// controllers use the one selected in motor_config.h through
+// VelocityUpdate().  tools/velocity_bench.cpp compares them on the host.
+//
+//*****************************************************************************
+
+#ifndef __VELOCITY_H__
+#define __VELOCITY_H__
+
+#include <stdint.h>
+#include "motor_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Estimator parameters
+//
+//*****************************************************************************
+#define VELOCITY_WINDOW         16      // Ticks, a power of two
+#define VELOCITY_MT_MIN_TICKS   16      // Shortest M/T interval [ticks]
+#define VELOCITY_MT_EVENTS      32      // Edge events kept, a power of two
+                                        // above VELOCITY_MT_MIN_TICKS
+#define VELOCITY_MT_MAX_TICKS   2000    // Velocity is zero after [ticks]
+#define VELOCITY_TRACKER_HZ     200     // Tracker bandwidth [Hz]
+
+//*****************************************************************************
+//
+// Tracker gains in Q16, critically damped:
+//   alpha = 2 * w * T,  beta = (w * T)^2,  w = 2 * pi * VELOCITY_TRACKER_HZ
+//
+//*****************************************************************************
+#define VELOCITY_TRACKER_WT     (6.2831853 * VELOCITY_TRACKER_HZ /          \
+                                 CONTROL_TICK_HZ)
+#define VELOCITY_TRACKER_ALPHA  ((int32_t)(2.0 * VELOCITY_TRACKER_WT *      \
+                                           65536.0 + 0.5))
+#define VELOCITY_TRACKER_BETA   ((int32_t)(VELOCITY_TRACKER_WT *            \
+                                           VELOCITY_TRACKER_WT *            \
+                                           65536.0 + 0.5))
+
+//*****************************************************************************
+//
+// State of the estimators of one axis
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t History[VELOCITY_WINDOW];  // Difference: low position bits
+    uint32_t Slot;                      // Difference: oldest entry
+
+    uint32_t EdgePosition[VELOCITY_MT_EVENTS];  // M/T: low position bits
+    uint32_t EdgeTick[VELOCITY_MT_EVENTS];      // M/T: tick of the event
+    uint32_t EdgeHead;                  // M/T: events recorded
+    uint32_t EdgeStart;                 // M/T: interval start event
+    uint32_t Tick;                      // M/T: ticks run
+    int32_t MTVelocity;                 // M/T: last estimate [counts/s]
+
+    int64_t TrackPosition;              // Tracker: Q16 counts
+    int32_t TrackVelocity;              // Tracker: Q16 counts/tick
+}
+tVelocityEstimator;
+
+//*****************************************************************************
+//
+// Estimator used by the controllers
+//
+//*****************************************************************************
+#if defined(VELOCITY_EST_DIFFERENCE)
+#define VelocityUpdate          VelocityDifference
+#elif defined(VELOCITY_EST_TRACKER)
+#define VelocityUpdate          VelocityTracker
+#else
+#define VelocityUpdate          VelocityMT
+#endif
+
+//*****************************************************************************
+//
+// Prototypes
+//
+//*****************************************************************************
+extern void VelocityInit(tVelocityEstimator *psEst, int64_t i64Position);
+extern int32_t VelocityDifference(tVelocityEstimator *psEst,
+                                  int64_t i64Position);
+extern int32_t VelocityMT(tVelocityEstimator *psEst, int64_t i64Position);
+extern int32_t VelocityTracker(tVelocityEstimator *psEst,
+                               int64_t i64Position);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __VELOCITY_H__